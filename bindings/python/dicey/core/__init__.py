@@ -14,4 +14,5 @@
 
 from .builders import *
 from .errors import *
-from .packet import *
\ No newline at end of file
+from .packet import *
+from .types import *
\ No newline at end of file
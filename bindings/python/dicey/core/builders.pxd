@@ -81,6 +81,7 @@ cdef extern from "dicey/dicey.h":
 
     dicey_error dicey_message_builder_init(dicey_message_builder *builder)
     dicey_error dicey_message_builder_begin(dicey_message_builder *builder, dicey_op op)
+    dicey_error dicey_message_builder_begin_streaming(dicey_message_builder *builder, dicey_op op)
     dicey_error dicey_message_builder_build(dicey_message_builder *builder, dicey_packet *packet)
     void dicey_message_builder_discard(dicey_message_builder *builder)
     dicey_error dicey_message_builder_set_path(dicey_message_builder *builder, const char *path)
@@ -113,6 +114,12 @@ cdef extern from "dicey/dicey.h":
     dicey_error dicey_value_builder_pair_start(dicey_value_builder *builder)
     dicey_error dicey_value_builder_pair_end(dicey_value_builder *builder)
     dicey_error dicey_value_builder_set(dicey_value_builder *builder, dicey_arg value)
+    dicey_error dicey_value_builder_set_array(
+        dicey_value_builder *builder,
+        dicey_type type,
+        const void *elems,
+        size_t nitems
+    )
     dicey_error dicey_value_builder_tuple_start(dicey_value_builder *builder)
     dicey_error dicey_value_builder_tuple_end(dicey_value_builder *builder)
 
@@ -125,4 +132,4 @@ cdef extern from "dicey/dicey.h":
         dicey_arg value
     )
 
-cdef void dump_value(dicey_value_builder *value, object obj, list obj_cache, type as_type = *)
\ No newline at end of file
+cdef void dump_value(dicey_value_builder *value, object obj, list obj_cache, object as_type = *)
\ No newline at end of file
@@ -14,9 +14,12 @@
 
 from collections.abc import Iterable as _Iterable
 from dataclasses import dataclass as _dataclass
+import sys as _sys
 from typing import Callable as _Callable
 from uuid import UUID
 
+from cpython.buffer cimport PyBUF_C_CONTIGUOUS, PyBUF_FORMAT, PyObject_CheckBuffer, PyObject_GetBuffer, \
+                           PyBuffer_Release
 from libc.stdint cimport int16_t, int32_t, int64_t, uint8_t, uint16_t, uint32_t, uint64_t
 
 # this only works as long as something includes <stdbool.h> before this file - which is the case, given that Dicey does
@@ -28,11 +31,11 @@ from .builders cimport dicey_value_builder, dicey_value_builder_set, \
                        dicey_value_builder_array_start, dicey_value_builder_array_end, \
                        dicey_value_builder_pair_start, dicey_value_builder_pair_end, \
                        dicey_value_builder_tuple_start, dicey_value_builder_tuple_end, \
-                       dicey_value_builder_next, \
+                       dicey_value_builder_next, dicey_value_builder_set_array, \
                        dicey_arg, dicey_bytes_arg, dicey_error_arg 
 
 from .errors   cimport _check
-from .type     cimport dicey_type, dicey_uuid_from_bytes
+from .type     cimport dicey_type, dicey_type_name, dicey_uuid_from_bytes
 
 cdef class _BuilderHandle:
     cdef dicey_value_builder *value
@@ -45,6 +48,12 @@ cdef class _BuilderHandle:
         cdef dicey_value_builder elem
         cdef dicey_type inner_type = _converter_for(a.type).dtype
 
+        # e.g. Array(float, numpy_array): copy the whole buffer in one go
+        if not isinstance(a.values, (list, tuple)) and PyObject_CheckBuffer(a.values):
+            self.set_buffer(a.values, inner_type)
+
+            return
+
         _check(dicey_value_builder_array_start(self.value, inner_type))
 
         for item in a.values:
@@ -70,6 +79,35 @@ cdef class _BuilderHandle:
 
         _check(dicey_value_builder_set(self.value, arg))
 
+    # any contiguous buffer is either sent as bytes (if its elements are bytes) or as an array of numbers, without
+    # converting its elements one by one. as_type, if given, is the type the elements are required to have, and forces
+    # buffers of bytes to be sent as arrays of bytes
+    cdef void set_buffer(self, object obj, dicey_type as_type = dicey_type.DICEY_TYPE_INVALID):
+        cdef Py_buffer view
+        cdef dicey_arg arg
+
+        PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)
+
+        try:
+            fmt = (<bytes> view.format).decode("ASCII") if view.format else "B"
+            elem_type = _buffer_type(fmt, view.itemsize)
+
+            if as_type != dicey_type.DICEY_TYPE_INVALID and elem_type != as_type:
+                raise TypeError(f"buffer with format '{fmt}' can't hold {dicey_type_name(as_type).decode('ASCII')}s")
+
+            if elem_type == dicey_type.DICEY_TYPE_BYTE and as_type == dicey_type.DICEY_TYPE_INVALID:
+                # the data is only borrowed by the builder: pin the buffer until the message is built
+                self.obj_cache.append(memoryview(obj))
+
+                arg.type = dicey_type.DICEY_TYPE_BYTES
+                arg.bytes = dicey_bytes_arg(view.len, <const uint8_t*> view.buf)
+
+                _check(dicey_value_builder_set(self.value, arg))
+            else:
+                _check(dicey_value_builder_set_array(self.value, elem_type, view.buf, view.len // view.itemsize))
+        finally:
+            PyBuffer_Release(&view)
+
     cdef void set_bytes(self, bytes b):
         cdef dicey_arg arg
         arg.type = dicey_type.DICEY_TYPE_BYTES
@@ -253,6 +291,11 @@ def _add_bool(_BuilderHandle value, b: bool):
 def _add_byte(_BuilderHandle value, by: Byte):
     value.set_byte(by)
 
+# the type is decided by the contents of the buffer: it's either bytes or an array
+@_dicey_matcher(dicey_type.DICEY_TYPE_INVALID)
+def _add_buffer(_BuilderHandle value, b: object):
+    value.set_buffer(b)
+
 @_dicey_matcher(dicey_type.DICEY_TYPE_BYTES)
 def _add_bytes(_BuilderHandle value, b: bytes):
     value.set_bytes(b)
@@ -321,10 +364,57 @@ def _add_unit(_BuilderHandle value, ignored):
 def _add_uuid(_BuilderHandle value, u: UUID):
     value.set_uuid(u)
 
-def _converter_for(type t) -> _Callable:
-    return _assoc_list.get(t)
+# DTF has no 8-bit signed integers and no single precision floats: buffers holding them must be converted first
+_buffer_signed = {
+    2: dicey_type.DICEY_TYPE_INT16,
+    4: dicey_type.DICEY_TYPE_INT32,
+    8: dicey_type.DICEY_TYPE_INT64,
+}
+
+_buffer_unsigned = {
+    1: dicey_type.DICEY_TYPE_BYTE,
+    2: dicey_type.DICEY_TYPE_UINT16,
+    4: dicey_type.DICEY_TYPE_UINT32,
+    8: dicey_type.DICEY_TYPE_UINT64,
+}
+
+def _buffer_type(fmt: str, itemsize: int) -> int:
+    # DTF uses the byte order of the host, so explicit byte orders are only fine if they match it
+    if fmt[:1] in ("@", "=", "<", ">", "!"):
+        order, code = fmt[0], fmt[1:]
+
+        if order in ("<", ">", "!") and (order == "<") != (_sys.byteorder == "little"):
+            raise TypeError(f"buffer with format '{fmt}' has a non-native byte order")
+    else:
+        code = fmt
+
+    elem_type = None
+
+    if code == "?" and itemsize == 1:
+        elem_type = dicey_type.DICEY_TYPE_BOOL
+    elif code == "c":
+        elem_type = dicey_type.DICEY_TYPE_BYTE if itemsize == 1 else None
+    elif code == "d" and itemsize == 8:
+        elem_type = dicey_type.DICEY_TYPE_FLOAT
+    elif code in ("h", "i", "l", "q", "n"):
+        elem_type = _buffer_signed.get(itemsize)
+    elif code in ("B", "H", "I", "L", "Q", "N"):
+        elem_type = _buffer_unsigned.get(itemsize)
+
+    if elem_type is None:
+        raise TypeError(f"unsupported buffer format: '{fmt}'")
+
+    return elem_type
+
+def _converter_for(t: object) -> _Callable:
+    conv = _assoc_list.get(t)
+    if conv is None and isinstance(t, type):
+        # subclasses of known types, e.g. Array[float]
+        conv = next((_assoc_list[base] for base in t.__mro__ if base in _assoc_list), None)
+
+    return conv
 
-cdef void dump_value(dicey_value_builder *const value, object obj, list obj_cache, type as_type = None):
+cdef void dump_value(dicey_value_builder *const value, object obj, list obj_cache, object as_type = None):
     assert isinstance(obj_cache, list)
 
     # hack: the empty tuple should be considered a unit value. Replace () with None.
@@ -335,6 +425,9 @@ cdef void dump_value(dicey_value_builder *const value, object obj, list obj_cach
     
     if assoc_conv:
         assoc_conv(_BuilderHandle.new(value, obj_cache), obj)
+    elif not as_type and PyObject_CheckBuffer(obj):
+        # NumPy arrays, array.array, etc
+        _add_buffer(_BuilderHandle.new(value, obj_cache), obj)
     else:
         raise TypeError(f"unsupported type: {type(obj)}")
 
@@ -358,6 +451,8 @@ _assoc_list = {
     Pair:         _add_pair,
 
     bytes:        _add_bytes,
+    bytearray:    _add_buffer,
+    memoryview:   _add_buffer,
     str:          _add_str,
 
     UUID:         _add_uuid,
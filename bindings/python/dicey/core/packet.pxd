@@ -22,11 +22,12 @@ from .value cimport dicey_value
 from .version cimport dicey_version
 from .type cimport dicey_selector
 
-cdef extern from "dicey/dicey.h":
+cdef extern from "dicey/dicey.h" nogil:
     cdef enum dicey_bye_reason:
         DICEY_BYE_REASON_INVALID
         DICEY_BYE_REASON_SHUTDOWN
         DICEY_BYE_REASON_ERROR
+        DICEY_BYE_REASON_KICKED
 
     cdef enum dicey_op:
         DICEY_OP_INVALID
@@ -54,10 +55,15 @@ cdef extern from "dicey/dicey.h":
         dicey_selector selector
         dicey_value value
 
+    cdef struct dicey_rcbuf:
+        pass
+
     cdef struct dicey_packet:
         void* payload
         size_t nbytes
 
+        dicey_rcbuf* _owner
+
     c_bool dicey_bye_reason_is_valid(dicey_bye_reason reason)
     const char* dicey_bye_reason_to_string(dicey_bye_reason reason)
 
@@ -72,7 +78,9 @@ cdef extern from "dicey/dicey.h":
     dicey_error dicey_packet_as_bye(dicey_packet packet, dicey_bye* bye)
     dicey_error dicey_packet_as_hello(dicey_packet packet, dicey_hello* hello)
     dicey_error dicey_packet_as_message(dicey_packet packet, dicey_message* message)
+    dicey_error dicey_packet_clone(dicey_packet* dest, dicey_packet src)
     void dicey_packet_deinit(dicey_packet* packet)
+    dicey_error dicey_packet_detach(dicey_packet* packet)
     dicey_error dicey_packet_dump(dicey_packet packet, void** data, size_t* nbytes)
     dicey_packet_kind dicey_packet_get_kind(dicey_packet packet)
     dicey_error dicey_packet_get_seq(dicey_packet packet, uint32_t* seq)
@@ -90,7 +98,7 @@ cdef class Message(Packet):
     cdef object _value
     
     @staticmethod
-    cdef Message from_cpacket(dicey_packet packet)
+    cdef Message from_cpacket(dicey_packet packet, object owner=*)
     
     cdef dicey_packet to_cpacket(self)
 
@@ -23,7 +23,7 @@ from libc.stdint cimport uint8_t, uint32_t
 from .errors import BadVersionStrError
 from .types import Path, Selector
 
-from .builders cimport dicey_message_builder, dicey_message_builder_init, dicey_message_builder_begin, \
+from .builders cimport dicey_message_builder, dicey_message_builder_init, dicey_message_builder_begin_streaming, \
                        dicey_message_builder_discard, dicey_message_builder_build, dicey_message_builder_set_seq, \
                        dicey_message_builder_set_path, dicey_message_builder_set_selector, \
                        dicey_message_builder_set_value, dicey_message_builder_value_start, \
@@ -61,7 +61,8 @@ cdef class _MessageBuilder:
         return packet
 
     cdef start(self, int seq, dicey_op op):
-        _check(dicey_message_builder_begin(&self.builder, op))
+        # values are always built in order, so they can be encoded on the fly, without building a tree of arguments
+        _check(dicey_message_builder_begin_streaming(&self.builder, op))
         _check(dicey_message_builder_set_seq(&self.builder, seq))
 
     cdef set_path(self, str path):
@@ -97,6 +98,7 @@ cdef class _PacketWrapper:
 class ByeReason(_Enum):
     SHUTDOWN = dicey_bye_reason.DICEY_BYE_REASON_SHUTDOWN
     ERROR = dicey_bye_reason.DICEY_BYE_REASON_ERROR
+    KICKED = dicey_bye_reason.DICEY_BYE_REASON_KICKED
 
 class Operation(_Enum):
     GET = dicey_op.DICEY_OP_GET
@@ -160,7 +162,11 @@ cdef class Bye(Packet):
         cdef dicey_bye bye
         _check(dicey_packet_as_bye(packet, &bye))
 
-        assert bye.reason in (dicey_bye_reason.DICEY_BYE_REASON_SHUTDOWN, dicey_bye_reason.DICEY_BYE_REASON_ERROR)
+        assert bye.reason in (
+            dicey_bye_reason.DICEY_BYE_REASON_SHUTDOWN,
+            dicey_bye_reason.DICEY_BYE_REASON_ERROR,
+            dicey_bye_reason.DICEY_BYE_REASON_KICKED,
+        )
         reason = ByeReason(bye.reason)
 
         return Bye(reason)
@@ -237,15 +243,16 @@ cdef class Message(Packet):
     def __str__(self) -> str:
         return f"Message(path={self.path}, selector={self.selector}, value={self.value})"
 
+    # if owner is not None, it must own the packet: bytes and arrays of numbers are then returned as memoryviews into it
     @staticmethod
-    cdef Message from_cpacket(dicey_packet packet):
+    cdef Message from_cpacket(dicey_packet packet, object owner=None):
         cdef dicey_message message
         _check(dicey_packet_as_message(packet, &message))
 
         op = Operation(message.type)
         path = message.path.decode("ASCII")
         selector = Selector(message.selector.trait.decode("ASCII"), message.selector.elem.decode("ASCII"))
-        value = pythonize_value(&message.value)
+        value = pythonize_value(&message.value, None, tuple, False, owner)
 
         return Message(op, path, selector, value)
 
@@ -274,7 +281,7 @@ cdef dicey_packet _dump_packet(object packet):
     else:
         assert False, "Unknown packet kind"
 
-cdef object _load_packet(dicey_packet packet):
+cdef object _load_packet(dicey_packet packet, object owner):
     cdef dicey_packet_kind kind = dicey_packet_get_kind(packet)
 
     if kind == dicey_packet_kind.DICEY_PACKET_KIND_BYE:
@@ -282,7 +289,7 @@ cdef object _load_packet(dicey_packet packet):
     elif kind == dicey_packet_kind.DICEY_PACKET_KIND_HELLO:
         return Hello.from_cpacket(packet)
     elif kind == dicey_packet_kind.DICEY_PACKET_KIND_MESSAGE:
-        return Message.from_cpacket(packet)
+        return Message.from_cpacket(packet, owner)
     else:
         assert False, "Unknown packet kind"
 
@@ -296,12 +303,13 @@ def dumps(object packet not None: Packet) -> bytes:
     
     return bytes((<uint8_t*> cpacket.payload)[:cpacket.nbytes])
 
-def load(object fp not None: _Any) -> Packet:
+def load(object fp not None: _Any, *, zero_copy: bool = False) -> Packet:
     data = fp.read() # dumbest implementation ever
 
-    return loads(data)
+    return loads(data, zero_copy=zero_copy)
 
-def loads(bytes data not None: bytes) -> Packet:
+# with zero_copy, bytes and arrays of numbers are loaded as read-only memoryviews into the packet rather than copied
+def loads(bytes data not None: bytes, *, zero_copy: bool = False) -> Packet:
     cdef const void *data_ptr = <uint8_t*> data
     cdef size_t data_len = len(data)
     cdef dicey_packet packet
@@ -311,4 +319,4 @@ def loads(bytes data not None: bytes) -> Packet:
     # RAII wrapper
     cdef _PacketWrapper wrapper = _PacketWrapper.wrap(packet)
 
-    return _load_packet(packet)
+    return _load_packet(packet, wrapper if zero_copy else None)
@@ -211,4 +211,18 @@ class UInt64:
 
     def __post_init__(self):
         if not 0 <= self.value <= UINT64_MAX:
-            raise ValueError("uint64 value out of range")
\ No newline at end of file
+            raise ValueError("uint64 value out of range")
+
+# the NumPy dtypes matching the arrays of fixed-size values, i.e. the memoryviews returned by zero-copy clients. They
+# are plain strings so that NumPy stays optional: use them as `numpy.dtype(NUMPY_DTYPES[Int16])`
+NUMPY_DTYPES = {
+    bool:   "?",
+    Byte:   "u1",
+    float:  "f8",
+    Int16:  "i2",
+    Int32:  "i4",
+    Int64:  "i8",
+    UInt16: "u2",
+    UInt32: "u4",
+    UInt64: "u8",
+}
@@ -30,6 +30,13 @@ cdef extern from "dicey/dicey.h":
     cdef struct dicey_list:
         pass
 
+    cdef struct dicey_array_span:
+        dicey_type type
+        size_t nitems
+
+        # the anonymous union is flattened here, only the raw pointer is needed
+        const void *data
+
     cdef struct dicey_pair:
         dicey_value first
         dicey_value second
@@ -43,6 +50,7 @@ cdef extern from "dicey/dicey.h":
     dicey_type dicey_value_get_type(const dicey_value *value)
 
     dicey_error dicey_value_get_array(const dicey_value *value, dicey_list *dest)
+    dicey_error dicey_value_get_array_span(const dicey_value *value, dicey_array_span *dest)
     dicey_error dicey_value_get_bool(const dicey_value *value, c_bool *dest)
     dicey_error dicey_value_get_byte(const dicey_value *value, uint8_t *dest)
     dicey_error dicey_value_get_bytes(const dicey_value *value, const uint8_t **dest, size_t *nbytes)
@@ -64,4 +72,4 @@ cdef extern from "dicey/dicey.h":
     c_bool dicey_value_is(const dicey_value *value, dicey_type type)
     c_bool dicey_value_is_valid(const dicey_value *value)
 
-cdef pythonize_value(const dicey_value *value, object value_hook=*, type array_cls=*, bint pair_lists_as_dict=*)
+cdef pythonize_value(const dicey_value *value, object value_hook=*, type array_cls=*, bint pair_lists_as_dict=*, object owner=*)
@@ -16,6 +16,7 @@ from collections.abc import Callable as _Callable
 from dataclasses import dataclass as _dataclass
 from uuid import UUID
 
+from cpython.buffer cimport PyBUF_FORMAT, PyBUF_ND, PyBUF_STRIDES, PyBUF_WRITABLE
 from libc.stddef cimport size_t
 from libc.stdint cimport uint8_t
 
@@ -25,9 +26,12 @@ from .errors import InvalidDataError
 from .types import Array, Byte, ErrorMessage, Int16, Int32, Int64, Pair, Path, Selector, UInt16, UInt32, UInt64
 
 from .errors cimport _check
-from .type   cimport dicey_type, dicey_selector, dicey_uuid, DICEY_UUID_SIZE, DICEY_VARIANT_ID
-from .value  cimport dicey_value, dicey_errmsg, dicey_iterator, dicey_list, dicey_pair, \
+from .type   cimport dicey_type, dicey_selector, dicey_uuid, DICEY_UUID_SIZE, DICEY_VARIANT_ID, \
+                     dicey_bool, dicey_byte, dicey_float, dicey_i16, dicey_i32, dicey_i64, \
+                     dicey_u16, dicey_u32, dicey_u64
+from .value  cimport dicey_value, dicey_array_span, dicey_errmsg, dicey_iterator, dicey_list, dicey_pair, \
                      dicey_iterator_has_next, dicey_iterator_next, dicey_list_iter, dicey_list_type, \
+                     dicey_value_get_array_span, \
                      dicey_value_get_bool, dicey_value_get_byte, dicey_value_get_float, \
                      dicey_value_get_i16, dicey_value_get_i32, dicey_value_get_i64, \
                      dicey_value_get_u16, dicey_value_get_u32, dicey_value_get_u64, \
@@ -41,6 +45,51 @@ class _AssocArgs:
     pair_lists_as_dict: bool
     value_hook: Callable[[object], object]
 
+    # the object keeping the packet alive, if bytes and arrays of fixed-size values should be exposed without copying
+    owner: object
+
+cdef class _PacketBuffer:
+    """Exports a read-only span of a packet via the buffer protocol, keeping the packet alive while it's in use"""
+
+    cdef object owner
+    cdef const void *data
+    cdef Py_ssize_t nitems
+    cdef Py_ssize_t itemsize
+    cdef const char *format
+
+    def __getbuffer__(self, Py_buffer *buffer, int flags):
+        if flags & PyBUF_WRITABLE:
+            raise BufferError("Dicey values are read-only")
+
+        buffer.buf = <void *> self.data
+        buffer.obj = self
+        buffer.len = self.nitems * self.itemsize
+        buffer.readonly = 1
+        buffer.itemsize = self.itemsize
+        buffer.format = <char *> self.format if flags & PyBUF_FORMAT else NULL
+        buffer.ndim = 1
+        buffer.shape = &self.nitems if flags & PyBUF_ND else NULL
+        buffer.strides = &self.itemsize if (flags & PyBUF_STRIDES) == PyBUF_STRIDES else NULL
+        buffer.suboffsets = NULL
+        buffer.internal = NULL
+
+    def __releasebuffer__(self, Py_buffer *buffer):
+        pass
+
+    @staticmethod
+    cdef object view(object owner, const void *data, size_t nitems, size_t itemsize, const char *format):
+        cdef _PacketBuffer self = _PacketBuffer.__new__(_PacketBuffer)
+
+        self.owner = owner
+
+        # the buffer protocol dislikes NULL pointers, even for empty buffers
+        self.data = data if data else <const void *> b""
+        self.nitems = nitems
+        self.itemsize = itemsize
+        self.format = format
+
+        return memoryview(self)
+
 cdef struct _type_assoc:
     dicey_type type
     object (*_to_python)(const dicey_value *value, object args)
@@ -81,6 +130,48 @@ cdef const _type_assoc *_find_type_assoc(const dicey_type ty):
 
     return NULL
 
+# the arrays that can be read straight out of a packet, with the struct-style format of their elements. DTF stores
+# numbers in the byte order of the host, so native formats are the right ones. UUIDs are fixed-size too, but they're
+# still converted into UUID objects
+cdef struct _span_assoc:
+    dicey_type type
+    const char *format
+    size_t itemsize
+
+cdef _span_assoc[9] _span_list = [
+    _span_assoc(dicey_type.DICEY_TYPE_BOOL, "?", sizeof(dicey_bool)),
+    _span_assoc(dicey_type.DICEY_TYPE_BYTE, "B", sizeof(dicey_byte)),
+    _span_assoc(dicey_type.DICEY_TYPE_FLOAT, "d", sizeof(dicey_float)),
+    _span_assoc(dicey_type.DICEY_TYPE_INT16, "h", sizeof(dicey_i16)),
+    _span_assoc(dicey_type.DICEY_TYPE_INT32, "i", sizeof(dicey_i32)),
+    _span_assoc(dicey_type.DICEY_TYPE_INT64, "q", sizeof(dicey_i64)),
+    _span_assoc(dicey_type.DICEY_TYPE_UINT16, "H", sizeof(dicey_u16)),
+    _span_assoc(dicey_type.DICEY_TYPE_UINT32, "I", sizeof(dicey_u32)),
+    _span_assoc(dicey_type.DICEY_TYPE_UINT64, "Q", sizeof(dicey_u64)),
+]
+
+cdef const _span_assoc *_find_span_assoc(const int ty):
+    cdef size_t assoc_len = sizeof(_span_list) // sizeof(_span_assoc)
+
+    for i in range(assoc_len):
+        if _span_list[i].type == ty:
+            return &_span_list[i]
+
+    return NULL
+
+# the classes the elements of the arrays above are converted to when copied
+_span_classes = {
+    dicey_type.DICEY_TYPE_BOOL: bool,
+    dicey_type.DICEY_TYPE_BYTE: Byte,
+    dicey_type.DICEY_TYPE_FLOAT: float,
+    dicey_type.DICEY_TYPE_INT16: Int16,
+    dicey_type.DICEY_TYPE_INT32: Int32,
+    dicey_type.DICEY_TYPE_INT64: Int64,
+    dicey_type.DICEY_TYPE_UINT16: UInt16,
+    dicey_type.DICEY_TYPE_UINT32: UInt32,
+    dicey_type.DICEY_TYPE_UINT64: UInt64,
+}
+
 cdef _to_array(const dicey_value *const value, object args):
     cdef dicey_list lst
 
@@ -88,13 +179,43 @@ cdef _to_array(const dicey_value *const value, object args):
 
     array_type = dicey_list_type(&lst)
 
-    if array_type == dicey_type.DICEY_TYPE_PAIR and args.pair_lists_as_dict:
+    if _find_span_assoc(array_type):
+        return _to_array_span(value, args)
+    elif array_type == dicey_type.DICEY_TYPE_PAIR and args.pair_lists_as_dict:
         return _to_dict(&lst, args)
     else:
         l = _to_list(&lst, args)
 
         return Array[l[0].__class__ if l else type(None)](*l)
     
+# arrays of numbers are read in bulk, without probing each element. They are either returned as a memoryview into the
+# packet, or copied out of a temporary one. A value hook must see every element, so it always forces a copy
+cdef _to_array_span(const dicey_value *const value, object args):
+    cdef dicey_array_span span
+
+    _check(dicey_value_get_array_span(value, &span))
+
+    cdef const _span_assoc *assoc = _find_span_assoc(span.type)
+
+    cdef bint zero_copy = args.owner is not None and not args.value_hook
+
+    view = _PacketBuffer.view(args.owner if zero_copy else None, span.data, span.nitems, assoc.itemsize, assoc.format)
+
+    if zero_copy:
+        return view
+
+    items = view.tolist()
+    view.release()
+
+    cls = _span_classes[span.type]
+    if cls is not float and cls is not bool:
+        items = [cls(item) for item in items]
+
+    if args.value_hook:
+        items = [args.value_hook(item) for item in items]
+
+    return Array[items[0].__class__ if items else type(None)](*items)
+
 cdef _to_bool(const dicey_value *const value, object args):
     cdef c_bool dest = 0
 
@@ -115,6 +236,10 @@ cdef _to_bytes(const dicey_value *const value, object args):
 
     _check(dicey_value_get_bytes(value, &bys, &nbytes))
 
+    # same as arrays: value hooks get the same bytes object they would get without zero copy
+    if args.owner is not None and not args.value_hook:
+        return _PacketBuffer.view(args.owner, bys, nbytes, sizeof(uint8_t), "B")
+
     return bytes(bys[:nbytes])
 
 cdef _to_dict(const dicey_list *const list, object args):
@@ -280,12 +405,16 @@ cdef _to_value(const dicey_value *const value, object args):
 
     return args.value_hook(py_val) if args.value_hook else py_val
 
-# note: the default array class here is tuple due to the fact it is immutable, and thus can be used as a dict key
-cdef pythonize_value(const dicey_value *const value, object value_hook=None, type array_cls=tuple, bint pair_lists_as_dict=False):
+# note: the default array class here is tuple due to the fact it is immutable, and thus can be used as a dict key.
+# If owner is not None, bytes and arrays of fixed-size values are returned as read-only memoryviews that point straight
+# into the packet, and keep owner (i.e. whatever frees the packet) alive for as long as they are referenced. This is
+# ignored if value_hook is set, given that the hook must be called on every value, array elements included
+cdef pythonize_value(const dicey_value *const value, object value_hook=None, type array_cls=tuple, bint pair_lists_as_dict=False, object owner=None):
     args = _AssocArgs(
         array_cls = array_cls,
         pair_lists_as_dict = pair_lists_as_dict,
         value_hook = value_hook,
+        owner = owner,
     )
 
     ret = _to_value(value, args)
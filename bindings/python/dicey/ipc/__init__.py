@@ -13,4 +13,4 @@
 # limitations under the License.
 
 from .address import Address
-from .client import Client, Object, connect
+from .client import AsyncClient, Client, Object, connect, connect_async
@@ -12,7 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-from libc.stdint cimport uint32_t
+from libc.stdint cimport uint32_t, uint64_t
 
 from libcpp cimport bool as c_bool
 
@@ -20,7 +20,9 @@ from dicey.core cimport dicey_error, dicey_packet, dicey_selector, dicey_version
 
 from .address cimport dicey_addr
 
-cdef extern from "dicey/dicey.h":
+# all of the client API can be called without holding the GIL: the blocking calls wait on the client thread, which
+# never needs the GIL unless it's calling back into Python
+cdef extern from "dicey/dicey.h" nogil:
     cdef enum dicey_client_event_type:
         DICEY_CLIENT_EVENT_CONNECT
         DICEY_CLIENT_EVENT_ERROR
@@ -91,6 +93,7 @@ cdef extern from "dicey/dicey.h":
     cdef struct dicey_client_args:
         dicey_client_inspect_fn *inspect_func
         dicey_client_signal_fn *on_signal
+        uint32_t cache_ttl
 
     dicey_error dicey_client_new(dicey_client **dest, const dicey_client_args *args)
     void dicey_client_delete(dicey_client *client)
@@ -110,6 +113,15 @@ cdef extern from "dicey/dicey.h":
         void *data
     )
 
+    dicey_error dicey_client_get_async(
+        dicey_client *client,
+        const char *path,
+        dicey_selector sel,
+        dicey_client_on_reply_fn *cb,
+        void *data,
+        uint32_t timeout
+    )
+
     void *dicey_client_get_context(const dicey_client *client)
 
     dicey_error dicey_client_get_real_path(
@@ -173,6 +185,21 @@ cdef extern from "dicey/dicey.h":
 
     c_bool dicey_client_is_running(const dicey_client *client)
 
+    dicey_error dicey_client_list_changes(
+        dicey_client *client,
+        uint64_t since,
+        dicey_packet *response,
+        uint32_t timeout
+    )
+
+    dicey_error dicey_client_list_changes_async(
+        dicey_client *client,
+        uint64_t since,
+        dicey_client_on_reply_fn *cb,
+        void *data,
+        uint32_t timeout
+    )
+
     dicey_error dicey_client_list_objects(
         dicey_client *client,
         dicey_packet *response,
@@ -12,13 +12,24 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import asyncio as _asyncio
+import os as _os
+
 from typing import Any as _Any, Callable as _Callable, Optional as _Optional
 
 from inflection import underscore as _underscore
 
+from cpython.pythread cimport PyThread_type_lock, PyThread_allocate_lock, \
+                              PyThread_acquire_lock, PyThread_release_lock, WAIT_LOCK, \
+                              PyThread_get_thread_ident, PyThread_start_new_thread
+from libc.stdint cimport uint32_t
+from libc.stdlib cimport calloc, free, malloc
+from libc.string cimport strdup
+
 from dicey.core import Byte, DiceyError, ObjectExistsError, Operation, Path, PathNotAliasError, Selector
 
-from dicey.core cimport _PacketWrapper, _check, Message, dicey_packet, dicey_selector
+from dicey.core cimport _PacketWrapper, _check, Message, dicey_error, dicey_packet, dicey_selector
+from dicey.core.packet cimport dicey_packet_deinit
 
 from .sigparse import wrapper_for
 
@@ -26,10 +37,13 @@ from .address cimport Address
 from .builtins cimport DICEY_INTROSPECTION_TRAIT_NAME
 from .client cimport dicey_client, dicey_client_args, \
                      dicey_client_new, dicey_client_delete, \
-                     dicey_client_set_context, \
+                     dicey_client_get_context, dicey_client_set_context, \
                      dicey_client_connect, dicey_client_disconnect, dicey_client_request, \
+                     dicey_client_connect_async, dicey_client_disconnect_async, dicey_client_request_async, \
+                     dicey_client_get_async, \
                      dicey_client_get_real_path, dicey_client_is_path_alias, dicey_client_is_running, \
-                     dicey_client_subscribe_to, dicey_client_unsubscribe_from, \
+                     dicey_client_subscribe_result, dicey_client_subscribe_to, dicey_client_unsubscribe_from, \
+                     dicey_client_subscribe_to_async, dicey_client_unsubscribe_from_async, \
                      dicey_client_inspect_path, dicey_client_inspect_path_as_xml, \
                      dicey_client_list_objects, dicey_client_list_paths
 from .traits cimport dicey_element_type
@@ -43,10 +57,11 @@ cdef void on_csignal(dicey_client *const cclient, void *const ctx, dicey_packet
     cdef Message msg
     client = <Client> ctx
 
-    msg = Message.from_cpacket(packet[0])
+    # take ownership of the packet, so that the values pointing into it can keep it alive
+    cdef _PacketWrapper wrapper = _PacketWrapper.wrap(packet[0])
+    packet[0] = dicey_packet(NULL, 0, NULL)
 
-    # prevent the message from being deallocated twice
-    packet[0] = dicey_packet(NULL, 0)
+    msg = Message.from_cpacket(wrapper.packet, wrapper if client._zero_copy else None)
 
     if client.on_signal:    
         client.on_signal(msg)
@@ -55,25 +70,218 @@ cdef void on_csignal(dicey_client *const cclient, void *const ctx, dicey_packet
     for callback in client._signal_map.get((msg.path, msg.selector), []):
         callback(msg.value)
 
+# the completions of AsyncClient requests, and the signals it receives. The client thread appends them to a queue without
+# touching the GIL, and wakes up the asyncio loop only when the queue goes from empty to non-empty, so that a burst of
+# replies and signals costs a single wakeup and a single trip into Python
+cdef extern from *:
+    """
+    #if defined(_WIN32)
+    #include <io.h>
+    #define dicey_py_wake_fd(FD) ((void) _write((FD), "", 1U))
+    #else
+    #include <unistd.h>
+    #define dicey_py_wake_fd(FD) ((void) !write((FD), "", 1U))
+    #endif
+    """
+    void dicey_py_wake_fd(int fd) nogil
+
+# PyThread locks don't depend on any interpreter state, so they can be freed without the GIL too. This is needed by
+# queues outliving their AsyncClient, which are released from a thread that never held the GIL
+cdef extern from "pythread.h":
+    void _free_lock_nogil "PyThread_free_lock"(PyThread_type_lock lock) nogil
+
+cdef enum _completion_kind:
+    _COMPLETION_SIGNAL
+    _COMPLETION_REPLY
+    _COMPLETION_SUBSCRIBE
+    _COMPLETION_STATUS
+
+cdef struct _completion:
+    _completion *next
+
+    _completion_kind kind
+    size_t id               # the request this completes; 0 for signals
+    dicey_error status
+    dicey_packet packet     # the reply or the signal, owned by the completion
+    char *real_path         # only for subscriptions to aliases
+
+cdef struct _completion_queue:
+    PyThread_type_lock lock
+
+    _completion *head
+    _completion *tail
+    bint wake_pending
+
+    int wake_fd             # -1 if the event loop doesn't support readers, in which case it's woken up via the GIL
+    void *owner             # the AsyncClient owning the queue (borrowed). NULL once it's being deallocated
+    long thread_ident       # the client thread, once it has called into Python to wake the loop up. 0 until then
+
+cdef void _completion_free(_completion *item) noexcept nogil:
+    dicey_packet_deinit(&item.packet)
+    free(item.real_path)
+    free(item)
+
+cdef _completion *_queue_take(_completion_queue *queue) noexcept nogil:
+    cdef _completion *items
+
+    PyThread_acquire_lock(queue.lock, WAIT_LOCK)
+
+    items = queue.head
+    queue.head = queue.tail = NULL
+    queue.wake_pending = False
+
+    PyThread_release_lock(queue.lock)
+
+    return items
+
+cdef void _queue_free(_completion_queue *queue) noexcept nogil:
+    cdef _completion *item = _queue_take(queue)
+    cdef _completion *next_item
+
+    while item:
+        next_item = item.next
+        _completion_free(item)
+        item = next_item
+
+    _free_lock_nogil(queue.lock)
+    free(queue)
+
+cdef void _client_teardown(dicey_client *client) noexcept nogil:
+    # either disconnects or fails because we weren't connected, it's the same
+    dicey_client_disconnect(client)
+
+    # this stops the client thread, so nothing will touch its queue from now on
+    dicey_client_delete(client)
+
+cdef struct _teardown_req:
+    dicey_client *client
+    _completion_queue *queue
+
+cdef void _teardown_thread(void *arg) noexcept nogil:
+    cdef _teardown_req *req = <_teardown_req *> arg
+
+    _client_teardown(req.client)
+    _queue_free(req.queue)
+
+    free(req)
+
+cdef void _wake_with_gil(_completion_queue *queue) noexcept with gil:
+    cdef AsyncClient owner = None
+
+    # the owner must be read again now that we hold the GIL: __dealloc__ clears it before releasing the GIL, so if it's
+    # still set the AsyncClient is alive. A strong reference is taken because running Python code here may trigger a GC
+    # pass, or let the loop thread run: either way, the client may die on this thread (see __dealloc__)
+    PyThread_acquire_lock(queue.lock, WAIT_LOCK)
+
+    queue.thread_ident = PyThread_get_thread_ident()
+
+    if queue.owner:
+        owner = <AsyncClient> queue.owner
+
+    PyThread_release_lock(queue.lock)
+
+    if owner is not None:
+        owner._schedule_drain()
+
+cdef void _queue_push(_completion_queue *queue, _completion *item) noexcept nogil:
+    cdef bint wake
+    cdef int wake_fd
+    cdef void *owner
+
+    item.next = NULL
+
+    PyThread_acquire_lock(queue.lock, WAIT_LOCK)
+
+    if queue.tail:
+        queue.tail.next = item
+    else:
+        queue.head = item
+
+    queue.tail = item
+
+    wake = not queue.wake_pending
+    queue.wake_pending = True
+
+    wake_fd = queue.wake_fd
+    owner = queue.owner
+
+    PyThread_release_lock(queue.lock)
+
+    if wake:
+        if wake_fd >= 0:
+            dicey_py_wake_fd(wake_fd)
+        elif owner:
+            _wake_with_gil(queue)
+
+cdef void on_async_reply(dicey_client *const cclient, void *const ctx, const dicey_error status, dicey_packet *const packet) noexcept nogil:
+    cdef _completion *item = <_completion *> ctx
+
+    item.status = status
+
+    if packet:
+        # steal the packet, the client is going to release it otherwise
+        item.packet = packet[0]
+        packet[0] = dicey_packet(NULL, 0, NULL)
+
+    _queue_push(<_completion_queue *> dicey_client_get_context(cclient), item)
+
+cdef void on_async_status(dicey_client *const cclient, void *const ctx, const dicey_error status) noexcept nogil:
+    cdef _completion *item = <_completion *> ctx
+
+    item.status = status
+
+    _queue_push(<_completion_queue *> dicey_client_get_context(cclient), item)
+
+cdef void on_async_connect(dicey_client *const cclient, void *const ctx, const dicey_error status, const char *const msg) noexcept nogil:
+    on_async_status(cclient, ctx, status)
+
+cdef void on_async_subscribe(dicey_client *const cclient, void *const ctx, const dicey_client_subscribe_result result) noexcept nogil:
+    cdef _completion *item = <_completion *> ctx
+
+    item.status = result.err
+
+    if result.real_path:
+        # the real path is released after the callback returns
+        item.real_path = strdup(result.real_path)
+
+    _queue_push(<_completion_queue *> dicey_client_get_context(cclient), item)
+
+cdef void on_async_signal(dicey_client *const cclient, void *const ctx, dicey_packet *const packet) noexcept nogil:
+    cdef _completion *item = <_completion *> calloc(1, sizeof(_completion))
+
+    if not item:
+        return # out of memory: the best we can do is dropping the signal
+
+    item.kind = _COMPLETION_SIGNAL
+    item.packet = packet[0]
+    packet[0] = dicey_packet(NULL, 0, NULL)
+
+    _queue_push(<_completion_queue *> ctx, item)
+
 cdef class Client:
     cdef dicey_client *_client
     cdef Address _addr
+    cdef bint _zero_copy
 
     _on_signal: GlobalSignalCallback
 
     _signal_map: dict[(Pair, Selector), set[SignalCallback]]
 
 
-    def __cinit__(self):
+    # with zero_copy, bytes and arrays of numbers are returned as read-only memoryviews into the packets they came with
+    def __cinit__(self, *, cache_ttl_ms: int = 0, zero_copy: bool = False):
         cdef dicey_client_args args
 
         args.on_signal = &on_csignal
         args.inspect_func = NULL
+        args.cache_ttl = cache_ttl_ms
 
         _check(dicey_client_new(&self._client, &args))
 
         dicey_client_set_context(self._client, <void *> self)
 
+        self._zero_copy = zero_copy
+
         self._on_signal = None
         self._signal_map = {}
 
@@ -100,6 +308,7 @@ cdef class Client:
 
     def connect(self, addr: Address | str):
         cdef dicey_addr caddr
+        cdef dicey_error err
 
         if isinstance(addr, str):
             self._addr = Address(addr)
@@ -108,11 +317,19 @@ cdef class Client:
 
         # the address must be cloned: the client wants an owned copy
         caddr = self._addr.clone_raw()
-        
-        _check(dicey_client_connect(self._client, caddr))
+
+        with nogil:
+            err = dicey_client_connect(self._client, caddr)
+
+        _check(err)
 
     def disconnect(self):
-        _check(dicey_client_disconnect(self._client))
+        cdef dicey_error err
+
+        with nogil:
+            err = dicey_client_disconnect(self._client)
+
+        _check(err)
 
     def exec(self, path: Path | str, selector: Selector | (str, str), arg: _Any = None, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _Any:
         return self.request(Message(Operation.EXEC, path, selector, arg), timeout_ms=timeout_ms)
@@ -122,19 +339,35 @@ cdef class Client:
 
     def inspect(self, path: Path | str, *, timeout_ms: int = DEFAULT_TIMEOUT_MS, xml = False) -> _Any:
         cdef dicey_packet response
+        cdef dicey_error err
+        cdef bytes bpath = str(path).encode('ASCII')
+        cdef const char *cpath = bpath
+        cdef uint32_t timeout = timeout_ms
+        cdef bint as_xml = xml
+
+        with nogil:
+            if as_xml:
+                err = dicey_client_inspect_path_as_xml(self._client, cpath, &response, timeout)
+            else:
+                err = dicey_client_inspect_path(self._client, cpath, &response, timeout)
 
-        if xml:
-            _check(dicey_client_inspect_path_as_xml(self._client, str(path).encode('ASCII'), &response, timeout_ms))
-        else:
-            _check(dicey_client_inspect_path(self._client, str(path).encode('ASCII'), &response, timeout_ms))
+        _check(err)
 
         entries = Message.from_cpacket(response).value
 
         return {name : dict(trait) for name, trait in entries}
 
     def is_alias(self, path: Path | str, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> bool:
+        cdef dicey_error err
+        cdef bytes bpath = str(path).encode('ASCII')
+        cdef const char *cpath = bpath
+        cdef uint32_t timeout = timeout_ms
+
+        with nogil:
+            err = dicey_client_is_path_alias(self._client, cpath, timeout)
+
         try:
-            _check(dicey_client_is_path_alias(self._client, str(path).encode('ASCII'), timeout_ms))
+            _check(err)
 
             return True
         except PathNotAliasError:
@@ -145,11 +378,17 @@ cdef class Client:
 
     def objects(self, *, include_aliases=False, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _Any:
         cdef dicey_packet response
+        cdef dicey_error err
+        cdef uint32_t timeout = timeout_ms
+        cdef bint with_aliases = include_aliases
 
-        if include_aliases:
-            _check(dicey_client_list_paths(self._client, &response, timeout_ms))
-        else:
-            _check(dicey_client_list_objects(self._client, &response, timeout_ms))
+        with nogil:
+            if with_aliases:
+                err = dicey_client_list_paths(self._client, &response, timeout)
+            else:
+                err = dicey_client_list_objects(self._client, &response, timeout)
+
+        _check(err)
 
         return Message.from_cpacket(response).value
 
@@ -163,7 +402,15 @@ cdef class Client:
 
     def real_path_of(self, path: Path | str, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> Path:
         cdef dicey_packet response
-        _check(dicey_client_get_real_path(self._client, str(path).encode('ASCII'), &response, timeout_ms))
+        cdef dicey_error err
+        cdef bytes bpath = str(path).encode('ASCII')
+        cdef const char *cpath = bpath
+        cdef uint32_t timeout = timeout_ms
+
+        with nogil:
+            err = dicey_client_get_real_path(self._client, cpath, &response, timeout)
+
+        _check(err)
 
         return Message.from_cpacket(response).value
 
@@ -179,11 +426,19 @@ cdef class Client:
 
     def request(self, message: Message, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _Any:
         cdef dicey_packet response
-        _check(dicey_client_request(self._client, message.to_cpacket(), &response, timeout_ms))
+        cdef dicey_error err
+        cdef dicey_packet packet = message.to_cpacket()
+        cdef uint32_t timeout = timeout_ms
+
+        # don't hold the GIL while waiting: other threads (and the signal callbacks) can run in the meantime
+        with nogil:
+            err = dicey_client_request(self._client, packet, &response, timeout)
+
+        _check(err)
 
         cdef _PacketWrapper wrapper = _PacketWrapper.wrap(response)
 
-        return Message.from_cpacket(response).value
+        return Message.from_cpacket(response, wrapper if self._zero_copy else None).value
 
     @property
     def running(self) -> bool:
@@ -201,7 +456,13 @@ cdef class Client:
         trait = selector.trait.encode('ASCII')
         elem = selector.elem.encode('ASCII')
 
-        result = dicey_client_subscribe_to(self._client, path, dicey_selector(trait, elem), timeout_ms)
+        cdef dicey_client_subscribe_result result
+        cdef const char *cpath = path
+        cdef dicey_selector csel = dicey_selector(trait, elem)
+        cdef uint32_t timeout = timeout_ms
+
+        with nogil:
+            result = dicey_client_subscribe_to(self._client, cpath, csel, timeout)
 
         _check(result.err)
 
@@ -228,7 +489,15 @@ cdef class Client:
         trait = selector.trait.encode('ASCII')
         elem = selector.elem.encode('ASCII')
 
-        _check(dicey_client_unsubscribe_from(self._client, path, dicey_selector(trait, elem), timeout_ms))
+        cdef dicey_error err
+        cdef const char *cpath = path
+        cdef dicey_selector csel = dicey_selector(trait, elem)
+        cdef uint32_t timeout = timeout_ms
+
+        with nogil:
+            err = dicey_client_unsubscribe_from(self._client, cpath, csel, timeout)
+
+        _check(err)
 
     def __repr__(self):
         return f"<Dicey client for dicey://[{self.address}]>"
@@ -245,8 +514,8 @@ class Signal:
     def unregister(self, callback: SignalCallback, *, unsubscribe: bool = True):
         self._client.unregister_from(self._path, self._selector, callback, unsubscribe=unsubscribe)
 
-def connect(addr: Address | str, *, on_signal: _Optional[GlobalSignalCallback] = None) -> Client:
-    cl = Client()
+def connect(addr: Address | str, *, on_signal: _Optional[GlobalSignalCallback] = None, zero_copy: bool = False) -> Client:
+    cl = Client(zero_copy=zero_copy)
 
     cl.on_signal = on_signal
 
@@ -254,6 +523,385 @@ def connect(addr: Address | str, *, on_signal: _Optional[GlobalSignalCallback] =
 
     return cl
 
+cdef class AsyncClient:
+    """An asyncio-native client. All the requests are sent without blocking, and return a future that is resolved on
+    the event loop the client was connected from. Signals are dispatched on the same loop"""
+
+    cdef dicey_client *_client
+    cdef _completion_queue *_queue
+    cdef Address _addr
+
+    cdef object _loop
+    cdef object _rfd
+    cdef object _wfd
+
+    cdef dict _pending
+    cdef size_t _last_id
+
+    cdef object _on_signal
+    cdef dict _signal_map
+
+    cdef bint _zero_copy
+
+    def __cinit__(self, *, cache_ttl_ms: int = 0, zero_copy: bool = False):
+        cdef dicey_client_args args
+
+        args.on_signal = &on_async_signal
+        args.inspect_func = NULL
+        args.cache_ttl = cache_ttl_ms
+
+        # the queue is kept apart from the object, because it may have to outlive it (see __dealloc__)
+        self._queue = <_completion_queue *> calloc(1, sizeof(_completion_queue))
+        if not self._queue:
+            raise MemoryError()
+
+        self._queue.lock = PyThread_allocate_lock()
+        if not self._queue.lock:
+            free(self._queue)
+            self._queue = NULL
+
+            raise MemoryError()
+
+        self._queue.wake_fd = -1
+        self._queue.owner = <void *> self
+
+        _check(dicey_client_new(&self._client, &args))
+
+        dicey_client_set_context(self._client, self._queue)
+
+        self._pending = {}
+        self._signal_map = {}
+        self._zero_copy = zero_copy
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, exc_type, exc_value, traceback):
+        if self.running:
+            await self.disconnect()
+
+    def __dealloc__(self):
+        cdef _teardown_req *req
+
+        if not self._queue:
+            return # __cinit__ failed before creating anything
+
+        # from now on, completions just pile up in the queue: there's no loop to wake up anymore
+        PyThread_acquire_lock(self._queue.lock, WAIT_LOCK)
+
+        self._queue.wake_fd = -1
+        self._queue.owner = NULL
+
+        PyThread_release_lock(self._queue.lock)
+
+        if self._client and self._queue.thread_ident == PyThread_get_thread_ident():
+            # we're being collected by the client thread itself, while it's waking up the loop. A thread can't stop
+            # and join itself, so the teardown is left to a new one. If even that fails, leaking is the only safe option
+            req = <_teardown_req *> malloc(sizeof(_teardown_req))
+            if req:
+                req.client = self._client
+                req.queue = self._queue
+
+                if PyThread_start_new_thread(&_teardown_thread, req) == -1:
+                    free(req)
+        else:
+            if self._client:
+                # the GIL must be released: the client thread may be waiting for it to deliver a wakeup
+                with nogil:
+                    _client_teardown(self._client)
+
+            _queue_free(self._queue)
+
+        # the futures of the requests still in flight will never be resolved
+        self._pending = None
+
+        if self._rfd is not None:
+            if self._loop is not None and not self._loop.is_closed():
+                self._loop.remove_reader(self._rfd)
+
+            _os.close(self._rfd)
+            _os.close(self._wfd)
+
+    @property
+    def address(self) -> Address | None:
+        return self._addr
+
+    def connect(self, addr: Address | str) -> _asyncio.Future:
+        cdef dicey_addr caddr
+        cdef dicey_error err
+
+        self._bind_loop()
+
+        self._addr = Address(addr) if isinstance(addr, str) else addr
+
+        # the address must be cloned: the client wants an owned copy
+        caddr = self._addr.clone_raw()
+
+        cdef _completion *item = self._track(_COMPLETION_STATUS)
+
+        with nogil:
+            err = dicey_client_connect_async(self._client, caddr, &on_async_connect, item)
+
+        return self._submitted(item, err)
+
+    def disconnect(self) -> _asyncio.Future:
+        cdef dicey_error err
+        cdef _completion *item = self._track(_COMPLETION_STATUS)
+
+        with nogil:
+            err = dicey_client_disconnect_async(self._client, &on_async_status, item)
+
+        return self._submitted(item, err)
+
+    def exec(self, path: Path | str, selector: Selector | (str, str), arg: _Any = None, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _asyncio.Future:
+        return self.request(Message(Operation.EXEC, path, selector, arg), timeout_ms=timeout_ms)
+
+    def get(self, path: Path | str, selector: Selector | (str, str), *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _asyncio.Future:
+        cdef dicey_error err
+
+        selector = Selector(*selector) if isinstance(selector, tuple) else selector
+
+        cdef bytes bpath = str(path).encode('ASCII')
+        cdef bytes trait = selector.trait.encode('ASCII')
+        cdef bytes elem = selector.elem.encode('ASCII')
+
+        cdef const char *cpath = bpath
+        cdef dicey_selector csel = dicey_selector(trait, elem)
+        cdef uint32_t timeout = timeout_ms
+
+        cdef _completion *item = self._track(_COMPLETION_REPLY)
+
+        with nogil:
+            err = dicey_client_get_async(self._client, cpath, csel, &on_async_reply, item, timeout)
+
+        return self._submitted(item, err)
+
+    @property
+    def on_signal(self) -> GlobalSignalCallback:
+        return self._on_signal
+
+    @on_signal.setter
+    def on_signal(self, value: GlobalSignalCallback):
+        self._on_signal = value
+
+    async def register_for(self, path: Path | str, selector: Selector | (str, str), callback: SignalCallback):
+        self._signal_map.setdefault(_signal_key(path, selector), set()).add(callback)
+
+        # as a good measure, subscribe to the signal, but ignore the error the server might throw
+        # if we're already subscribed
+        try:
+            await self.subscribe(path, selector)
+        except ObjectExistsError:
+            pass
+
+    def request(self, message: Message, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _asyncio.Future:
+        cdef dicey_error err
+        cdef dicey_packet packet = message.to_cpacket()
+        cdef uint32_t timeout = timeout_ms
+
+        cdef _completion *item
+
+        try:
+            item = self._track(_COMPLETION_REPLY)
+        except:
+            dicey_packet_deinit(&packet)
+
+            raise
+
+        with nogil:
+            err = dicey_client_request_async(self._client, packet, &on_async_reply, item, timeout)
+
+        if err:
+            dicey_packet_deinit(&packet)
+
+        return self._submitted(item, err)
+
+    @property
+    def running(self) -> bool:
+        return dicey_client_is_running(self._client)
+
+    def set(self, path: Path | str, selector: Selector | (str, str), value: _Any, *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _asyncio.Future:
+        return self.request(Message(Operation.SET, path, selector, value), timeout_ms=timeout_ms)
+
+    def subscribe(self, path: Path | str, selector: Selector | (str, str), *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _asyncio.Future:
+        return self._subunsub(path, selector, timeout_ms, True)
+
+    async def unregister_from(self, path: Path | str, selector: Selector | (str, str), callback: SignalCallback, *, unsubscribe: bool = True):
+        if callbacks := self._signal_map.get(_signal_key(path, selector)):
+            callbacks.discard(callback)
+
+            if not callbacks and unsubscribe:
+                await self.unsubscribe(path, selector)
+
+    def unsubscribe(self, path: Path | str, selector: Selector | (str, str), *, timeout_ms: int = DEFAULT_TIMEOUT_MS) -> _asyncio.Future:
+        return self._subunsub(path, selector, timeout_ms, False)
+
+    def __repr__(self):
+        return f"<Dicey async client for dicey://[{self.address}]>"
+
+    cdef _bind_loop(self):
+        loop = _asyncio.get_running_loop()
+
+        if self._loop is loop:
+            return
+
+        if self._loop is not None:
+            raise RuntimeError("an AsyncClient can only be used from the event loop it was first connected from")
+
+        self._loop = loop
+
+        rfd, wfd = _os.pipe()
+        _os.set_blocking(rfd, False)
+        _os.set_blocking(wfd, False) # a full pipe already has a wakeup pending, so failed writes are harmless
+
+        try:
+            loop.add_reader(rfd, self._drain)
+        except NotImplementedError:
+            # e.g. the proactor loop on Windows. Fall back to waking up the loop from the client thread
+            _os.close(rfd)
+            _os.close(wfd)
+
+            return
+
+        self._rfd = rfd
+        self._wfd = wfd
+        self._queue.wake_fd = wfd
+
+    cdef _dispatch(self, _completion *item):
+        cdef dicey_packet packet = item.packet
+
+        if item.kind == _COMPLETION_SIGNAL:
+            msg = Message.from_cpacket(packet, self._take_packet(item))
+
+            if self._on_signal:
+                self._on_signal(msg)
+
+            for callback in tuple(self._signal_map.get((msg.path, msg.selector), ())):
+                callback(msg.value)
+
+            return
+
+        future, og_path = self._pending.pop(item.id)
+        if future.done(): # cancelled, most likely
+            return
+
+        try:
+            _check(item.status)
+
+            # error replies are turned into exceptions when converted
+            if item.kind == _COMPLETION_REPLY:
+                result = Message.from_cpacket(packet, self._take_packet(item)).value
+            elif item.kind == _COMPLETION_SUBSCRIBE:
+                result = Path(item.real_path.decode('ASCII')) if item.real_path else Path(og_path)
+            else:
+                result = None
+        except Exception as exc:
+            future.set_exception(exc)
+        else:
+            future.set_result(result)
+
+    def _drain(self):
+        cdef _completion *item
+        cdef _completion *next_item
+
+        if self._rfd is not None:
+            try:
+                _os.read(self._rfd, 4096)
+            except BlockingIOError:
+                pass
+
+        with nogil:
+            item = _queue_take(self._queue)
+
+        while item:
+            try:
+                self._dispatch(item)
+            except Exception as exc:
+                self._loop.call_exception_handler({
+                    'message': 'exception while dispatching a dicey reply or signal',
+                    'exception': exc,
+                })
+            finally:
+                next_item = item.next
+                _completion_free(item)
+                item = next_item
+
+    # with zero_copy, moves the packet of a completion into a wrapper that values can keep alive
+    cdef object _take_packet(self, _completion *item):
+        if not self._zero_copy:
+            return None
+
+        wrapper = _PacketWrapper.wrap(item.packet)
+        item.packet = dicey_packet(NULL, 0, NULL)
+
+        return wrapper
+
+    cdef _schedule_drain(self):
+        self._loop.call_soon_threadsafe(self._drain)
+
+    cdef object _submitted(self, _completion *item, const dicey_error err):
+        future, _ = self._pending[item.id] if not err else self._pending.pop(item.id)
+
+        if err:
+            free(item)
+
+            _check(err)
+
+        return future
+
+    cdef object _subunsub(self, path: Path | str, selector: Selector | (str, str), timeout_ms: int, subscribe: bool):
+        cdef dicey_error err
+
+        selector = Selector(*selector) if isinstance(selector, tuple) else selector
+
+        cdef bytes bpath = str(path).encode('ASCII')
+        cdef bytes trait = selector.trait.encode('ASCII')
+        cdef bytes elem = selector.elem.encode('ASCII')
+
+        cdef const char *cpath = bpath
+        cdef dicey_selector csel = dicey_selector(trait, elem)
+        cdef uint32_t timeout = timeout_ms
+        cdef bint is_sub = subscribe
+
+        cdef _completion *item = self._track(_COMPLETION_SUBSCRIBE if is_sub else _COMPLETION_STATUS, path)
+
+        with nogil:
+            if is_sub:
+                err = dicey_client_subscribe_to_async(self._client, cpath, csel, &on_async_subscribe, item, timeout)
+            else:
+                err = dicey_client_unsubscribe_from_async(self._client, cpath, csel, &on_async_status, item, timeout)
+
+        return self._submitted(item, err)
+
+    cdef _completion *_track(self, const _completion_kind kind, object path = None) except NULL:
+        if self._loop is None:
+            raise RuntimeError("the client was never connected")
+
+        cdef _completion *item = <_completion *> calloc(1, sizeof(_completion))
+        if not item:
+            raise MemoryError()
+
+        self._last_id += 1
+
+        item.kind = kind
+        item.id = self._last_id
+
+        self._pending[item.id] = (self._loop.create_future(), path)
+
+        return item
+
+def _signal_key(path: Path | str, selector: Selector | (str, str)) -> tuple[Path, Selector]:
+    return (Path(path) if isinstance(path, str) else path, Selector(*selector) if isinstance(selector, tuple) else selector)
+
+async def connect_async(addr: Address | str, *, on_signal: _Optional[GlobalSignalCallback] = None, zero_copy: bool = False):
+    cl = AsyncClient(zero_copy=zero_copy)
+
+    cl.on_signal = on_signal
+
+    await cl.connect(addr)
+
+    return cl
+
 class Object:
     def __init__(self, client: Client, path: Path | str, data: _Any, timeout_ms: int):
         self._client = client
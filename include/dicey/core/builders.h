@@ -17,6 +17,8 @@
 #if !defined(FJWTVTVLMM_BUILDERS_H)
 #define FJWTVTVLMM_BUILDERS_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "message.h"
@@ -42,7 +44,12 @@ struct dicey_message_builder {
     const char *_path;
     struct dicey_selector _selector;
 
-    struct dicey_arg *_root; // Root argument of the message. Requires freeing by either discard or build
+    union {
+        struct dicey_arg *_root; // Root argument of the message. Requires freeing by either discard or build
+
+        // Streaming builders only (see `dicey_message_builder_begin_streaming`): the buffer the message is encoded into
+        struct _dicey_message_builder_stream *_stream;
+    };
 
     // While constructing the value, _root is the root of the value, and _borrowed_to is the value builder that is
     // holding the lock over this message builder.
@@ -60,6 +67,26 @@ struct dicey_message_builder {
  */
 DICEY_EXPORT enum dicey_error dicey_message_builder_begin(struct dicey_message_builder *builder, enum dicey_op op);
 
+/**
+ * @brief Begins building a message in streaming mode.
+ * @note  A streaming builder encodes the value directly into the final packet buffer as it is built, without
+ *        constructing an intermediate tree of `dicey_arg`s and without a separate sizing pass. This is considerably
+ *        faster and leaner for large values, such as arrays with many thousands of elements.
+ *        Streaming builders are used exactly as regular ones, with one additional constraint: values must be built in
+ *        order, i.e. each element of a list must be fully built before `dicey_value_builder_next` or `*_end` are
+ *        called again on that list. Set the path and the selector before starting the value to avoid an extra copy
+ *        on build.
+ * @param builder Message builder (must be initialised and idle).
+ * @param op The operation represented by the message under construction.
+ * @return Error code. Possible errors are:
+ *         - OK: The operation was successful
+ *         - EINVAL: The builder is not idle
+ */
+DICEY_EXPORT enum dicey_error dicey_message_builder_begin_streaming(
+    struct dicey_message_builder *builder,
+    enum dicey_op op
+);
+
 /**
  * @brief Builds a message into a packet.
  * @note This function completely discards the builder contents, leaving it ready to be reused.
@@ -243,18 +270,36 @@ struct dicey_value_builder {
 
     int _state;
 
-    // root of the built message, i.e. a leaf if the value is not a compound type, or a node otherwise.
-    // this value is borrowed from the parent builder, and must not be freed by the value builder
-    struct dicey_arg *_root;
+    union {
+        // root of the built message, i.e. a leaf if the value is not a compound type, or a node otherwise.
+        // this value is borrowed from the parent builder, and must not be freed by the value builder
+        struct dicey_arg *_root;
+
+        // streaming builders only: the stream this value is written to
+        struct _dicey_message_builder_stream *_stream;
+    };
 
     // specialised builder structure for subvalues (used by arrays and tuples)
     struct _dicey_value_builder_list {
-        enum dicey_type type; // type of the elements. Only valid if the value is an array
-
-        // dynamic array of elements. Only valid if the value is an array or a tuple
+        // type of the elements. Only valid if the value is an array.
+        // Streaming builders that haven't been set yet keep the type they are required to have here instead, if any.
+        // Values without a required type (i.e. anything that isn't an array element) are written as variants
+        enum dicey_type type;
+
+        // dynamic array of elements. Only valid if the value is an array or a tuple.
+        // Streaming builders have no elements to keep: they store the offset of the list header in the stream, and the
+        // stream depth once the list was opened
         uint16_t nitems;
-        size_t cap;
-        struct dicey_arg *elems;
+
+        union {
+            size_t cap;
+            size_t header_at;
+        };
+
+        union {
+            struct dicey_arg *elems;
+            size_t depth;
+        };
     } _list;
 };
 
@@ -383,6 +428,31 @@ DICEY_EXPORT enum dicey_error dicey_value_builder_pair_end(struct dicey_value_bu
  */
 DICEY_EXPORT enum dicey_error dicey_value_builder_set(struct dicey_value_builder *builder, struct dicey_arg value);
 
+/**
+ * @brief Sets the value of a value builder to an array of fixed-size elements, taken from a contiguous C array.
+ * @note  This is the fastest way to send large arrays of numbers: streaming builders (see
+ *        `dicey_message_builder_begin_streaming`) copy the elements into the message in one go. Other builders expand
+ *        the array into individual arguments, and are as fast as building it element by element.
+ *        Unlike `dicey_value_builder_set`, the elements are copied immediately and need not outlive the call.
+ * @param builder The value builder. Must be ready for writing and empty.
+ * @param type The type of the elements. Must be a fixed-size type: bool, byte, float, any integer type or UUID.
+ * @param elems The elements, stored as the C type corresponding to `type` (e.g. `dicey_float` for DICEY_TYPE_FLOAT).
+ *              May be NULL if `nitems` is zero.
+ * @param nitems The number of elements in `elems`.
+ * @return Error code. Possible errors are:
+ *         - OK: The operation was successful
+ *         - EINVAL: The builder is not in the correct state, or `type` is not a fixed-size type
+ *         - ENOMEM: The builder is unable to allocate memory for the array
+ *         - EOVERFLOW: `nitems` exceeds the maximum number of elements an array can hold (65535)
+ *         - EVALUE_TYPE_MISMATCH: when the builder requires a value of a type other than array
+ */
+DICEY_EXPORT enum dicey_error dicey_value_builder_set_array(
+    struct dicey_value_builder *builder,
+    enum dicey_type type,
+    const void *elems,
+    size_t nitems
+);
+
 /**
  * @brief Starts building a tuple value.
  * @note This function locks the value builder, which enters in a "tuple" state until tuple_end is called.
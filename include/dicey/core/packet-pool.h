@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(MGHJJAQTFQ_PACKET_POOL_H)
+#define MGHJJAQTFQ_PACKET_POOL_H
+
+#include <stddef.h>
+
+#include "dicey_export.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics about the pool packet payloads are allocated from.
+ */
+struct dicey_packet_pool_stats {
+    size_t hits;         /**< The number of allocations served from a cache. */
+    size_t misses;       /**< The number of allocations that had to go to the system allocator. */
+    size_t bytes_cached; /**< The number of bytes currently held in the caches, ready to be reused. */
+};
+
+/**
+ * @brief Gets the statistics of the packet pool. Packet payloads (and the buffers used to write them out) are
+ *        allocated from a pool of power-of-two size classes, with a small cache per thread.
+ * @note  The counters of other threads are read while they keep running, so the result is only a snapshot.
+ * @return The current statistics of the pool.
+ */
+DICEY_EXPORT struct dicey_packet_pool_stats dicey_packet_pool_get_stats(void);
+
+/**
+ * @brief Releases the memory held by the packet pool back to the system. Only the shared caches and the cache of the
+ *        calling thread are released; the caches of other threads are released when those threads exit.
+ * @return The number of bytes released.
+ */
+DICEY_EXPORT size_t dicey_packet_pool_trim(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MGHJJAQTFQ_PACKET_POOL_H
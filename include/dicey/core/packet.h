@@ -99,12 +99,23 @@ struct dicey_hello {
     struct dicey_version version; /**< Version information */
 };
 
+struct dicey_rcbuf;
+
 /**
  * @brief Structure representing a packet.
+ * @note  Packets received by a client or server may borrow their payload from a shared receive buffer instead of owning
+ *        a private copy. This is transparent to users: `dicey_packet_deinit` works the same on both kinds of packets.
+ *        Use `dicey_packet_detach` to turn a borrowed packet into one that owns its payload.
+ * @note  Owned payloads are allocated from an internal pool, not with `malloc`. Packets must only be created through
+ *        the functions in this library (loading, building, cloning, ...): a packet whose payload was allocated by other
+ *        means must never be passed to `dicey_packet_deinit`, or to any function that takes ownership of it.
  */
 struct dicey_packet {
     void *payload; /**< Raw payload, castable to uint8_t* and ready to be sent on the wire */
     size_t nbytes; /**< Number of bytes allocated in payload*/
+
+    // internal data - do not touch
+    struct dicey_rcbuf *_owner; // if not NULL, the payload is a slice of this buffer and must not be freed
 };
 
 /**
@@ -115,7 +126,7 @@ struct dicey_message;
 /**
  * @brief Quick macro to initialize an empty packet.
  */
-#define DICEY_EMPTY_PACKET ((struct dicey_packet) { .payload = NULL, .nbytes = 0 })
+#define DICEY_EMPTY_PACKET ((struct dicey_packet) { .payload = NULL, .nbytes = 0, ._owner = NULL })
 
 /**
  * @brief Loads a packet from data pointer at `data`.
@@ -171,12 +182,40 @@ DICEY_EXPORT enum dicey_error dicey_packet_as_hello(struct dicey_packet packet,
  */
 DICEY_EXPORT enum dicey_error dicey_packet_as_message(struct dicey_packet packet, struct dicey_message *message);
 
+/**
+ * @brief Copies a packet into a new packet owning its payload, so that the two can be modified (e.g. stamped with a
+ *        different seq) and released independently.
+ * @param dest The destination packet. Must be released with dicey_packet_deinit().
+ * @param src The packet to copy. It can either own or borrow its payload, and is left untouched.
+ * @return The error code indicating the success or failure of the operation. Possible errors are:
+ *         - OK: `dest` now holds a copy of `src`
+ *         - EINVAL: `src` is invalid
+ *         - ENOMEM: the payload could not be copied
+ */
+DICEY_EXPORT enum dicey_error dicey_packet_clone(struct dicey_packet *dest, struct dicey_packet src);
+
 /**
  * @brief Deinitializes a packet, freeing its contents.
+ * @note  The payload is released to the library's packet pool, so `packet` must have been created by this library. Never
+ *        call this function on a packet wrapping memory allocated by other means (e.g. `malloc`).
  * @param packet The packet to deinitialize.
  */
 DICEY_EXPORT void dicey_packet_deinit(struct dicey_packet *packet);
 
+/**
+ * @brief Ensures a packet owns its payload. If the packet borrows its payload from a shared receive buffer, the payload
+ *        is copied into a new allocation and the reference to the buffer is dropped. Packets that already own their
+ *        payload are left untouched.
+ * @note  Holding on to a borrowed packet keeps the whole receive buffer it was read from alive. Detach packets that
+ *        must be kept around for a long time.
+ * @param packet The packet to detach.
+ * @return The error code indicating the success or failure of the operation. Possible errors are:
+ *         - OK: the packet now owns its payload
+ *         - EINVAL: the packet is invalid
+ *         - ENOMEM: the payload could not be copied. The packet is left untouched
+ */
+DICEY_EXPORT enum dicey_error dicey_packet_detach(struct dicey_packet *packet);
+
 /**
  * @brief Dumps the contents of a packet into the given data buffer.
  * @param packet The packet to dump.
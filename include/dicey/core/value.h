@@ -174,6 +174,48 @@ DICEY_EXPORT enum dicey_type dicey_value_get_type(const struct dicey_value *valu
  */
 DICEY_EXPORT enum dicey_error dicey_value_get_array(const struct dicey_value *value, struct dicey_list *dest);
 
+/**
+ * @brief A read-only view over the elements of an array of fixed-size values (i.e. bools, bytes, floats, integers or
+ *        UUIDs), pointing straight into the packet the array belongs to.
+ * @note  DTF is a packed format, so the elements are not guaranteed to be aligned as their type would require. On
+ *        platforms that do not support unaligned accesses, read them with `memcpy` (or copy the whole span at once).
+ */
+struct dicey_array_span {
+    enum dicey_type type; /**< The type of the elements of the array */
+    size_t nitems;        /**< The number of elements in the array */
+
+    union {
+        const void *data; /**< The elements, as raw bytes */
+
+        const dicey_bool *bools;
+        const dicey_byte *bytes;
+        const dicey_float *floats;
+        const dicey_i16 *i16s;
+        const dicey_i32 *i32s;
+        const dicey_i64 *i64s;
+        const dicey_u16 *u16s;
+        const dicey_u32 *u32s;
+        const dicey_u64 *u64s;
+        const struct dicey_uuid *uuids;
+    };
+};
+
+/**
+ * @brief Gets the elements of an array of fixed-size values as a contiguous span, without probing them one by one.
+ * @note  The span is borrowed and tied to the lifetime of the packet (or owning value) `value` comes from.
+ * @param value The value to get the array from.
+ * @param dest The span which will point to the elements of the array.
+ * @return The error code indicating the success or failure of the operation.
+ *        Possible errors include:
+ *        - OK: The operation was successful.
+ *        - EBADMSG: The size of the array does not match the number and type of its elements.
+ *        - EVALUE_TYPE_MISMATCH: The value is not an array, or its elements are not of a fixed-size type.
+ */
+DICEY_EXPORT enum dicey_error dicey_value_get_array_span(
+    const struct dicey_value *value,
+    struct dicey_array_span *dest
+);
+
 /**
  * @brief Gets the boolean value from the given value.
  * @param value The value to get the boolean from.
@@ -23,6 +23,7 @@
 #include "core/hashset.h"
 #include "core/hashtable.h"
 #include "core/message.h"
+#include "core/packet-pool.h"
 #include "core/packet.h"
 #include "core/type.h"
 #include "core/typedescr.h"
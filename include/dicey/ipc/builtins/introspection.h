@@ -43,10 +43,15 @@
 
 /**
  * trait dicey.Registry {
+ *     ro Generation: t // the current generation of the registry, bumped by every change made to it
  *     ro Objects: [@] // a list of object paths (excluding aliases)
  *     ro Paths: [@] // a list of all paths in the registry, including aliases
  *     ro Traits: [@]  // a list of trait object paths
  *
+ *     // takes a generation, returns the current generation, whether a full resync is required and, if not, the
+ *     // changes made after the given generation as (generation, kind, subject, target). See
+ *     // `enum dicey_registry_change_kind`
+ *     ChangesSince: t -> (tb[(tcss)])
  *     ElementExists: (@%) -> b // given a path and selector, return true if the element exists
  *     PathExists: @ -> b // takes a path, returns true if it exists. Nicer than attempting to get data from a
  *                        // non-existing path and handling failure
@@ -55,12 +60,16 @@
  *     RealPath: @ -> @ // takes a path, returns the real path of the object (same if not an alias)
  *     TraitExists: s -> b // takes a path, returns true if such a trait exists
  *
- *     // TODO: add signals for object creation and deletion
+ *     signal Changed: t // raised with the new generation, at most once per server loop iteration, when the registry
+ *                       // changes
  * }
  */
 
 #define DICEY_REGISTRY_TRAIT_NAME "dicey.Registry"
 
+#define DICEY_REGISTRY_GENERATION_PROP_NAME "Generation"
+#define DICEY_REGISTRY_GENERATION_PROP_SIG "t"
+
 #define DICEY_REGISTRY_OBJECTS_PROP_NAME "Objects"
 #define DICEY_REGISTRY_OBJECTS_PROP_SIG "[@]"
 
@@ -70,6 +79,9 @@
 #define DICEY_REGISTRY_TRAITS_PROP_NAME "Traits"
 #define DICEY_REGISTRY_TRAITS_PROP_SIG "[s]"
 
+#define DICEY_REGISTRY_CHANGES_SINCE_OP_NAME "ChangesSince"
+#define DICEY_REGISTRY_CHANGES_SINCE_OP_SIG "t -> (tb[(tcss)])"
+
 #define DICEY_REGISTRY_ELEMENT_EXISTS_OP_NAME "ElementExists"
 #define DICEY_REGISTRY_ELEMENT_EXISTS_OP_SIG "(@%) -> b"
 
@@ -85,6 +97,25 @@
 #define DICEY_REGISTRY_TRAIT_EXISTS_OP_NAME "TraitExists"
 #define DICEY_REGISTRY_TRAIT_EXISTS_OP_SIG "s -> b"
 
+#define DICEY_REGISTRY_CHANGED_SIGNAL_NAME "Changed"
+#define DICEY_REGISTRY_CHANGED_SIGNAL_SIG "t"
+
+/**
+ * @brief The kinds of change reported by `dicey.Registry.ChangesSince`, as the `c` field of each change. The subject is
+ *        the path (or trait name) that changed; the target is only set for new aliases, and is empty otherwise.
+ * @note  Generations are only meaningful within the lifetime of a server: after reconnecting, mirrors must list
+ *        everything again.
+ */
+enum dicey_registry_change_kind {
+    DICEY_REGISTRY_CHANGE_INVALID = 0, /**< Not a valid change. */
+
+    DICEY_REGISTRY_CHANGE_OBJECT_ADDED = 1,   /**< An object was added. The subject is its path. */
+    DICEY_REGISTRY_CHANGE_OBJECT_REMOVED = 2, /**< An object was removed. The subject is its path. */
+    DICEY_REGISTRY_CHANGE_ALIAS_ADDED = 3,    /**< An alias was added. The target is the object path. */
+    DICEY_REGISTRY_CHANGE_ALIAS_REMOVED = 4,  /**< An alias was removed. The subject is the alias. */
+    DICEY_REGISTRY_CHANGE_TRAIT_ADDED = 5,    /**< A trait was added. The subject is its name. */
+};
+
 /**
  * trait dicey.Trait {
  *     ro Properties: [(ssb)] // array of (name, signature, read-only)
@@ -20,7 +20,7 @@
 #include "dicey_config.h"
 
 /**
- * object "/dicey/server" : dicey.SignalManager, dicey.PluginManager (if plugins are enabled)
+ * object "/dicey/server" : dicey.SignalManager, dicey.Batch, dicey.PluginManager (if plugins are enabled)
  */
 #define DICEY_SERVER_PATH "/dicey/server"
 
@@ -31,6 +31,12 @@
  *                            // Note: signals are never raised on aliases. The client must take note of whether the
  *                            // user subscribed to an aliased path or not.
  *     Unsubscribe: {@%} -> $ // takes a path and selector of a signal to unsubscribe from. Will follow aliases.
+ *
+ *     SubscribeMany: [{@%}] -> v   // same as Subscribe, for many signals in one go. Returns a tuple with one item per
+ *                                  // signal, in the same order, holding either what Subscribe would return or the
+ *                                  // error that prevented the subscription. A failure does not affect the others
+ *     UnsubscribeMany: [{@%}] -> v // same as Unsubscribe, for many signals in one go. Returns a tuple with one item
+ *                                  // per signal, holding either unit or an error
  * }
  */
 
@@ -42,4 +48,32 @@
 #define DICEY_EVENTMANAGER_UNSUBSCRIBE_OP_NAME "Unsubscribe"
 #define DICEY_EVENTMANAGER_UNSUBSCRIBE_OP_SIG "{@%} -> $"
 
+#define DICEY_EVENTMANAGER_SUBSCRIBE_MANY_OP_NAME "SubscribeMany"
+#define DICEY_EVENTMANAGER_SUBSCRIBE_MANY_OP_SIG "[{@%}] -> v"
+
+#define DICEY_EVENTMANAGER_UNSUBSCRIBE_MANY_OP_NAME "UnsubscribeMany"
+#define DICEY_EVENTMANAGER_UNSUBSCRIBE_MANY_OP_SIG "[{@%}] -> v"
+
+/**
+ * trait dicey.Batch {
+ *     GetMany: [{@%}] -> v  // takes a list of paths and selectors of properties, and gets all of them in one go.
+ *                           // Returns a tuple with one item per property, in the same order, holding either the
+ *                           // value of the property or the error that prevented the server from getting it
+ *     SetMany: [(@%v)] -> v // takes a list of paths, selectors and values of properties, and sets all of them in one
+ *                           // go. Returns a tuple with one item per property, in the same order, holding either unit
+ *                           // or the error that prevented the server from setting it
+ * }
+ *
+ * Note: every item is handled exactly like a standalone GET or SET, so properties handled by the user still go through
+ *       the server's on_request callback. The response is only sent once every item has an outcome.
+ */
+
+#define DICEY_BATCH_TRAIT_NAME "dicey.Batch"
+
+#define DICEY_BATCH_GET_MANY_OP_NAME "GetMany"
+#define DICEY_BATCH_GET_MANY_OP_SIG "[{@%}] -> v"
+
+#define DICEY_BATCH_SET_MANY_OP_NAME "SetMany"
+#define DICEY_BATCH_SET_MANY_OP_SIG "[(@%v)] -> v"
+
 #endif // GFBKZEFZQX_SERVER_H
@@ -68,6 +68,24 @@ struct dicey_client_event {
  */
 struct dicey_client;
 
+/**
+ * @brief A path and selector pair, such as a property to get with `dicey_client_get_many()` or a signal to subscribe to
+ *        with `dicey_client_subscribe_many()`.
+ */
+struct dicey_client_target {
+    const char *path;          /**< The path of the object hosting the element. */
+    struct dicey_selector sel; /**< The selector pointing to the element. */
+};
+
+/**
+ * @brief A property to set with `dicey_client_set_many()`.
+ */
+struct dicey_client_set_item {
+    const char *path;          /**< The path of the object hosting the property. */
+    struct dicey_selector sel; /**< The selector pointing to the property. */
+    struct dicey_arg value;    /**< The value to set the property to. */
+};
+
 /**
  * @brief Represents the result of a subscription operation on a client.
  * @note  This structure must be initialised with `dicey_client_subscribe_result_deinit()` after use to free any
@@ -172,6 +190,44 @@ typedef void dicey_client_on_sub_done_fn(
  */
 typedef void dicey_client_on_unsub_done_fn(struct dicey_client *client, void *ctx, enum dicey_error status);
 
+/**
+ * @brief Represents a callback function that is called whenever a client finishes subscribing to multiple signals.
+ * @param client   The client this callback is associated with.
+ * @param ctx      The context associated to this function (usually passed through
+ *                 `dicey_client_subscribe_many_async()`).
+ * @param status   The status of the request as a whole - either `DICEY_OK` or an error describing why the request
+ *                 failed. If not OK, `results` is NULL.
+ * @param results  One result per signal, in the same order as they were requested. The results are only valid for the
+ *                 duration of the callback and are deinitialised after it returns; steal `real_path` to keep it.
+ * @param nresults The number of items in `results`.
+ */
+typedef void dicey_client_on_sub_many_done_fn(
+    struct dicey_client *client,
+    void *ctx,
+    enum dicey_error status,
+    struct dicey_client_subscribe_result *results,
+    size_t nresults
+);
+
+/**
+ * @brief Represents a callback function that is called whenever a client finishes unsubscribing from multiple signals.
+ * @param client   The client this callback is associated with.
+ * @param ctx      The context associated to this function (usually passed through
+ *                 `dicey_client_unsubscribe_many_async()`).
+ * @param status   The status of the request as a whole - either `DICEY_OK` or an error describing why the request
+ *                 failed. If not OK, `results` is NULL.
+ * @param results  One error code per signal, in the same order as they were requested. Only valid for the duration of
+ *                 the callback.
+ * @param nresults The number of items in `results`.
+ */
+typedef void dicey_client_on_unsub_many_done_fn(
+    struct dicey_client *client,
+    void *ctx,
+    enum dicey_error status,
+    const enum dicey_error *results,
+    size_t nresults
+);
+
 /**
  * @brief Represents a callback function that is called whenever a client receives a Dicey Message containing a signal.
  * @param client  The client this callback is associated with.
@@ -202,6 +258,15 @@ struct dicey_client_args {
 
     /** The function that will be called whenever the client receives a signal. */
     dicey_client_signal_fn *on_signal;
+
+    /**
+     * How long, in milliseconds, `dicey_client_get()` can serve a property from the client's cache before asking the
+     * server again. 0 (the default) disables the cache. Cached values are also dropped (or updated, see
+     * `dicey_client_cache_bind()`) whenever the client receives a signal from the same trait and object, so subscribing
+     * to the signals of the properties you read lets you use long TTLs safely. Setting a property through this client
+     * drops its cached value as soon as the server replies.
+     */
+    uint32_t cache_ttl;
 };
 
 /**
@@ -222,6 +287,46 @@ DICEY_EXPORT enum dicey_error dicey_client_new(struct dicey_client **dest, const
  */
 DICEY_EXPORT void dicey_client_delete(struct dicey_client *client);
 
+/**
+ * @brief Makes a signal update the cached value of a property, instead of invalidating all the cached properties of its
+ *        trait. The value carried by the signal becomes the new value of the property.
+ * @note  Like any other signal, the bound signal is only received if the client is subscribed to it.
+ * @param client The client to configure. Its cache must be enabled (see `dicey_client_args.cache_ttl`).
+ * @param path   The path of the object raising the signal. Signals are always raised from the main path of an object,
+ *               so this must not be an alias.
+ * @param sel    The selector of the property to update.
+ * @param signal The name of the signal, which must belong to the same trait as the property.
+ * @return       Error code. Possible values are:
+ *               - OK: the binding was successfully added (or replaced an existing one)
+ *               - EINVAL: the cache is disabled
+ *               - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_cache_bind(
+    struct dicey_client *client,
+    const char *path,
+    struct dicey_selector sel,
+    const char *signal
+);
+
+/**
+ * @brief Drops all the values in the client's cache. Bindings set with `dicey_client_cache_bind()` are kept.
+ * @note  The cache is also flushed automatically when the client disconnects.
+ * @param client The client whose cache should be flushed. If the cache is disabled, this function does nothing.
+ */
+DICEY_EXPORT void dicey_client_cache_flush(struct dicey_client *client);
+
+/**
+ * @brief Drops the cached value of a property, so that the next `dicey_client_get()` will ask the server again.
+ * @param client The client whose cache should be updated. If the cache is disabled, this function does nothing.
+ * @param path   The path the property was read from.
+ * @param sel    The selector of the property.
+ */
+DICEY_EXPORT void dicey_client_cache_invalidate(
+    struct dicey_client *client,
+    const char *path,
+    struct dicey_selector sel
+);
+
 /**
  * @brief Connects a client to a server, blocking until the connection is established or an error occurs.
  * @param client The client to connect.
@@ -340,6 +445,10 @@ DICEY_EXPORT enum dicey_error dicey_client_exec_async(
  * @brief Sends a GET request to the server, blocking until a response is received or an error occurs.
  * @note  This function is meant as a convenience wrapper around `dicey_client_request()`, and is equivalent to calling
  *        `dicey_client_request()` with a custom GET packet.
+ *        If the client's cache is enabled (see `dicey_client_args.cache_ttl`), the property may be served from the
+ *        cache without contacting the server. Given that signals are only raised from the main path of an object, the
+ *        first read from a path (and the first one after the TTL expires) also asks the server which object the path
+ *        points to, which costs an extra round trip.
  * @param client   The client to send the request with.
  * @param path     The object path to send the request to.
  * @param sel      The selector pointing to the property to get.
@@ -366,6 +475,8 @@ DICEY_EXPORT enum dicey_error dicey_client_get(
  * response is received or an error occurs.
  * @note  This function is meant as a convenience wrapper around `dicey_client_request_async()`, and is equivalent to
  *        calling `dicey_client_request_async()` with a custom GET packet.
+ *        Unlike `dicey_client_get()`, this function never uses the client's cache: the request is always sent to the
+ *        server, and its response is not cached.
  * @param client The client to send the request with.
  * @param path     The object path to send the request to.
  * @param sel      The selector pointing to the property to get.
@@ -395,6 +506,56 @@ DICEY_EXPORT enum dicey_error dicey_client_get_async(
  */
 DICEY_EXPORT void *dicey_client_get_context(const struct dicey_client *client);
 
+/**
+ * @brief Gets multiple properties in a single round trip, blocking until a response is received or an error occurs.
+ * @note  The server handles every property exactly as if it had been requested with `dicey_client_get()`. Failing to
+ *        get a property does not fail the whole request; the error is reported in place of the value instead.
+ * @param client   The client to send the request with.
+ * @param items    The properties to get.
+ * @param nitems   The number of properties to get. Must be between 1 and UINT16_MAX.
+ * @param response The response packet, if the request was successful. Its value is a tuple with one item per property,
+ *                 in the same order as `items`, holding either the value of the property or an error. Must be freed
+ *                 using `dicey_packet_deinit()` when done.
+ * @param timeout  The maximum time to wait for a response, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successfully sent and a response was received (`response` is valid)
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected), or `nitems` is 0
+ *                 - EOVERFLOW: too many items
+ *                 - ETIMEDOUT: the request timed out
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_get_many(
+    struct dicey_client *client,
+    const struct dicey_client_target *items,
+    size_t nitems,
+    struct dicey_packet *response,
+    uint32_t timeout
+);
+
+/**
+ * @brief Gets multiple properties in a single round trip, returning immediately and calling the provided callback when
+ *        either a response is received or an error occurs. See `dicey_client_get_many()` for the format of the reply.
+ * @param client  The client to send the request with.
+ * @param items   The properties to get.
+ * @param nitems  The number of properties to get. Must be between 1 and UINT16_MAX.
+ * @param cb      The callback to call when a response is received or an error occurs.
+ * @param data    The context to pass to the callback.
+ * @param timeout The maximum time to wait for a response, in milliseconds.
+ * @return        Error code. A (non-exhaustive) list of possible values are:
+ *                - OK: the request was successfully submitted for sending
+ *                - EINVAL: the client is in the wrong state (i.e. not connected), or `nitems` is 0
+ *                - EOVERFLOW: too many items
+ *                - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_get_many_async(
+    struct dicey_client *client,
+    const struct dicey_client_target *items,
+    size_t nitems,
+    dicey_client_on_reply_fn *cb,
+    void *data,
+    uint32_t timeout
+);
+
 /**
  * @brief Asks the server the real path of a given path, blocking until a response is received or an error occurs.
  *        This function is useful to resolve aliases and get the actual path of an object.
@@ -564,6 +725,54 @@ DICEY_EXPORT enum dicey_error dicey_client_is_path_alias_async(
  */
 DICEY_EXPORT bool dicey_client_is_running(const struct dicey_client *client);
 
+/**
+ * @brief Lists the changes made to the registry of the server after a given generation, blocking until a response is
+ *        received or an error occurs.
+ * @note  This is meant for clients that mirror the objects on the server: after listing everything once, they can
+ *        subscribe to `dicey.Registry.Changed` and only fetch what changed since the last generation they have seen.
+ *        The server only keeps the latest changes: if the response says a resync is required, everything must be
+ *        listed again.
+ * @param client   The client to send the request with.
+ * @param since    The last generation known to the caller, as returned by a previous call or by the `Generation`
+ *                 property of `dicey.Registry`.
+ * @param response The response packet, if the request was successful. Must be freed using `dicey_packet_deinit()` when
+ *                 done. The packet is expected to have the output signature of `DICEY_REGISTRY_CHANGES_SINCE_OP_SIG`.
+ * @param timeout  The maximum time to wait for a response, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successfully sent and a response was received (`response` is valid)
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected)
+ *                 - ETIMEDOUT: the request timed out
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_list_changes(
+    struct dicey_client *client,
+    uint64_t since,
+    struct dicey_packet *response,
+    uint32_t timeout
+);
+
+/**
+ * @brief Lists the changes made to the registry of the server after a given generation, returning immediately and
+ *        calling the provided callback when a response is received or an error occurs.
+ * @param client  The client to send the request with.
+ * @param since   The last generation known to the caller.
+ * @param cb      The callback to call when a response is received or an error occurs. The packet is expected to have
+ *                the output signature of `DICEY_REGISTRY_CHANGES_SINCE_OP_SIG`.
+ * @param data    The context to pass to the callback.
+ * @param timeout The maximum time to wait for a response, in milliseconds.
+ * @return        Error code. A (non-exhaustive) list of possible values are:
+ *                - OK: the request was successfully submitted for sending
+ *                - EINVAL: the client is in the wrong state (i.e. not connected)
+ *                - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_list_changes_async(
+    struct dicey_client *client,
+    uint64_t since,
+    dicey_client_on_reply_fn *cb,
+    void *data,
+    uint32_t timeout
+);
+
 /**
  * @brief Lists all objects on the server, blocking until a response is received or an error occurs.
  * @note  The list of objects returned will not contain aliases. Use `dicey_client_list_paths()` to get a list of all
@@ -793,6 +1002,106 @@ DICEY_EXPORT enum dicey_error dicey_client_set_async(
  */
 DICEY_EXPORT void *dicey_client_set_context(struct dicey_client *client, void *data);
 
+/**
+ * @brief Sets multiple properties in a single round trip, blocking until a response is received or an error occurs.
+ * @note  The server handles every property exactly as if it had been set with `dicey_client_set()`. Failing to set a
+ *        property does not fail the whole request, nor does it stop the server from setting the others.
+ * @param client   The client to send the request with.
+ * @param items    The properties to set, and the values to set them to.
+ * @param nitems   The number of properties to set. Must be between 1 and UINT16_MAX.
+ * @param response The response packet, if the request was successful. Its value is a tuple with one item per property,
+ *                 in the same order as `items`, holding either unit or an error. Must be freed using
+ *                 `dicey_packet_deinit()` when done.
+ * @param timeout  The maximum time to wait for a response, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successfully sent and a response was received (`response` is valid)
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected), or `nitems` is 0
+ *                 - EOVERFLOW: too many items
+ *                 - ETIMEDOUT: the request timed out
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_set_many(
+    struct dicey_client *client,
+    const struct dicey_client_set_item *items,
+    size_t nitems,
+    struct dicey_packet *response,
+    uint32_t timeout
+);
+
+/**
+ * @brief Sets multiple properties in a single round trip, returning immediately and calling the provided callback when
+ *        either a response is received or an error occurs. See `dicey_client_set_many()` for the format of the reply.
+ * @param client  The client to send the request with.
+ * @param items   The properties to set, and the values to set them to.
+ * @param nitems  The number of properties to set. Must be between 1 and UINT16_MAX.
+ * @param cb      The callback to call when a response is received or an error occurs.
+ * @param data    The context to pass to the callback.
+ * @param timeout The maximum time to wait for a response, in milliseconds.
+ * @return        Error code. A (non-exhaustive) list of possible values are:
+ *                - OK: the request was successfully submitted for sending
+ *                - EINVAL: the client is in the wrong state (i.e. not connected), or `nitems` is 0
+ *                - EOVERFLOW: too many items
+ *                - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_set_many_async(
+    struct dicey_client *client,
+    const struct dicey_client_set_item *items,
+    size_t nitems,
+    dicey_client_on_reply_fn *cb,
+    void *data,
+    uint32_t timeout
+);
+
+/**
+ * @brief Subscribes to multiple signals in a single round trip, blocking until the server replies or an error occurs.
+ * @note  Each signal is handled exactly as if it had been subscribed to with `dicey_client_subscribe_to()`. Failing to
+ *        subscribe to a signal does not fail the whole request; the error is reported in its result instead.
+ * @param client   The client that will subscribe to the signals.
+ * @param targets  The signals to subscribe to.
+ * @param ntargets The number of signals. Must be between 1 and UINT16_MAX.
+ * @param results  An array of `ntargets` results, filled with one result per signal, in the same order as `targets`.
+ *                 Only valid if this function returns OK; each result must then be freed with
+ *                 `dicey_client_subscribe_result_deinit()`.
+ * @param timeout  The maximum time to wait for the subscriptions to complete, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successful (check `results` for the outcome of each subscription)
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected), or `ntargets` is 0
+ *                 - EOVERFLOW: too many targets
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ *                 - ETIMEDOUT: the request timed out
+ */
+DICEY_EXPORT enum dicey_error dicey_client_subscribe_many(
+    struct dicey_client *client,
+    const struct dicey_client_target *targets,
+    size_t ntargets,
+    struct dicey_client_subscribe_result *results,
+    uint32_t timeout
+);
+
+/**
+ * @brief Subscribes to multiple signals in a single round trip. Returns immediately and calls the provided callback
+ *        when the server replies or an error occurs.
+ * @param client   The client that will subscribe to the signals.
+ * @param targets  The signals to subscribe to.
+ * @param ntargets The number of signals. Must be between 1 and UINT16_MAX.
+ * @param cb       The callback to call when the request is complete or an error occurs.
+ * @param data     The context to pass to the callback.
+ * @param timeout  The maximum time to wait for the subscriptions to complete, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successfully submitted for sending
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected), or `ntargets` is 0
+ *                 - EOVERFLOW: too many targets
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_subscribe_many_async(
+    struct dicey_client *client,
+    const struct dicey_client_target *targets,
+    size_t ntargets,
+    dicey_client_on_sub_many_done_fn *cb,
+    void *data,
+    uint32_t timeout
+);
+
 /**
  * @brief Subscribes to a signal identified by a given path and selector. Blocks until the subscription is complete or
  * an error occurs.
@@ -887,6 +1196,55 @@ DICEY_EXPORT enum dicey_error dicey_client_unsubscribe_from_async(
     uint32_t timeout
 );
 
+/**
+ * @brief Unsubscribes from multiple signals in a single round trip, blocking until the server replies or an error
+ *        occurs.
+ * @note  Each signal is handled exactly as if it had been unsubscribed from with `dicey_client_unsubscribe_from()`.
+ * @param client   The client that will unsubscribe from the signals.
+ * @param targets  The signals to unsubscribe from.
+ * @param ntargets The number of signals. Must be between 1 and UINT16_MAX.
+ * @param results  An array of `ntargets` error codes, filled with the outcome of each unsubscription in the same order
+ *                 as `targets`. Only valid if this function returns OK.
+ * @param timeout  The maximum time to wait for the unsubscriptions to complete, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successful (check `results` for the outcome of each unsubscription)
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected), or `ntargets` is 0
+ *                 - EOVERFLOW: too many targets
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ *                 - ETIMEDOUT: the request timed out
+ */
+DICEY_EXPORT enum dicey_error dicey_client_unsubscribe_many(
+    struct dicey_client *client,
+    const struct dicey_client_target *targets,
+    size_t ntargets,
+    enum dicey_error *results,
+    uint32_t timeout
+);
+
+/**
+ * @brief Unsubscribes from multiple signals in a single round trip. Returns immediately and calls the provided callback
+ *        when the server replies or an error occurs.
+ * @param client   The client that will unsubscribe from the signals.
+ * @param targets  The signals to unsubscribe from.
+ * @param ntargets The number of signals. Must be between 1 and UINT16_MAX.
+ * @param cb       The callback to call when the request is complete or an error occurs.
+ * @param data     The context to pass to the callback.
+ * @param timeout  The maximum time to wait for the unsubscriptions to complete, in milliseconds.
+ * @return         Error code. A (non-exhaustive) list of possible values are:
+ *                 - OK: the request was successfully submitted for sending
+ *                 - EINVAL: the client is in the wrong state (i.e. not connected), or `ntargets` is 0
+ *                 - EOVERFLOW: too many targets
+ *                 - ENOMEM: memory allocation failed (out of memory)
+ */
+DICEY_EXPORT enum dicey_error dicey_client_unsubscribe_many_async(
+    struct dicey_client *client,
+    const struct dicey_client_target *targets,
+    size_t ntargets,
+    dicey_client_on_unsub_many_done_fn *cb,
+    void *data,
+    uint32_t timeout
+);
+
 #if defined(__cplusplus)
 }
 #endif
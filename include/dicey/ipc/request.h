@@ -180,6 +180,21 @@ DICEY_EXPORT enum dicey_error dicey_request_response_start(
     struct dicey_value_builder *builder
 );
 
+/**
+ * @brief Starts building the response for a request, serialising the value directly into its wire form.
+ * @note Unlike dicey_request_response_start(), the value must be built strictly in order: lists can only be appended
+ *       to, and each item must be completed before the next one is started. In exchange, the response is never built
+ *       as a tree and then encoded, which saves both time and memory on large values.
+ * @param req The request.
+ * @param builder The response builder.
+ * @return An error code indicating if the operation was successful. On failure, the request can still be replied to
+ *         with dicey_request_response_start() or dicey_request_reply().
+ */
+DICEY_EXPORT enum dicey_error dicey_request_response_start_streaming(
+    struct dicey_request *req,
+    struct dicey_value_builder *builder
+);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -19,6 +19,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "../core/builders.h"
 #include "../core/errors.h"
@@ -103,6 +104,21 @@ typedef void dicey_server_on_request_fn(struct dicey_server *server, struct dice
  */
 typedef void dicey_server_on_startup(struct dicey_server *server, enum dicey_error error);
 
+/**
+ * @brief Describes what the server does when a client doesn't read its packets fast enough, and the data waiting to be
+ *        sent to it exceeds the budget set in `dicey_server_args`.
+ * @note  Responses are never dropped or conflated. Instead, with the signal policies, a response that doesn't fit in
+ *        the budget also makes the server stop reading requests from the client, like
+ *        `DICEY_SERVER_OVERFLOW_PAUSE_READING` does. The client is considered to have caught up again once its pending
+ *        data falls below half of the budget.
+ */
+enum dicey_server_overflow_policy {
+    DICEY_SERVER_OVERFLOW_DROP_SIGNALS = 0, /**< Signals are dropped until the client catches up (default). */
+    DICEY_SERVER_OVERFLOW_CONFLATE_SIGNALS, /**< Only the latest signal for each path and selector is kept. */
+    DICEY_SERVER_OVERFLOW_PAUSE_READING,    /**< Requests from the client aren't read until it catches up. */
+    DICEY_SERVER_OVERFLOW_KICK,             /**< The client is disconnected with `DICEY_BYE_REASON_KICKED`. */
+};
+
 /**
  * @brief Describes the arguments that can be passed to a new Dicey server.
  */
@@ -114,6 +130,41 @@ struct dicey_server_args {
     dicey_server_on_startup *on_startup;    /**< The callback to be called when the server starts up. */
     dicey_server_on_request_fn *on_request; /**< The callback to be called when a request is received. */
 
+    /**
+     * Outbound packets are queued per client and written in a single batch once per loop iteration. A client's queue is
+     * written immediately instead as soon as it holds at least this many bytes. If not set, it's 64KB.
+     */
+    size_t outbound_flush_bytes;
+
+    /**
+     * Same as `outbound_flush_bytes`, but in number of queued packets. If not set, it's 256.
+     */
+    size_t outbound_flush_packets;
+
+    /**
+     * The maximum number of bytes that may be waiting to be sent to a single client, either queued or being written.
+     * When a client exceeds it, `client_overflow_policy` is applied and the violation is reported via `on_error`.
+     * If not set, there is no limit.
+     */
+    size_t client_max_outbound_bytes;
+
+    /**
+     * Same as `client_max_outbound_bytes`, but in number of packets. If not set, there is no limit.
+     */
+    size_t client_max_outbound_packets;
+
+    /**
+     * What to do when a client exceeds its outbound budget. If not set, signals are dropped.
+     */
+    enum dicey_server_overflow_policy client_overflow_policy;
+
+    /**
+     * The capacity of the lock-free queue other threads use to submit work to the server loop (e.g. responses sent from
+     * worker threads). Submissions that don't fit spill into a growable overflow list, so producers never wait. If not
+     * set, it's 1024.
+     */
+    size_t loop_queue_cap;
+
 #if DICEY_HAS_PLUGINS
     dicey_server_on_plugin_event_fn *on_plugin_event; /**< The callback to be called when a plugin event occurs. */
 
@@ -284,6 +335,105 @@ DICEY_EXPORT enum dicey_error dicey_server_delete_object(struct dicey_server *se
  */
 DICEY_EXPORT enum dicey_error dicey_server_drop_all_aliases_of_object(struct dicey_server *server, const char *path);
 
+/**
+ * @brief A list of registry mutations (objects and aliases to add, objects to delete), built on any thread and then
+ *        applied to a server all at once using `dicey_server_registry_batch_commit`.
+ */
+struct dicey_server_registry_batch;
+
+/**
+ * @brief Creates a new, empty registry batch.
+ * @param dest The destination pointer to store the pointer to the new batch.
+ * @return     Error code. The possible values are:
+ *             - OK: the batch was successfully created
+ *             - ENOMEM: memory allocation failed
+ */
+DICEY_EXPORT enum dicey_error dicey_server_registry_batch_begin(struct dicey_server_registry_batch **dest);
+
+/**
+ * @brief Queues the addition of an object to a batch. This is the batched version of `dicey_server_add_object`.
+ * @note  The strings are copied into the batch, and are not required to be valid after the function returns. Whether
+ *        the object can actually be added is only checked when the batch is committed.
+ * @param batch  The batch to add the entry to.
+ * @param path   The path at which the object will be accessible.
+ * @param traits A list of `const char*` trait names that the object implements, terminated by a NULL pointer.
+ * @return       Error code. The possible values are:
+ *               - OK: the entry was successfully queued
+ *               - ENOMEM: memory allocation failed
+ *               - EOVERFLOW: the batch is too big
+ */
+DICEY_EXPORT enum dicey_error dicey_server_registry_batch_add_object(
+    struct dicey_server_registry_batch *batch,
+    const char *path,
+    const char *const *traits
+);
+
+/**
+ * @brief Queues the addition of an alias to a batch. This is the batched version of `dicey_server_add_object_alias`.
+ * @note  The strings are copied into the batch, and are not required to be valid after the function returns. The
+ *        object may be added by an earlier entry of the same batch.
+ * @param batch The batch to add the entry to.
+ * @param path  The path of the object to alias.
+ * @param alias The alias to add to the object.
+ * @return      Error code. The possible values are:
+ *              - OK: the entry was successfully queued
+ *              - ENOMEM: memory allocation failed
+ *              - EOVERFLOW: the batch is too big
+ */
+DICEY_EXPORT enum dicey_error dicey_server_registry_batch_add_alias(
+    struct dicey_server_registry_batch *batch,
+    const char *path,
+    const char *alias
+);
+
+/**
+ * @brief Queues the deletion of an object to a batch. This is the batched version of `dicey_server_delete_object`.
+ * @note  The path is copied into the batch, and is not required to be valid after the function returns.
+ * @param batch The batch to add the entry to.
+ * @param path  The path at which the object is accessible.
+ * @return      Error code. The possible values are:
+ *              - OK: the entry was successfully queued
+ *              - ENOMEM: memory allocation failed
+ *              - EOVERFLOW: the batch is too big
+ */
+DICEY_EXPORT enum dicey_error dicey_server_registry_batch_delete_object(
+    struct dicey_server_registry_batch *batch,
+    const char *path
+);
+
+/**
+ * @brief Deletes a batch without applying it.
+ * @param batch The batch to delete. May be NULL.
+ */
+DICEY_EXPORT void dicey_server_registry_batch_discard(struct dicey_server_registry_batch *batch);
+
+/**
+ * @brief Applies all the entries of a batch to the server's registry, in order, and deletes the batch.
+ * @note  This function has a different behaviour depending on whether the server is running or not. If the server is
+ *        in a stopped state (or if this function is called from the server's loop thread), the batch is applied to the
+ *        registry immediately (note: not thread safe). If the server is running, the whole batch is handed over to the
+ *        server loop as a single request, and this function blocks until it has been applied. In both cases, no client
+ *        request is handled while the batch is being applied, and the clients subscribed to registry changes are
+ *        notified only once.
+ * @note  A failed entry does not stop the others, nor rolls back the entries that came before it.
+ * @param server  The server to apply the batch to.
+ * @param batch   The batch to apply. The batch is always deleted, even on failure.
+ * @param results If not NULL, an array with room for one error code per entry in the batch, which is filled with the
+ *                outcome of each entry (see `dicey_server_add_object`, `dicey_server_add_object_alias` and
+ *                `dicey_server_delete_object` for the possible values). Left untouched if the batch isn't applied.
+ * @return        Error code. The possible values are several and include:
+ *                - OK: every entry was successfully applied
+ *                - ENOMEM: memory allocation failed
+ *                - ECANCELLED: the server shut down before the batch could be applied
+ *                - EINVAL: the server is in an invalid state (i.e. it is shutting down)
+ *                - any error returned by the first failed entry
+ */
+DICEY_EXPORT enum dicey_error dicey_server_registry_batch_commit(
+    struct dicey_server *server,
+    struct dicey_server_registry_batch *batch,
+    enum dicey_error *results
+);
+
 /**
  * @brief Gets the context associated with the server, as set by `dicey_server_set_context`.
  * @param server The server to get the context from.
@@ -291,6 +441,23 @@ DICEY_EXPORT enum dicey_error dicey_server_drop_all_aliases_of_object(struct dic
  */
 DICEY_EXPORT void *dicey_server_get_context(struct dicey_server *server);
 
+/**
+ * @brief Statistics about the data a server has written to its clients.
+ * @note  `packets / writes` is the average number of packets coalesced in a single write.
+ */
+struct dicey_server_stats {
+    uint64_t writes;  /**< Number of write operations issued */
+    uint64_t packets; /**< Number of packets written */
+    uint64_t bytes;   /**< Number of bytes written */
+};
+
+/**
+ * @brief Gets the outbound statistics of the server. This function can be safely called from any thread, at any time.
+ * @param server The server to get the statistics from.
+ * @param stats  The destination for the statistics.
+ */
+DICEY_EXPORT void dicey_server_get_stats(struct dicey_server *server, struct dicey_server_stats *stats);
+
 /**
  * @brief Gets the registry associated with the server.
  * @note  This function can't be called after the server has been started. The registry is owned by the server and will
@@ -310,6 +477,35 @@ DICEY_EXPORT struct dicey_registry *dicey_server_get_registry(struct dicey_serve
  */
 DICEY_EXPORT enum dicey_error dicey_server_kick(struct dicey_server *server, size_t id);
 
+/**
+ * @brief Publishes the value of a cached property (i.e. one with the `DICEY_ELEMENT_CACHED` flag). From now on, GET
+ *        requests for the property are answered directly by the server with the last published value, without
+ *        calling `on_request`. Until a value is published, GET requests are handled as usual.
+ * @note  The value is encoded by the caller, while storing it happens on the server thread. If the server is running
+ *        and this function isn't called from the server thread, it returns immediately and errors are reported via
+ *        `on_error`.
+ * @param server        The server to publish the value on.
+ * @param path          The path of the object hosting the property. Can be an alias.
+ * @param sel           The selector of the property.
+ * @param value         The new value of the property. It's copied, so it can be released right after the call.
+ * @param change_signal The name of a signal of the same trait to raise with the new value, or NULL to not raise
+ *                      anything. The signal is raised from the main path of the object.
+ * @return              Error code. The possible values are several and include:
+ *                      - OK: the value was successfully published (or submitted to the server thread)
+ *                      - ENOMEM: memory allocation failed
+ *                      - EINVAL: the element is not a cached property, or `change_signal` is not a signal
+ *                      - EPATH_NOT_FOUND: the object is not registered
+ *                      - EELEMENT_NOT_FOUND: the property or the signal don't exist
+ *                      - ESIGNATURE_MISMATCH: the value doesn't match the signature of the property or of the signal
+ */
+DICEY_EXPORT enum dicey_error dicey_server_publish_property(
+    struct dicey_server *server,
+    const char *path,
+    struct dicey_selector sel,
+    struct dicey_arg value,
+    const char *change_signal
+);
+
 /**
  * @brief Raises a signal, notifying all clients subscribed to it. This function is asynchronous and won't wait for the
  *        signal to actually be sent.
@@ -324,6 +520,28 @@ DICEY_EXPORT enum dicey_error dicey_server_kick(struct dicey_server *server, siz
  */
 DICEY_EXPORT enum dicey_error dicey_server_raise(struct dicey_server *server, struct dicey_packet packet);
 
+/**
+ * @brief Raises several signals at once. This is equivalent to calling `dicey_server_raise` for each packet, in order,
+ *        but the whole batch is handed over to the server loop in a single step, waking it up at most once.
+ * @note  Errors that happen while the signals are being raised (e.g. an element not being found) are not reported. The
+ *        signals are still raised in order, and a failed signal does not stop the others.
+ * @param server   The server to raise the signals from.
+ * @param packets  The signals to raise. Once the batch is accepted, the ownership of all the packets is transferred to
+ *                 the server, which will free them when done. If the batch is rejected with EINVAL, EOVERFLOW or
+ *                 ENOMEM, the packets are left untouched.
+ * @param npackets The number of packets in `packets`.
+ * @return         Error code. The possible values are several and include:
+ *                 - OK: the signals were successfully handed over to the server
+ *                 - ENOMEM: memory allocation failed
+ *                 - EINVAL: at least one packet is invalid (e.g. it is not a signal)
+ *                 - EOVERFLOW: the batch is too big
+ */
+DICEY_EXPORT enum dicey_error dicey_server_raise_batch(
+    struct dicey_server *server,
+    const struct dicey_packet *packets,
+    size_t npackets
+);
+
 /*
  * @brief Raises a signal, notifying all clients subscribed to it. This function is synchronous and will block until the
  *        signal is actually sent.
@@ -342,15 +560,21 @@ DICEY_EXPORT enum dicey_error dicey_server_raise_and_wait(struct dicey_server *s
 
 /**
  * @brief Replies to a client. This functions is asynchronous and won't wait for the packet to actually be sent.
+ * @note  When called from the server's loop thread (i.e. from `on_request`), the response is queued for writing right
+ *        away instead of being handed over to the loop, and any error that happens while doing so is returned.
+ *        Otherwise, errors that happen after the packet has been handed over are reported via `on_error`.
  * @param server The server to send the packet from.
  * @param id     The unique identifier of the client to send the packet to.
- * @param packet The packet to send. The ownership of the packet is transferred to the server, which will free it when
- * done. This packet must be response matching the sequence number, path and selector of a previously received request.
+ * @param packet The packet to send. If the packet is accepted, its ownership is transferred to the server, which will
+ * free it when done. If the packet is rejected with EINVAL or EOVERFLOW, or with ENOMEM when not called from the loop
+ * thread, the packet is still owned by the caller. This packet must be response matching the sequence number, path and
+ * selector of a previously received request.
  * @return       Error code. The possible values are several and include:
  *               - OK: the packet was successfully sent
  *               - ENOMEM: memory allocation failed
  *               - EINVAL: the packet is invalid (e.g. it is not a response or the sequence number does not match any
  *                         request)
+ *               - EOVERFLOW: the client id is out of range
  */
 DICEY_EXPORT enum dicey_error dicey_server_send_response(
     struct dicey_server *server,
@@ -363,15 +587,20 @@ DICEY_EXPORT enum dicey_error dicey_server_send_response(
  *        sent.
  * @note  Even if this function returns, there is no guarantee that the client actually received anything. This function
  *        only guarantees that the `write()` syscall is actually performed and that it succeeded.
+ * @note  When called from the server's loop thread, this function does not block and behaves exactly like
+ *        `dicey_server_send_response`.
  * @param server The server to send the packet from.
  * @param id     The unique identifier of the client to send the packet to.
- * @param packet The packet to send. The ownership of the packet is transferred to the server, which will free it when
- * done. This packet must be response matching the sequence number, path and selector of a previously received request.
+ * @param packet The packet to send. If the packet is accepted, its ownership is transferred to the server, which will
+ * free it when done. If the packet is rejected with EINVAL or EOVERFLOW, or with ENOMEM when not called from the loop
+ * thread, the packet is still owned by the caller. This packet must be response matching the sequence number, path and
+ * selector of a previously received request.
  * @return       Error code. The possible values are several and include:
  *               - OK: the packet was successfully sent
  *               - ENOMEM: memory allocation failed
  *               - EINVAL: the packet is invalid (e.g. it is not a response or the sequence number does not match any
  *                         request)
+ *               - EOVERFLOW: the client id is out of range
  */
 DICEY_EXPORT enum dicey_error dicey_server_send_response_and_wait(
     struct dicey_server *server,
@@ -379,6 +608,36 @@ DICEY_EXPORT enum dicey_error dicey_server_send_response_and_wait(
     struct dicey_packet packet
 );
 
+/**
+ * @brief A response to a client's request, as sent by `dicey_server_send_responses`.
+ */
+struct dicey_server_response {
+    size_t client_id;           /**< The unique identifier of the client to send the packet to. */
+    struct dicey_packet packet; /**< The response packet. */
+};
+
+/**
+ * @brief Replies to several requests at once, possibly from different clients. This is equivalent to calling
+ *        `dicey_server_send_response` for each response, in order, but the whole batch is handed over to the server
+ *        loop in a single step, waking it up at most once.
+ * @note  Errors that happen after the batch has been accepted are reported via `on_error`, one per failed response.
+ * @param server     The server to send the packets from.
+ * @param responses  The responses to send. Once the batch is accepted, the ownership of all the packets is
+ *                   transferred to the server, which will free them when done. If the batch is rejected with EINVAL,
+ *                   EOVERFLOW or ENOMEM, the packets are left untouched.
+ * @param nresponses The number of responses in `responses`.
+ * @return           Error code. The possible values are several and include:
+ *                   - OK: the responses were successfully handed over to the server
+ *                   - ENOMEM: memory allocation failed
+ *                   - EINVAL: at least one packet is invalid (e.g. it is not a response)
+ *                   - EOVERFLOW: the batch is too big, or a client id is out of range
+ */
+DICEY_EXPORT enum dicey_error dicey_server_send_responses(
+    struct dicey_server *server,
+    const struct dicey_server_response *responses,
+    size_t nresponses
+);
+
 /**
  * @brief Sets the context associated with the server. This context can be retrieved later with
  * `dicey_server_get_context`.
@@ -55,6 +55,8 @@ enum dicey_element_flags {
     DICEY_ELEMENT_READONLY = 1, /**< Whether a property is read-only or not. Has no effect on operations or signals */
     DICEY_ELEMENT_INTERNAL =
         2, /**< Whether an element is internal or not. Internal elements are not exposed to clients */
+    DICEY_ELEMENT_CACHED = 4, /**< Whether a property is served from the values published with
+                                   `dicey_server_publish_property()`. Has no effect on operations or signals */
 };
 
 /**
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// thank you MS, but just no
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <uv.h>
+
+#include <dicey/dicey.h>
+
+#include "util/getopt.h"
+
+#define DEFAULT_KEYS 100000U
+#define DEFAULT_ROUNDS 10U
+
+#define HELP_MSG                                                                                                       \
+    "Usage: %s [options...]\n"                                                                                         \
+    "  -h  print this help message and exit\n"                                                                         \
+    "  -n  number of keys to insert (default: %u)\n"                                                                   \
+    "  -r  number of lookup rounds (default: %u)\n"                                                                    \
+    "\nMeasures the average cost of the dicey_hashtable operations over registry-like keys.\n"                         \
+    "Only the public API is used, so the same program can be linked against different builds of libdicey to\n"         \
+    "compare their hash tables.\n"
+
+static void print_help(const char *const progname, FILE *const out) {
+    fprintf(out, HELP_MSG, progname, DEFAULT_KEYS, DEFAULT_ROUNDS);
+}
+
+struct bench_keys {
+    char **hits;   // keys that are inserted into the table
+    char **misses; // keys that look alike but are never inserted
+    size_t len;
+};
+
+static void bench_keys_free(struct bench_keys *const keys) {
+    for (size_t i = 0; i < keys->len; ++i) {
+        free(keys->hits[i]);
+        free(keys->misses[i]);
+    }
+
+    free(keys->hits);
+    free(keys->misses);
+
+    *keys = (struct bench_keys) { 0 };
+}
+
+static char *key_format(const char *const prefix, const size_t i) {
+    // long shared prefixes, like the paths and element descriptors the server actually stores
+    char buf[128] = { 0 };
+    const int len = snprintf(buf, sizeof buf, "/dicey/bench/%s/object_%zu#dicey.bench.Trait:Element", prefix, i);
+
+    return len > 0 ? strdup(buf) : NULL;
+}
+
+static bool bench_keys_init(struct bench_keys *const keys, const size_t len) {
+    *keys = (struct bench_keys) {
+        .hits = calloc(len, sizeof *keys->hits),
+        .misses = calloc(len, sizeof *keys->misses),
+        .len = len,
+    };
+
+    if (!keys->hits || !keys->misses) {
+        bench_keys_free(keys);
+
+        return false;
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        keys->hits[i] = key_format("hit", i);
+        keys->misses[i] = key_format("miss", i);
+
+        if (!keys->hits[i] || !keys->misses[i]) {
+            bench_keys_free(keys);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void report(const char *const name, const uint64_t start, const size_t ops) {
+    const uint64_t elapsed = uv_hrtime() - start;
+
+    printf("%-16s %10zu ops %12.2f ns/op\n", name, ops, ops ? (double) elapsed / (double) ops : 0.0);
+}
+
+static int run_bench(const struct bench_keys *const keys, const size_t rounds) {
+    struct dicey_hashtable *table = NULL;
+    int ret = EXIT_FAILURE;
+
+    uint64_t start = uv_hrtime();
+    for (size_t i = 0; i < keys->len; ++i) {
+        if (dicey_hashtable_set(&table, keys->hits[i], keys->hits[i], NULL) != DICEY_HASH_SET_ADDED) {
+            fputs("error: insert failed\n", stderr);
+
+            goto quit;
+        }
+    }
+    report("insert", start, keys->len);
+
+    size_t found = 0U;
+
+    start = uv_hrtime();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < keys->len; ++i) {
+            found += dicey_hashtable_get(table, keys->hits[i]) == keys->hits[i];
+        }
+    }
+    report("lookup (hit)", start, keys->len * rounds);
+
+    start = uv_hrtime();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < keys->len; ++i) {
+            found += dicey_hashtable_contains(table, keys->misses[i]);
+        }
+    }
+    report("lookup (miss)", start, keys->len * rounds);
+
+    if (found != keys->len * rounds) {
+        fprintf(stderr, "error: expected %zu hits, got %zu\n", keys->len * rounds, found);
+
+        goto quit;
+    }
+
+    size_t visited = 0U;
+
+    start = uv_hrtime();
+    for (size_t r = 0; r < rounds; ++r) {
+        struct dicey_hashtable_iter iter = dicey_hashtable_iter_start(table);
+
+        while (dicey_hashtable_iter_next(&iter, NULL, NULL)) {
+            ++visited;
+        }
+    }
+    report("iterate", start, visited);
+
+    // churn: remove and reinsert every other key, which stresses the handling of freed slots
+    start = uv_hrtime();
+    for (size_t i = 0; i < keys->len; i += 2U) {
+        if (!dicey_hashtable_remove(table, keys->hits[i])) {
+            fputs("error: remove failed\n", stderr);
+
+            goto quit;
+        }
+    }
+
+    for (size_t i = 0; i < keys->len; i += 2U) {
+        if (dicey_hashtable_set(&table, keys->hits[i], keys->hits[i], NULL) != DICEY_HASH_SET_ADDED) {
+            fputs("error: reinsert failed\n", stderr);
+
+            goto quit;
+        }
+    }
+    report("remove+reinsert", start, keys->len);
+
+    if (dicey_hashtable_size(table) != keys->len) {
+        fprintf(stderr, "error: expected %zu keys, got %" PRIu32 "\n", keys->len, dicey_hashtable_size(table));
+
+        goto quit;
+    }
+
+    ret = EXIT_SUCCESS;
+
+quit:
+    start = uv_hrtime();
+    dicey_hashtable_delete(table, NULL);
+    report("delete", start, keys->len);
+
+    return ret;
+}
+
+int main(const int argc, char *const *argv) {
+    const char *const progname = argv[0];
+    size_t nkeys = DEFAULT_KEYS, rounds = DEFAULT_ROUNDS;
+
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "hn:r:")) != -1) {
+        switch (opt) {
+        case 'h':
+            print_help(progname, stdout);
+            return EXIT_SUCCESS;
+
+        case 'n':
+            nkeys = strtoul(optarg, NULL, 10);
+            break;
+
+        case 'r':
+            rounds = strtoul(optarg, NULL, 10);
+            break;
+
+        case '?':
+            if (optopt == 'n' || optopt == 'r') {
+                fprintf(stderr, "error: -%c requires an argument\n", optopt);
+            } else {
+                fprintf(stderr, "error: unknown option -%c\n", optopt);
+            }
+
+            print_help(progname, stderr);
+            return EXIT_FAILURE;
+
+        default:
+            abort();
+        }
+    }
+
+    if (!nkeys || !rounds) {
+        fputs("error: -n and -r must be positive integers\n", stderr);
+
+        return EXIT_FAILURE;
+    }
+
+    struct bench_keys keys = { 0 };
+    if (!bench_keys_init(&keys, nkeys)) {
+        fputs("error: out of memory\n", stderr);
+
+        return EXIT_FAILURE;
+    }
+
+    const int ret = run_bench(&keys, rounds);
+
+    bench_keys_free(&keys);
+
+    return ret;
+}
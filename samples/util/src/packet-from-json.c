@@ -97,6 +97,7 @@ static enum dicey_bye_reason json_to_bye_reason(const cJSON *const item) {
     const enum dicey_bye_reason values[] = {
         DICEY_BYE_REASON_SHUTDOWN,
         DICEY_BYE_REASON_ERROR,
+        DICEY_BYE_REASON_KICKED,
     };
 
     const enum dicey_bye_reason *const end = values + sizeof values / sizeof *values;
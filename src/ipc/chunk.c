@@ -19,58 +19,146 @@
 #include "chunk.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
-#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 #include <uv.h>
 
-#define BUFFER_MINCAP 1024U // 1KB
+#include <dicey/core/errors.h>
+#include <dicey/core/packet.h>
+
+#include "sup/rcbuf.h"
+#include "sup/util.h"
+
+#include "wirefmt/packet-internal.h"
 
 size_t dicey_chunk_avail(const struct dicey_chunk *const cnk) {
-    return cnk ? cnk->cap - cnk->len - sizeof *cnk : 0U;
+    return cnk && cnk->buf ? dicey_rcbuf_cap(cnk->buf) - cnk->start - cnk->len : 0U;
 }
 
-struct dicey_chunk *dicey_chunk_grow(struct dicey_chunk *buf) {
-    const bool zero = !buf;
-    const size_t new_cap = buf && buf->cap ? buf->cap * 3 / 2 : BUFFER_MINCAP;
+void dicey_chunk_clear(struct dicey_chunk *const buffer) {
+    assert(buffer);
 
-    buf = realloc(buf, new_cap);
-    if (buf) {
-        if (zero) {
-            *buf = (struct dicey_chunk) { 0 };
-        }
+    if (buffer->buf && dicey_rcbuf_is_shared(buffer->buf)) {
+        // some packet still points into the buffer: leave it alone and start over with a new one when needed
+        dicey_chunk_deinit(buffer);
+    }
 
-        buf->cap = new_cap;
+    buffer->start = buffer->len = 0U;
+}
+
+void dicey_chunk_consume(struct dicey_chunk *const buffer, const size_t nbytes) {
+    assert(buffer && nbytes <= buffer->len);
+
+    buffer->start += nbytes;
+    buffer->len -= nbytes;
+
+    // if nothing is left and nobody borrowed from the buffer, the next read can start again from the beginning.
+    // Partial packets are not moved here - they are only compacted if we run out of space (see make_room)
+    if (!buffer->len && buffer->buf && !dicey_rcbuf_is_shared(buffer->buf)) {
+        buffer->start = 0U;
     }
+}
 
-    return buf;
+void dicey_chunk_deinit(struct dicey_chunk *const buffer) {
+    if (buffer) {
+        dicey_rcbuf_unref(buffer->buf);
+
+        *buffer = (struct dicey_chunk) { 0 };
+    }
 }
 
-uv_buf_t dicey_chunk_get_buf(struct dicey_chunk **const buf, const size_t min) {
-    assert(buf);
+enum dicey_error dicey_chunk_drain_packets(
+    struct dicey_chunk *const buf,
+    dicey_chunk_on_packet_fn *const on_packet,
+    void *const ctx
+) {
+    assert(buf && on_packet);
+
+    if (!buf->len) {
+        return DICEY_OK;
+    }
+
+    const void *base = dicey_rcbuf_bytes(buf->buf) + buf->start;
+    size_t remainder = buf->len;
 
-    size_t avail = 0U;
-    for (;;) {
-        avail = dicey_chunk_avail(*buf);
+    enum dicey_error err = DICEY_OK;
 
-        if (avail >= min) {
+    while (remainder) {
+        struct dicey_packet packet = { 0 };
+
+        // the packet borrows its payload from the chunk's buffer, which is kept alive until the packet is deinit'ed
+        err = dicey_packet_load_borrowed(&packet, &base, &remainder, buf->buf);
+        if (err) {
             break;
         }
 
-        *buf = dicey_chunk_grow(*buf);
+        if (!on_packet(ctx, packet)) {
+            break;
+        }
     }
 
-    struct dicey_chunk *const cnk = *buf;
-    if (!cnk) {
-        return uv_buf_init(NULL, 0U);
+    // drop everything we've parsed so far, and keep the trailing partial packet (if any) for the next read
+    dicey_chunk_consume(buf, buf->len - remainder);
+
+    // EAGAIN just means that the last packet is not complete yet - not an error
+    return err == DICEY_EAGAIN ? DICEY_OK : err;
+}
+
+static bool make_room(struct dicey_chunk *const cnk, const size_t min) {
+    assert(cnk);
+
+    size_t needed = 0U;
+    if (!dutl_checked_add(&needed, cnk->len, min)) {
+        return false;
+    }
+
+    const size_t cap = cnk->buf ? dicey_rcbuf_cap(cnk->buf) : 0U;
+
+    // if nobody borrowed from the current buffer and it's large enough, just compact it
+    if (cnk->buf && cap >= needed && !dicey_rcbuf_is_shared(cnk->buf)) {
+        char *const bytes = dicey_rcbuf_bytes(cnk->buf);
+
+        memmove(bytes, bytes + cnk->start, cnk->len);
+        cnk->start = 0U;
+
+        return true;
+    }
+
+    // otherwise, move the leftovers (if any) to a new buffer. The old one stays alive as long as some packet uses it
+    const size_t grown = cap / 2U > SIZE_MAX - cap ? SIZE_MAX : cap + cap / 2U;
+    const size_t new_cap = needed > cap ? (grown > needed ? grown : needed) : cap;
+
+    struct dicey_rcbuf *const new_buf = dicey_rcbuf_new(new_cap);
+    if (!new_buf) {
+        return false;
     }
 
-    return uv_buf_init(cnk->bytes + cnk->len, avail > UINT_MAX ? UINT_MAX : (unsigned int) avail);
+    if (cnk->len) {
+        memcpy(dicey_rcbuf_bytes(new_buf), dicey_rcbuf_bytes(cnk->buf) + cnk->start, cnk->len);
+    }
+
+    dicey_rcbuf_unref(cnk->buf);
+
+    cnk->buf = new_buf;
+    cnk->start = 0U;
+
+    return true;
 }
 
-void dicey_chunk_clear(struct dicey_chunk *const buffer) {
-    assert(buffer);
+uv_buf_t dicey_chunk_get_buf(struct dicey_chunk *const cnk, const size_t min) {
+    assert(cnk);
+
+    if (dicey_chunk_avail(cnk) < min && !make_room(cnk, min)) {
+        return uv_buf_init(NULL, 0U);
+    }
+
+    const size_t avail = dicey_chunk_avail(cnk);
 
-    buffer->len = 0;
+    return uv_buf_init(
+        dicey_rcbuf_bytes(cnk->buf) + cnk->start + cnk->len, avail > UINT_MAX ? UINT_MAX : (unsigned int) avail
+    );
 }
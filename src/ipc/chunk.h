@@ -17,25 +17,43 @@
 #if !defined(KIAZVPTVYT_CHUNK_H)
 #define KIAZVPTVYT_CHUNK_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 #include <uv.h>
 
-#include "dicey_config.h"
+#include <dicey/core/errors.h>
+#include <dicey/core/packet.h>
 
-#if defined(DICEY_CC_IS_MSVC)
-#pragma warning(disable : 4200)
-#endif
+#include "sup/rcbuf.h"
 
+// receive buffer for a connection. Data is read into a refcounted buffer, and packets loaded from it borrow slices of
+// it instead of copying them. Bytes in a buffer that is still referenced by some packet are never moved or overwritten:
+// when space runs out, leftover data is moved to a fresh buffer instead
 struct dicey_chunk {
-    size_t len;
-    size_t cap;
-    char bytes[];
+    struct dicey_rcbuf *buf;
+
+    size_t start; // offset of the first unconsumed byte in `buf`
+    size_t len;   // number of bytes read after `start`
 };
 
+// callback invoked by dicey_chunk_drain_packets for each complete packet found in a chunk. The packet is owned by the
+// callee. Returning false stops the draining (i.e. the peer is gone and any further data is meaningless)
+typedef bool dicey_chunk_on_packet_fn(void *ctx, struct dicey_packet packet);
+
 size_t dicey_chunk_avail(const struct dicey_chunk *buf);
-void dicey_chunk_clear(struct dicey_chunk *const buffer);
-struct dicey_chunk *dicey_chunk_grow(struct dicey_chunk *buf);
-uv_buf_t dicey_chunk_get_buf(struct dicey_chunk **buf, size_t min);
+void dicey_chunk_clear(struct dicey_chunk *buffer);
+void dicey_chunk_consume(struct dicey_chunk *buffer, size_t nbytes);
+
+// drops the chunk's reference to its buffer. Packets borrowing from it are still valid until they are deinit'ed
+void dicey_chunk_deinit(struct dicey_chunk *buffer);
+
+// loads all the complete packets currently stored in the chunk, in order, and hands them over to `on_packet`. The
+// packets borrow their payload from the chunk's buffer. Any trailing partial packet is kept, waiting for more data.
+// Returns DICEY_OK if all complete packets have been consumed, or the error returned by dicey_packet_load otherwise
+enum dicey_error dicey_chunk_drain_packets(struct dicey_chunk *buf, dicey_chunk_on_packet_fn *on_packet, void *ctx);
+
+// returns a buffer with at least `min` free bytes, right after the data currently in the chunk
+uv_buf_t dicey_chunk_get_buf(struct dicey_chunk *buf, size_t min);
 
 #endif // KIAZVPTVYT_CHUNK_H
@@ -24,6 +24,7 @@
 #include <dicey/ipc/client.h>
 
 #include "ipc/chunk.h"
+#include "ipc/client/value-cache.h"
 #include "ipc/client/waiting-list.h"
 #include "ipc/tasks/loop.h"
 
@@ -66,10 +67,12 @@ struct dicey_client {
     dicey_client_signal_fn *on_signal;
 
     struct dicey_waiting_list *waiting_tasks;
-    struct dicey_chunk *recv_chunk;
+    struct dicey_chunk recv_chunk;
 
     uint32_t next_seq;
 
+    struct dicey_value_cache cache; // values served by dicey_client_get; disabled unless a TTL was given
+
     void *ctx;
 };
 
@@ -320,7 +320,7 @@ static void client_alloc_buffer(uv_handle_t *const handle, const size_t suggeste
 
     *buf = dicey_chunk_get_buf(&client->recv_chunk, READ_MINBUF);
 
-    assert(buf->base && buf->len && buf->len >= READ_MINBUF && client->recv_chunk);
+    assert(buf->base && buf->len && buf->len >= READ_MINBUF && client->recv_chunk.buf);
 }
 
 static void client_got_packet(struct dicey_client *const client, struct dicey_packet packet) {
@@ -374,6 +374,11 @@ static void client_got_packet(struct dicey_client *const client, struct dicey_pa
     if (is_event) {
         assert(client->on_signal);
 
+        // update the cache before the user sees the signal, so that reading the property from the callback is coherent
+        if (dicey_value_cache_is_enabled(&client->cache)) {
+            dicey_value_cache_on_signal(&client->cache, packet);
+        }
+
         client->on_signal(client, dicey_client_get_context(client), &packet);
     } else {
         // the packet is a response or hello, so it must match with something in our waiting list. If it doesn't, it may
@@ -392,6 +397,16 @@ cleanup:
     dicey_packet_deinit(&packet);
 }
 
+static bool client_got_packet_from_chunk(void *const ctx, const struct dicey_packet packet) {
+    struct dicey_client *const client = ctx;
+    assert(client);
+
+    client_got_packet(client, packet);
+
+    // if the server said bye or violated the protocol, there's no point in parsing anything else
+    return client->state != CLIENT_STATE_DEAD;
+}
+
 static void client_on_read(uv_stream_t *stream, const ssize_t nread, const struct uv_buf_t *const buf) {
     DICEY_UNUSED(buf); // unused
 
@@ -410,7 +425,7 @@ static void client_on_read(uv_stream_t *stream, const ssize_t nread, const struc
         return;
     }
 
-    struct dicey_chunk *const chunk = client->recv_chunk;
+    struct dicey_chunk *const chunk = &client->recv_chunk;
 
     // advance the chunk's length
     if (!dutl_checked_add(&chunk->len, chunk->len, (size_t) nread)) {
@@ -419,27 +434,10 @@ static void client_on_read(uv_stream_t *stream, const ssize_t nread, const struc
         return;
     }
 
-    const void *base = chunk->bytes;
-    size_t remainder = chunk->len;
-
-    // attempt parsing a packet
-    struct dicey_packet packet = { 0 };
-    const enum dicey_error err = dicey_packet_load(&packet, &base, &remainder);
-    switch (err) {
-    case DICEY_OK:
-        client_got_packet(client, packet);
-
-        dicey_chunk_clear(chunk);
-
-        break;
-
-    case DICEY_EAGAIN:
-        break; // not enough data to parse a packet
-
-    default:
+    // parse all the packets received so far. The server may send many responses and signals in one go
+    const enum dicey_error err = dicey_chunk_drain_packets(chunk, &client_got_packet_from_chunk, client);
+    if (err) {
         client_event(client, DICEY_CLIENT_EVENT_ERROR, err, "invalid packet received");
-
-        break;
     }
 }
 
@@ -899,7 +897,7 @@ static bool client_process_event_va(
             assert(client->state >= CLIENT_STATE_CONNECT_START);
 
             const enum dicey_bye_reason bye_reason = va_arg(args, enum dicey_bye_reason);
-            if (bye_reason == DICEY_BYE_REASON_ERROR) {
+            if (bye_reason == DICEY_BYE_REASON_ERROR || bye_reason == DICEY_BYE_REASON_KICKED) {
                 return client_process_event(ev, client, DICEY_CLIENT_EVENT_ERROR, DICEY_ECONNRESET, "kicked by server");
             } else {
                 // raise the event
@@ -1009,15 +1007,10 @@ static enum dicey_error parse_unit_reply(const struct dicey_packet packet) {
     return DICEY_OK;
 }
 
-static enum dicey_error parse_subunsub_reply(struct dicey_packet packet, char **const real_path) {
-    // attempt extracting an error code, or find errors in the reply
-    struct dicey_message msg = { 0 };
-    enum dicey_error err = dicey_packet_as_message(packet, &msg);
-    if (err) {
-        return err; // failed to parse the packet as a message
-    }
+static enum dicey_error parse_subunsub_value(const struct dicey_value *const value, char **const real_path) {
+    assert(value);
 
-    if (dicey_value_is_unit(&msg.value)) {
+    if (dicey_value_is_unit(value)) {
         // unit is a valid response, so we can return OK
         if (real_path) {
             *real_path = NULL; // no path for unit
@@ -1026,8 +1019,13 @@ static enum dicey_error parse_subunsub_reply(struct dicey_packet packet, char **
         return DICEY_OK;
     }
 
+    struct dicey_errmsg errmsg = { 0 };
+    if (!dicey_value_get_error(value, &errmsg)) {
+        return (enum dicey_error) errmsg.code;
+    }
+
     const char *path = NULL;
-    err = dicey_value_get_path(&msg.value, &path);
+    const enum dicey_error err = dicey_value_get_path(value, &path);
     if (err) {
         return err; // if it's not unit, it must return a path
     }
@@ -1045,6 +1043,89 @@ static enum dicey_error parse_subunsub_reply(struct dicey_packet packet, char **
     return DICEY_OK; // successfully parsed the reply
 }
 
+static enum dicey_error parse_subunsub_reply(struct dicey_packet packet, char **const real_path) {
+    // attempt extracting an error code, or find errors in the reply
+    struct dicey_message msg = { 0 };
+    const enum dicey_error err = dicey_packet_as_message(packet, &msg);
+    if (err) {
+        return err; // failed to parse the packet as a message
+    }
+
+    return parse_subunsub_value(&msg.value, real_path);
+}
+
+// parses the reply of SubscribeMany or UnsubscribeMany, which is a tuple with one item per target. Exactly one of
+// `sub_results` and `unsub_results` must be set. On failure, any path allocated so far is freed
+static enum dicey_error parse_subunsub_many_reply(
+    const struct dicey_packet packet,
+    const size_t nresults,
+    struct dicey_client_subscribe_result *const sub_results,
+    enum dicey_error *const unsub_results
+) {
+    assert(nresults && (!sub_results != !unsub_results));
+
+    struct dicey_message msg = { 0 };
+    enum dicey_error err = dicey_packet_as_message(packet, &msg);
+    if (err) {
+        return err;
+    }
+
+    // the request as a whole may have failed (i.e. malformed), in which case the server replies with a single error
+    struct dicey_errmsg errmsg = { 0 };
+    if (!dicey_value_get_error(&msg.value, &errmsg)) {
+        return (enum dicey_error) errmsg.code;
+    }
+
+    struct dicey_list tuple = { 0 };
+    err = dicey_value_get_tuple(&msg.value, &tuple);
+    if (err) {
+        return err;
+    }
+
+    struct dicey_iterator iter = dicey_list_iter(&tuple);
+
+    size_t i = 0U;
+    for (; i < nresults; ++i) {
+        struct dicey_value item = { 0 };
+
+        err = dicey_iterator_next(&iter, &item);
+        if (err) {
+            goto fail;
+        }
+
+        if (sub_results) {
+            char *real_path = NULL;
+            const enum dicey_error item_err = parse_subunsub_value(&item, &real_path);
+            if (item_err == DICEY_ENOMEM) {
+                err = item_err;
+
+                goto fail;
+            }
+
+            sub_results[i] = (struct dicey_client_subscribe_result) { .err = item_err, .real_path = real_path };
+        } else {
+            unsub_results[i] = parse_subunsub_value(&item, NULL);
+        }
+    }
+
+    if (dicey_iterator_has_next(iter)) {
+        err = TRACE(DICEY_EINVAL); // the server replied with more items than we asked for
+
+        goto fail;
+    }
+
+    return DICEY_OK;
+
+fail:
+    if (sub_results) {
+        while (i--) {
+            dicey_client_subscribe_result_deinit(&sub_results[i]);
+        }
+    }
+
+    return err;
+}
+
 struct is_alias_async_ctx {
     dicey_client_on_is_alias_fn *cb; /**< Callback for is_alias */
     void *data;                      /**< Data to pass to the callback */
@@ -1174,6 +1255,7 @@ static enum dicey_error client_subunsub(
         }
 
         *subunsub_ctx = (struct subunsub_async_ctx) {
+            .op = op,
             .cb = *optional_cb,
             .data = data,
         };
@@ -1207,6 +1289,304 @@ static enum dicey_error client_subunsub(
     return err;
 }
 
+// GetMany and SetMany take an array of items, whose contents are laid out in `storage` right after the items
+// themselves. The strings are borrowed from the caller, so `storage` must be freed once the request has been built
+static enum dicey_error get_many_arg(
+    struct dicey_arg **const storage,
+    struct dicey_arg *const dest,
+    const struct dicey_client_target *const items,
+    const size_t nitems
+) {
+    assert(storage && dest && items);
+
+    if (!nitems) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (nitems > UINT16_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    // one pair per item, plus its path and selector
+    struct dicey_arg *const args = calloc(nitems * 3U, sizeof *args);
+    if (!args) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    for (size_t i = 0U; i < nitems; ++i) {
+        struct dicey_arg *const contents = args + nitems + i * 2U;
+
+        contents[0] = (struct dicey_arg) { .type = DICEY_TYPE_PATH, .path = items[i].path };
+        contents[1] = (struct dicey_arg) { .type = DICEY_TYPE_SELECTOR, .selector = items[i].sel };
+
+        args[i] = (struct dicey_arg) {
+            .type = DICEY_TYPE_PAIR,
+            .pair = { .first = &contents[0], .second = &contents[1] },
+        };
+    }
+
+    *storage = args;
+    *dest = (struct dicey_arg) {
+        .type = DICEY_TYPE_ARRAY,
+        .array = { .type = DICEY_TYPE_PAIR, .nitems = (uint16_t) nitems, .elems = args },
+    };
+
+    return DICEY_OK;
+}
+
+static enum dicey_error set_many_arg(
+    struct dicey_arg **const storage,
+    struct dicey_arg *const dest,
+    const struct dicey_client_set_item *const items,
+    const size_t nitems
+) {
+    assert(storage && dest && items);
+
+    if (!nitems) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (nitems > UINT16_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    // one tuple per item, plus its path, selector and value
+    struct dicey_arg *const args = calloc(nitems * 4U, sizeof *args);
+    if (!args) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    for (size_t i = 0U; i < nitems; ++i) {
+        struct dicey_arg *const contents = args + nitems + i * 3U;
+
+        contents[0] = (struct dicey_arg) { .type = DICEY_TYPE_PATH, .path = items[i].path };
+        contents[1] = (struct dicey_arg) { .type = DICEY_TYPE_SELECTOR, .selector = items[i].sel };
+        contents[2] = items[i].value;
+
+        args[i] = (struct dicey_arg) {
+            .type = DICEY_TYPE_TUPLE,
+            .tuple = { .nitems = 3U, .elems = contents },
+        };
+    }
+
+    *storage = args;
+    *dest = (struct dicey_arg) {
+        .type = DICEY_TYPE_ARRAY,
+        .array = { .type = DICEY_TYPE_TUPLE, .nitems = (uint16_t) nitems, .elems = args },
+    };
+
+    return DICEY_OK;
+}
+
+// the properties changed by an asynchronous SET or SetMany, so that they can be dropped from the cache once the server
+// has replied. Their strings are laid out right after the targets
+struct set_async_ctx {
+    dicey_client_on_reply_fn *cb;
+    void *data;
+
+    bool many;
+    size_t ntargets;
+    struct dicey_client_target targets[];
+};
+
+static size_t set_async_target_size(const char *const path, const struct dicey_selector sel) {
+    return sizeof(struct dicey_client_target) + strlen(path) + strlen(sel.trait) + strlen(sel.elem) + 3U;
+}
+
+// copies a target into the context, and returns where the strings of the next one go
+static char *set_async_target_copy(
+    struct dicey_client_target *const dest,
+    char *storage,
+    const char *const path,
+    const struct dicey_selector sel
+) {
+    const char *const strings[] = { path, sel.trait, sel.elem };
+    const char *copies[3] = { 0 };
+
+    for (size_t i = 0U; i < DICEY_LENOF(strings); ++i) {
+        const size_t size = strlen(strings[i]) + 1U;
+
+        memcpy(storage, strings[i], size);
+        copies[i] = storage;
+        storage += size;
+    }
+
+    *dest = (struct dicey_client_target) {
+        .path = copies[0],
+        .sel = { .trait = copies[1], .elem = copies[2] },
+    };
+
+    return storage;
+}
+
+static void set_async_on_reply(
+    struct dicey_client *const client,
+    void *const ctx,
+    const enum dicey_error status,
+    struct dicey_packet *const reply
+) {
+    assert(client && ctx && reply);
+
+    struct set_async_ctx *const set_ctx = ctx;
+
+    // failing to set some of the properties in a SetMany doesn't fail the request: just drop them all
+    if (!status && (set_ctx->many || !parse_unit_reply(*reply))) {
+        for (size_t i = 0U; i < set_ctx->ntargets; ++i) {
+            dicey_value_cache_invalidate(&client->cache, set_ctx->targets[i].path, set_ctx->targets[i].sel);
+        }
+    }
+
+    set_ctx->cb(client, set_ctx->data, status, reply);
+
+    free(set_ctx);
+}
+
+union client_subunsub_many_cb {
+    dicey_client_on_sub_many_done_fn *sub_cb;     /**< Callback for multiple subscriptions */
+    dicey_client_on_unsub_many_done_fn *unsub_cb; /**< Callback for multiple unsubscriptions */
+};
+
+struct subunsub_many_async_ctx {
+    enum client_subunsub op;
+    union client_subunsub_many_cb cb;
+    void *data;
+    size_t ntargets;
+};
+
+static void subunsub_many_on_reply(
+    struct dicey_client *const client,
+    void *const ctx,
+    enum dicey_error status,
+    struct dicey_packet *const reply
+) {
+    assert(client && ctx && reply);
+
+    struct subunsub_many_async_ctx *const many_ctx = ctx;
+    const size_t n = many_ctx->ntargets;
+
+    switch (many_ctx->op) {
+    case CLIENT_SUBSCRIBE:
+        {
+            struct dicey_client_subscribe_result *results = NULL;
+
+            if (status == DICEY_OK) {
+                results = calloc(n, sizeof *results);
+
+                status = results ? parse_subunsub_many_reply(*reply, n, results, NULL) : TRACE(DICEY_ENOMEM);
+            }
+
+            if (status) {
+                free(results);
+                results = NULL;
+            }
+
+            many_ctx->cb.sub_cb(client, many_ctx->data, status, results, results ? n : 0U);
+
+            if (results) {
+                for (size_t i = 0U; i < n; ++i) {
+                    dicey_client_subscribe_result_deinit(&results[i]);
+                }
+
+                free(results);
+            }
+
+            break;
+        }
+    case CLIENT_UNSUBSCRIBE:
+        {
+            enum dicey_error *results = NULL;
+
+            if (status == DICEY_OK) {
+                results = calloc(n, sizeof *results);
+
+                status = results ? parse_subunsub_many_reply(*reply, n, NULL, results) : TRACE(DICEY_ENOMEM);
+            }
+
+            if (status) {
+                free(results);
+                results = NULL;
+            }
+
+            many_ctx->cb.unsub_cb(client, many_ctx->data, status, results, results ? n : 0U);
+
+            free(results);
+
+            break;
+        }
+    }
+
+    free(many_ctx);
+}
+
+static enum dicey_error client_subunsub_many(
+    struct dicey_client *const client,
+    const enum client_subunsub op,
+    const struct dicey_client_target *const targets,
+    const size_t ntargets,
+    union client_subunsub_many_cb *const optional_cb,
+    struct dicey_client_subscribe_result *const sub_results, // only used for synchronous subscribe
+    enum dicey_error *const unsub_results,                   // only used for synchronous unsubscribe
+    void *const data,
+    const uint32_t timeout
+) {
+    assert(client && targets);
+
+    struct dicey_arg *storage = NULL;
+    struct dicey_arg payload = { 0 };
+
+    // the payload has the same shape as GetMany's, a list of (path, selector) pairs
+    enum dicey_error err = get_many_arg(&storage, &payload, targets, ntargets);
+    if (err) {
+        return err;
+    }
+
+    const struct dicey_selector many_sel = {
+        .trait = DICEY_EVENTMANAGER_TRAIT_NAME,
+        .elem = op == CLIENT_SUBSCRIBE ? DICEY_EVENTMANAGER_SUBSCRIBE_MANY_OP_NAME
+                                       : DICEY_EVENTMANAGER_UNSUBSCRIBE_MANY_OP_NAME,
+    };
+
+    // if a callback is provided, we will issue the request asynchronously
+    if (optional_cb) {
+        struct subunsub_many_async_ctx *const many_ctx = malloc(sizeof *many_ctx);
+        if (!many_ctx) {
+            err = TRACE(DICEY_ENOMEM);
+
+            goto quit;
+        }
+
+        *many_ctx = (struct subunsub_many_async_ctx) {
+            .op = op,
+            .cb = *optional_cb,
+            .data = data,
+            .ntargets = ntargets,
+        };
+
+        err = dicey_client_exec_async(
+            client, DICEY_SERVER_PATH, many_sel, payload, &subunsub_many_on_reply, many_ctx, timeout
+        );
+        if (err) {
+            free(many_ctx);
+        }
+    } else {
+        struct dicey_packet response = { 0 };
+
+        err = dicey_client_exec(client, DICEY_SERVER_PATH, many_sel, payload, &response, timeout);
+        if (err) {
+            goto quit;
+        }
+
+        err = parse_subunsub_many_reply(response, ntargets, sub_results, unsub_results);
+
+        dicey_packet_deinit(&response);
+    }
+
+quit:
+    free(storage);
+
+    return err;
+}
+
 static void unlock_when_done(
     struct dicey_client *const client,
     void *const data,
@@ -1280,11 +1660,15 @@ static void reset_state(void *const ctx) {
     client->next_seq = 0U;
     client->pipe = (uv_pipe_t) { 0 };
 
-    free(client->waiting_tasks);
+    dicey_waiting_list_delete(client->waiting_tasks);
     client->waiting_tasks = NULL;
 
-    free(client->recv_chunk);
-    client->recv_chunk = NULL;
+    dicey_chunk_deinit(&client->recv_chunk);
+
+    // without a connection we won't get any more signals, so nothing in the cache can be trusted anymore
+    if (dicey_value_cache_is_enabled(&client->cache)) {
+        dicey_value_cache_flush(&client->cache);
+    }
 
     // note: we don't reset the loop because it would cause horrible race conditions. The loop will reset itself when
     // the client is reused
@@ -1355,6 +1739,41 @@ static enum dicey_error client_open_async(
     );
 }
 
+enum dicey_error dicey_client_cache_bind(
+    struct dicey_client *const client,
+    const char *const path,
+    const struct dicey_selector sel,
+    const char *const signal
+) {
+    assert(client && path && dicey_selector_is_valid(sel) && signal);
+
+    if (!dicey_value_cache_is_enabled(&client->cache)) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    return dicey_value_cache_bind(&client->cache, path, sel, signal);
+}
+
+void dicey_client_cache_flush(struct dicey_client *const client) {
+    assert(client);
+
+    if (dicey_value_cache_is_enabled(&client->cache)) {
+        dicey_value_cache_flush(&client->cache);
+    }
+}
+
+void dicey_client_cache_invalidate(
+    struct dicey_client *const client,
+    const char *const path,
+    const struct dicey_selector sel
+) {
+    assert(client && path && dicey_selector_is_valid(sel));
+
+    if (dicey_value_cache_is_enabled(&client->cache)) {
+        dicey_value_cache_invalidate(&client->cache, path, sel);
+    }
+}
+
 enum dicey_error dicey_client_connect(struct dicey_client *const client, const struct dicey_addr addr) {
     assert(client && addr.addr);
 
@@ -1396,6 +1815,7 @@ enum dicey_error dicey_client_connect_async(
 void dicey_client_deinit(struct dicey_client *const client) {
     if (client) {
         dicey_task_loop_delete(client->tloop);
+        dicey_value_cache_deinit(&client->cache);
     }
 }
 
@@ -1486,6 +1906,25 @@ enum dicey_error dicey_client_exec_async(
     return err;
 }
 
+// asks the server which object `path` points to and tells the cache, so that values read from `path` can be cached.
+// Failing to do so is not an error: the values just won't be cached
+static void client_cache_resolve(struct dicey_client *const client, const char *const path, const uint32_t timeout) {
+    struct dicey_packet response = { 0 };
+
+    if (dicey_client_get_real_path(client, path, &response, timeout)) {
+        return;
+    }
+
+    struct dicey_message msg = { 0 };
+    const char *main_path = NULL;
+
+    if (!dicey_packet_as_message(response, &msg) && !dicey_value_get_path(&msg.value, &main_path)) {
+        dicey_value_cache_add_path(&client->cache, path, main_path);
+    }
+
+    dicey_packet_deinit(&response);
+}
+
 enum dicey_error dicey_client_get(
     struct dicey_client *const client,
     const char *const path,
@@ -1495,14 +1934,43 @@ enum dicey_error dicey_client_get(
 ) {
     assert(client && path && dicey_selector_is_valid(sel) && response);
 
+    const bool use_cache = dicey_value_cache_is_enabled(&client->cache);
+    uint64_t ticket = 0U;
+
+    enum dicey_error err = DICEY_OK;
+
+    if (use_cache) {
+        if (client->state != CLIENT_STATE_RUNNING) {
+            return TRACE(DICEY_EINVAL); // never serve anything from the cache when disconnected
+        }
+
+        err = dicey_value_cache_lookup(&client->cache, path, sel, response, &ticket);
+
+        // signals are only raised from the main path of an object, so `path` must be resolved before caching anything
+        if (err == DICEY_ENOENT && !dicey_value_cache_knows_path(&client->cache, path)) {
+            client_cache_resolve(client, path, timeout);
+
+            err = dicey_value_cache_lookup(&client->cache, path, sel, response, &ticket);
+        }
+
+        if (err != DICEY_ENOENT) {
+            return err; // either a hit or a real error
+        }
+    }
+
     struct dicey_packet packet = { 0 };
 
-    enum dicey_error err = dicey_packet_message(&packet, 0U, DICEY_OP_GET, path, sel, (struct dicey_arg) { 0 });
+    err = dicey_packet_message(&packet, 0U, DICEY_OP_GET, path, sel, (struct dicey_arg) { 0 });
     if (err) {
         return err;
     }
 
-    return dicey_client_request(client, packet, response, timeout);
+    err = dicey_client_request(client, packet, response, timeout);
+    if (!err && use_cache) {
+        dicey_value_cache_store(&client->cache, path, sel, *response, ticket);
+    }
+
+    return err;
 }
 
 enum dicey_error dicey_client_get_async(
@@ -1536,6 +2004,76 @@ void *dicey_client_get_context(const struct dicey_client *client) {
     return client->ctx;
 }
 
+enum dicey_error dicey_client_get_many(
+    struct dicey_client *const client,
+    const struct dicey_client_target *const items,
+    const size_t nitems,
+    struct dicey_packet *const response,
+    const uint32_t timeout
+) {
+    assert(client && items && response);
+
+    struct dicey_arg *storage = NULL;
+    struct dicey_arg arg = { 0 };
+
+    const enum dicey_error err = get_many_arg(&storage, &arg, items, nitems);
+    if (err) {
+        return err;
+    }
+
+    const enum dicey_error exec_err = dicey_client_exec(
+        client,
+        DICEY_SERVER_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_BATCH_TRAIT_NAME,
+            .elem = DICEY_BATCH_GET_MANY_OP_NAME,
+        },
+        arg,
+        response,
+        timeout
+    );
+
+    free(storage);
+
+    return exec_err;
+}
+
+enum dicey_error dicey_client_get_many_async(
+    struct dicey_client *const client,
+    const struct dicey_client_target *const items,
+    const size_t nitems,
+    dicey_client_on_reply_fn *const cb,
+    void *const data,
+    const uint32_t timeout
+) {
+    assert(client && items && cb);
+
+    struct dicey_arg *storage = NULL;
+    struct dicey_arg arg = { 0 };
+
+    const enum dicey_error err = get_many_arg(&storage, &arg, items, nitems);
+    if (err) {
+        return err;
+    }
+
+    const enum dicey_error exec_err = dicey_client_exec_async(
+        client,
+        DICEY_SERVER_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_BATCH_TRAIT_NAME,
+            .elem = DICEY_BATCH_GET_MANY_OP_NAME,
+        },
+        arg,
+        cb,
+        data,
+        timeout
+    );
+
+    free(storage);
+
+    return exec_err;
+}
+
 enum dicey_error dicey_client_get_real_path(
     struct dicey_client *const client,
     const char *const path,
@@ -1594,6 +2132,11 @@ enum dicey_error dicey_client_init(struct dicey_client *const client, const stru
         client->on_signal = args->on_signal;
     }
 
+    const enum dicey_error err = dicey_value_cache_init(&client->cache, args ? args->cache_ttl : 0U);
+    if (err) {
+        return err;
+    }
+
     client_event(client, DICEY_CLIENT_EVENT_INIT);
 
     return DICEY_OK;
@@ -1748,6 +2291,56 @@ bool dicey_client_is_running(const struct dicey_client *const client) {
     return client->state == CLIENT_STATE_RUNNING;
 }
 
+enum dicey_error dicey_client_list_changes(
+    struct dicey_client *const client,
+    const uint64_t since,
+    struct dicey_packet *const response,
+    const uint32_t timeout
+) {
+    assert(client && response);
+
+    return dicey_client_exec(
+        client,
+        DICEY_REGISTRY_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_REGISTRY_TRAIT_NAME,
+            .elem = DICEY_REGISTRY_CHANGES_SINCE_OP_NAME,
+        },
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_UINT64,
+            .u64 = since,
+        },
+        response,
+        timeout
+    );
+}
+
+enum dicey_error dicey_client_list_changes_async(
+    struct dicey_client *const client,
+    const uint64_t since,
+    dicey_client_on_reply_fn *const cb,
+    void *const data,
+    const uint32_t timeout
+) {
+    assert(client && cb);
+
+    return dicey_client_exec_async(
+        client,
+        DICEY_REGISTRY_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_REGISTRY_TRAIT_NAME,
+            .elem = DICEY_REGISTRY_CHANGES_SINCE_OP_NAME,
+        },
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_UINT64,
+            .u64 = since,
+        },
+        cb,
+        data,
+        timeout
+    );
+}
+
 enum dicey_error dicey_client_list_objects(
     struct dicey_client *const client,
     struct dicey_packet *const response,
@@ -1974,6 +2567,10 @@ enum dicey_error dicey_client_set(
     err = parse_unit_reply(response);
     dicey_packet_deinit(&response);
 
+    if (!err) {
+        dicey_client_cache_invalidate(client, path, sel);
+    }
+
     return err;
 }
 
@@ -1995,9 +2592,29 @@ enum dicey_error dicey_client_set_async(
         return err;
     }
 
-    err = dicey_client_request_async(client, packet, cb, data, timeout);
+    if (!dicey_value_cache_is_enabled(&client->cache)) {
+        err = dicey_client_request_async(client, packet, cb, data, timeout);
+        if (err) {
+            dicey_packet_deinit(&packet);
+        }
+
+        return err;
+    }
+
+    struct set_async_ctx *const ctx = malloc(sizeof *ctx + set_async_target_size(path, sel));
+    if (!ctx) {
+        dicey_packet_deinit(&packet);
+
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    *ctx = (struct set_async_ctx) { .cb = cb, .data = data, .ntargets = 1U };
+    set_async_target_copy(ctx->targets, (char *) (ctx->targets + 1), path, sel);
+
+    err = dicey_client_request_async(client, packet, &set_async_on_reply, ctx, timeout);
     if (err) {
         dicey_packet_deinit(&packet);
+        free(ctx);
     }
 
     return err;
@@ -2013,6 +2630,111 @@ void *dicey_client_set_context(struct dicey_client *const client, void *const da
     return old;
 }
 
+enum dicey_error dicey_client_set_many(
+    struct dicey_client *const client,
+    const struct dicey_client_set_item *const items,
+    const size_t nitems,
+    struct dicey_packet *const response,
+    const uint32_t timeout
+) {
+    assert(client && items && response);
+
+    struct dicey_arg *storage = NULL;
+    struct dicey_arg arg = { 0 };
+
+    const enum dicey_error err = set_many_arg(&storage, &arg, items, nitems);
+    if (err) {
+        return err;
+    }
+
+    const enum dicey_error exec_err = dicey_client_exec(
+        client,
+        DICEY_SERVER_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_BATCH_TRAIT_NAME,
+            .elem = DICEY_BATCH_SET_MANY_OP_NAME,
+        },
+        arg,
+        response,
+        timeout
+    );
+
+    free(storage);
+
+    // failing to set some of the properties doesn't fail the request: just drop them all
+    if (!exec_err) {
+        for (size_t i = 0U; i < nitems; ++i) {
+            dicey_client_cache_invalidate(client, items[i].path, items[i].sel);
+        }
+    }
+
+    return exec_err;
+}
+
+enum dicey_error dicey_client_set_many_async(
+    struct dicey_client *const client,
+    const struct dicey_client_set_item *const items,
+    const size_t nitems,
+    dicey_client_on_reply_fn *const cb,
+    void *const data,
+    const uint32_t timeout
+) {
+    assert(client && items && cb);
+
+    struct dicey_arg *storage = NULL;
+    struct dicey_arg arg = { 0 };
+
+    const enum dicey_error err = set_many_arg(&storage, &arg, items, nitems);
+    if (err) {
+        return err;
+    }
+
+    struct set_async_ctx *ctx = NULL;
+
+    if (dicey_value_cache_is_enabled(&client->cache)) {
+        size_t ctx_size = sizeof *ctx;
+
+        for (size_t i = 0U; i < nitems; ++i) {
+            ctx_size += set_async_target_size(items[i].path, items[i].sel);
+        }
+
+        ctx = malloc(ctx_size);
+        if (!ctx) {
+            free(storage);
+
+            return TRACE(DICEY_ENOMEM);
+        }
+
+        *ctx = (struct set_async_ctx) { .cb = cb, .data = data, .many = true, .ntargets = nitems };
+
+        char *strings = (char *) (ctx->targets + nitems);
+        for (size_t i = 0U; i < nitems; ++i) {
+            strings = set_async_target_copy(&ctx->targets[i], strings, items[i].path, items[i].sel);
+        }
+    }
+
+    const enum dicey_error exec_err = dicey_client_exec_async(
+        client,
+        DICEY_SERVER_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_BATCH_TRAIT_NAME,
+            .elem = DICEY_BATCH_SET_MANY_OP_NAME,
+        },
+        arg,
+        ctx ? &set_async_on_reply : cb,
+        ctx ? ctx : data,
+        timeout
+    );
+
+    free(storage);
+
+    if (exec_err) {
+        free(ctx);
+    }
+
+    return exec_err;
+}
+
 void dicey_client_subscribe_result_deinit(struct dicey_client_subscribe_result *const result) {
     if (result) {
         free((char *) result->real_path); // free the path if it was allocated, cast is safe because it was strdup'd
@@ -2020,6 +2742,42 @@ void dicey_client_subscribe_result_deinit(struct dicey_client_subscribe_result *
     }
 }
 
+enum dicey_error dicey_client_subscribe_many(
+    struct dicey_client *const client,
+    const struct dicey_client_target *const targets,
+    const size_t ntargets,
+    struct dicey_client_subscribe_result *const results,
+    const uint32_t timeout
+) {
+    assert(client && targets && results);
+
+    // null cb means we're blocking
+    return client_subunsub_many(client, CLIENT_SUBSCRIBE, targets, ntargets, NULL, results, NULL, NULL, timeout);
+}
+
+enum dicey_error dicey_client_subscribe_many_async(
+    struct dicey_client *const client,
+    const struct dicey_client_target *const targets,
+    const size_t ntargets,
+    dicey_client_on_sub_many_done_fn *const cb,
+    void *const data,
+    const uint32_t timeout
+) {
+    assert(client && targets && cb);
+
+    return client_subunsub_many(
+        client,
+        CLIENT_SUBSCRIBE,
+        targets,
+        ntargets,
+        &(union client_subunsub_many_cb) { .sub_cb = cb },
+        NULL,
+        NULL,
+        data,
+        timeout
+    );
+}
+
 struct dicey_client_subscribe_result dicey_client_subscribe_to(
     struct dicey_client *const client,
     const char *const path,
@@ -2080,3 +2838,39 @@ enum dicey_error dicey_client_unsubscribe_from_async(
         client, CLIENT_UNSUBSCRIBE, path, sel, &(union client_subunsub_cb) { .unsub_cb = cb }, NULL, data, timeout
     );
 }
+
+enum dicey_error dicey_client_unsubscribe_many(
+    struct dicey_client *const client,
+    const struct dicey_client_target *const targets,
+    const size_t ntargets,
+    enum dicey_error *const results,
+    const uint32_t timeout
+) {
+    assert(client && targets && results);
+
+    // null cb means we're blocking
+    return client_subunsub_many(client, CLIENT_UNSUBSCRIBE, targets, ntargets, NULL, NULL, results, NULL, timeout);
+}
+
+enum dicey_error dicey_client_unsubscribe_many_async(
+    struct dicey_client *const client,
+    const struct dicey_client_target *const targets,
+    const size_t ntargets,
+    dicey_client_on_unsub_many_done_fn *const cb,
+    void *const data,
+    const uint32_t timeout
+) {
+    assert(client && targets && cb);
+
+    return client_subunsub_many(
+        client,
+        CLIENT_UNSUBSCRIBE,
+        targets,
+        ntargets,
+        &(union client_subunsub_many_cb) { .unsub_cb = cb },
+        NULL,
+        NULL,
+        data,
+        timeout
+    );
+}
@@ -0,0 +1,622 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <uv.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/hashtable.h>
+#include <dicey/core/message.h>
+#include <dicey/core/packet.h>
+#include <dicey/core/type.h>
+#include <dicey/core/value.h>
+#include <dicey/core/views.h>
+
+#include "sup/trace.h"
+#include "sup/uvtools.h"
+#include "sup/view-ops.h"
+
+#include "value-cache.h"
+
+#define BINDING_KEY_FMT "%s:%s"
+
+struct cached_value {
+    struct dicey_packet response;
+    uint64_t expires_at; // uv_hrtime() timestamp
+};
+
+struct cached_object {
+    uint64_t invalidated_at; // the clock of the last invalidation. GETs issued before that are not stored
+
+    struct dicey_hashtable *traits;   // trait -> struct dicey_hashtable * (elem -> struct cached_value *)
+    struct dicey_hashtable *bindings; // trait:signal -> char * (the property updated by the signal)
+};
+
+struct resolved_path {
+    uint64_t expires_at; // uv_hrtime() timestamp
+    char main_path[];
+};
+
+static void free_value(void *const ptr) {
+    struct cached_value *const value = ptr;
+
+    if (value) {
+        dicey_packet_deinit(&value->response);
+        free(value);
+    }
+}
+
+static void free_trait(void *const ptr) {
+    dicey_hashtable_delete(ptr, &free_value);
+}
+
+static void free_object(void *const ptr) {
+    struct cached_object *const object = ptr;
+
+    if (object) {
+        dicey_hashtable_delete(object->traits, &free_trait);
+        dicey_hashtable_delete(object->bindings, &free);
+        free(object);
+    }
+}
+
+static const char *format_binding_key(
+    struct dicey_value_cache *const cache,
+    const char *const trait,
+    const char *const signal
+) {
+    assert(cache && trait && signal);
+
+    const int required = snprintf(NULL, 0U, BINDING_KEY_FMT, trait, signal) + 1;
+    assert(required > 3);
+
+    if ((size_t) required > cache->scratch.len) {
+        char *const new_data = realloc(cache->scratch.data, (size_t) required);
+        if (!new_data) {
+            return NULL;
+        }
+
+        cache->scratch = dicey_view_mut_from(new_data, (size_t) required);
+    }
+
+    snprintf(cache->scratch.data, cache->scratch.len, BINDING_KEY_FMT, trait, signal);
+
+    return cache->scratch.data;
+}
+
+// drops the objects with nothing left in them. Any GET still in flight for one of them just won't be stored
+static void evict_empty_objects(struct dicey_value_cache *const cache) {
+    struct dicey_hashtable_iter iter = dicey_hashtable_iter_start(cache->objects);
+    const char *path = NULL;
+    void *value = NULL;
+
+    while (dicey_hashtable_iter_next(&iter, &path, &value)) {
+        struct cached_object *const object = value;
+        assert(object);
+
+        if (!dicey_hashtable_size(object->traits) && !dicey_hashtable_size(object->bindings)) {
+            free_object(dicey_hashtable_remove(cache->objects, path));
+        }
+    }
+}
+
+static bool is_error_response(const struct dicey_packet packet) {
+    struct dicey_message msg = { 0 };
+
+    return dicey_packet_as_message(packet, &msg) || dicey_value_get_type(&msg.value) == DICEY_TYPE_ERROR;
+}
+
+static struct cached_object *object_get_or_create(struct dicey_value_cache *const cache, const char *const path) {
+    assert(cache && path);
+
+    struct cached_object *object = dicey_hashtable_get(cache->objects, path);
+    if (object) {
+        return object;
+    }
+
+    object = calloc(1U, sizeof *object);
+    if (!object) {
+        return NULL;
+    }
+
+    // nothing was ever cached for this object, so there's nothing older than now to reject
+    object->invalidated_at = cache->clock;
+
+    if (dicey_hashtable_set(&cache->objects, path, object, NULL) == DICEY_HASH_SET_FAILED) {
+        free(object);
+
+        return NULL;
+    }
+
+    return object;
+}
+
+// must always tick the clock, even if there's no object to invalidate: it may have been evicted while a GET for it was
+// in flight, and be created again by another lookup before that GET is stored
+static void object_invalidate(struct dicey_value_cache *const cache, struct cached_object *const object) {
+    assert(cache);
+
+    ++cache->clock;
+
+    if (object) {
+        object->invalidated_at = cache->clock;
+    }
+}
+
+// stores `response` as the value of a property. On success the object takes ownership of the packet; on failure, the
+// packet is left untouched
+static enum dicey_error object_set_value(
+    struct cached_object *const object,
+    const struct dicey_selector sel,
+    const struct dicey_packet response,
+    const uint64_t expires_at
+) {
+    assert(object && dicey_selector_is_valid(sel) && dicey_packet_is_valid(response));
+
+    struct cached_value *const value = malloc(sizeof *value);
+    if (!value) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    *value = (struct cached_value) {
+        .response = response,
+        .expires_at = expires_at,
+    };
+
+    struct dicey_hashtable *elems = dicey_hashtable_get(object->traits, sel.trait);
+    const bool new_trait = !elems;
+
+    void *old_value = NULL;
+
+    switch (dicey_hashtable_set(&elems, sel.elem, value, &old_value)) {
+    case DICEY_HASH_SET_FAILED:
+        free(value);
+
+        return TRACE(DICEY_ENOMEM);
+
+    case DICEY_HASH_SET_UPDATED:
+        free_value(old_value);
+
+        break;
+
+    case DICEY_HASH_SET_ADDED:
+        break;
+    }
+
+    // the inner table may have been created or reallocated, so always store it back
+    if (dicey_hashtable_set(&object->traits, sel.trait, elems, NULL) == DICEY_HASH_SET_FAILED) {
+        assert(new_trait); // updating an existing key never allocates
+
+        // give the packet back to the caller before getting rid of the table
+        dicey_hashtable_remove(elems, sel.elem);
+        free(value);
+        dicey_hashtable_delete(elems, NULL);
+
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    return DICEY_OK;
+}
+
+static void object_drop_value(struct cached_object *const object, const struct dicey_selector sel) {
+    assert(object && dicey_selector_is_valid(sel));
+
+    struct dicey_hashtable *const elems = dicey_hashtable_get(object->traits, sel.trait);
+    if (elems) {
+        free_value(dicey_hashtable_remove(elems, sel.elem));
+
+        if (!dicey_hashtable_size(elems)) {
+            free_trait(dicey_hashtable_remove(object->traits, sel.trait));
+        }
+    }
+}
+
+// returns the main path of the object `path` points to, or NULL if it isn't known (anymore)
+static const char *resolve_path(struct dicey_value_cache *const cache, const char *const path, const uint64_t now) {
+    assert(cache && path);
+
+    const struct resolved_path *const resolved = dicey_hashtable_get(cache->paths, path);
+    if (!resolved) {
+        return NULL;
+    }
+
+    if (resolved->expires_at <= now) {
+        free(dicey_hashtable_remove(cache->paths, path));
+
+        return NULL;
+    }
+
+    return resolved->main_path;
+}
+
+// drops everything that has expired. Lookups only ever drop the values they come across, so without this the values
+// (and paths) read once and never again would pile up
+static void sweep(struct dicey_value_cache *const cache, const uint64_t now) {
+    assert(cache);
+
+    struct dicey_hashtable_iter objects = dicey_hashtable_iter_start(cache->objects);
+    void *object = NULL;
+
+    while (dicey_hashtable_iter_next(&objects, NULL, &object)) {
+        struct dicey_hashtable *const traits = ((struct cached_object *) object)->traits;
+
+        struct dicey_hashtable_iter trait_iter = dicey_hashtable_iter_start(traits);
+        const char *trait = NULL;
+        void *elems = NULL;
+
+        while (dicey_hashtable_iter_next(&trait_iter, &trait, &elems)) {
+            struct dicey_hashtable_iter elem_iter = dicey_hashtable_iter_start(elems);
+            const char *elem = NULL;
+            void *value = NULL;
+
+            while (dicey_hashtable_iter_next(&elem_iter, &elem, &value)) {
+                if (((const struct cached_value *) value)->expires_at <= now) {
+                    free_value(dicey_hashtable_remove(elems, elem));
+                }
+            }
+
+            if (!dicey_hashtable_size(elems)) {
+                free_trait(dicey_hashtable_remove(traits, trait));
+            }
+        }
+    }
+
+    evict_empty_objects(cache);
+
+    struct dicey_hashtable_iter paths = dicey_hashtable_iter_start(cache->paths);
+    const char *path = NULL;
+    void *resolved = NULL;
+
+    while (dicey_hashtable_iter_next(&paths, &path, &resolved)) {
+        if (((const struct resolved_path *) resolved)->expires_at <= now) {
+            free(dicey_hashtable_remove(cache->paths, path));
+        }
+    }
+
+    cache->next_sweep = now + cache->ttl_ns;
+}
+
+void dicey_value_cache_deinit(struct dicey_value_cache *const cache) {
+    if (cache && dicey_value_cache_is_enabled(cache)) {
+        dicey_hashtable_delete(cache->objects, &free_object);
+        dicey_hashtable_delete(cache->paths, &free);
+        free(cache->scratch.data);
+
+        uv_mutex_destroy(&cache->lock);
+
+        *cache = (struct dicey_value_cache) { 0 };
+    }
+}
+
+enum dicey_error dicey_value_cache_init(struct dicey_value_cache *const cache, const uint32_t ttl_ms) {
+    assert(cache);
+
+    *cache = (struct dicey_value_cache) { 0 };
+
+    if (!ttl_ms) {
+        return DICEY_OK; // the cache is disabled
+    }
+
+    const int uverr = uv_mutex_init(&cache->lock);
+    if (uverr) {
+        return dicey_error_from_uv(uverr);
+    }
+
+    cache->ttl_ns = (uint64_t) ttl_ms * UINT64_C(1000000);
+
+    return DICEY_OK;
+}
+
+void dicey_value_cache_add_path(
+    struct dicey_value_cache *const cache,
+    const char *const path,
+    const char *const main_path
+) {
+    assert(cache && dicey_value_cache_is_enabled(cache) && path && main_path);
+
+    const size_t main_path_size = strlen(main_path) + 1U;
+
+    struct resolved_path *const resolved = malloc(sizeof *resolved + main_path_size);
+    if (!resolved) {
+        return;
+    }
+
+    memcpy(resolved->main_path, main_path, main_path_size);
+
+    uv_mutex_lock(&cache->lock);
+
+    resolved->expires_at = uv_hrtime() + cache->ttl_ns;
+
+    void *old_resolved = NULL;
+
+    switch (dicey_hashtable_set(&cache->paths, path, resolved, &old_resolved)) {
+    case DICEY_HASH_SET_FAILED:
+        free(resolved);
+
+        break;
+
+    case DICEY_HASH_SET_UPDATED:
+        free(old_resolved);
+
+        break;
+
+    case DICEY_HASH_SET_ADDED:
+        break;
+    }
+
+    uv_mutex_unlock(&cache->lock);
+}
+
+enum dicey_error dicey_value_cache_bind(
+    struct dicey_value_cache *const cache,
+    const char *const path,
+    const struct dicey_selector sel,
+    const char *const signal
+) {
+    assert(cache && dicey_value_cache_is_enabled(cache) && path && dicey_selector_is_valid(sel) && signal);
+
+    enum dicey_error err = DICEY_OK;
+
+    uv_mutex_lock(&cache->lock);
+
+    struct cached_object *const object = object_get_or_create(cache, path);
+    const char *const key = object ? format_binding_key(cache, sel.trait, signal) : NULL;
+    char *const property = key ? strdup(sel.elem) : NULL;
+
+    if (!property) {
+        err = TRACE(DICEY_ENOMEM);
+
+        goto unlock;
+    }
+
+    void *old_property = NULL;
+
+    switch (dicey_hashtable_set(&object->bindings, key, property, &old_property)) {
+    case DICEY_HASH_SET_FAILED:
+        free(property);
+
+        err = TRACE(DICEY_ENOMEM);
+
+        break;
+
+    case DICEY_HASH_SET_UPDATED:
+        free(old_property);
+
+        break;
+
+    case DICEY_HASH_SET_ADDED:
+        break;
+    }
+
+unlock:
+    uv_mutex_unlock(&cache->lock);
+
+    return err;
+}
+
+void dicey_value_cache_flush(struct dicey_value_cache *const cache) {
+    assert(cache && dicey_value_cache_is_enabled(cache));
+
+    uv_mutex_lock(&cache->lock);
+
+    const uint64_t now = ++cache->clock;
+
+    struct dicey_hashtable_iter iter = dicey_hashtable_iter_start(cache->objects);
+    const char *path = NULL;
+    void *value = NULL;
+
+    while (dicey_hashtable_iter_next(&iter, &path, &value)) {
+        struct cached_object *const object = value;
+        assert(object);
+
+        dicey_hashtable_delete(object->traits, &free_trait);
+
+        object->traits = NULL;
+        object->invalidated_at = now;
+    }
+
+    evict_empty_objects(cache);
+
+    // the paths may point somewhere else by the time they are read again
+    dicey_hashtable_delete(cache->paths, &free);
+    cache->paths = NULL;
+
+    uv_mutex_unlock(&cache->lock);
+}
+
+void dicey_value_cache_invalidate(
+    struct dicey_value_cache *const cache,
+    const char *const path,
+    const struct dicey_selector sel
+) {
+    assert(cache && dicey_value_cache_is_enabled(cache) && path && dicey_selector_is_valid(sel));
+
+    uv_mutex_lock(&cache->lock);
+
+    const char *const main_path = resolve_path(cache, path, uv_hrtime());
+
+    if (main_path) {
+        struct cached_object *const object = dicey_hashtable_get(cache->objects, main_path);
+
+        object_invalidate(cache, object);
+
+        if (object) {
+            object_drop_value(object, sel);
+        }
+    } else {
+        object_invalidate(cache, NULL);
+
+        struct dicey_hashtable_iter iter = dicey_hashtable_iter_start(cache->objects);
+        void *value = NULL;
+
+        while (dicey_hashtable_iter_next(&iter, NULL, &value)) {
+            struct cached_object *const object = value;
+            assert(object);
+
+            object->invalidated_at = cache->clock;
+            object_drop_value(object, sel);
+        }
+    }
+
+    uv_mutex_unlock(&cache->lock);
+}
+
+bool dicey_value_cache_knows_path(struct dicey_value_cache *const cache, const char *const path) {
+    assert(cache && dicey_value_cache_is_enabled(cache) && path);
+
+    uv_mutex_lock(&cache->lock);
+
+    const bool known = resolve_path(cache, path, uv_hrtime());
+
+    uv_mutex_unlock(&cache->lock);
+
+    return known;
+}
+
+enum dicey_error dicey_value_cache_lookup(
+    struct dicey_value_cache *const cache,
+    const char *const path,
+    const struct dicey_selector sel,
+    struct dicey_packet *const dest,
+    uint64_t *const ticket
+) {
+    assert(cache && dicey_value_cache_is_enabled(cache) && path && dicey_selector_is_valid(sel) && dest && ticket);
+
+    enum dicey_error err = DICEY_ENOENT;
+
+    uv_mutex_lock(&cache->lock);
+
+    *ticket = cache->clock;
+
+    const uint64_t now = uv_hrtime();
+
+    // without knowing the object `path` points to, the value can't be looked up nor stored
+    const char *const main_path = resolve_path(cache, path, now);
+    if (!main_path) {
+        goto unlock;
+    }
+
+    // create the object on a miss, so that signals received while the GET is in flight can invalidate it. If this
+    // fails, the response just won't be stored
+    struct cached_object *const object = object_get_or_create(cache, main_path);
+    struct dicey_hashtable *const elems = object ? dicey_hashtable_get(object->traits, sel.trait) : NULL;
+    const struct cached_value *const value = elems ? dicey_hashtable_get(elems, sel.elem) : NULL;
+
+    if (value) {
+        if (value->expires_at > now) {
+            err = dicey_packet_forward_message(dest, value->response, 0U, DICEY_OP_RESPONSE, path, sel);
+        } else {
+            object_drop_value(object, sel);
+        }
+    }
+
+unlock:
+    uv_mutex_unlock(&cache->lock);
+
+    return err;
+}
+
+void dicey_value_cache_on_signal(struct dicey_value_cache *const cache, const struct dicey_packet packet) {
+    assert(cache && dicey_value_cache_is_enabled(cache));
+
+    struct dicey_message msg = { 0 };
+    if (dicey_packet_as_message(packet, &msg) || msg.type != DICEY_OP_SIGNAL) {
+        return;
+    }
+
+    uv_mutex_lock(&cache->lock);
+
+    struct cached_object *const object = dicey_hashtable_get(cache->objects, msg.path);
+
+    object_invalidate(cache, object);
+
+    if (!object) {
+        goto unlock; // nothing is cached for this object
+    }
+
+    const char *const key = format_binding_key(cache, msg.selector.trait, msg.selector.elem);
+    const char *const property = key ? dicey_hashtable_get(object->bindings, key) : NULL;
+
+    if (property) {
+        const struct dicey_selector sel = { .trait = msg.selector.trait, .elem = property };
+        struct dicey_packet response = { 0 };
+
+        if (dicey_packet_forward_message(&response, packet, 0U, DICEY_OP_RESPONSE, msg.path, sel) ||
+            object_set_value(object, sel, response, uv_hrtime() + cache->ttl_ns)) {
+            // the new value can't be stored, but the old one must go anyway
+            dicey_packet_deinit(&response);
+            object_drop_value(object, sel);
+        }
+    } else {
+        // we don't know which properties the signal is about, so drop the whole trait
+        free_trait(dicey_hashtable_remove(object->traits, msg.selector.trait));
+    }
+
+unlock:
+    uv_mutex_unlock(&cache->lock);
+}
+
+void dicey_value_cache_store(
+    struct dicey_value_cache *const cache,
+    const char *const path,
+    const struct dicey_selector sel,
+    const struct dicey_packet response,
+    const uint64_t ticket
+) {
+    assert(cache && dicey_value_cache_is_enabled(cache) && path && dicey_selector_is_valid(sel));
+
+    if (!dicey_packet_is_valid(response) || is_error_response(response)) {
+        return;
+    }
+
+    // copy the response before taking the lock; the caller keeps the original
+    struct dicey_packet copy = { 0 };
+    if (dicey_packet_forward_message(&copy, response, 0U, DICEY_OP_RESPONSE, path, sel)) {
+        return;
+    }
+
+    bool stored = false;
+
+    uv_mutex_lock(&cache->lock);
+
+    const uint64_t now = uv_hrtime();
+
+    const char *const main_path = resolve_path(cache, path, now);
+    struct cached_object *const object = main_path ? dicey_hashtable_get(cache->objects, main_path) : NULL;
+
+    if (object && object->invalidated_at <= ticket) {
+        stored = !object_set_value(object, sel, copy, now + cache->ttl_ns);
+    }
+
+    if (now >= cache->next_sweep) {
+        sweep(cache, now);
+    }
+
+    uv_mutex_unlock(&cache->lock);
+
+    if (!stored) {
+        dicey_packet_deinit(&copy);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(QZRFKWMDUA_VALUE_CACHE_H)
+#define QZRFKWMDUA_VALUE_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <uv.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/hashtable.h>
+#include <dicey/core/packet.h>
+#include <dicey/core/type.h>
+#include <dicey/core/views.h>
+
+// the client-side cache used by dicey_client_get. It holds copies of the last GET responses received for each property,
+// which are served until they expire or a signal says they may have changed. The cache is used both by the threads
+// calling dicey_client_get and by the loop thread (which processes signals), so every function takes the lock.
+//
+// Values are keyed by the main path of their object, because that's where signals are raised from. Paths are only
+// cached once the main path they point to is known (see dicey_value_cache_add_path), and that knowledge expires like
+// any cached value. Expired entries, and objects left with nothing cached, are swept away at most once per TTL.
+//
+// GET responses race with the signals that invalidate them: a response may have been computed before a change whose
+// signal arrived while it was in flight. To avoid caching stale values, every lookup hands out a ticket (the current
+// value of `clock`) and each object remembers when it was last invalidated; responses to GETs issued before that are
+// simply not stored
+struct dicey_value_cache {
+    uv_mutex_t lock;
+
+    uint64_t ttl_ns;     // 0 if the cache is disabled
+    uint64_t clock;      // ticks at every invalidation
+    uint64_t next_sweep; // uv_hrtime() timestamp
+
+    struct dicey_hashtable *objects; // main path -> struct cached_object *
+    struct dicey_hashtable *paths;   // path -> struct resolved_path * (the main path of the object it points to)
+
+    struct dicey_view_mut scratch; // used to format the keys of the bindings
+};
+
+void dicey_value_cache_deinit(struct dicey_value_cache *cache);
+enum dicey_error dicey_value_cache_init(struct dicey_value_cache *cache, uint32_t ttl_ms);
+
+static inline bool dicey_value_cache_is_enabled(const struct dicey_value_cache *const cache) {
+    return cache->ttl_ns;
+}
+
+// remembers that `path` points to the object at `main_path`, so that values read from `path` can be cached. Failing to
+// do so is not an error (the values just won't be cached), so this function never fails
+void dicey_value_cache_add_path(struct dicey_value_cache *cache, const char *path, const char *main_path);
+
+// makes `signal` (of the same trait as `sel`) update the value of the property `sel` of the object at `path`, instead
+// of just invalidating the cached values of its trait
+enum dicey_error dicey_value_cache_bind(
+    struct dicey_value_cache *cache,
+    const char *path,
+    struct dicey_selector sel,
+    const char *signal
+);
+
+// drops all the cached values, keeping the bindings
+void dicey_value_cache_flush(struct dicey_value_cache *cache);
+
+// drops the cached value of a property, if any. If the object `path` points to is unknown, the property is dropped from
+// every object, since `path` may be an alias of any of them
+void dicey_value_cache_invalidate(struct dicey_value_cache *cache, const char *path, struct dicey_selector sel);
+
+// true if the main path of the object `path` points to is known, and thus values read from `path` can be cached
+bool dicey_value_cache_knows_path(struct dicey_value_cache *cache, const char *path);
+
+// looks up a property. On a hit, `dest` receives a copy of the cached response, which the caller must free.
+// On a miss, returns ENOENT and sets `ticket` to the value to later pass to dicey_value_cache_store
+enum dicey_error dicey_value_cache_lookup(
+    struct dicey_value_cache *cache,
+    const char *path,
+    struct dicey_selector sel,
+    struct dicey_packet *dest,
+    uint64_t *ticket
+);
+
+// updates or invalidates the cached values of the object that raised the signal in `packet`
+void dicey_value_cache_on_signal(struct dicey_value_cache *cache, struct dicey_packet packet);
+
+// stores a copy of the response to a GET issued with `ticket`, unless the object was invalidated in the meantime, the
+// object `path` points to is unknown or the response is an error. Failing to store a value is not an error, so this
+// function never fails
+void dicey_value_cache_store(
+    struct dicey_value_cache *cache,
+    const char *path,
+    struct dicey_selector sel,
+    struct dicey_packet response,
+    uint64_t ticket
+);
+
+#endif // QZRFKWMDUA_VALUE_CACHE_H
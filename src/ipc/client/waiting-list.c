@@ -14,9 +14,6 @@
  * limitations under the License.
  */
 
-#if defined(DICEY_CC_IS_MSVC)
-#pragma warning(disable : 4200)
-#endif
 
 #include <assert.h>
 #include <stdbool.h>
@@ -25,26 +22,248 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "sup/util.h"
+
 #include "waiting-list.h"
 
-#define ARRAY_EXPORT
-#define ARRAY_TYPE_NAME dicey_waiting_list
-#define ARRAY_VALUE_TYPE struct dicey_waiting_task
-#include "sup/array.inc"
+#define RING_BASE_CAP 128U
+#define INDEX_BASE_CAP (RING_BASE_CAP * 2U)
 
-bool dicey_waiting_list_remove_seq(struct dicey_waiting_list *const list, const uint32_t seq, uint64_t *const task_id) {
+// marks a ring position whose request has already been answered or removed. Task ids are never negative
+#define NO_TASK UINT64_MAX
+
+// task id -> sequence number, open addressing with linear probing. Empty slots have task_id == NO_TASK
+struct task_index_slot {
+    uint64_t task_id;
+    uint32_t seq;
+};
+
+struct dicey_waiting_list {
+    // ring of requests, where position `head` holds `base_seq` and every following position the next sequence number.
+    // Positions whose request is gone are holes (task_id == NO_TASK), and the head skips them as soon as it can
+    uint32_t base_seq;
+    size_t head;
+    size_t span;  // positions in use starting from head, holes included
+    size_t count; // requests actually waiting in the ring
+    size_t cap;   // power of two
+    struct dicey_waiting_task *ring;
+
+    size_t index_cap; // power of two, kept at most half full
+    struct task_index_slot *index;
+
+    // requests that were left behind by the ring, because they were waiting for so long that keeping them in it would
+    // have required it to grow for holes alone. Unordered, and expected to be almost always empty
+    size_t stragglers_len, stragglers_cap;
+    struct dicey_waiting_task *stragglers;
+};
+
+// distance between two sequence numbers handed out by client_next_seq(). Client sequence numbers are even and, after
+// wrapping around, restart from 2 instead of 0. If `to` comes before `from`, the result is huge
+static size_t seq_distance(const uint32_t from, const uint32_t to) {
+    const size_t diff = (uint32_t) (to - from) / 2U;
+
+    return to < from ? diff - 1U : diff;
+}
+
+static struct dicey_waiting_task *ring_at(const struct dicey_waiting_list *const list, const size_t offset) {
+    assert(offset < list->cap);
+
+    return &list->ring[(list->head + offset) & (list->cap - 1U)];
+}
+
+static size_t index_home(const struct dicey_waiting_list *const list, const uint64_t task_id) {
+    return (size_t) ((task_id * 0x9E3779B97F4A7C15ULL) >> 32U) & (list->index_cap - 1U);
+}
+
+static struct task_index_slot *index_find(const struct dicey_waiting_list *const list, const uint64_t task_id) {
+    assert(list && task_id != NO_TASK);
+
+    if (!list->index_cap) {
+        return NULL;
+    }
+
+    const size_t mask = list->index_cap - 1U;
+
+    for (size_t pos = index_home(list, task_id);; pos = (pos + 1U) & mask) {
+        struct task_index_slot *const slot = &list->index[pos];
+
+        if (slot->task_id == task_id) {
+            return slot;
+        }
+
+        if (slot->task_id == NO_TASK) {
+            return NULL;
+        }
+    }
+}
+
+static void index_put(struct dicey_waiting_list *const list, const uint64_t task_id, const uint32_t seq) {
+    assert(list && task_id != NO_TASK && list->index_cap);
+
+    const size_t mask = list->index_cap - 1U;
+
+    size_t pos = index_home(list, task_id);
+    while (list->index[pos].task_id != NO_TASK) {
+        pos = (pos + 1U) & mask;
+    }
+
+    list->index[pos] = (struct task_index_slot) { .task_id = task_id, .seq = seq };
+}
+
+static void index_remove(struct dicey_waiting_list *const list, struct task_index_slot *const slot) {
+    assert(list && slot);
+
+    const size_t mask = list->index_cap - 1U;
+    size_t hole = (size_t) (slot - list->index);
+
+    // backward shift deletion, so that no tombstones are needed
+    for (size_t pos = (hole + 1U) & mask;; pos = (pos + 1U) & mask) {
+        const struct task_index_slot cur = list->index[pos];
+        if (cur.task_id == NO_TASK) {
+            break;
+        }
+
+        const size_t home = index_home(list, cur.task_id);
+
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            list->index[hole] = cur;
+            hole = pos;
+        }
+    }
+
+    list->index[hole].task_id = NO_TASK;
+}
+
+static bool index_grow_if_needed(struct dicey_waiting_list *const list) {
+    assert(list);
+
+    if ((list->count + list->stragglers_len + 1U) * 2U <= list->index_cap) {
+        return true;
+    }
+
+    const size_t new_cap = list->index_cap ? list->index_cap * 2U : INDEX_BASE_CAP;
+    if (new_cap < list->index_cap || new_cap > SIZE_MAX / sizeof *list->index) {
+        return false;
+    }
+
+    struct task_index_slot *const new_index = malloc(new_cap * sizeof *new_index);
+    if (!new_index) {
+        return false;
+    }
+
+    for (size_t i = 0U; i < new_cap; ++i) {
+        new_index[i].task_id = NO_TASK;
+    }
+
+    free(list->index);
+
+    list->index = new_index;
+    list->index_cap = new_cap;
+
+    // rebuild from the ring and the stragglers, which are the source of truth
+    for (size_t i = 0U; i < list->span; ++i) {
+        const struct dicey_waiting_task *const task = ring_at(list, i);
+
+        if (task->task_id != NO_TASK) {
+            index_put(list, task->task_id, task->packet_seq);
+        }
+    }
+
+    for (size_t i = 0U; i < list->stragglers_len; ++i) {
+        index_put(list, list->stragglers[i].task_id, list->stragglers[i].packet_seq);
+    }
+
+    return true;
+}
+
+static bool ring_reserve(struct dicey_waiting_list *const list, const size_t span) {
+    assert(list);
+
+    if (span <= list->cap) {
+        return true;
+    }
+
+    size_t new_cap = list->cap ? list->cap : RING_BASE_CAP;
+    while (new_cap < span) {
+        if (new_cap > SIZE_MAX / 2U / sizeof *list->ring) {
+            return false;
+        }
+
+        new_cap *= 2U;
+    }
+
+    struct dicey_waiting_task *const new_ring = malloc(new_cap * sizeof *new_ring);
+    if (!new_ring) {
+        return false;
+    }
+
+    // unwrap the ring, so that the head is at position 0 again
+    for (size_t i = 0U; i < list->span; ++i) {
+        new_ring[i] = *ring_at(list, i);
+    }
+
+    free(list->ring);
+
+    list->ring = new_ring;
+    list->cap = new_cap;
+    list->head = 0U;
+
+    return true;
+}
+
+static void ring_pop_head(struct dicey_waiting_list *const list) {
+    assert(list && list->span);
+
+    list->head = (list->head + 1U) & (list->cap - 1U);
+    list->base_seq = list->base_seq + 2U ? list->base_seq + 2U : 2U; // same wraparound as client_next_seq()
+    --list->span;
+}
+
+static void ring_clear(struct dicey_waiting_list *const list, struct dicey_waiting_task *const task) {
+    assert(list && task && task->task_id != NO_TASK && list->count);
+
+    task->task_id = NO_TASK;
+    --list->count;
+
+    // advance the head past any hole, so that the ring never spans more than needed
+    while (list->span && ring_at(list, 0U)->task_id == NO_TASK) {
+        ring_pop_head(list);
+    }
+}
+
+static bool stragglers_push(struct dicey_waiting_list *const list, const struct dicey_waiting_task task) {
+    assert(list);
+
+    if (list->stragglers_len == list->stragglers_cap) {
+        const size_t new_cap = list->stragglers_cap ? list->stragglers_cap * 2U : 8U;
+        if (new_cap > SIZE_MAX / sizeof *list->stragglers) {
+            return false;
+        }
+
+        struct dicey_waiting_task *const stragglers = realloc(list->stragglers, new_cap * sizeof *stragglers);
+        if (!stragglers) {
+            return false;
+        }
+
+        list->stragglers = stragglers;
+        list->stragglers_cap = new_cap;
+    }
+
+    list->stragglers[list->stragglers_len++] = task;
+
+    return true;
+}
+
+static bool stragglers_remove(struct dicey_waiting_list *const list, const uint32_t seq, uint64_t *const task_id) {
     assert(list);
 
-    for (const struct dicey_waiting_task *it = dicey_waiting_list_cbegin(list),
-                                         *const end = dicey_waiting_list_cend(list);
-         it < end;
-         ++it) {
-        if (it->packet_seq == seq) {
+    for (size_t i = 0U; i < list->stragglers_len; ++i) {
+        if (list->stragglers[i].packet_seq == seq) {
             if (task_id) {
-                *task_id = it->task_id;
+                *task_id = list->stragglers[i].task_id;
             }
 
-            dicey_waiting_list_erase(list, it);
+            list->stragglers[i] = list->stragglers[--list->stragglers_len];
 
             return true;
         }
@@ -53,29 +272,179 @@ bool dicey_waiting_list_remove_seq(struct dicey_waiting_list *const list, const
     return false;
 }
 
+// makes room for position `offset` without growing the ring, by moving the requests at its front to the stragglers.
+// Only worth it when the ring is mostly holes, i.e. when a few old requests are keeping it from advancing
+static bool ring_evict_front(struct dicey_waiting_list *const list, size_t *const offset) {
+    assert(list && offset);
+
+    while (list->span && *offset >= list->cap) {
+        const struct dicey_waiting_task *const front = ring_at(list, 0U);
+
+        if (front->task_id != NO_TASK) {
+            if (!stragglers_push(list, *front)) {
+                return false;
+            }
+
+            --list->count;
+        }
+
+        ring_pop_head(list);
+        --*offset;
+    }
+
+    return true;
+}
+
+struct dicey_waiting_task *dicey_waiting_list_append(
+    struct dicey_waiting_list **const list_ptr,
+    struct dicey_waiting_task *const task
+) {
+    assert(list_ptr && task && task->task_id != NO_TASK);
+
+    if (!*list_ptr) {
+        *list_ptr = calloc(1U, sizeof **list_ptr);
+        if (!*list_ptr) {
+            return NULL;
+        }
+    }
+
+    struct dicey_waiting_list *const list = *list_ptr;
+
+    size_t offset = 0U;
+
+    if (list->span) {
+        offset = seq_distance(list->base_seq, task->packet_seq);
+
+        // sequence numbers must be appended in order, with no repetitions
+        assert(offset >= list->span);
+        if (offset < list->span) {
+            return NULL;
+        }
+
+        if (offset >= list->cap && list->count <= list->cap / 4U && !ring_evict_front(list, &offset)) {
+            return NULL;
+        }
+    }
+
+    if (!list->span) {
+        // nothing is waiting in the ring: restart it from this sequence number
+        list->base_seq = task->packet_seq;
+        list->head = 0U;
+        offset = 0U;
+    }
+
+    if (offset == SIZE_MAX || !ring_reserve(list, offset + 1U) || !index_grow_if_needed(list)) {
+        return NULL;
+    }
+
+    // any sequence number skipped since the last append (i.e. sent without waiting for a response) becomes a hole
+    for (size_t i = list->span; i < offset; ++i) {
+        ring_at(list, i)->task_id = NO_TASK;
+    }
+
+    struct dicey_waiting_task *const dest = ring_at(list, offset);
+    *dest = *task;
+
+    list->span = offset + 1U;
+    ++list->count;
+
+    index_put(list, task->task_id, task->packet_seq);
+
+    return dest;
+}
+
+void dicey_waiting_list_delete(struct dicey_waiting_list *const list) {
+    if (list) {
+        free(list->ring);
+        free(list->index);
+        free(list->stragglers);
+        free(list);
+    }
+}
+
+static bool stragglers_remove_seq(struct dicey_waiting_list *const list, const uint32_t seq, uint64_t *const task_id) {
+    uint64_t found_id = NO_TASK;
+    if (!list->stragglers_len || !stragglers_remove(list, seq, &found_id)) {
+        return false;
+    }
+
+    struct task_index_slot *const slot = index_find(list, found_id);
+    assert(slot && slot->seq == seq);
+
+    index_remove(list, slot);
+
+    if (task_id) {
+        *task_id = found_id;
+    }
+
+    return true;
+}
+
+bool dicey_waiting_list_remove_seq(struct dicey_waiting_list *const list, const uint32_t seq, uint64_t *const task_id) {
+    if (!list) {
+        return false;
+    }
+
+    const size_t offset = seq_distance(list->base_seq, seq);
+    if (offset >= list->span) {
+        // never sent, already answered, or left behind by the ring
+        return stragglers_remove_seq(list, seq, task_id);
+    }
+
+    struct dicey_waiting_task *const task = ring_at(list, offset);
+    if (task->task_id == NO_TASK || task->packet_seq != seq) {
+        return false;
+    }
+
+    struct task_index_slot *const slot = index_find(list, task->task_id);
+    assert(slot && slot->seq == seq);
+
+    index_remove(list, slot);
+
+    if (task_id) {
+        *task_id = task->task_id;
+    }
+
+    ring_clear(list, task);
+
+    return true;
+}
+
 bool dicey_waiting_list_remove_task(
     struct dicey_waiting_list *const list,
     const uint64_t task_id,
     uint32_t *const seq
 ) {
-    if (!list) {
+    if (!list || task_id == NO_TASK) {
         return false;
     }
 
-    for (const struct dicey_waiting_task *it = dicey_waiting_list_begin(list),
-                                         *const end = dicey_waiting_list_end(list);
-         it < end;
-         ++it) {
-        if (it->task_id == task_id) {
-            if (seq) {
-                *seq = it->packet_seq;
-            }
+    struct task_index_slot *const slot = index_find(list, task_id);
+    if (!slot) {
+        return false;
+    }
 
-            dicey_waiting_list_erase(list, it);
+    const uint32_t packet_seq = slot->seq;
 
-            return true;
-        }
+    index_remove(list, slot);
+
+    if (seq) {
+        *seq = packet_seq;
     }
 
-    return false;
+    const size_t offset = seq_distance(list->base_seq, packet_seq);
+    if (offset >= list->span) {
+        const bool found = stragglers_remove(list, packet_seq, NULL);
+        DICEY_UNUSED(found);
+        assert(found);
+
+        return true;
+    }
+
+    struct dicey_waiting_task *const task = ring_at(list, offset);
+    assert(task->task_id == task_id && task->packet_seq == packet_seq);
+
+    ring_clear(list, task);
+
+    return true;
 }
@@ -25,6 +25,9 @@ struct dicey_waiting_task {
     uint64_t task_id;
 };
 
+// the requests waiting for a response, indexed both by sequence number and by task id. Sequence numbers must be
+// appended in the order client_next_seq() hands them out (including its wraparound), which allows them to be stored
+// in a ring indexed by their distance from the oldest one still waiting
 struct dicey_waiting_list;
 
 struct dicey_waiting_task *dicey_waiting_list_append(
@@ -32,10 +35,7 @@ struct dicey_waiting_task *dicey_waiting_list_append(
     struct dicey_waiting_task *task
 );
 
-const struct dicey_waiting_task *dicey_waiting_list_cbegin(const struct dicey_waiting_list *list);
-const struct dicey_waiting_task *dicey_waiting_list_cend(const struct dicey_waiting_list *list);
-
-void dicey_waiting_list_clear(struct dicey_waiting_list *list);
+void dicey_waiting_list_delete(struct dicey_waiting_list *list);
 
 bool dicey_waiting_list_remove_seq(struct dicey_waiting_list *list, uint32_t seq, uint64_t *task_id);
 
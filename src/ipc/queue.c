@@ -17,94 +17,309 @@
 #define _XOPEN_SOURCE 700
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <uv.h>
 
 #include <dicey/core/errors.h>
-#include <dicey/core/packet.h>
+
+#include "sup/trace.h"
+#include "sup/uvtools.h"
 
 #include "queue.h"
 
-void dicey_queue_deinit(struct dicey_queue *const queue, free_data_fn *const free_data, void *ctx) {
-    uv_mutex_destroy(&queue->mutex);
-    uv_cond_destroy(&queue->cond);
+#define OVERFLOW_STARTING_CAP 64U
 
-    if (free_data) {
-        for (ptrdiff_t i = queue->head; i != queue->tail; i = (i + 1) % REQUEST_QUEUE_CAP) {
-            free_data(ctx, queue->data[i]);
-        }
+// the ring is a bounded MPMC queue in the style of Dmitry Vyukov's, used with a single consumer. Each slot carries a
+// sequence number that says whose turn it is: `pos` when free for the producer claiming position `pos`, `pos + 1` when
+// it holds the item pushed at `pos`. This way producers only contend on `tail`, and never on the slots
+struct dicey_queue_slot {
+    _Atomic size_t seq;
+    void *data;
+};
+
+static size_t round_up_pow2(size_t n) {
+    size_t cap = 2U;
+
+    while (cap < n && cap <= SIZE_MAX / 2U) {
+        cap *= 2U;
     }
+
+    return cap;
 }
 
-enum dicey_error dicey_queue_init(struct dicey_queue *const queue) {
-    *queue = (struct dicey_queue) { 0 };
+static bool ring_try_push(struct dicey_queue *const queue, void *const val) {
+    size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    for (;;) {
+        struct dicey_queue_slot *const slot = &queue->slots[pos & queue->mask];
+
+        const size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        const intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+        if (!diff) {
+            // the slot is free: try to claim it. On failure, `pos` is reloaded with the current tail
+            if (atomic_compare_exchange_weak_explicit(
+                    &queue->tail, &pos, pos + 1U, memory_order_relaxed, memory_order_relaxed
+                )) {
+                slot->data = val;
+                atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
 
-    int error = uv_mutex_init(&queue->mutex);
-    if (error < 0) {
-        return error;
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // the slot still holds an item from the previous lap: the ring is full
+        } else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed); // someone else got here first
+        }
     }
+}
 
-    error = uv_cond_init(&queue->cond);
-    if (error < 0) {
-        uv_mutex_destroy(&queue->mutex);
+static bool ring_try_pop(struct dicey_queue *const queue, void **const val) {
+    struct dicey_queue_slot *const slot = &queue->slots[queue->head & queue->mask];
 
-        return error;
+    // either the ring is empty, or the producer that claimed this slot hasn't written it yet. In the latter case it
+    // will claim a wakeup right after, so it's fine to report the queue as empty
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != queue->head + 1U) {
+        return false;
     }
 
-    return 0;
+    *val = slot->data;
+    slot->data = NULL;
+
+    // hand the slot to the producer that will push at head + cap, one lap from now
+    atomic_store_explicit(&slot->seq, queue->head + queue->mask + 1U, memory_order_release);
+
+    ++queue->head;
+
+    return true;
 }
 
-bool dicey_queue_pop(struct dicey_queue *const queue, void **const val, const enum dicey_locking_policy policy) {
-    uv_mutex_lock(&queue->mutex);
+// must be called with the mutex held
+static bool overflow_push(struct dicey_queue *const queue, void *const val) {
+    if (queue->overflow_len == queue->overflow_cap) {
+        const size_t old_cap = queue->overflow_cap;
+        const size_t new_cap = old_cap ? old_cap * 2U : OVERFLOW_STARTING_CAP;
 
-    while (queue->head == queue->tail) {
-        if (policy == DICEY_LOCKING_POLICY_NONBLOCKING) {
-            uv_mutex_unlock(&queue->mutex);
+        if (new_cap < old_cap || new_cap > SIZE_MAX / sizeof *queue->overflow) {
+            return false;
+        }
 
+        void **const new_overflow = realloc(queue->overflow, new_cap * sizeof *new_overflow);
+        if (!new_overflow) {
             return false;
         }
 
-        uv_cond_wait(&queue->cond, &queue->mutex);
+        queue->overflow = new_overflow;
+        queue->overflow_cap = new_cap;
     }
 
-    *val = queue->data[queue->head];
-    queue->data[queue->head] = NULL;
+    queue->overflow[queue->overflow_len++] = val;
+    atomic_fetch_add_explicit(&queue->spilled, 1U, memory_order_release);
 
-    queue->head = (queue->head + 1) % REQUEST_QUEUE_CAP;
+    return true;
+}
 
-    uv_cond_signal(&queue->cond);
-    uv_mutex_unlock(&queue->mutex);
+static bool overflow_try_pop(struct dicey_queue *const queue, void **const val) {
+    if (queue->drain_pos == queue->drain_len) {
+        if (!atomic_load_explicit(&queue->spilled, memory_order_acquire)) {
+            return false;
+        }
+
+        // take the whole overflow list at once, and give the producers the empty drain buffer in exchange
+        uv_mutex_lock(&queue->mutex);
+
+        void **const batch = queue->overflow;
+        const size_t batch_len = queue->overflow_len, batch_cap = queue->overflow_cap;
+
+        queue->overflow = queue->drain;
+        queue->overflow_len = 0U;
+        queue->overflow_cap = queue->drain_cap;
+
+        uv_mutex_unlock(&queue->mutex);
+
+        queue->drain = batch;
+        queue->drain_pos = 0U;
+        queue->drain_len = batch_len;
+        queue->drain_cap = batch_cap;
+
+        assert(batch_len); // only the consumer ever removes items
+    }
+
+    *val = queue->drain[queue->drain_pos++];
+
+    atomic_fetch_sub_explicit(&queue->spilled, 1U, memory_order_release);
 
     return true;
 }
 
-bool dicey_queue_push(struct dicey_queue *const queue, void *const req, const enum dicey_locking_policy policy) {
+static bool queue_try_pop(struct dicey_queue *const queue, void **const val) {
+    if (ring_try_pop(queue, val)) {
+        // pairs with the fence in push_blocking: either we see the waiting producer, or it sees the slot we just freed
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if (atomic_load_explicit(&queue->blocked, memory_order_relaxed)) {
+            uv_mutex_lock(&queue->mutex);
+            uv_cond_broadcast(&queue->cond);
+            uv_mutex_unlock(&queue->mutex);
+        }
+
+        return true;
+    }
+
+    // the overflow list only holds items pushed while the ring was full, which come after whatever is in the ring
+    return overflow_try_pop(queue, val);
+}
+
+static void push_blocking(struct dicey_queue *const queue, void *const val) {
     uv_mutex_lock(&queue->mutex);
 
-    const ptrdiff_t new_tail = (queue->tail + 1) % REQUEST_QUEUE_CAP;
+    atomic_fetch_add_explicit(&queue->blocked, 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
 
-    while (new_tail == queue->head) {
-        if (policy == DICEY_LOCKING_POLICY_NONBLOCKING) {
-            uv_mutex_unlock(&queue->mutex);
+    while (!ring_try_push(queue, val)) {
+        uv_cond_wait(&queue->cond, &queue->mutex);
+    }
+
+    atomic_fetch_sub_explicit(&queue->blocked, 1U, memory_order_relaxed);
+
+    uv_mutex_unlock(&queue->mutex);
+}
+
+void dicey_queue_deinit(struct dicey_queue *const queue, free_data_fn *const free_data, void *ctx) {
+    if (!queue->slots) {
+        return; // never initialised, or already deinit'ed
+    }
+
+    if (free_data) {
+        void *item = NULL;
+
+        while (queue_try_pop(queue, &item)) {
+            free_data(ctx, item);
+        }
+    }
+
+    uv_mutex_destroy(&queue->mutex);
+    uv_cond_destroy(&queue->cond);
+
+    free(queue->slots);
+    free(queue->overflow);
+    free(queue->drain);
+
+    *queue = (struct dicey_queue) { 0 };
+}
+
+enum dicey_error dicey_queue_init(struct dicey_queue *const queue, const size_t cap, const bool growable) {
+    assert(queue);
+
+    *queue = (struct dicey_queue) { .growable = growable };
+
+    const size_t real_cap = round_up_pow2(cap ? cap : DICEY_QUEUE_DEFAULT_CAP);
+    if (real_cap > SIZE_MAX / sizeof *queue->slots) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    struct dicey_queue_slot *const slots = malloc(real_cap * sizeof *slots);
+    if (!slots) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    for (size_t i = 0U; i < real_cap; ++i) {
+        atomic_init(&slots[i].seq, i);
+        slots[i].data = NULL;
+    }
+
+    enum dicey_error err = dicey_error_from_uv(uv_mutex_init(&queue->mutex));
+    if (err) {
+        goto free_slots;
+    }
+
+    err = dicey_error_from_uv(uv_cond_init(&queue->cond));
+    if (err) {
+        goto destroy_mutex;
+    }
+
+    queue->slots = slots;
+    queue->mask = real_cap - 1U;
+
+    return DICEY_OK;
 
+destroy_mutex:
+    uv_mutex_destroy(&queue->mutex);
+
+free_slots:
+    free(slots);
+
+    return err;
+}
+
+bool dicey_queue_claim_wakeup(struct dicey_queue *const queue) {
+    assert(queue);
+
+    return !atomic_exchange_explicit(&queue->wakeup_pending, true, memory_order_acq_rel);
+}
+
+bool dicey_queue_pop(struct dicey_queue *const queue, void **const val) {
+    assert(queue && val);
+
+    for (;;) {
+        if (queue_try_pop(queue, val)) {
+            return true;
+        }
+
+        // the queue looks empty: let the next push wake the consumer up again. If a wakeup had been claimed since the
+        // last time we got here, its item may have landed after the check above - look again before giving up
+        if (!atomic_exchange_explicit(&queue->wakeup_pending, false, memory_order_acq_rel)) {
             return false;
         }
+    }
+}
 
-        uv_cond_wait(&queue->cond, &queue->mutex);
+bool dicey_queue_push(struct dicey_queue *const queue, void *const val, const enum dicey_locking_policy policy) {
+    assert(queue && val && queue->slots);
+
+    // once something has spilled into the overflow list, everything must go there until the consumer drains it.
+    // Otherwise, items pushed by the same thread could be popped out of order
+    if (!atomic_load_explicit(&queue->spilled, memory_order_acquire) && ring_try_push(queue, val)) {
+        return true;
     }
 
-    assert(!queue->data[queue->tail]);
+    if (queue->growable) {
+        uv_mutex_lock(&queue->mutex);
 
-    queue->data[queue->tail] = req;
-    queue->tail = new_tail;
+        const bool pushed = overflow_push(queue, val);
 
-    uv_cond_signal(&queue->cond);
-    uv_mutex_unlock(&queue->mutex);
+        uv_mutex_unlock(&queue->mutex);
+
+        if (pushed) {
+            return true;
+        }
+    }
+
+    if (policy == DICEY_LOCKING_POLICY_NONBLOCKING) {
+        return false;
+    }
+
+    push_blocking(queue, val);
 
     return true;
 }
 
+void dicey_queue_reset_wakeup(struct dicey_queue *const queue) {
+    assert(queue);
+
+    atomic_store_explicit(&queue->wakeup_pending, false, memory_order_release);
+}
+
 size_t dicey_queue_size(const struct dicey_queue *const queue) {
-    return (size_t) ((queue->tail - queue->head + REQUEST_QUEUE_CAP) % REQUEST_QUEUE_CAP);
+    assert(queue);
+
+    const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    return tail - queue->head + atomic_load_explicit(&queue->spilled, memory_order_relaxed);
 }
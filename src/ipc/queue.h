@@ -17,36 +17,89 @@
 #if !defined(NYSSJKURJT_QUEUE_H)
 #define NYSSJKURJT_QUEUE_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 
 #include <uv.h>
 
 #include <dicey/core/errors.h>
-#include <dicey/core/packet.h>
 
-#define REQUEST_QUEUE_CAP 128
+#define DICEY_QUEUE_DEFAULT_CAP 1024U
+
+// producers and the consumer touch different ends of the queue - keep them on different cache lines
+#define DICEY_QUEUE_CACHELINE 64U
 
 enum dicey_locking_policy {
     DICEY_LOCKING_POLICY_BLOCKING,
     DICEY_LOCKING_POLICY_NONBLOCKING,
 };
 
+struct dicey_queue_slot;
+
+// a bounded lock-free multi-producer, single-consumer queue. Any thread can push, but only one thread (the one running
+// the loop that owns the queue) may pop. If the queue is growable, items that don't fit in the ring spill into an
+// overflow list instead of making the producer wait, and are popped after the ring has been drained.
+// The queue doesn't wake up its consumer by itself: after a successful push, producers must call
+// dicey_queue_claim_wakeup and wake the consumer up (i.e. uv_async_send) only if it returns true. This coalesces
+// wakeups, so that a busy consumer isn't woken up again for every single item
 struct dicey_queue {
+    _Atomic size_t tail;
+    char _pad_tail[DICEY_QUEUE_CACHELINE - sizeof(_Atomic size_t)];
+
+    size_t head; // only touched by the consumer
+    char _pad_head[DICEY_QUEUE_CACHELINE - sizeof(size_t)];
+
+    struct dicey_queue_slot *slots;
+    size_t mask;
+
+    _Atomic bool wakeup_pending;
+    _Atomic size_t blocked; // producers waiting for room in the ring
+
+    bool growable;
+
+    // protects the overflow list. Also used by blocked producers to wait for room in the ring
     uv_mutex_t mutex;
     uv_cond_t cond;
 
-    void **data[REQUEST_QUEUE_CAP];
-    ptrdiff_t head;
-    ptrdiff_t tail;
+    // items in the overflow list plus the ones in the drain buffer the consumer hasn't popped yet
+    _Atomic size_t spilled;
+
+    void **overflow;
+    size_t overflow_len;
+    size_t overflow_cap;
+
+    // the consumer swaps the whole overflow list with this buffer in one go, and then pops from it without locking
+    void **drain;
+    size_t drain_pos;
+    size_t drain_len;
+    size_t drain_cap;
 };
 
 typedef void free_data_fn(void *ctx, void *data);
 
+// frees all items still in the queue with `free_fn`, if set. Must not race with anything else, pushes included
 void dicey_queue_deinit(struct dicey_queue *queue, free_data_fn *free_fn, void *ctx);
-enum dicey_error dicey_queue_init(struct dicey_queue *queue);
-bool dicey_queue_pop(struct dicey_queue *queue, void **val, enum dicey_locking_policy policy);
+
+// `cap` is rounded up to a power of two. If 0, DICEY_QUEUE_DEFAULT_CAP is used
+enum dicey_error dicey_queue_init(struct dicey_queue *queue, size_t cap, bool growable);
+
+// true if the caller has to wake the consumer up after a push. Only one producer gets true until the consumer runs dry
+bool dicey_queue_claim_wakeup(struct dicey_queue *queue);
+
+// consumer only. Returns false when the queue is empty; after that, the next push will claim a new wakeup
+bool dicey_queue_pop(struct dicey_queue *queue, void **val);
+
+// fails only if there is no room for the item and the policy is nonblocking. Blocking pushes wait for the consumer to
+// make room instead. Growable queues only run out of room if the overflow list can't be grown.
+// Pushing is not synchronised with dicey_queue_deinit: the owner of the queue must make sure that no producer can push
+// anymore before deinit'ing it
 bool dicey_queue_push(struct dicey_queue *queue, void *val, enum dicey_locking_policy policy);
+
+// consumer only. Makes the next push claim a wakeup, for consumers that stop popping before the queue runs dry
+void dicey_queue_reset_wakeup(struct dicey_queue *queue);
+
+// consumer only. Items being pushed concurrently may or may not be counted
 size_t dicey_queue_size(const struct dicey_queue *queue);
 
 #endif // NYSSJKURJT_QUEUE_H
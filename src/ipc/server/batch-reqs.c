@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dicey/core/builders.h>
+#include <dicey/core/errors.h>
+#include <dicey/core/message.h>
+#include <dicey/core/packet.h>
+
+#include "sup/trace.h"
+#include "sup/util.h"
+
+#include "wirefmt/packet-args.h"
+
+#include "batch-reqs.h"
+#include "pending-reqs.h"
+
+#if defined(DICEY_CC_IS_MSVC)
+#pragma warning(disable : 4200)
+#endif
+
+#define FIRST_ITEM_SEQ ((uint32_t) 1U)
+#define STARTING_CAP 4U
+
+struct dicey_batch_requests {
+    uint32_t next_seq;
+
+    size_t len, cap;
+    struct dicey_batch_request *batches[];
+};
+
+static void batch_slot_deinit(struct dicey_batch_slot *const slot) {
+    assert(slot);
+
+    dicey_request_deinit(&slot->req);
+    dicey_packet_deinit(&slot->result);
+}
+
+static void batch_request_resolve(struct dicey_batch_request *const batch, const size_t i) {
+    assert(batch && i < batch->nitems && batch->npending);
+
+    struct dicey_batch_slot *const slot = &batch->slots[i];
+
+    // the request is not needed anymore. The user may still hold a pointer to it, but it's not allowed to touch it
+    // after replying, same as any other request
+    dicey_request_deinit(&slot->req);
+
+    slot->done = true;
+    --batch->npending;
+}
+
+static struct dicey_batch_requests *batch_requests_grow(struct dicey_batch_requests *list) {
+    const size_t old_cap = list ? list->cap : 0U;
+    const size_t new_cap = old_cap ? old_cap * 2U : STARTING_CAP;
+
+    if (new_cap > (SIZE_MAX - sizeof *list) / sizeof *list->batches) {
+        return NULL;
+    }
+
+    struct dicey_batch_requests *const new_list = realloc(list, sizeof *list + new_cap * sizeof *list->batches);
+    if (!new_list) {
+        return NULL;
+    }
+
+    if (!list) {
+        *new_list = (struct dicey_batch_requests) { .next_seq = FIRST_ITEM_SEQ };
+    }
+
+    new_list->cap = new_cap;
+
+    return new_list;
+}
+
+static void batch_requests_remove_at(struct dicey_batch_requests *const list, const size_t i) {
+    assert(list && i < list->len);
+
+    --list->len;
+
+    // the order of the batches doesn't matter
+    list->batches[i] = list->batches[list->len];
+}
+
+struct dicey_batch_request *dicey_batch_request_new(
+    const struct dicey_packet source,
+    const char *const path,
+    const struct dicey_selector sel,
+    const size_t nitems
+) {
+    assert(dicey_packet_is_valid(source) && path && dicey_selector_is_valid(sel));
+
+    if (nitems > (SIZE_MAX - sizeof(struct dicey_batch_request)) / sizeof(struct dicey_batch_slot)) {
+        return NULL;
+    }
+
+    struct dicey_batch_request *const batch =
+        calloc(1U, sizeof *batch + nitems * sizeof(struct dicey_batch_slot));
+    if (!batch) {
+        return NULL;
+    }
+
+    uint32_t seq = 0U;
+    DICEY_ASSUME(dicey_packet_get_seq(source, &seq));
+
+    batch->seq = seq;
+    batch->source = source;
+    batch->path = path;
+    batch->sel = sel;
+    batch->npending = nitems + 1U; // the extra reference is dropped by dicey_batch_request_release
+    batch->nitems = nitems;
+
+    return batch;
+}
+
+enum dicey_error dicey_batch_request_build_response(
+    const struct dicey_batch_request *const batch,
+    struct dicey_packet *const dest
+) {
+    assert(batch && dicey_batch_request_is_done(batch) && dest);
+
+    if (batch->nitems > UINT16_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    struct dicey_arg *const elems = batch->nitems ? calloc(batch->nitems, sizeof *elems) : NULL;
+    if (batch->nitems && !elems) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    enum dicey_error err = DICEY_OK;
+
+    for (size_t i = 0U; i < batch->nitems && !err; ++i) {
+        const struct dicey_batch_slot *const slot = &batch->slots[i];
+
+        if (slot->err) {
+            elems[i] = (struct dicey_arg) {
+                .type = DICEY_TYPE_ERROR,
+                .error = {
+                    .code = (uint16_t) slot->err,
+                    .message = dicey_error_msg(slot->err),
+                },
+            };
+
+            continue;
+        }
+
+        struct dicey_message msg = { 0 };
+
+        err = dicey_packet_as_message(slot->result, &msg);
+        if (!err) {
+            // the values are borrowed from the item responses, which outlive the response being built here
+            err = dicey_arg_from_borrowed_value(&elems[i], &msg.value);
+        }
+    }
+
+    if (!err) {
+        err = dicey_packet_message(
+            dest,
+            batch->seq,
+            DICEY_OP_RESPONSE,
+            batch->path,
+            batch->sel,
+            (struct dicey_arg) {
+                .type = DICEY_TYPE_TUPLE,
+                .tuple = {
+                    .nitems = (uint16_t) batch->nitems,
+                    .elems = elems,
+                },
+            }
+        );
+    }
+
+    dicey_arg_free_list(elems, batch->nitems);
+
+    return err;
+}
+
+void dicey_batch_request_complete(
+    struct dicey_batch_request *const batch,
+    const size_t i,
+    struct dicey_packet result
+) {
+    assert(batch && i < batch->nitems && dicey_packet_is_valid(result));
+
+    struct dicey_batch_slot *const slot = &batch->slots[i];
+
+    if (slot->done) {
+        dicey_packet_deinit(&result);
+
+        return;
+    }
+
+    slot->result = result;
+
+    batch_request_resolve(batch, i);
+}
+
+void dicey_batch_request_delete(struct dicey_batch_request *const batch) {
+    if (batch) {
+        for (size_t i = 0U; i < batch->nitems; ++i) {
+            batch_slot_deinit(&batch->slots[i]);
+        }
+
+        dicey_packet_deinit(&batch->source);
+
+        free(batch);
+    }
+}
+
+void dicey_batch_request_fail(struct dicey_batch_request *const batch, const size_t i, const enum dicey_error err) {
+    assert(batch && i < batch->nitems && err);
+
+    struct dicey_batch_slot *const slot = &batch->slots[i];
+
+    if (slot->done) {
+        return;
+    }
+
+    slot->err = err;
+
+    batch_request_resolve(batch, i);
+}
+
+bool dicey_batch_request_is_done(const struct dicey_batch_request *const batch) {
+    assert(batch);
+
+    return !batch->npending;
+}
+
+void dicey_batch_request_release(struct dicey_batch_request *const batch) {
+    assert(batch && batch->npending);
+
+    --batch->npending;
+}
+
+bool dicey_batch_seq_is_item(const uint32_t seq) {
+    // clients only ever send even seqs, so odd ones are free for the server to use
+    return seq & 1U;
+}
+
+enum dicey_error dicey_batch_requests_add(
+    struct dicey_batch_requests **const list_ptr,
+    struct dicey_batch_request *const batch
+) {
+    assert(list_ptr && batch);
+
+    struct dicey_batch_requests *list = *list_ptr;
+
+    if (batch->nitems > UINT32_MAX / 2U) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    if (!list || list->len == list->cap) {
+        list = batch_requests_grow(list);
+        if (!list) {
+            return TRACE(DICEY_ENOMEM);
+        }
+
+        *list_ptr = list;
+    }
+
+    const uint32_t span = (uint32_t) batch->nitems * 2U;
+
+    // start over when the seqs run out. By then, any batch still using the first seqs is long dead
+    if (list->next_seq > UINT32_MAX - span) {
+        list->next_seq = FIRST_ITEM_SEQ;
+    }
+
+    batch->first_seq = list->next_seq;
+    list->next_seq += span;
+
+    list->batches[list->len++] = batch;
+
+    return DICEY_OK;
+}
+
+void dicey_batch_requests_delete(struct dicey_batch_requests *const list) {
+    if (list) {
+        for (size_t i = 0U; i < list->len; ++i) {
+            dicey_batch_request_delete(list->batches[i]);
+        }
+
+        free(list);
+    }
+}
+
+struct dicey_batch_request *dicey_batch_requests_find(
+    struct dicey_batch_requests *const list,
+    const uint32_t seq,
+    size_t *const item
+) {
+    assert(item);
+
+    if (!list || !dicey_batch_seq_is_item(seq)) {
+        return NULL;
+    }
+
+    // there are rarely more than a handful of batches in flight per client, so a linear scan is fine
+    for (size_t i = 0U; i < list->len; ++i) {
+        struct dicey_batch_request *const batch = list->batches[i];
+
+        if (seq < batch->first_seq) {
+            continue;
+        }
+
+        const size_t ix = (seq - batch->first_seq) / 2U;
+        if (ix < batch->nitems) {
+            *item = ix;
+
+            return batch;
+        }
+    }
+
+    return NULL;
+}
+
+void dicey_batch_requests_prune(
+    struct dicey_batch_requests *const list,
+    dicey_batch_request_prune_fn *const prune_fn,
+    void *const ctx,
+    const enum dicey_error err
+) {
+    assert(prune_fn && err);
+
+    if (!list) {
+        return;
+    }
+
+    for (size_t i = 0U; i < list->len; ++i) {
+        struct dicey_batch_request *const batch = list->batches[i];
+
+        for (size_t j = 0U; j < batch->nitems; ++j) {
+            const struct dicey_batch_slot *const slot = &batch->slots[j];
+
+            // only the items waiting on the user have a request
+            if (!slot->done && slot->req.message.path && prune_fn(&slot->req, ctx)) {
+                dicey_batch_request_fail(batch, j, err);
+            }
+        }
+    }
+}
+
+struct dicey_batch_request *dicey_batch_requests_take_done(struct dicey_batch_requests *const list) {
+    if (!list) {
+        return NULL;
+    }
+
+    for (size_t i = 0U; i < list->len; ++i) {
+        struct dicey_batch_request *const batch = list->batches[i];
+
+        if (dicey_batch_request_is_done(batch)) {
+            batch_requests_remove_at(list, i);
+
+            return batch;
+        }
+    }
+
+    return NULL;
+}
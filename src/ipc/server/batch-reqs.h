@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#if !defined(PROGBXAOSJ_BATCH_REQS_H)
+#define PROGBXAOSJ_BATCH_REQS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/packet.h>
+#include <dicey/core/type.h>
+
+#include "pending-reqs.h"
+
+#if defined(DICEY_CC_IS_MSVC)
+#pragma warning(disable : 4200)
+#endif
+
+// the outcome of a single property access inside a GetMany or SetMany batch (see dicey.Batch)
+struct dicey_batch_slot {
+    // the request handed to on_request, if any. Empty if the item was handled by the server itself
+    struct dicey_request req;
+
+    struct dicey_packet result; // the response to the item. Only valid if done and err is DICEY_OK
+    enum dicey_error err;       // the error the item failed with, reported to the client in place of its value
+
+    bool done;
+};
+
+// a GetMany or SetMany request, fanned out into one request per item. Every item gets its own odd sequence number, so
+// that the responses sent by the user can be told apart from the responses to regular requests (which are always even)
+struct dicey_batch_request {
+    uint32_t seq;       // the seq of the batch request, used for the aggregated response
+    uint32_t first_seq; // the seq of the first item. Item i has seq first_seq + 2 * i
+
+    struct dicey_packet source; // the batch request itself, which owns the path below
+    const char *path;
+    struct dicey_selector sel; // owned by the registry
+
+    // the number of items still waiting for an outcome, plus one while the batch is being dispatched
+    size_t npending;
+
+    size_t nitems;
+    struct dicey_batch_slot slots[];
+};
+
+// creates a new batch with `nitems` empty slots, taking ownership of `source`
+struct dicey_batch_request *dicey_batch_request_new(
+    struct dicey_packet source,
+    const char *path,
+    struct dicey_selector sel,
+    size_t nitems
+);
+
+// builds the aggregated response of a batch that's done: a tuple with either the value or the error of each item
+enum dicey_error dicey_batch_request_build_response(
+    const struct dicey_batch_request *batch,
+    struct dicey_packet *dest
+);
+
+// records the response to item `i`, taking ownership of `result`. Late or repeated responses are dropped
+void dicey_batch_request_complete(struct dicey_batch_request *batch, size_t i, struct dicey_packet result);
+
+void dicey_batch_request_delete(struct dicey_batch_request *batch);
+
+// records the failure of item `i`. Does nothing if the item is already done
+void dicey_batch_request_fail(struct dicey_batch_request *batch, size_t i, enum dicey_error err);
+
+bool dicey_batch_request_is_done(const struct dicey_batch_request *batch);
+
+// drops the reference held while dispatching the batch. Must be called exactly once, after every item was handed out
+void dicey_batch_request_release(struct dicey_batch_request *batch);
+
+// true if `seq` can only belong to an item of a batch
+bool dicey_batch_seq_is_item(uint32_t seq);
+
+// the list of batches in flight for a single client
+struct dicey_batch_requests;
+
+// adds `batch` to the list and assigns the sequence numbers of its items. The list is allocated if NULL
+enum dicey_error dicey_batch_requests_add(struct dicey_batch_requests **list_ptr, struct dicey_batch_request *batch);
+
+// deletes the list and all the batches in it
+void dicey_batch_requests_delete(struct dicey_batch_requests *list);
+
+// finds the batch owning the item with the given seq, and writes the index of the item in `item`
+struct dicey_batch_request *dicey_batch_requests_find(struct dicey_batch_requests *list, uint32_t seq, size_t *item);
+
+typedef bool dicey_batch_request_prune_fn(const struct dicey_request *req, void *ctx);
+
+// fails with `err` every item still pending on the user for which prune_fn returns true
+void dicey_batch_requests_prune(
+    struct dicey_batch_requests *list,
+    dicey_batch_request_prune_fn *prune_fn,
+    void *ctx,
+    enum dicey_error err
+);
+
+// removes and returns a batch that's done, if there's any. The caller owns the returned batch
+struct dicey_batch_request *dicey_batch_requests_take_done(struct dicey_batch_requests *list);
+
+#endif // PROGBXAOSJ_BATCH_REQS_H
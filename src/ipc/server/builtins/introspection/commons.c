@@ -36,7 +36,7 @@ enum dicey_error introspection_init_builder(
         return err;
     }
 
-    err = dicey_message_builder_begin(builder, DICEY_OP_RESPONSE);
+    err = dicey_message_builder_begin_streaming(builder, DICEY_OP_RESPONSE);
     if (err) {
         goto fail;
     }
@@ -19,6 +19,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <dicey/core/builders.h>
@@ -48,9 +49,11 @@ enum introspection_op {
     INTROSPECTION_OP_INVALID = 0,
     INTROSPECTION_OP_GET_DATA,
     INTROSPECTION_OP_GET_XML,
+    INTROSPECTION_OP_REGISTRY_GET_GENERATION,
     INTROSPECTION_OP_REGISTRY_GET_OBJS,
     INTROSPECTION_OP_REGISTRY_GET_PATHS,
     INTROSPECTION_OP_REGISTRY_GET_TRAITS,
+    INTROSPECTION_OP_REGISTRY_CHANGES_SINCE,
     INTROSPECTION_OP_REGISTRY_ELEMENT_EXISTS,
     INTROSPECTION_OP_REGISTRY_PATH_EXISTS,
     INTROSPECTION_OP_REGISTRY_PATH_IS_ALIAS,
@@ -79,6 +82,13 @@ static const struct dicey_default_element introspection_elements[] = {
 };
 
 static const struct dicey_default_element registry_elements[] = {
+    {
+     .name = DICEY_REGISTRY_GENERATION_PROP_NAME,
+     .type = DICEY_ELEMENT_TYPE_PROPERTY,
+     .signature = DICEY_REGISTRY_GENERATION_PROP_SIG,
+     .flags = DICEY_ELEMENT_READONLY,
+     .opcode = INTROSPECTION_OP_REGISTRY_GET_GENERATION,
+     },
     {
      .name = DICEY_REGISTRY_OBJECTS_PROP_NAME,
      .type = DICEY_ELEMENT_TYPE_PROPERTY,
@@ -100,6 +110,12 @@ static const struct dicey_default_element registry_elements[] = {
      .flags = DICEY_ELEMENT_READONLY,
      .opcode = INTROSPECTION_OP_REGISTRY_GET_TRAITS,
      },
+    {
+     .name = DICEY_REGISTRY_CHANGES_SINCE_OP_NAME,
+     .type = DICEY_ELEMENT_TYPE_OPERATION,
+     .signature = DICEY_REGISTRY_CHANGES_SINCE_OP_SIG,
+     .opcode = INTROSPECTION_OP_REGISTRY_CHANGES_SINCE,
+     },
     {
      .name = DICEY_REGISTRY_ELEMENT_EXISTS_OP_NAME,
      .type = DICEY_ELEMENT_TYPE_OPERATION,
@@ -130,6 +146,11 @@ static const struct dicey_default_element registry_elements[] = {
      .signature = DICEY_REGISTRY_TRAIT_EXISTS_OP_SIG,
      .opcode = INTROSPECTION_OP_REGISTRY_TRAIT_EXISTS,
      },
+    {
+     .name = DICEY_REGISTRY_CHANGED_SIGNAL_NAME,
+     .type = DICEY_ELEMENT_TYPE_SIGNAL,
+     .signature = DICEY_REGISTRY_CHANGED_SIGNAL_SIG,
+     },
 };
 
 static const struct dicey_default_element trait_elements[] = {
@@ -274,6 +295,9 @@ static enum dicey_error perform_introspection_op(
     case INTROSPECTION_OP_GET_XML:
         return introspection_dump_xml(registry, path, response);
 
+    case INTROSPECTION_OP_REGISTRY_GET_GENERATION:
+        return introspection_craft_generation(registry, response);
+
     case INTROSPECTION_OP_REGISTRY_GET_PATHS:
         return introspection_craft_pathlist(registry, response);
 
@@ -283,6 +307,18 @@ static enum dicey_error perform_introspection_op(
     case INTROSPECTION_OP_REGISTRY_GET_TRAITS:
         return introspection_craft_traitlist(registry, response);
 
+    case INTROSPECTION_OP_REGISTRY_CHANGES_SINCE:
+        {
+            assert(value);
+
+            uint64_t since = 0U;
+
+            // this operation consumes a generation and returns the changes made after it
+            const enum dicey_error err = dicey_value_get_u64(value, &since);
+
+            return err ? err : introspection_craft_changes_since(registry, since, response);
+        }
+
     case INTROSPECTION_OP_REGISTRY_ELEMENT_EXISTS:
         {
             assert(value);
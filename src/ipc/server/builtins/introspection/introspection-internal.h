@@ -17,6 +17,8 @@
 #if !defined(JTHRFVRFQF_INTERNAL_H)
 #define JTHRFVRFQF_INTERNAL_H
 
+#include <stdint.h>
+
 #include <libxml/xmlstring.h>
 
 #include <dicey/core/builders.h>
@@ -50,6 +52,12 @@ enum dicey_error introspection_check_trait_exists(
     struct dicey_packet *dest
 );
 
+enum dicey_error introspection_craft_changes_since(
+    const struct dicey_registry *registry,
+    uint64_t since,
+    struct dicey_packet *dest
+);
+
 enum dicey_error introspection_craft_filtered_elemlist(
     const struct dicey_registry *registry,
     const char *path,
@@ -58,9 +66,12 @@ enum dicey_error introspection_craft_filtered_elemlist(
     struct dicey_packet *dest
 );
 
-enum dicey_error introspection_craft_objlist(const struct dicey_registry *registry, struct dicey_packet *dest);
-enum dicey_error introspection_craft_pathlist(const struct dicey_registry *registry, struct dicey_packet *dest);
-enum dicey_error introspection_craft_traitlist(const struct dicey_registry *registry, struct dicey_packet *dest);
+enum dicey_error introspection_craft_generation(const struct dicey_registry *registry, struct dicey_packet *dest);
+
+// the listings are cached on the registry, and rebuilt only after it changes
+enum dicey_error introspection_craft_objlist(struct dicey_registry *registry, struct dicey_packet *dest);
+enum dicey_error introspection_craft_pathlist(struct dicey_registry *registry, struct dicey_packet *dest);
+enum dicey_error introspection_craft_traitlist(struct dicey_registry *registry, struct dicey_packet *dest);
 
 enum dicey_error introspection_dump_object(
     struct dicey_registry *registry,
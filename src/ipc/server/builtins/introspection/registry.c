@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include <libxml/xmlstring.h>
 
@@ -24,14 +25,17 @@
 #include <dicey/core/errors.h>
 #include <dicey/core/hashset.h>
 #include <dicey/core/hashtable.h>
+#include <dicey/core/packet.h>
 #include <dicey/core/type.h>
 #include <dicey/ipc/builtins/introspection.h>
 #include <dicey/ipc/registry.h>
 #include <dicey/ipc/traits.h>
 
 #include "sup/trace.h"
+#include "sup/util.h"
 
 #include "../../registry-internal.h"
+#include "../../registry-journal.h"
 
 #include "introspection-internal.h"
 
@@ -161,6 +165,41 @@ fail:
     return err;
 }
 
+// (tcss)
+static enum dicey_error populate_change(
+    const struct dicey_registry_change *const change,
+    struct dicey_value_builder *const value
+) {
+    assert(change && value);
+
+    enum dicey_error err = dicey_value_builder_tuple_start(value);
+    if (err) {
+        return err;
+    }
+
+    const struct dicey_arg fields[] = {
+        { .type = DICEY_TYPE_UINT64, .u64 = change->generation },
+        { .type = DICEY_TYPE_BYTE, .byte = (dicey_byte) change->kind },
+        { .type = DICEY_TYPE_STR, .str = change->subject },
+        { .type = DICEY_TYPE_STR, .str = change->target ? change->target : "" },
+    };
+
+    for (size_t i = 0U; i < DICEY_LENOF(fields); ++i) {
+        struct dicey_value_builder field = { 0 };
+        err = dicey_value_builder_next(value, &field);
+        if (err) {
+            return err;
+        }
+
+        err = dicey_value_builder_set(&field, fields[i]);
+        if (err) {
+            return err;
+        }
+    }
+
+    return dicey_value_builder_tuple_end(value);
+}
+
 static enum dicey_error populate_element_kind(
     const enum dicey_element_type type,
     struct dicey_value_builder *const value
@@ -463,24 +502,7 @@ enum dicey_error introspection_check_trait_exists(
     );
 }
 
-enum dicey_error introspection_craft_objlist(
-    const struct dicey_registry *const registry,
-    struct dicey_packet *const dest
-) {
-    return craft_pathlist(registry, PATHLIST_NO_ALIASES, dest);
-}
-
-enum dicey_error introspection_craft_pathlist(
-    const struct dicey_registry *const registry,
-    struct dicey_packet *const dest
-) {
-    return craft_pathlist(registry, PATHLIST_ALL, dest);
-}
-
-enum dicey_error introspection_craft_traitlist(
-    const struct dicey_registry *const registry,
-    struct dicey_packet *const dest
-) {
+static enum dicey_error craft_traitlist(const struct dicey_registry *const registry, struct dicey_packet *const dest) {
     assert(registry && dest);
 
     struct dicey_hashtable_iter iter = dicey_hashtable_iter_start(registry->traits);
@@ -550,6 +572,235 @@ fail:
     return err;
 }
 
+enum dicey_error introspection_craft_changes_since(
+    const struct dicey_registry *const registry,
+    const uint64_t since,
+    struct dicey_packet *const dest
+) {
+    assert(registry && dest);
+
+    const struct dicey_registry_journal *const journal = &registry->journal;
+
+    // a generation from the future was not handed out by this registry (e.g. it comes from a previous server), and the
+    // journal only knows about the latest changes: in both cases the caller must list everything again
+    size_t first = journal->len;
+    const bool resync = since > registry->generation || !dicey_registry_journal_since(journal, since, &first);
+    if (resync) {
+        first = journal->len;
+    }
+
+    struct dicey_message_builder builder = { 0 };
+    enum dicey_error err = introspection_init_builder(
+        &builder, DICEY_REGISTRY_PATH, DICEY_REGISTRY_TRAIT_NAME, DICEY_REGISTRY_CHANGES_SINCE_OP_NAME
+    );
+
+    if (err) {
+        goto fail;
+    }
+
+    struct dicey_value_builder value_builder = { 0 };
+    err = dicey_message_builder_value_start(&builder, &value_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_value_builder_tuple_start(&value_builder);
+    if (err) {
+        goto fail;
+    }
+
+    struct dicey_value_builder generation_builder = { 0 };
+    err = dicey_value_builder_next(&value_builder, &generation_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_value_builder_set(
+        &generation_builder,
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_UINT64,
+            .u64 = registry->generation,
+        }
+    );
+
+    if (err) {
+        goto fail;
+    }
+
+    struct dicey_value_builder resync_builder = { 0 };
+    err = dicey_value_builder_next(&value_builder, &resync_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_value_builder_set(
+        &resync_builder,
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_BOOL,
+            .boolean = resync,
+        }
+    );
+
+    if (err) {
+        goto fail;
+    }
+
+    struct dicey_value_builder changes_builder = { 0 };
+    err = dicey_value_builder_next(&value_builder, &changes_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_value_builder_array_start(&changes_builder, DICEY_TYPE_TUPLE);
+    if (err) {
+        goto fail;
+    }
+
+    for (size_t i = first; i < journal->len; ++i) {
+        struct dicey_value_builder change_builder = { 0 };
+        err = dicey_value_builder_next(&changes_builder, &change_builder);
+        if (err) {
+            goto fail;
+        }
+
+        err = populate_change(dicey_registry_journal_get(journal, i), &change_builder);
+        if (err) {
+            goto fail;
+        }
+    }
+
+    err = dicey_value_builder_array_end(&changes_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_value_builder_tuple_end(&value_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_message_builder_value_end(&builder, &value_builder);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_message_builder_build(&builder, dest);
+    if (err) {
+        goto fail;
+    }
+
+    return DICEY_OK;
+
+fail:
+    dicey_message_builder_discard(&builder);
+
+    return err;
+}
+
+enum dicey_error introspection_craft_generation(
+    const struct dicey_registry *const registry,
+    struct dicey_packet *const dest
+) {
+    assert(registry && dest);
+
+    struct dicey_message_builder builder = { 0 };
+    enum dicey_error err = introspection_init_builder(
+        &builder, DICEY_REGISTRY_PATH, DICEY_REGISTRY_TRAIT_NAME, DICEY_REGISTRY_GENERATION_PROP_NAME
+    );
+
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_message_builder_set_value(
+        &builder,
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_UINT64,
+            .u64 = registry->generation,
+        }
+    );
+
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_message_builder_build(&builder, dest);
+    if (err) {
+        goto fail;
+    }
+
+    return DICEY_OK;
+
+fail:
+    dicey_message_builder_discard(&builder);
+
+    return err;
+}
+
+static enum dicey_error craft_listing(
+    const struct dicey_registry *const registry,
+    const enum dicey_registry_listing kind,
+    struct dicey_packet *const dest
+) {
+    switch (kind) {
+    case DICEY_REGISTRY_LISTING_PATHS:
+        return craft_pathlist(registry, PATHLIST_ALL, dest);
+
+    case DICEY_REGISTRY_LISTING_OBJECTS:
+        return craft_pathlist(registry, PATHLIST_NO_ALIASES, dest);
+
+    case DICEY_REGISTRY_LISTING_TRAITS:
+        return craft_traitlist(registry, dest);
+
+    default:
+        assert(false);
+
+        return TRACE(DICEY_EINVAL);
+    }
+}
+
+// answers with a copy of the cached listing, rebuilding it first if the registry changed since it was last built
+static enum dicey_error serve_listing(
+    struct dicey_registry *const registry,
+    const enum dicey_registry_listing kind,
+    struct dicey_packet *const dest
+) {
+    assert(registry && kind < DICEY_REGISTRY_LISTING_COUNT && dest);
+
+    struct dicey_registry_cached_listing *const cached = &registry->listings[kind];
+
+    if (!dicey_packet_is_valid(cached->packet) || cached->generation != registry->generation) {
+        struct dicey_packet fresh = { 0 };
+
+        const enum dicey_error err = craft_listing(registry, kind, &fresh);
+        if (err) {
+            return err;
+        }
+
+        dicey_packet_deinit(&cached->packet);
+
+        *cached = (struct dicey_registry_cached_listing) {
+            .generation = registry->generation,
+            .packet = fresh,
+        };
+    }
+
+    // the seq is stamped by the server on the copy, so the cached packet is never modified
+    return dicey_packet_clone(dest, cached->packet);
+}
+
+enum dicey_error introspection_craft_objlist(struct dicey_registry *const registry, struct dicey_packet *const dest) {
+    return serve_listing(registry, DICEY_REGISTRY_LISTING_OBJECTS, dest);
+}
+
+enum dicey_error introspection_craft_pathlist(struct dicey_registry *const registry, struct dicey_packet *const dest) {
+    return serve_listing(registry, DICEY_REGISTRY_LISTING_PATHS, dest);
+}
+
+enum dicey_error introspection_craft_traitlist(struct dicey_registry *const registry, struct dicey_packet *const dest) {
+    return serve_listing(registry, DICEY_REGISTRY_LISTING_TRAITS, dest);
+}
+
 enum dicey_error introspection_dump_object(
     struct dicey_registry *const registry,
     const char *const path,
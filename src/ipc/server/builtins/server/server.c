@@ -35,16 +35,24 @@
 
 #include "ipc/elemdescr.h"
 #include "ipc/server/builtins/builtins.h"
+#include "ipc/server/batch-reqs.h"
 #include "ipc/server/client-data.h"
+#include "ipc/server/server-internal.h"
 
 #include "sup/trace.h"
 #include "sup/util.h"
 
+#include "wirefmt/packet-args.h"
+
 #include "server.h"
 
 enum server_op {
     SERVER_OP_EVENT_SUBSCRIBE = 0,
     SERVER_OP_EVENT_UNSUBSCRIBE,
+    SERVER_OP_EVENT_SUBSCRIBE_MANY,
+    SERVER_OP_EVENT_UNSUBSCRIBE_MANY,
+    SERVER_OP_BATCH_GET_MANY,
+    SERVER_OP_BATCH_SET_MANY,
 };
 
 static const struct dicey_default_element em_elements[] = {
@@ -60,14 +68,43 @@ static const struct dicey_default_element em_elements[] = {
      .signature = DICEY_EVENTMANAGER_UNSUBSCRIBE_OP_SIG,
      .opcode = SERVER_OP_EVENT_UNSUBSCRIBE,
      },
+    {
+     .name = DICEY_EVENTMANAGER_SUBSCRIBE_MANY_OP_NAME,
+     .type = DICEY_ELEMENT_TYPE_OPERATION,
+     .signature = DICEY_EVENTMANAGER_SUBSCRIBE_MANY_OP_SIG,
+     .opcode = SERVER_OP_EVENT_SUBSCRIBE_MANY,
+     },
+    {
+     .name = DICEY_EVENTMANAGER_UNSUBSCRIBE_MANY_OP_NAME,
+     .type = DICEY_ELEMENT_TYPE_OPERATION,
+     .signature = DICEY_EVENTMANAGER_UNSUBSCRIBE_MANY_OP_SIG,
+     .opcode = SERVER_OP_EVENT_UNSUBSCRIBE_MANY,
+     },
+};
+
+static const struct dicey_default_element batch_elements[] = {
+    {
+     .name = DICEY_BATCH_GET_MANY_OP_NAME,
+     .type = DICEY_ELEMENT_TYPE_OPERATION,
+     .signature = DICEY_BATCH_GET_MANY_OP_SIG,
+     .opcode = SERVER_OP_BATCH_GET_MANY,
+     },
+    {
+     .name = DICEY_BATCH_SET_MANY_OP_NAME,
+     .type = DICEY_ELEMENT_TYPE_OPERATION,
+     .signature = DICEY_BATCH_SET_MANY_OP_SIG,
+     .opcode = SERVER_OP_BATCH_SET_MANY,
+     },
 };
 
 static const struct dicey_default_trait server_traits[] = {
     {.name = DICEY_EVENTMANAGER_TRAIT_NAME, .elements = em_elements, .num_elements = DICEY_LENOF(em_elements)},
+    {.name = DICEY_BATCH_TRAIT_NAME, .elements = batch_elements, .num_elements = DICEY_LENOF(batch_elements)},
 };
 
 static const char *const server_object_traits[] = {
     DICEY_EVENTMANAGER_TRAIT_NAME,
+    DICEY_BATCH_TRAIT_NAME,
 
 #if DICEY_HAS_PLUGINS
 
@@ -113,6 +150,190 @@ static enum dicey_error extract_path_sel(
     return DICEY_OK;
 }
 
+static enum dicey_error list_len(const struct dicey_list *const list, size_t *const dest) {
+    assert(list && dest);
+
+    size_t len = 0U;
+
+    for (struct dicey_iterator iter = dicey_list_iter(list); dicey_iterator_has_next(iter); ++len) {
+        struct dicey_value item = { 0 };
+
+        const enum dicey_error err = dicey_iterator_next(&iter, &item);
+        if (err) {
+            return err;
+        }
+    }
+
+    *dest = len;
+
+    return DICEY_OK;
+}
+
+// extracts an item of SetMany, with signature (@%v)
+static enum dicey_error extract_path_sel_value(
+    const struct dicey_value *const value,
+    const char **const path,
+    struct dicey_selector *const sel,
+    struct dicey_value *const payload
+) {
+    assert(value && path && sel && payload);
+
+    struct dicey_list tuple = { 0 };
+
+    enum dicey_error err = dicey_value_get_tuple(value, &tuple);
+    if (err) {
+        return err;
+    }
+
+    struct dicey_iterator iter = dicey_list_iter(&tuple);
+
+    struct dicey_value elem = { 0 };
+
+    err = dicey_iterator_next(&iter, &elem);
+    if (err) {
+        return err;
+    }
+
+    err = dicey_value_get_path(&elem, path);
+    if (err) {
+        return err;
+    }
+
+    err = dicey_iterator_next(&iter, &elem);
+    if (err) {
+        return err;
+    }
+
+    err = dicey_value_get_selector(&elem, sel);
+    if (err) {
+        return err;
+    }
+
+    err = dicey_iterator_next(&iter, payload);
+    if (err) {
+        return err;
+    }
+
+    return dicey_iterator_has_next(iter) ? TRACE(DICEY_EINVAL) : DICEY_OK;
+}
+
+// crafts the standalone GET or SET request for an item of a batch. The seq is set later by the server
+static enum dicey_error item_packet_for(
+    struct dicey_packet *const dest,
+    const enum dicey_op op,
+    const struct dicey_value *const item
+) {
+    assert(dest && item);
+
+    const char *path = NULL;
+    struct dicey_selector sel = { 0 };
+    struct dicey_value payload = { 0 };
+
+    enum dicey_error err =
+        op == DICEY_OP_SET ? extract_path_sel_value(item, &path, &sel, &payload) : extract_path_sel(item, &path, &sel);
+    if (err) {
+        return err;
+    }
+
+    struct dicey_arg arg = { 0 }; // GETs carry no value
+
+    if (op == DICEY_OP_SET) {
+        err = dicey_arg_from_borrowed_value(&arg, &payload);
+        if (err) {
+            return err;
+        }
+    }
+
+    err = dicey_packet_message(dest, 0U, op, path, sel, arg);
+
+    dicey_arg_free_contents(&arg);
+
+    return err;
+}
+
+static enum dicey_error handle_batch_operation(
+    struct dicey_builtin_request *const req,
+    struct dicey_packet *const response
+) {
+    assert(dicey_builtin_request_is_valid(req) && response);
+
+    const enum dicey_op op = req->opcode == SERVER_OP_BATCH_SET_MANY ? DICEY_OP_SET : DICEY_OP_GET;
+
+    struct dicey_list items = { 0 };
+
+    enum dicey_error err = dicey_value_get_array(req->value, &items);
+    if (err) {
+        return err;
+    }
+
+    size_t nitems = 0U;
+
+    err = list_len(&items, &nitems);
+    if (err) {
+        return err;
+    }
+
+    struct dicey_packet *const packets = calloc(nitems ? nitems : 1U, sizeof *packets);
+    if (!packets) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    struct dicey_batch_request *batch = NULL;
+
+    struct dicey_iterator iter = dicey_list_iter(&items);
+    for (size_t i = 0U; i < nitems; ++i) {
+        struct dicey_value item = { 0 };
+
+        err = dicey_iterator_next(&iter, &item);
+        if (err) {
+            goto fail;
+        }
+
+        // malformed items fail the whole batch, like a malformed request would
+        err = item_packet_for(&packets[i], op, &item);
+        if (err) {
+            goto fail;
+        }
+    }
+
+    batch = dicey_batch_request_new(*req->source, req->path, req->entry->sel, nitems);
+    if (!batch) {
+        err = TRACE(DICEY_ENOMEM);
+
+        goto fail;
+    }
+
+    // steal the request: the batch needs it to stay alive until the response is sent, given it owns the path. There's
+    // no response to send right now either, the server sends it once all the items are done
+    *req->source = DICEY_EMPTY_PACKET;
+
+    err = dicey_server_dispatch_batch_internal(req->client->parent, req->client, batch, packets);
+    if (err) {
+        // give the request back, so that the error can be reported to the client
+        *req->source = batch->source;
+        batch->source = DICEY_EMPTY_PACKET;
+
+        goto fail;
+    }
+
+    free(packets);
+
+    *response = DICEY_EMPTY_PACKET;
+
+    return DICEY_OK;
+
+fail:
+    dicey_batch_request_delete(batch);
+
+    for (size_t i = 0U; i < nitems; ++i) {
+        dicey_packet_deinit(&packets[i]);
+    }
+
+    free(packets);
+
+    return err;
+}
+
 static enum dicey_error message_for(
     struct dicey_packet *const dest,
     const char *const path,
@@ -193,20 +414,16 @@ static enum dicey_error unit_message_for(
     );
 }
 
-static enum dicey_error handle_server_operation(
-    struct dicey_builtin_context *ctx,
-    struct dicey_builtin_request *const req,
-    struct dicey_packet *const response
+// subscribes or unsubscribes the client to a signal. On success, main_path is set to the path the signal is raised from
+static enum dicey_error server_subunsub(
+    struct dicey_builtin_context *const ctx,
+    struct dicey_client_data *const client,
+    const bool subscribe,
+    const char *const path,
+    const struct dicey_selector sel,
+    const char **const main_path
 ) {
-    assert(dicey_builtin_request_is_valid(req) && response);
-
-    const char *path = NULL;
-    struct dicey_selector sel = { 0 };
-
-    enum dicey_error err = extract_path_sel(req->value, &path, &sel);
-    if (err) {
-        return err;
-    }
+    assert(dicey_builtin_context_is_valid(ctx) && client && path && main_path);
 
     struct dicey_object_element_entry entry = { 0 };
     const bool found = dicey_registry_get_element_entry(ctx->registry, path, sel.trait, sel.elem, &entry);
@@ -231,32 +448,136 @@ static enum dicey_error handle_server_operation(
         return TRACE(DICEY_ENOMEM);
     }
 
-    switch (req->opcode) {
-    case SERVER_OP_EVENT_SUBSCRIBE:
-        {
-            err = dicey_client_data_subscribe(req->client, elemdescr);
+    if (subscribe) {
+        const enum dicey_error err = dicey_client_data_subscribe(client, elemdescr);
+        if (err) {
+            return err;
+        }
+    } else if (!dicey_client_data_unsubscribe(client, elemdescr)) {
+        // do not trace the result of this operation, the ENOENT should be reported to the client without blocking
+        // the server
+        return DICEY_ENOENT;
+    }
+
+    *main_path = entry.main_path;
+
+    return DICEY_OK;
+}
+
+static enum dicey_error handle_server_operation(
+    struct dicey_builtin_context *ctx,
+    struct dicey_builtin_request *const req,
+    struct dicey_packet *const response
+) {
+    assert(dicey_builtin_request_is_valid(req) && response);
+
+    const char *path = NULL;
+    struct dicey_selector sel = { 0 };
+
+    enum dicey_error err = extract_path_sel(req->value, &path, &sel);
+    if (err) {
+        return err;
+    }
 
-            if (err) {
-                return err;
-            }
+    const bool subscribe = req->opcode == SERVER_OP_EVENT_SUBSCRIBE;
 
-            const bool targets_alias = strcmp(entry.main_path, path) != 0;
+    const char *main_path = NULL;
 
-            return targets_alias ? path_message_for(response, path, sel, entry.main_path)
-                                 : unit_message_for(response, path, sel);
+    err = server_subunsub(ctx, req->client, subscribe, path, sel, &main_path);
+    if (err) {
+        return err;
+    }
+
+    const bool targets_alias = subscribe && strcmp(main_path, path) != 0;
+
+    return targets_alias ? path_message_for(response, path, sel, main_path) : unit_message_for(response, path, sel);
+}
+
+// same as handle_server_operation, but for a whole list of signals. Entries that fail don't affect the others; the
+// reply has one result per entry, with either unit, the main path of the object (for subscriptions to aliases) or an
+// error
+static enum dicey_error handle_server_many_operation(
+    struct dicey_builtin_context *ctx,
+    struct dicey_builtin_request *const req,
+    struct dicey_packet *const response
+) {
+    assert(dicey_builtin_request_is_valid(req) && response);
+
+    const bool subscribe = req->opcode == SERVER_OP_EVENT_SUBSCRIBE_MANY;
+
+    struct dicey_list entries = { 0 };
+
+    enum dicey_error err = dicey_value_get_array(req->value, &entries);
+    if (err) {
+        return err;
+    }
+
+    size_t nentries = 0U;
+
+    err = list_len(&entries, &nentries);
+    if (err) {
+        return err;
+    }
+
+    if (nentries > UINT16_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    struct dicey_arg *const results = calloc(nentries ? nentries : 1U, sizeof *results);
+    if (!results) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    struct dicey_iterator iter = dicey_list_iter(&entries);
+    for (size_t i = 0U; i < nentries; ++i) {
+        struct dicey_value entry = { 0 };
+
+        err = dicey_iterator_next(&iter, &entry);
+        if (err) {
+            goto quit;
         }
 
-    case SERVER_OP_EVENT_UNSUBSCRIBE:
-        // do not trace the result of this operation, the ENOENT should be reported to the client without blocking
-        // the server
-        err = dicey_client_data_unsubscribe(req->client, elemdescr) ? DICEY_OK : DICEY_ENOENT;
+        const char *path = NULL;
+        struct dicey_selector sel = { 0 };
 
-        return err ? err : unit_message_for(response, path, sel);
+        err = extract_path_sel(&entry, &path, &sel);
+        if (err) {
+            goto quit;
+        }
 
-    default:
-        assert(false);
-        return TRACE(DICEY_EINVAL);
+        const char *main_path = NULL;
+
+        // the main paths are owned by the registry, and the rest by the request: it's safe to borrow all of them
+        const enum dicey_error entry_err = server_subunsub(ctx, req->client, subscribe, path, sel, &main_path);
+        if (entry_err) {
+            results[i] = (struct dicey_arg) {
+                .type = DICEY_TYPE_ERROR,
+                .error = {
+                    .code = (uint16_t) entry_err,
+                    .message = dicey_error_msg(entry_err),
+                },
+            };
+        } else if (subscribe && strcmp(main_path, path) != 0) {
+            results[i] = (struct dicey_arg) { .type = DICEY_TYPE_PATH, .path = main_path };
+        } else {
+            results[i] = (struct dicey_arg) { .type = DICEY_TYPE_UNIT };
+        }
     }
+
+    err = message_for(
+        response,
+        req->path,
+        req->entry->sel,
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_TUPLE,
+            .tuple = { .nitems = (uint16_t) nentries, .elems = results },
+        }
+    );
+
+quit:
+    free(results);
+
+    return err;
 }
 
 static ptrdiff_t builtin_handler(
@@ -264,7 +585,28 @@ static ptrdiff_t builtin_handler(
     struct dicey_builtin_request *const req,
     struct dicey_packet *const response
 ) {
-    const enum dicey_error err = handle_server_operation(ctx, req, response);
+    enum dicey_error err = DICEY_OK;
+
+    switch (req->opcode) {
+    case SERVER_OP_EVENT_SUBSCRIBE:
+    case SERVER_OP_EVENT_UNSUBSCRIBE:
+        err = handle_server_operation(ctx, req, response);
+        break;
+
+    case SERVER_OP_EVENT_SUBSCRIBE_MANY:
+    case SERVER_OP_EVENT_UNSUBSCRIBE_MANY:
+        err = handle_server_many_operation(ctx, req, response);
+        break;
+
+    case SERVER_OP_BATCH_GET_MANY:
+    case SERVER_OP_BATCH_SET_MANY:
+        err = handle_batch_operation(req, response);
+        break;
+
+    default:
+        assert(false);
+        err = TRACE(DICEY_EINVAL);
+    }
 
     // server builtin operations don't alter the client state
     return err ? err : CLIENT_DATA_STATE_RUNNING;
@@ -29,8 +29,10 @@
 
 #include "sup/trace.h"
 #include "sup/unsafe.h"
+#include "sup/util.h"
 
 #include "client-data.h"
+#include "server-internal.h"
 
 #define BASE_CAP 128
 
@@ -63,7 +65,9 @@ static enum dicey_error finish_client_data_cleanup(struct dicey_client_data *cli
     if (client) {
         dicey_hashset_delete(client->subscriptions);
 
-        free(client->chunk);
+        dicey_chunk_deinit(&client->chunk);
+        dicey_outbound_queue_deinit(&client->outbound);
+        dicey_batch_requests_delete(client->batches);
         free(client->pending);
         free(client);
     }
@@ -93,6 +97,10 @@ struct dicey_client_data *dicey_client_data_init(
             .id = id,
         },
 
+        .outbound_max_bytes = parent->client_max_bytes,
+        .outbound_max_packets = parent->client_max_packets,
+        .overflow_policy = parent->overflow_policy,
+
         .parent = parent,
     };
 
@@ -133,7 +141,7 @@ void dicey_client_data_set_state(struct dicey_client_data *const client, const e
 }
 
 enum dicey_error dicey_client_data_subscribe(struct dicey_client_data *const client, const char *const elemdescr) {
-    assert(client && elemdescr);
+    assert(client && client->parent && elemdescr);
 
     switch (dicey_hashset_add(&client->subscriptions, elemdescr)) {
     case DICEY_HASH_SET_FAILED:
@@ -141,6 +149,17 @@ enum dicey_error dicey_client_data_subscribe(struct dicey_client_data *const cli
         return TRACE(DICEY_ENOMEM);
 
     case DICEY_HASH_SET_ADDED:
+        {
+            const enum dicey_error err =
+                dicey_subscription_index_add(&client->parent->subscribers, elemdescr, client->info.id);
+            if (err) {
+                // keep the client and the index in sync
+                (void) dicey_hashset_remove(client->subscriptions, elemdescr);
+            }
+
+            return err;
+        }
+
     case DICEY_HASH_SET_UPDATED: // we're lenient here, we don't care if the client is already subscribed
         return DICEY_OK;
 
@@ -150,9 +169,31 @@ enum dicey_error dicey_client_data_subscribe(struct dicey_client_data *const cli
 }
 
 bool dicey_client_data_unsubscribe(struct dicey_client_data *const client, const char *const elemdescr) {
-    assert(client && elemdescr);
+    assert(client && client->parent && elemdescr);
+
+    if (!dicey_hashset_remove(client->subscriptions, elemdescr)) {
+        return false;
+    }
+
+    const bool removed = dicey_subscription_index_remove(&client->parent->subscribers, elemdescr, client->info.id);
+    assert(removed);
+    DICEY_UNUSED(removed);
+
+    return true;
+}
+
+void dicey_client_data_unsubscribe_all(struct dicey_client_data *const client) {
+    assert(client && client->parent);
+
+    struct dicey_hashset_iter iter = dicey_hashset_iter_start(client->subscriptions);
+    const char *elemdescr = NULL;
+
+    while (dicey_hashset_iter_next(&iter, &elemdescr)) {
+        (void) dicey_subscription_index_remove(&client->parent->subscribers, elemdescr, client->info.id);
+    }
 
-    return dicey_hashset_remove(client->subscriptions, elemdescr);
+    dicey_hashset_delete(client->subscriptions);
+    client->subscriptions = NULL;
 }
 
 struct dicey_client_data *const *dicey_client_list_begin(const struct dicey_client_list *const list) {
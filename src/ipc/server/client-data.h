@@ -32,6 +32,8 @@
 
 #include "ipc/chunk.h"
 
+#include "batch-reqs.h"
+#include "outbound.h"
 #include "pending-reqs.h"
 
 #include "dicey_config.h"
@@ -73,11 +75,22 @@ struct dicey_client_data {
 
     struct dicey_client_info info;
 
-    struct dicey_chunk *chunk;
+    struct dicey_chunk chunk;
+    struct dicey_outbound_queue outbound;
+
+    // outbound budget, see dicey_server_args. inflight_packets counts the packets handed to libuv but not yet written
+    size_t outbound_max_bytes;
+    size_t outbound_max_packets;
+    enum dicey_server_overflow_policy overflow_policy;
+    size_t inflight_packets;
+
+    bool over_budget;    // true from when the budget is exceeded until the client catches up
+    bool reading_paused; // true if reading was stopped by DICEY_SERVER_OVERFLOW_PAUSE_READING
 
     struct dicey_server *parent;
 
     struct dicey_pending_requests *pending;
+    struct dicey_batch_requests *batches; // GetMany and SetMany requests waiting for the responses of their items
 
     struct dicey_hashset *subscriptions;
 
@@ -98,6 +111,7 @@ struct dicey_client_data *dicey_client_data_new(struct dicey_server *parent, siz
 void dicey_client_data_set_state(struct dicey_client_data *client, enum dicey_client_data_state state);
 enum dicey_error dicey_client_data_subscribe(struct dicey_client_data *client, const char *elemdescr);
 bool dicey_client_data_unsubscribe(struct dicey_client_data *client, const char *elemdescr);
+void dicey_client_data_unsubscribe_all(struct dicey_client_data *client);
 
 struct dicey_client_list;
 
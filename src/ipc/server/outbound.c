@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <uv.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/message.h>
+#include <dicey/core/packet.h>
+
+#include "sup/trace.h"
+#include "sup/util.h"
+
+#include "outbound.h"
+#include "shared-packet.h"
+
+#define OUTBOUND_QUEUE_MINCAP 16U
+
+struct dicey_packet dicey_outbound_packet_borrow(const struct dicey_outbound_packet packet) {
+    switch (packet.kind) {
+    case DICEY_OP_RESPONSE:
+        return packet.single;
+
+    case DICEY_OP_SIGNAL:
+        return dicey_shared_packet_borrow(packet.shared);
+
+    default:
+        assert(false);
+
+        return (struct dicey_packet) { 0 };
+    }
+}
+
+void dicey_outbound_packet_cleanup(struct dicey_outbound_packet *const packet) {
+    assert(packet);
+
+    switch (packet->kind) {
+    case DICEY_OP_RESPONSE:
+        dicey_packet_deinit(&packet->single);
+
+        break;
+
+    case DICEY_OP_SIGNAL:
+        dicey_shared_packet_unref(packet->shared);
+
+        break;
+
+    default:
+        assert(false);
+
+        break;
+    }
+
+    *packet = (struct dicey_outbound_packet) { 0 };
+}
+
+bool dicey_outbound_packet_is_valid(const struct dicey_outbound_packet packet) {
+    switch (packet.kind) {
+    case DICEY_OP_RESPONSE:
+        return dicey_packet_is_valid(packet.single);
+
+    case DICEY_OP_SIGNAL:
+        return dicey_shared_packet_is_valid(packet.shared);
+
+    default:
+        return false;
+    }
+}
+
+void *dicey_outbound_packet_payload(const struct dicey_outbound_packet packet) {
+    switch (packet.kind) {
+    case DICEY_OP_RESPONSE:
+        return packet.single.payload;
+
+    case DICEY_OP_SIGNAL:
+        return dicey_shared_packet_borrow(packet.shared).payload;
+
+    default:
+        assert(false);
+
+        return NULL;
+    }
+}
+
+size_t dicey_outbound_packet_size(const struct dicey_outbound_packet packet) {
+    switch (packet.kind) {
+    case DICEY_OP_RESPONSE:
+        return packet.single.nbytes;
+
+    case DICEY_OP_SIGNAL:
+        return dicey_shared_packet_size(packet.shared);
+
+    default:
+        assert(false);
+
+        return 0U;
+    }
+}
+
+static bool outbound_queue_grow(struct dicey_outbound_queue *const queue) {
+    assert(queue);
+
+    const size_t new_cap = queue->cap ? queue->cap * 3 / 2 : OUTBOUND_QUEUE_MINCAP;
+    if (new_cap > (size_t) PTRDIFF_MAX / sizeof *queue->packets) {
+        return false;
+    }
+
+    struct dicey_outbound_packet *const packets = realloc(queue->packets, new_cap * sizeof *packets);
+    if (!packets) {
+        return false;
+    }
+
+    queue->packets = packets;
+
+    uv_buf_t *const bufs = realloc(queue->bufs, new_cap * sizeof *bufs);
+    if (!bufs) {
+        return false; // the packet array is larger than needed, but it's harmless
+    }
+
+    queue->bufs = bufs;
+    queue->cap = new_cap;
+
+    return true;
+}
+
+void dicey_outbound_queue_clear(struct dicey_outbound_queue *const queue) {
+    assert(queue);
+
+    for (size_t i = 0U; i < queue->len; ++i) {
+        dicey_outbound_packet_cleanup(&queue->packets[i]);
+    }
+
+    queue->len = 0U;
+    queue->nbytes = 0U;
+}
+
+void dicey_outbound_queue_deinit(struct dicey_outbound_queue *const queue) {
+    if (queue) {
+        dicey_outbound_queue_clear(queue);
+
+        free(queue->packets);
+        free(queue->bufs);
+
+        *queue = (struct dicey_outbound_queue) { 0 };
+    }
+}
+
+enum dicey_error dicey_outbound_queue_push(
+    struct dicey_outbound_queue *const queue,
+    const struct dicey_outbound_packet packet
+) {
+    assert(queue && dicey_outbound_packet_is_valid(packet));
+
+    const size_t nbytes = dicey_outbound_packet_size(packet);
+    if (nbytes > UINT_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    if (queue->len == queue->cap && !outbound_queue_grow(queue)) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    queue->packets[queue->len] = packet;
+    queue->bufs[queue->len] = uv_buf_init(dicey_outbound_packet_payload(packet), (unsigned int) nbytes);
+
+    ++queue->len;
+    queue->nbytes += nbytes;
+
+    return DICEY_OK;
+}
+
+enum dicey_error dicey_outbound_queue_replace(
+    struct dicey_outbound_queue *const queue,
+    const size_t i,
+    const struct dicey_outbound_packet packet
+) {
+    assert(queue && i < queue->len && dicey_outbound_packet_is_valid(packet));
+
+    const size_t nbytes = dicey_outbound_packet_size(packet);
+    if (nbytes > UINT_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    struct dicey_outbound_packet *const old = &queue->packets[i];
+
+    queue->nbytes -= dicey_outbound_packet_size(*old);
+    dicey_outbound_packet_cleanup(old);
+
+    *old = packet;
+    queue->bufs[i] = uv_buf_init(dicey_outbound_packet_payload(packet), (unsigned int) nbytes);
+    queue->nbytes += nbytes;
+
+    return DICEY_OK;
+}
+
+size_t dicey_outbound_queue_take(struct dicey_outbound_queue *const queue, struct dicey_outbound_packet *const dest) {
+    assert(queue && (dest || !queue->len));
+
+    const size_t len = queue->len;
+
+    if (len) {
+        memcpy(dest, queue->packets, len * sizeof *dest);
+    }
+
+    queue->len = 0U;
+    queue->nbytes = 0U;
+
+    return len;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(ZMWQTHRCAE_OUTBOUND_H)
+#define ZMWQTHRCAE_OUTBOUND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <uv.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/message.h>
+#include <dicey/core/packet.h>
+
+#include "shared-packet.h"
+
+// a packet waiting to be sent to a client. Responses are always single packets, while signals are shared between all
+// the clients they are being sent to
+struct dicey_outbound_packet {
+    enum dicey_op kind;
+
+    union {
+        struct dicey_shared_packet *shared;
+        struct dicey_packet single;
+    };
+};
+
+struct dicey_packet dicey_outbound_packet_borrow(struct dicey_outbound_packet packet);
+
+// utility function that either deallocates or decrements the refcount of the packet, depending if it's shared or not
+void dicey_outbound_packet_cleanup(struct dicey_outbound_packet *packet);
+
+bool dicey_outbound_packet_is_valid(struct dicey_outbound_packet packet);
+void *dicey_outbound_packet_payload(struct dicey_outbound_packet packet);
+size_t dicey_outbound_packet_size(struct dicey_outbound_packet packet);
+
+// per-client queue of packets waiting to be written. Packets are accumulated during a loop iteration and then written
+// all at once with a single vectored write. `bufs` always mirrors `packets`, ready to be handed over to uv_write
+struct dicey_outbound_queue {
+    struct dicey_outbound_packet *packets;
+    uv_buf_t *bufs;
+
+    size_t len;
+    size_t cap;
+
+    size_t nbytes; // total number of bytes queued
+
+    bool scheduled; // true if the queue is already in the server's list of queues to flush
+};
+
+// drops all the queued packets, keeping the allocated memory around
+void dicey_outbound_queue_clear(struct dicey_outbound_queue *queue);
+
+void dicey_outbound_queue_deinit(struct dicey_outbound_queue *queue);
+
+// appends a packet to the queue, which takes ownership of it. On failure, the packet is left untouched
+enum dicey_error dicey_outbound_queue_push(struct dicey_outbound_queue *queue, struct dicey_outbound_packet packet);
+
+// replaces the packet at index `i` with `packet`, taking ownership of it. The old packet is cleaned up
+enum dicey_error dicey_outbound_queue_replace(
+    struct dicey_outbound_queue *queue,
+    size_t i,
+    struct dicey_outbound_packet packet
+);
+
+// moves all the queued packets into `dest`, which must have room for at least `queue->len` elements, and empties the
+// queue. The buffers are not touched, so `queue->bufs` must be used before pushing anything else
+size_t dicey_outbound_queue_take(struct dicey_outbound_queue *queue, struct dicey_outbound_packet *dest);
+
+#endif // ZMWQTHRCAE_OUTBOUND_H
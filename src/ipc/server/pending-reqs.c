@@ -58,10 +58,9 @@ static uint32_t next_seq(const uint32_t cur_seq) {
     return cur_seq < UINT32_MAX - 2U ? cur_seq + 2U : FIRST_SEQ;
 }
 
-static void pending_request_invalidate(struct dicey_pending_requests *const reqs, const size_t m) {
-    assert(reqs);
-
-    const size_t i = index_of(reqs, m);
+// invalidates the request at absolute index i, shrinking the live range if the request sits at either end of it
+static void pending_request_invalidate(struct dicey_pending_requests *const reqs, const size_t i) {
+    assert(reqs && i < reqs->cap);
 
     struct dicey_request *const req = &reqs->reqs[i];
 
@@ -74,7 +73,7 @@ static void pending_request_invalidate(struct dicey_pending_requests *const reqs
     if (i == reqs->start) {
         reqs->start = next_index(reqs, i);
     } else if (next_index(reqs, i) == reqs->end) {
-        reqs->end = next_index(reqs, reqs->end);
+        reqs->end = i;
     }
 
     --reqs->len;
@@ -85,6 +84,11 @@ static bool pending_request_is_valid(const struct dicey_request *const req) {
 }
 
 static size_t total_len(const struct dicey_pending_requests *const reqs) {
+    if (reqs->start == reqs->end) {
+        // the live range is either empty or spans the whole buffer
+        return reqs->len ? reqs->cap : 0U;
+    }
+
     const size_t diff = (size_t) llabs((long long) reqs->end - (long long) reqs->start);
 
     assert(diff <= reqs->cap);
@@ -123,9 +127,18 @@ static struct search_result search_seq(struct dicey_pending_requests *const reqs
         if (req->packet_seq < seq) {
             l = m + 1;
         } else if (req->packet_seq > seq) {
+            if (!m) {
+                break; // avoid wrapping around
+            }
+
             r = m - 1;
-        } else if (pending_request_is_valid(req)) {
-            return (struct search_result) { .value = req, .index = m };
+        } else {
+            // seqs are unique, so if this is a hole the request has already been completed
+            if (pending_request_is_valid(req)) {
+                return (struct search_result) { .value = req, .index = m };
+            }
+
+            break;
         }
     }
 
@@ -192,6 +205,16 @@ static ptrdiff_t pending_requests_make_room(struct dicey_pending_requests **reqs
         i = next_index(old_reqs, i);
     } while (i != old_reqs->end);
 
+    if (!reallocd) {
+        // when compacting in place, the slots past the last live request still hold stale copies. Clear them, and
+        // move the end of the live range right after the last request
+        for (size_t h = o; h != reqs->start; h = next_index(reqs, h)) {
+            reqs->reqs[h] = (struct dicey_request) { 0 };
+        }
+
+        reqs->end = o;
+    }
+
 quit:
     *reqs_ptr = reqs;
 
@@ -301,7 +324,7 @@ enum dicey_error dicey_pending_requests_complete(
         *req = *sres.value;
     }
 
-    pending_request_invalidate(reqs, sres.index);
+    pending_request_invalidate(reqs, index_of(reqs, sres.index));
 
     return DICEY_OK;
 }
@@ -329,19 +352,20 @@ void dicey_pending_requests_prune(
         return;
     }
 
-    for (size_t i = reqs->start; i != reqs->end; i = next_index(reqs, i)) {
+    // invalidating a request may shrink the live range, so iterate over the range as it was before pruning
+    const size_t start = reqs->start, end = reqs->end;
+    size_t i = start;
+
+    do {
         struct dicey_request *const req = &reqs->reqs[i];
         assert(req);
 
-        if (is_hole(req)) {
-            continue;
-        }
-
-        if (prune_fn(req, ctx)) {
+        if (!is_hole(req) && prune_fn(req, ctx)) {
             pending_request_invalidate(reqs, i);
-            --reqs->len;
         }
-    }
+
+        i = next_index(reqs, i);
+    } while (i != end);
 }
 
 enum dicey_error dicey_pending_request_skip(struct dicey_pending_requests **const reqs_ptr, const uint32_t seq) {
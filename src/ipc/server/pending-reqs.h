@@ -30,6 +30,8 @@
 #include <dicey/ipc/server-api.h>
 #include <dicey/ipc/server.h>
 
+#include "wirefmt/value-validate.h"
+
 enum dicey_request_state {
     DICEY_REQUEST_STATE_PENDING,      // the request is pending
     DICEY_REQUEST_STATE_CONSTRUCTING, // the request is being constructed
@@ -51,16 +53,21 @@ struct dicey_request {
     struct dicey_message_builder resp_builder; // the response builder
 
     const char *signature;
+    const struct dicey_validator *validator; // the compiled signature. Owned by the element, like the string above
 
     struct dicey_server *server; // the server that this request comes from
 };
 
 void dicey_request_deinit(struct dicey_request *req);
 
+struct dicey_route;
+
+// builds a request for `packet`, which must have already been resolved to `route`
 enum dicey_error dicey_server_request_for(
     struct dicey_server *server,
     struct dicey_client_info *cln,
     struct dicey_packet packet,
+    const struct dicey_route *route,
     struct dicey_request *dest
 );
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/hashtable.h>
+#include <dicey/core/packet.h>
+#include <dicey/core/type.h>
+#include <dicey/core/views.h>
+
+#include "sup/trace.h"
+#include "sup/view-ops.h"
+
+#include "property-cache.h"
+
+#define ELEM_KEY_FMT "%s:%s"
+
+static void free_packet(void *const ptr) {
+    struct dicey_packet *const packet = ptr;
+
+    if (packet) {
+        dicey_packet_deinit(packet);
+        free(packet);
+    }
+}
+
+static void free_elems(void *const ptr) {
+    dicey_hashtable_delete(ptr, &free_packet);
+}
+
+static const char *format_elem_key(struct dicey_property_cache *const cache, const struct dicey_selector sel) {
+    assert(cache && dicey_selector_is_valid(sel));
+
+    const int required = snprintf(NULL, 0U, ELEM_KEY_FMT, sel.trait, sel.elem) + 1;
+    assert(required > 3);
+
+    if ((size_t) required > cache->scratch.len) {
+        char *const new_data = realloc(cache->scratch.data, (size_t) required);
+        if (!new_data) {
+            return NULL;
+        }
+
+        cache->scratch = dicey_view_mut_from(new_data, (size_t) required);
+    }
+
+    snprintf(cache->scratch.data, cache->scratch.len, ELEM_KEY_FMT, sel.trait, sel.elem);
+
+    return cache->scratch.data;
+}
+
+void dicey_property_cache_deinit(struct dicey_property_cache *const cache) {
+    if (cache) {
+        dicey_hashtable_delete(cache->objects, &free_elems);
+        free(cache->scratch.data);
+
+        *cache = (struct dicey_property_cache) { 0 };
+    }
+}
+
+void dicey_property_cache_drop_object(struct dicey_property_cache *const cache, const char *const path) {
+    assert(cache && path);
+
+    free_elems(dicey_hashtable_remove(cache->objects, path));
+}
+
+const struct dicey_packet *dicey_property_cache_get(
+    struct dicey_property_cache *const cache,
+    const char *const path,
+    const struct dicey_selector sel
+) {
+    assert(cache && path);
+
+    const struct dicey_hashtable *const elems = dicey_hashtable_get(cache->objects, path);
+    if (!elems) {
+        return NULL;
+    }
+
+    const char *const key = format_elem_key(cache, sel);
+
+    return key ? dicey_hashtable_get(elems, key) : NULL;
+}
+
+enum dicey_error dicey_property_cache_set(
+    struct dicey_property_cache *const cache,
+    const char *const path,
+    const struct dicey_selector sel,
+    const struct dicey_packet packet
+) {
+    assert(cache && path && dicey_packet_is_valid(packet));
+
+    const char *const key = format_elem_key(cache, sel);
+    if (!key) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    struct dicey_packet *const stored = malloc(sizeof *stored);
+    if (!stored) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    *stored = packet;
+
+    struct dicey_hashtable *elems = dicey_hashtable_get(cache->objects, path);
+    const bool new_object = !elems;
+
+    void *old_value = NULL;
+
+    switch (dicey_hashtable_set(&elems, key, stored, &old_value)) {
+    case DICEY_HASH_SET_FAILED:
+        free(stored);
+
+        return TRACE(DICEY_ENOMEM);
+
+    case DICEY_HASH_SET_UPDATED:
+        free_packet(old_value);
+
+        break;
+
+    case DICEY_HASH_SET_ADDED:
+        break;
+    }
+
+    // the inner table may have been created or reallocated, so always store it back
+    if (dicey_hashtable_set(&cache->objects, path, elems, NULL) == DICEY_HASH_SET_FAILED) {
+        assert(new_object); // updating an existing key never allocates
+
+        // give the packet back to the caller before getting rid of the table
+        dicey_hashtable_remove(elems, key);
+        free(stored);
+        dicey_hashtable_delete(elems, NULL);
+
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    return DICEY_OK;
+}
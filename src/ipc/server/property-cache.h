@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(NVQEHXKTLB_PROPERTY_CACHE_H)
+#define NVQEHXKTLB_PROPERTY_CACHE_H
+
+#include <dicey/core/errors.h>
+#include <dicey/core/hashtable.h>
+#include <dicey/core/packet.h>
+#include <dicey/core/type.h>
+#include <dicey/core/views.h>
+
+// the values published for cached properties (see DICEY_ELEMENT_CACHED), stored as ready-made response packets. A GET
+// on a cached property is answered by rewriting the seq and path of the stored packet, without involving on_request
+struct dicey_property_cache {
+    struct dicey_hashtable *objects; // main path -> struct dicey_hashtable * (trait:elem -> struct dicey_packet *)
+
+    struct dicey_view_mut scratch; // used to format the keys of the inner tables
+};
+
+void dicey_property_cache_deinit(struct dicey_property_cache *cache);
+
+// drops all the values published for the object at `path`. Must be called when the object is deleted, or a new object
+// registered at the same path would inherit them
+void dicey_property_cache_drop_object(struct dicey_property_cache *cache, const char *path);
+
+// returns the last value published for a property, or NULL if none was. The packet is owned by the cache and is only
+// valid until the cache is modified again
+const struct dicey_packet *dicey_property_cache_get(
+    struct dicey_property_cache *cache,
+    const char *path,
+    struct dicey_selector sel
+);
+
+// stores `packet` as the value of a property, replacing the previous one. On success the cache takes ownership of the
+// packet; on failure, the packet is left untouched
+enum dicey_error dicey_property_cache_set(
+    struct dicey_property_cache *cache,
+    const char *path,
+    struct dicey_selector sel,
+    struct dicey_packet packet
+);
+
+#endif // NVQEHXKTLB_PROPERTY_CACHE_H
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/ipc/server-api.h>
+
+#include "sup/trace.h"
+
+#include "registry-batch.h"
+
+#define BASE_ENTRIES_CAP 16U
+#define BASE_STRINGS_CAP 256U
+
+static enum dicey_error batch_reserve_strings(struct dicey_server_registry_batch *const batch, const size_t nbytes) {
+    assert(batch);
+
+    if (nbytes > (size_t) PTRDIFF_MAX - batch->strings_len) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    const size_t needed = batch->strings_len + nbytes;
+    if (needed <= batch->strings_cap) {
+        return DICEY_OK;
+    }
+
+    size_t new_cap = batch->strings_cap ? batch->strings_cap : BASE_STRINGS_CAP;
+    while (new_cap < needed) {
+        new_cap = new_cap > (size_t) PTRDIFF_MAX / 2U ? (size_t) PTRDIFF_MAX : new_cap * 2U;
+    }
+
+    char *const new_strings = realloc(batch->strings, new_cap);
+    if (!new_strings) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    batch->strings = new_strings;
+    batch->strings_cap = new_cap;
+
+    return DICEY_OK;
+}
+
+static void batch_push_string(struct dicey_server_registry_batch *const batch, const char *const str) {
+    assert(batch && str);
+
+    const size_t size = strlen(str) + 1U;
+    assert(batch->strings_len + size <= batch->strings_cap);
+
+    memcpy(batch->strings + batch->strings_len, str, size);
+    batch->strings_len += size;
+}
+
+// reserves room for a new entry and `nbytes` worth of strings, then appends the entry. The caller must push exactly
+// `nbytes` bytes of strings right after
+static enum dicey_error batch_push_entry(
+    struct dicey_server_registry_batch *const batch,
+    const enum dicey_registry_batch_op op,
+    const size_t nbytes,
+    const size_t ntraits
+) {
+    assert(batch);
+
+    if (batch->len == batch->cap) {
+        const size_t new_cap = batch->cap ? batch->cap * 3U / 2U : BASE_ENTRIES_CAP;
+
+        if (new_cap > (size_t) PTRDIFF_MAX / sizeof *batch->entries) {
+            return TRACE(DICEY_EOVERFLOW);
+        }
+
+        struct dicey_registry_batch_entry *const new_entries = realloc(batch->entries, new_cap * sizeof *new_entries);
+        if (!new_entries) {
+            return TRACE(DICEY_ENOMEM);
+        }
+
+        batch->entries = new_entries;
+        batch->cap = new_cap;
+    }
+
+    const enum dicey_error err = batch_reserve_strings(batch, nbytes);
+    if (err) {
+        return err;
+    }
+
+    batch->entries[batch->len++] = (struct dicey_registry_batch_entry) {
+        .op = op,
+        .strings = batch->strings_len,
+        .ntraits = ntraits,
+    };
+
+    if (ntraits > batch->max_traits) {
+        batch->max_traits = ntraits;
+    }
+
+    return DICEY_OK;
+}
+
+const char *dicey_registry_batch_entry_arg(
+    const struct dicey_server_registry_batch *const batch,
+    const struct dicey_registry_batch_entry *const entry
+) {
+    const char *const path = dicey_registry_batch_entry_path(batch, entry);
+
+    return path + strlen(path) + 1U;
+}
+
+const char *dicey_registry_batch_entry_path(
+    const struct dicey_server_registry_batch *const batch,
+    const struct dicey_registry_batch_entry *const entry
+) {
+    assert(batch && entry && entry->strings < batch->strings_len);
+
+    return batch->strings + entry->strings;
+}
+
+void dicey_registry_batch_entry_traits(
+    const struct dicey_server_registry_batch *const batch,
+    const struct dicey_registry_batch_entry *const entry,
+    const char **const dest
+) {
+    assert(batch && entry && entry->op == DICEY_REGISTRY_BATCH_OP_ADD_OBJECT && dest);
+
+    const char *trait = dicey_registry_batch_entry_arg(batch, entry);
+
+    for (size_t i = 0U; i < entry->ntraits; ++i) {
+        dest[i] = trait;
+
+        trait += strlen(trait) + 1U;
+    }
+
+    dest[entry->ntraits] = NULL;
+}
+
+enum dicey_error dicey_server_registry_batch_add_alias(
+    struct dicey_server_registry_batch *const batch,
+    const char *const path,
+    const char *const alias
+) {
+    assert(batch && path && alias);
+
+    const size_t path_size = strlen(path) + 1U, alias_size = strlen(alias) + 1U;
+
+    const enum dicey_error err = batch_push_entry(batch, DICEY_REGISTRY_BATCH_OP_ADD_ALIAS, path_size + alias_size, 0U);
+    if (err) {
+        return err;
+    }
+
+    batch_push_string(batch, path);
+    batch_push_string(batch, alias);
+
+    return DICEY_OK;
+}
+
+enum dicey_error dicey_server_registry_batch_add_object(
+    struct dicey_server_registry_batch *const batch,
+    const char *const path,
+    const char *const *const traits
+) {
+    assert(batch && path && traits);
+
+    size_t nbytes = strlen(path) + 1U, ntraits = 0U;
+
+    for (const char *const *trait = traits; *trait; ++trait, ++ntraits) {
+        nbytes += strlen(*trait) + 1U;
+    }
+
+    const enum dicey_error err = batch_push_entry(batch, DICEY_REGISTRY_BATCH_OP_ADD_OBJECT, nbytes, ntraits);
+    if (err) {
+        return err;
+    }
+
+    batch_push_string(batch, path);
+
+    for (const char *const *trait = traits; *trait; ++trait) {
+        batch_push_string(batch, *trait);
+    }
+
+    return DICEY_OK;
+}
+
+enum dicey_error dicey_server_registry_batch_begin(struct dicey_server_registry_batch **const dest) {
+    assert(dest);
+
+    struct dicey_server_registry_batch *const batch = calloc(1U, sizeof *batch);
+    if (!batch) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    *dest = batch;
+
+    return DICEY_OK;
+}
+
+enum dicey_error dicey_server_registry_batch_delete_object(
+    struct dicey_server_registry_batch *const batch,
+    const char *const path
+) {
+    assert(batch && path);
+
+    const enum dicey_error err = batch_push_entry(batch, DICEY_REGISTRY_BATCH_OP_DELETE_OBJECT, strlen(path) + 1U, 0U);
+    if (err) {
+        return err;
+    }
+
+    batch_push_string(batch, path);
+
+    return DICEY_OK;
+}
+
+void dicey_server_registry_batch_discard(struct dicey_server_registry_batch *const batch) {
+    if (batch) {
+        free(batch->entries);
+        free(batch->strings);
+        free(batch);
+    }
+}
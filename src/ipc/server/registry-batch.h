@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(QJCDMWQLVV_REGISTRY_BATCH_H)
+#define QJCDMWQLVV_REGISTRY_BATCH_H
+
+#include <stddef.h>
+
+#include <dicey/ipc/server-api.h>
+
+enum dicey_registry_batch_op {
+    DICEY_REGISTRY_BATCH_OP_ADD_OBJECT,
+    DICEY_REGISTRY_BATCH_OP_ADD_ALIAS,
+    DICEY_REGISTRY_BATCH_OP_DELETE_OBJECT,
+};
+
+// a single mutation queued in a batch. Its strings are stored back to back in the batch's string buffer, starting at
+// `strings`: first the path, then either the alias (ADD_ALIAS) or `ntraits` trait names (ADD_OBJECT)
+struct dicey_registry_batch_entry {
+    enum dicey_registry_batch_op op;
+
+    size_t strings; // offset in the string buffer, which may move while the batch grows
+    size_t ntraits;
+};
+
+struct dicey_server_registry_batch {
+    struct dicey_registry_batch_entry *entries;
+    size_t len;
+    size_t cap;
+
+    char *strings;
+    size_t strings_len;
+    size_t strings_cap;
+
+    size_t max_traits; // the largest `ntraits` of any entry, used to size the trait list when adding objects
+};
+
+// the path of the entry. The pointer is valid until the batch is modified
+const char *dicey_registry_batch_entry_path(
+    const struct dicey_server_registry_batch *batch,
+    const struct dicey_registry_batch_entry *entry
+);
+
+// writes the NULL-terminated list of traits of an ADD_OBJECT entry into `dest`, which must hold `ntraits + 1` pointers
+void dicey_registry_batch_entry_traits(
+    const struct dicey_server_registry_batch *batch,
+    const struct dicey_registry_batch_entry *entry,
+    const char **dest
+);
+
+// the string following the path, i.e. the alias of an ADD_ALIAS entry
+const char *dicey_registry_batch_entry_arg(
+    const struct dicey_server_registry_batch *batch,
+    const struct dicey_registry_batch_entry *entry
+);
+
+#endif // QJCDMWQLVV_REGISTRY_BATCH_H
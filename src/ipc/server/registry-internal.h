@@ -18,14 +18,20 @@
 #define FNMCVSLICR_REGISTRY_INTERNAL_H
 
 #include <stdarg.h>
+#include <stdint.h>
 
 #include <dicey/core/hashset.h>
 #include <dicey/core/hashtable.h>
+#include <dicey/core/packet.h>
 #include <dicey/core/views.h>
 #include <dicey/ipc/registry.h>
 
 #include "sup/util.h"
 
+#include "wirefmt/value-validate.h"
+
+#include "registry-journal.h"
+
 struct dicey_object {
     struct dicey_hashset *traits; /**< A set containing the names of traits that this object implements. */
 
@@ -42,6 +48,20 @@ struct dicey_object {
                               is removed. */
 };
 
+// the registry-wide listings served by the introspection builtins
+enum dicey_registry_listing {
+    DICEY_REGISTRY_LISTING_PATHS,   // all paths, aliases included
+    DICEY_REGISTRY_LISTING_OBJECTS, // main paths only
+    DICEY_REGISTRY_LISTING_TRAITS,  // all trait names
+
+    DICEY_REGISTRY_LISTING_COUNT,
+};
+
+struct dicey_registry_cached_listing {
+    uint64_t generation;        // the registry generation the response was built at
+    struct dicey_packet packet; // the encoded response, with seq 0. Invalid if nothing was built yet
+};
+
 struct dicey_registry {
     // note: While the paths are technically hierarchical, this has zero to no effect on the actual implementation.
     //       The paths are simply used as a way to identify objects and traits, and "directory-style" access is not
@@ -51,6 +71,18 @@ struct dicey_registry {
 
     struct dicey_hashtable *traits;
 
+    // bumped every time a path or trait is added or removed. Anything caching pointers into the registry (e.g. the
+    // server's route cache) must drop them when this changes
+    uint64_t generation;
+
+    // listings walk the whole registry, which is expensive with a lot of paths and tools tend to poll them. Their
+    // responses are kept here and reused for as long as `generation` doesn't change
+    struct dicey_registry_cached_listing listings[DICEY_REGISTRY_LISTING_COUNT];
+
+    // the latest changes, each tagged with the generation it bumped the registry to. Lets mirrors catch up without
+    // listing everything again
+    struct dicey_registry_journal journal;
+
     // scratchpad buffer used when crafting strings. Non thread-safe like all the rest of the registry.
     struct dicey_view_mut buffer;
 };
@@ -65,4 +97,7 @@ const char *dicey_registry_format_metaname(struct dicey_registry *registry, cons
 
 struct dicey_object *dicey_registry_get_object_mut(const struct dicey_registry *registry, const char *path);
 
+// returns the compiled signature of an element. `elem` must point to an element stored in a trait, not to a copy
+const struct dicey_validator *dicey_element_get_validator(const struct dicey_element *elem);
+
 #endif // FNMCVSLICR_REGISTRY_INTERNAL_H
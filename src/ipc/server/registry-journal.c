@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dicey/ipc/builtins/introspection.h>
+
+#include "registry-journal.h"
+
+static void change_deinit(struct dicey_registry_change *const change) {
+    assert(change);
+
+    free(change->subject);
+    free(change->target);
+
+    *change = (struct dicey_registry_change) { 0 };
+}
+
+static void journal_forget_until(struct dicey_registry_journal *const journal, const uint64_t generation) {
+    assert(journal);
+
+    for (size_t i = 0U; i < journal->len; ++i) {
+        change_deinit(&journal->entries[(journal->head + i) % DICEY_REGISTRY_JOURNAL_CAPACITY]);
+    }
+
+    journal->head = 0U;
+    journal->len = 0U;
+    journal->floor = generation;
+}
+
+void dicey_registry_journal_deinit(struct dicey_registry_journal *const journal) {
+    if (journal) {
+        journal_forget_until(journal, 0U);
+
+        free(journal->entries);
+
+        *journal = (struct dicey_registry_journal) { 0 };
+    }
+}
+
+const struct dicey_registry_change *dicey_registry_journal_get(
+    const struct dicey_registry_journal *const journal,
+    const size_t i
+) {
+    assert(journal && i < journal->len);
+
+    return &journal->entries[(journal->head + i) % DICEY_REGISTRY_JOURNAL_CAPACITY];
+}
+
+void dicey_registry_journal_record(
+    struct dicey_registry_journal *const journal,
+    const uint64_t generation,
+    const enum dicey_registry_change_kind kind,
+    const char *const subject,
+    const char *const target
+) {
+    assert(journal && generation > journal->floor && kind != DICEY_REGISTRY_CHANGE_INVALID && subject);
+
+    if (!journal->entries) {
+        journal->entries = calloc(DICEY_REGISTRY_JOURNAL_CAPACITY, sizeof *journal->entries);
+        if (!journal->entries) {
+            journal_forget_until(journal, generation);
+
+            return;
+        }
+    }
+
+    char *const subject_copy = strdup(subject);
+    char *const target_copy = target ? strdup(target) : NULL;
+
+    if (!subject_copy || (target && !target_copy)) {
+        free(subject_copy);
+        free(target_copy);
+
+        journal_forget_until(journal, generation);
+
+        return;
+    }
+
+    if (journal->len == DICEY_REGISTRY_JOURNAL_CAPACITY) {
+        struct dicey_registry_change *const oldest = &journal->entries[journal->head];
+
+        journal->floor = oldest->generation;
+        journal->head = (journal->head + 1U) % DICEY_REGISTRY_JOURNAL_CAPACITY;
+        --journal->len;
+
+        change_deinit(oldest);
+    }
+
+    struct dicey_registry_change *const slot =
+        &journal->entries[(journal->head + journal->len) % DICEY_REGISTRY_JOURNAL_CAPACITY];
+
+    *slot = (struct dicey_registry_change) {
+        .generation = generation,
+        .kind = kind,
+        .subject = subject_copy,
+        .target = target_copy,
+    };
+
+    ++journal->len;
+}
+
+bool dicey_registry_journal_since(
+    const struct dicey_registry_journal *const journal,
+    const uint64_t since,
+    size_t *const first
+) {
+    assert(journal && first);
+
+    if (since < journal->floor) {
+        return false;
+    }
+
+    // the changes are sorted by generation: look for the first one after `since`
+    size_t low = 0U, high = journal->len;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2U;
+
+        if (dicey_registry_journal_get(journal, mid)->generation <= since) {
+            low = mid + 1U;
+        } else {
+            high = mid;
+        }
+    }
+
+    *first = low;
+
+    return true;
+}
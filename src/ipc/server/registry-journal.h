@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(GQYNCIVNLI_REGISTRY_JOURNAL_H)
+#define GQYNCIVNLI_REGISTRY_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <dicey/ipc/builtins/introspection.h>
+
+// number of changes kept by the journal. Mirrors that fall further behind than this must list everything again
+#define DICEY_REGISTRY_JOURNAL_CAPACITY 1024U
+
+struct dicey_registry_change {
+    uint64_t generation; // the generation of the registry right after the change
+    enum dicey_registry_change_kind kind;
+
+    char *subject; // the path or trait name that changed. Owned by the journal
+    char *target;  // the object path for DICEY_REGISTRY_CHANGE_ALIAS_ADDED, NULL otherwise. Owned by the journal
+};
+
+// ring buffer holding the latest changes made to a registry, sorted by generation
+struct dicey_registry_journal {
+    struct dicey_registry_change *entries; // lazily allocated, DICEY_REGISTRY_JOURNAL_CAPACITY entries
+
+    size_t head; // index of the oldest change
+    size_t len;
+
+    // the journal knows about every change made after this generation. Moves forward when old changes are evicted
+    uint64_t floor;
+};
+
+void dicey_registry_journal_deinit(struct dicey_registry_journal *journal);
+
+// returns the i-th change still in the journal, starting from the oldest. `i` must be less than `journal->len`
+const struct dicey_registry_change *dicey_registry_journal_get(const struct dicey_registry_journal *journal, size_t i);
+
+// records a change that brought the registry to `generation`, evicting the oldest change if the journal is full. This
+// never fails: if the change can't be stored, the journal forgets everything up to `generation` instead, and whoever
+// asks about earlier generations is told to resync
+void dicey_registry_journal_record(
+    struct dicey_registry_journal *journal,
+    uint64_t generation,
+    enum dicey_registry_change_kind kind,
+    const char *subject,
+    const char *target
+);
+
+// looks up the changes made after `since`, which must not be newer than the registry. Returns false if the journal has
+// already forgotten some of them; otherwise, `*first` is set to the index of the first of them (`journal->len` if none)
+bool dicey_registry_journal_since(const struct dicey_registry_journal *journal, uint64_t since, size_t *first);
+
+#endif // GQYNCIVNLI_REGISTRY_JOURNAL_H
@@ -29,6 +29,7 @@
 #include <dicey/core/errors.h>
 #include <dicey/core/hashset.h>
 #include <dicey/core/hashtable.h>
+#include <dicey/core/packet.h>
 #include <dicey/core/views.h>
 #include <dicey/ipc/builtins/introspection.h>
 #include <dicey/ipc/registry.h>
@@ -119,14 +120,34 @@ static bool path_is_valid(const char *const path) {
     return true;
 }
 
+// bumps the generation of the registry, and logs the change that caused it in the journal
+static void registry_changed(
+    struct dicey_registry *const registry,
+    const enum dicey_registry_change_kind kind,
+    const char *const subject,
+    const char *const target
+) {
+    assert(registry && subject);
+
+    ++registry->generation;
+
+    dicey_registry_journal_record(&registry->journal, registry->generation, kind, subject, target);
+}
+
+// only used to remove aliases
 static enum dicey_error registry_remove_path(struct dicey_registry *const registry, const char *const path) {
     assert(registry && path);
 
-    struct dicey_object *const obj = dicey_hashtable_remove(registry->paths, path);
-    if (!obj) {
+    if (!dicey_hashtable_contains(registry->paths, path)) {
         return TRACE(DICEY_EPATH_NOT_FOUND);
     }
 
+    // log the change before removing the path: `path` is often the key the hashtable is about to free
+    registry_changed(registry, DICEY_REGISTRY_CHANGE_ALIAS_REMOVED, path, NULL);
+
+    struct dicey_object *const obj = dicey_hashtable_remove(registry->paths, path);
+    assert(obj);
+
     object_deref(obj);
 
     return DICEY_OK;
@@ -157,6 +178,9 @@ static enum dicey_error registry_del_object(struct dicey_registry *const registr
         assert(!err); // the alias should always exist in the hashtable
     }
 
+    // the main path is owned by the hashtable, so log the change while it's still around
+    registry_changed(registry, DICEY_REGISTRY_CHANGE_OBJECT_REMOVED, object->main_path, NULL);
+
     // remove the main path from the hashtable. The object is now purged from the registry
     const bool success = dicey_hashtable_remove(registry->paths, object->main_path);
     DICEY_UNUSED(success);
@@ -228,6 +252,11 @@ static enum dicey_error registry_add_object(
                 assert(!err); // we just added the object, so it should always exist
 
                 object->main_path = entry.path;
+
+                registry_changed(registry, DICEY_REGISTRY_CHANGE_OBJECT_ADDED, path, NULL);
+            } else {
+                // the object already lives somewhere else, so this is an alias
+                registry_changed(registry, DICEY_REGISTRY_CHANGE_ALIAS_ADDED, path, object->main_path);
             }
 
             break;
@@ -259,6 +288,8 @@ static enum dicey_error registry_add_trait(
 
     case DICEY_HASH_SET_ADDED:
         assert(!old_value);
+
+        registry_changed(registry, DICEY_REGISTRY_CHANGE_TRAIT_ADDED, trait_name, NULL);
         break;
     }
 
@@ -374,6 +405,12 @@ void dicey_registry_deinit(struct dicey_registry *const registry) {
         dicey_hashtable_delete(registry->paths, &object_deref);
         dicey_hashtable_delete(registry->traits, &trait_free);
 
+        for (size_t i = 0U; i < DICEY_REGISTRY_LISTING_COUNT; ++i) {
+            dicey_packet_deinit(&registry->listings[i].packet);
+        }
+
+        dicey_registry_journal_deinit(&registry->journal);
+
         free(registry->buffer.data);
 
         *registry = (struct dicey_registry) { 0 };
@@ -918,12 +955,20 @@ enum dicey_error dicey_registry_remove_object(struct dicey_registry *const regis
         return TRACE(DICEY_EPATH_MALFORMED);
     }
 
-    struct dicey_object *const object = dicey_hashtable_remove(registry->paths, path);
+    const struct dicey_object *const object = dicey_hashtable_get(registry->paths, path);
     if (!object) {
         return TRACE(DICEY_EPATH_NOT_FOUND);
     }
 
-    object_deref(object);
+    const enum dicey_registry_change_kind kind =
+        strcmp(object->main_path, path) ? DICEY_REGISTRY_CHANGE_ALIAS_REMOVED : DICEY_REGISTRY_CHANGE_OBJECT_REMOVED;
+
+    registry_changed(registry, kind, path, NULL);
+
+    struct dicey_object *const removed = dicey_hashtable_remove(registry->paths, path);
+    assert(removed == object);
+
+    object_deref(removed);
 
     return DICEY_OK;
 }
@@ -18,6 +18,7 @@
 #define _XOPEN_SOURCE 700
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -34,6 +35,7 @@
 #include "wirefmt/packet-args.h"
 
 #include "pending-reqs.h"
+#include "route-cache.h"
 #include "server-internal.h"
 
 enum reply_policy {
@@ -41,6 +43,43 @@ enum reply_policy {
     REPLY_POLICY_BLOCKING, // reply synchronously, waiting for the response to be sent
 };
 
+// begins the response builder of `req` and sets everything but the value
+static enum dicey_error response_builder_begin(struct dicey_request *const req, const bool streaming) {
+    assert(req);
+
+    struct dicey_message_builder *const builder = &req->resp_builder;
+
+    enum dicey_error err = streaming ? dicey_message_builder_begin_streaming(builder, DICEY_OP_RESPONSE)
+                                     : dicey_message_builder_begin(builder, DICEY_OP_RESPONSE);
+
+    if (err) {
+        return err;
+    }
+
+    err = dicey_message_builder_set_seq(builder, req->packet_seq);
+    if (err) {
+        goto fail;
+    }
+
+    // reply with the path the client used, even if it's an alias
+    err = dicey_message_builder_set_path(builder, req->real_path);
+    if (err) {
+        goto fail;
+    }
+
+    err = dicey_message_builder_set_selector(builder, req->message.selector);
+    if (err) {
+        goto fail;
+    }
+
+    return DICEY_OK;
+
+fail:
+    dicey_message_builder_discard(builder);
+
+    return err;
+}
+
 static enum dicey_error send_reply(
     struct dicey_request *const req,
     const enum reply_policy policy,
@@ -50,7 +89,8 @@ static enum dicey_error send_reply(
 
     struct dicey_value_builder builder = { 0 };
 
-    enum dicey_error err = dicey_request_response_start(req, &builder);
+    // the value is set in one go, so it can always be streamed
+    enum dicey_error err = dicey_request_response_start_streaming(req, &builder);
     if (err) {
         return err;
     }
@@ -114,22 +154,25 @@ enum dicey_error finalize_request(
         return err;
     }
 
-    err = policy == REPLY_POLICY_ASYNC ? dicey_server_send_response(req->server, req->cln.id, reply)
-                                       : dicey_server_send_response_and_wait(req->server, req->cln.id, reply);
+    // mark the request as completed before handing the response over: once the server has it, the request may be
+    // retired (and its storage reused) at any time by the loop thread
+    req->state = DICEY_REQUEST_STATE_COMPLETED;
 
-    if (err) {
-        // if the response could not be sent, reset the request state to failed
-        req->state = DICEY_REQUEST_STATE_ABORTED;
+    // once the server has accepted the packet, the request may already be gone, so `req` must not be touched anymore
+    bool accepted = false;
+    err = dicey_server_send_response_internal(
+        req->server, req->cln.id, reply, policy == REPLY_POLICY_BLOCKING, &accepted
+    );
 
-        // deinitialize the packet
-        dicey_packet_deinit(&reply);
+    if (!accepted) {
+        // the packet was rejected before reaching the server, so both it and the request are still ours
+        assert(err);
 
-        return err;
+        req->state = DICEY_REQUEST_STATE_ABORTED;
+        dicey_packet_deinit(&reply);
     }
 
-    req->state = DICEY_REQUEST_STATE_COMPLETED;
-
-    return DICEY_OK;
+    return err;
 }
 
 enum dicey_error dicey_request_acknowledge(struct dicey_request *const req) {
@@ -281,13 +324,38 @@ enum dicey_error dicey_request_response_start(struct dicey_request *req, struct
     return DICEY_OK;
 }
 
+enum dicey_error dicey_request_response_start_streaming(
+    struct dicey_request *const req,
+    struct dicey_value_builder *const builder
+) {
+    assert(req && builder);
+
+    if (req->state != DICEY_REQUEST_STATE_PENDING || dicey_value_builder_is_pending(builder)) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    // the response builder always starts as a regular one, and has no value yet: just begin it again as a streaming one
+    dicey_message_builder_discard(&req->resp_builder);
+
+    enum dicey_error err = response_builder_begin(req, true);
+    if (err) {
+        // leave the request as it was, so that the caller can still reply without streaming. This can't fail
+        (void) response_builder_begin(req, false);
+
+        return err;
+    }
+
+    return dicey_request_response_start(req, builder);
+}
+
 enum dicey_error dicey_server_request_for(
     struct dicey_server *const server,
     struct dicey_client_info *const cln,
     const struct dicey_packet packet,
+    const struct dicey_route *const route,
     struct dicey_request *const dest
 ) {
-    assert(server && dicey_packet_is_valid(packet) && dest);
+    assert(server && dicey_packet_is_valid(packet) && route && dest);
 
     enum dicey_error err = dicey_packet_as_message(packet, &dest->message);
     if (err) {
@@ -299,53 +367,31 @@ enum dicey_error dicey_server_request_for(
         goto fail;
     }
 
-    const struct dicey_element *elem = dicey_registry_get_element(
-        &server->registry, dest->message.path, dest->message.selector.trait, dest->message.selector.elem
-    );
+    const struct dicey_element *const elem = route->entry.element;
+    assert(elem && elem->signature);
 
-    if (!elem) {
-        err = TRACE(DICEY_EELEMENT_NOT_FOUND);
-        goto fail;
-    }
-
-    assert(elem->signature);
+    dest->real_path = dest->message.path;
 
-    err = dicey_message_builder_begin(&dest->resp_builder, DICEY_OP_RESPONSE);
+    // responses are built with a regular builder unless dicey_request_response_start_streaming says otherwise, given
+    // that a streaming one can't build values out of order
+    err = response_builder_begin(dest, false);
     if (err) {
         goto fail;
     }
 
-    err = dicey_message_builder_set_seq(&dest->resp_builder, dest->packet_seq);
-    if (err) {
-        goto deinit_all;
-    }
-
-    err = dicey_message_builder_set_path(&dest->resp_builder, dest->message.path);
-    if (err) {
-        goto deinit_all;
-    }
-
-    err = dicey_message_builder_set_selector(&dest->resp_builder, dest->message.selector);
-    if (err) {
-        goto deinit_all;
-    }
-
-    dest->real_path = dest->message.path;
     dest->packet = packet;
     dest->cln = *cln; // copy the client info, it's just a few bytes
     dest->op = dest->message.type;
     dest->state = DICEY_REQUEST_STATE_PENDING;
     dest->signature = elem->signature;
+    dest->validator = route->validator;
     dest->server = server;
 
     // hide the message path from the user-facing code
-    dest->message.path = dicey_registry_get_main_path(&server->registry, dest->message.path);
+    dest->message.path = route->entry.main_path;
 
     return DICEY_OK;
 
-deinit_all:
-    dicey_message_builder_discard(&dest->resp_builder);
-
 fail:
     *dest = (struct dicey_request) { 0 };
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/type.h>
+#include <dicey/ipc/registry.h>
+#include <dicey/ipc/traits.h>
+
+#include "sup/trace.h"
+
+#include "builtins/builtins.h"
+#include "registry-internal.h"
+
+#include "route-cache.h"
+
+static_assert(
+    (DICEY_ROUTE_CACHE_SLOTS & (DICEY_ROUTE_CACHE_SLOTS - 1U)) == 0U,
+    "DICEY_ROUTE_CACHE_SLOTS must be a power of two"
+);
+
+#define FNV1A_OFFSET 0xcbf29ce484222325ULL
+#define FNV1A_PRIME 0x00000100000001b3ULL
+
+static uint64_t fnv1a_str(uint64_t hash, const char *str) {
+    for (; *str; ++str) {
+        hash ^= (unsigned char) *str;
+        hash *= FNV1A_PRIME;
+    }
+
+    // mix in the terminator too, so that ("ab", "c") and ("a", "bc") hash differently
+    hash *= FNV1A_PRIME;
+
+    return hash;
+}
+
+static uint64_t route_hash(const char *const path, const struct dicey_selector sel) {
+    return fnv1a_str(fnv1a_str(fnv1a_str(FNV1A_OFFSET, path), sel.trait), sel.elem);
+}
+
+static bool slot_matches(
+    const struct dicey_route_cache_slot *const slot,
+    const uint64_t generation,
+    const uint64_t hash,
+    const char *const path,
+    const struct dicey_selector sel
+) {
+    // the generation is checked first: the strings in a stale slot may already have been freed
+    return slot->path && slot->generation == generation && slot->hash == hash && !strcmp(slot->path, path) &&
+           !strcmp(slot->route.entry.sel.trait, sel.trait) && !strcmp(slot->route.entry.sel.elem, sel.elem);
+}
+
+static enum dicey_error route_lookup(
+    const struct dicey_registry *const registry,
+    const char *const path,
+    const struct dicey_selector sel,
+    const char **const path_key,
+    struct dicey_route *const dest
+) {
+    // no TRACE()s here: unknown paths and elements are reported to the client, they are not internal errors
+    struct dicey_object_entry obj_entry = { 0 };
+    if (!dicey_registry_get_object_entry(registry, path, &obj_entry)) {
+        return DICEY_EPATH_NOT_FOUND;
+    }
+
+    if (!dicey_object_implements(obj_entry.object, sel.trait)) {
+        return DICEY_EELEMENT_NOT_FOUND;
+    }
+
+    const struct dicey_trait *const trait = dicey_registry_get_trait(registry, sel.trait);
+    struct dicey_element_entry elem_entry = { 0 };
+    if (!trait || !dicey_trait_get_element_entry(trait, sel.elem, &elem_entry)) {
+        return DICEY_EELEMENT_NOT_FOUND;
+    }
+
+    assert(elem_entry.element);
+
+    *dest = (struct dicey_route) {
+        .entry = {
+            .main_path = obj_entry.object->main_path,
+            .sel = elem_entry.sel,
+            .element = elem_entry.element,
+        },
+        .validator = dicey_element_get_validator(elem_entry.element),
+    };
+
+    if (!dicey_registry_get_builtin_info_for(elem_entry, &dest->binfo)) {
+        dest->binfo = (struct dicey_registry_builtin_info) { 0 };
+    }
+
+    *path_key = obj_entry.path;
+
+    return DICEY_OK;
+}
+
+void dicey_route_cache_deinit(struct dicey_route_cache *const cache) {
+    if (cache) {
+        free(cache->slots);
+
+        *cache = (struct dicey_route_cache) { 0 };
+    }
+}
+
+enum dicey_error dicey_route_cache_resolve(
+    struct dicey_route_cache *const cache,
+    const struct dicey_registry *const registry,
+    const char *const path,
+    const struct dicey_selector sel,
+    struct dicey_route *const dest
+) {
+    assert(cache && registry && path && dicey_selector_is_valid(sel) && dest);
+
+    const uint64_t hash = route_hash(path, sel);
+
+    struct dicey_route_cache_slot *slot = NULL;
+    if (cache->slots) {
+        slot = &cache->slots[hash & (DICEY_ROUTE_CACHE_SLOTS - 1U)];
+
+        if (slot_matches(slot, registry->generation, hash, path, sel)) {
+            *dest = slot->route;
+
+            return DICEY_OK;
+        }
+    }
+
+    const char *path_key = NULL;
+    const enum dicey_error err = route_lookup(registry, path, sel, &path_key, dest);
+    if (err) {
+        return err;
+    }
+
+    if (!slot) {
+        // allocated on first use, so that servers that never get a request do not pay for it. Failing to allocate is
+        // not an error, the route simply goes uncached
+        cache->slots = calloc(DICEY_ROUTE_CACHE_SLOTS, sizeof *cache->slots);
+        if (!cache->slots) {
+            return DICEY_OK;
+        }
+
+        slot = &cache->slots[hash & (DICEY_ROUTE_CACHE_SLOTS - 1U)];
+    }
+
+    *slot = (struct dicey_route_cache_slot) {
+        .hash = hash,
+        .generation = registry->generation,
+        .path = path_key,
+        .route = *dest,
+    };
+
+    return DICEY_OK;
+}
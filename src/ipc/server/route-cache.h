@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(QTRMZBEXWN_ROUTE_CACHE_H)
+#define QTRMZBEXWN_ROUTE_CACHE_H
+
+#include <stdint.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/type.h>
+#include <dicey/ipc/registry.h>
+#include <dicey/ipc/traits.h>
+
+#include "builtins/builtins.h"
+#include "registry-internal.h"
+
+// number of slots in the route cache. Must be a power of two
+#define DICEY_ROUTE_CACHE_SLOTS 1024U
+
+// everything the dispatcher needs to know about a (path, trait, elem) triple. All pointers are owned by the registry
+struct dicey_route {
+    struct dicey_object_element_entry entry; // main path, selector and element of the target
+    const struct dicey_validator *validator; // compiled signature of the element
+
+    struct dicey_registry_builtin_info binfo; // handler is NULL if the element is not a builtin
+};
+
+struct dicey_route_cache_slot {
+    uint64_t hash;
+    uint64_t generation; // registry generation this slot was filled at. Stale slots are ignored
+
+    const char *path; // the path as requested (possibly an alias), owned by the registry. NULL if the slot is empty
+    struct dicey_route route;
+};
+
+// direct-mapped cache of resolved routes, validated against the generation of the registry. Only successful lookups
+// are cached, so a miss always goes through the registry
+struct dicey_route_cache {
+    struct dicey_route_cache_slot *slots; // lazily allocated, DICEY_ROUTE_CACHE_SLOTS entries
+};
+
+void dicey_route_cache_deinit(struct dicey_route_cache *cache);
+
+// resolves `path` and `sel` to a route, either from the cache or from the registry. Fails with DICEY_EPATH_NOT_FOUND
+// or DICEY_EELEMENT_NOT_FOUND; the returned route is valid until the next mutation of the registry
+enum dicey_error dicey_route_cache_resolve(
+    struct dicey_route_cache *cache,
+    const struct dicey_registry *registry,
+    const char *path,
+    struct dicey_selector sel,
+    struct dicey_route *dest
+);
+
+#endif // QTRMZBEXWN_ROUTE_CACHE_H
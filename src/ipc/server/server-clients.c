@@ -58,7 +58,14 @@ enum dicey_error dicey_server_cleanup_id(struct dicey_server *const server, cons
 }
 
 struct dicey_client_data *dicey_server_release_id(struct dicey_server *const server, const size_t id) {
-    return dicey_client_list_drop_client(server->clients, id);
+    struct dicey_client_data *const client = dicey_client_list_drop_client(server->clients, id);
+
+    // the id may be reused right away, so it can't linger in the subscription index
+    if (client) {
+        dicey_client_data_unsubscribe_all(client);
+    }
+
+    return client;
 }
 
 enum dicey_error dicey_server_remove_client(struct dicey_server *const server, const size_t index) {
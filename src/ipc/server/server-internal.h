@@ -17,6 +17,9 @@
 #if !defined(JUYPLEPMAY_SERVER_INTERNAL_H)
 #define JUYPLEPMAY_SERVER_INTERNAL_H
 
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <uv.h>
@@ -31,7 +34,10 @@
 #include "ipc/queue.h"
 
 #include "client-data.h"
+#include "property-cache.h"
 #include "registry-internal.h"
+#include "route-cache.h"
+#include "subscriptions.h"
 
 #include "dicey_config.h"
 
@@ -56,9 +62,36 @@ struct dicey_server {
     uv_sem_t *shutdown_hook;
 
     uv_loop_t loop;
+    uv_thread_t loop_thread; // the thread running `loop`. Only meaningful while the server is running
     uv_async_t async;
     uv_prepare_t startup_prepare; // prepare that will only run once, at the beginning of the loop
 
+    // outbound packets are queued per client and written once per loop iteration, from flush_check. flush_idle is only
+    // active while some queue is waiting, to prevent the loop from blocking in poll before the check phase
+    uv_check_t flush_check;
+    uv_idle_t flush_idle;
+
+    struct {
+        size_t *ids; // ids of the clients with a non-empty outbound queue
+        size_t len;
+        size_t cap;
+    } flush_list;
+
+    size_t flush_bytes;   // a client queue is flushed immediately when it holds at least this many bytes...
+    size_t flush_packets; // ... or this many packets
+
+    // per-client outbound budgets; 0 means no limit. Copied into every client when it connects
+    size_t client_max_bytes;
+    size_t client_max_packets;
+    enum dicey_server_overflow_policy overflow_policy;
+
+    // written only by the loop thread, read by dicey_server_get_stats from any thread
+    struct {
+        _Atomic uint64_t writes;
+        _Atomic uint64_t packets;
+        _Atomic uint64_t bytes;
+    } stats;
+
     struct dicey_queue queue;
 
     dicey_server_on_connect_fn *on_connect;
@@ -70,6 +103,18 @@ struct dicey_server {
     struct dicey_client_list *clients;
     struct dicey_registry registry;
 
+    // the last registry generation dicey.Registry.Changed was raised for. Only touched by the loop thread
+    uint64_t notified_generation;
+
+    // elemdescr -> subscribed clients, kept in sync with the subscriptions of each client
+    struct dicey_subscription_index subscribers;
+
+    // (path, trait, elem) -> resolved route, so that repeated requests skip the registry lookups
+    struct dicey_route_cache routes;
+
+    // (main path, trait, elem) -> last value published for a cached property, ready to be sent as a response
+    struct dicey_property_cache props;
+
     // a simple buffer used to write strings here and there. Unfortunately I've been using this a bit
     // too much and I'm starting to worry some operations may overlap and corrupt it someday.
     // TODO: make this a real type, maybe with explicit borrowing
@@ -91,6 +136,27 @@ enum dicey_error dicey_server_client_raised_error(
     enum dicey_error err
 );
 
+// hands out the items of a GetMany or SetMany, one request packet per item, and sends the aggregated response once they
+// are all done. On success the server takes ownership of the batch and of all the packets; on failure, nothing is
+// touched. Must be called in the server's thread
+enum dicey_error dicey_server_dispatch_batch_internal(
+    struct dicey_server *server,
+    struct dicey_client_data *client,
+    struct dicey_batch_request *batch,
+    struct dicey_packet *packets
+);
+
+// sends a response, waiting for it to be written if `wait` is set and not on the loop thread. `accepted` is set to
+// true as soon as the server has taken the packet: from then on the packet must not be touched, even if the call fails.
+// If it's false, the packet was rejected and is still owned by the caller
+enum dicey_error dicey_server_send_response_internal(
+    struct dicey_server *server,
+    size_t id,
+    struct dicey_packet packet,
+    bool wait,
+    bool *accepted
+);
+
 // raises a signal directly. Must be called in the server's thread
 enum dicey_error dicey_server_raise_internal(struct dicey_server *server, struct dicey_packet packet);
 
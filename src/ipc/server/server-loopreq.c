@@ -43,7 +43,8 @@ enum dicey_error dicey_server_submit_request(
     assert(success);
     DICEY_UNUSED(success); // suppress unused variable warning with NDEBUG and MSVC
 
-    return dicey_error_from_uv(uv_async_send(&server->async));
+    // the loop drains the whole queue every time it wakes up: only wake it if nobody else has done it already
+    return dicey_queue_claim_wakeup(&server->queue) ? dicey_error_from_uv(uv_async_send(&server->async)) : DICEY_OK;
 }
 
 enum dicey_error dicey_server_blocking_request(
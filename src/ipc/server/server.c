@@ -20,6 +20,7 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -36,12 +37,14 @@
 #include <dicey/core/typedescr.h>
 #include <dicey/core/value.h>
 #include <dicey/ipc/address.h>
+#include <dicey/ipc/builtins/introspection.h>
 #include <dicey/ipc/registry.h>
 #include <dicey/ipc/request.h>
 #include <dicey/ipc/server-api.h>
 #include <dicey/ipc/server.h>
 #include <dicey/ipc/traits.h>
 
+#include "sup/bufpool.h"
 #include "sup/trace.h"
 #include "sup/util.h"
 #include "sup/uvtools.h"
@@ -53,7 +56,9 @@
 #include "builtins/builtins.h"
 
 #include "client-data.h"
+#include "outbound.h"
 #include "pending-reqs.h"
+#include "registry-batch.h"
 #include "server-clients.h"
 #include "server-internal.h"
 #include "server-loopreq.h"
@@ -61,113 +66,22 @@
 
 #include "dicey_config.h"
 
+#define OUTBOUND_DEFAULT_FLUSH_BYTES ((size_t) 64U * 1024U) // 64KB
+#define OUTBOUND_DEFAULT_FLUSH_PACKETS ((size_t) 256U)
+
 #define DICEY_SET_RESPONSE_SIG                                                                                         \
     (const char[]) { (char) DICEY_TYPE_UNIT, '\0' }
 
-struct outbound_packet {
-    enum dicey_op kind;
-
-    union {
-        struct dicey_shared_packet *shared;
-        struct dicey_packet single;
-    };
-};
-
-static struct dicey_packet outbound_packet_borrow(const struct outbound_packet packet) {
-    switch (packet.kind) {
-    case DICEY_OP_RESPONSE:
-        return packet.single;
-
-    case DICEY_OP_SIGNAL:
-        return dicey_shared_packet_borrow(packet.shared);
-
-    default:
-        assert(false);
-
-        return (struct dicey_packet) { 0 };
-    }
-}
-
-// utility function that either deallocates or decrements the refcount of the packet, depending if it's shared or not
-static void outbound_packet_cleanup(struct outbound_packet *const packet) {
-    assert(packet);
-
-    switch (packet->kind) {
-    case DICEY_OP_RESPONSE:
-        dicey_packet_deinit(&packet->single);
-
-        break;
-
-    case DICEY_OP_SIGNAL:
-        dicey_shared_packet_unref(packet->shared);
-
-        break;
-
-    default:
-        assert(false);
-
-        break;
-    }
-
-    *packet = (struct outbound_packet) { 0 };
-}
-
-#if !defined(NDEBUG)
-static bool outbound_packet_is_valid(const struct outbound_packet packet) {
-    switch (packet.kind) {
-    case DICEY_OP_RESPONSE:
-        return dicey_packet_is_valid(packet.single);
-
-    case DICEY_OP_SIGNAL:
-        return dicey_shared_packet_is_valid(packet.shared);
-
-    default:
-        assert(false);
-
-        return false;
-    }
-}
-#endif
-
-static void *outbound_packet_payload(const struct outbound_packet packet) {
-    switch (packet.kind) {
-    case DICEY_OP_RESPONSE:
-        return packet.single.payload;
-
-    case DICEY_OP_SIGNAL:
-        return dicey_shared_packet_borrow(packet.shared).payload;
-
-    default:
-        assert(false);
-
-        return NULL;
-    }
-}
-
-static size_t outbound_packet_size(const struct outbound_packet packet) {
-    switch (packet.kind) {
-    case DICEY_OP_RESPONSE:
-        return packet.single.nbytes;
-
-    case DICEY_OP_SIGNAL:
-        return dicey_shared_packet_size(packet.shared);
-
-    default:
-        assert(false);
-
-        return 0U;
-    }
-}
-
 struct write_request {
     uv_write_t req;
     struct dicey_server *server;
 
     ptrdiff_t client_id;
 
-    enum dicey_packet_kind kind;
+    bool has_bye; // true if one of the packets is a bye, which means the client must be dropped after the write
 
-    struct outbound_packet packet;
+    size_t npackets;
+    struct dicey_outbound_packet packets[];
 };
 
 static void loop_request_delete(void *const ctx, void *const ptr) {
@@ -188,7 +102,32 @@ static void loop_request_delete(void *const ctx, void *const ptr) {
     }
 }
 
+static void alloc_buffer(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf);
+static void loop_request_inbound(uv_async_t *async);
+static void on_flush_idle(uv_idle_t *idle);
+static void on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf);
 static void on_write(uv_write_t *req, int status);
+static enum dicey_error server_kick_client(
+    struct dicey_server *server,
+    struct dicey_client_data *client,
+    enum dicey_bye_reason reason
+);
+static void server_send_batch_response_inline(struct dicey_server *server, size_t id, struct dicey_packet packet);
+
+// true if the caller is running on the server's loop thread, where the server's state can be accessed directly
+static bool is_on_loop_thread(const struct dicey_server *const server) {
+    assert(server);
+
+    // pairs with the release store in dicey_server_start: if the server is seen as running, loop_thread is set
+    const enum dicey_server_state state = atomic_load_explicit(&server->state, memory_order_acquire);
+    if (state != SERVER_STATE_RUNNING && state != SERVER_STATE_QUITTING) {
+        return false;
+    }
+
+    const uv_thread_t self = uv_thread_self();
+
+    return uv_thread_equal(&self, &server->loop_thread);
+}
 
 static bool is_event_msg(const struct dicey_packet pkt) {
     struct dicey_message msg = { 0 };
@@ -209,14 +148,16 @@ static bool can_send_as_event(const struct dicey_packet packet) {
 }
 
 static enum dicey_error is_message_acceptable_for(
-    const struct dicey_element elem,
+    const struct dicey_route *const route,
     const struct dicey_message *const msg
 ) {
-    assert(msg);
+    assert(route && route->entry.element && msg);
+
+    const struct dicey_element *const elem = route->entry.element;
 
     switch (msg->type) {
     case DICEY_OP_GET:
-        if (elem.type != DICEY_ELEMENT_TYPE_PROPERTY) {
+        if (elem->type != DICEY_ELEMENT_TYPE_PROPERTY) {
             return DICEY_EINVAL;
         }
 
@@ -224,25 +165,25 @@ static enum dicey_error is_message_acceptable_for(
         return DICEY_OK;
 
     case DICEY_OP_SET:
-        if (elem.type != DICEY_ELEMENT_TYPE_PROPERTY) {
+        if (elem->type != DICEY_ELEMENT_TYPE_PROPERTY) {
             return DICEY_EINVAL;
         }
 
-        if (elem.flags & DICEY_ELEMENT_READONLY) {
+        if (elem->flags & DICEY_ELEMENT_READONLY) {
             return DICEY_EPROPERTY_READ_ONLY;
         }
 
         break;
 
     case DICEY_OP_EXEC:
-        if (elem.type != DICEY_ELEMENT_TYPE_OPERATION) {
+        if (elem->type != DICEY_ELEMENT_TYPE_OPERATION) {
             return DICEY_EINVAL;
         }
 
         break;
 
     case DICEY_OP_SIGNAL:
-        if (elem.type != DICEY_ELEMENT_TYPE_SIGNAL) {
+        if (elem->type != DICEY_ELEMENT_TYPE_SIGNAL) {
             return DICEY_EINVAL;
         }
 
@@ -257,7 +198,23 @@ static enum dicey_error is_message_acceptable_for(
         return DICEY_EINVAL;
     }
 
-    return dicey_value_is_compatible_with(&msg->value, elem.signature) ? DICEY_OK : DICEY_ESIGNATURE_MISMATCH;
+    return dicey_validator_accepts(route->validator, &msg->value) ? DICEY_OK : DICEY_ESIGNATURE_MISMATCH;
+}
+
+// returns the last value published for the property targeted by a GET, or NULL if the request must go through the
+// regular path (i.e. the property isn't cached, or nothing has been published for it yet)
+static const struct dicey_packet *server_cached_value_for(
+    struct dicey_server *const server,
+    const struct dicey_route *const route,
+    const struct dicey_message *const msg
+) {
+    assert(server && route && route->entry.element && msg);
+
+    if (msg->type != DICEY_OP_GET || !(route->entry.element->flags & DICEY_ELEMENT_CACHED)) {
+        return NULL;
+    }
+
+    return dicey_property_cache_get(&server->props, route->entry.main_path, msg->selector);
 }
 
 static bool is_server_op(const enum dicey_op op) {
@@ -327,7 +284,6 @@ static enum dicey_error registry_add_aliases(
     enum dicey_error err = DICEY_OK;
 
     while (dicey_hashset_iter_next(&iter, &alias)) {
-next:
         err = dicey_registry_alias_object(registry, path, alias);
 
         switch (err) {
@@ -336,7 +292,7 @@ next:
 
         case DICEY_EEXIST:
             // if the alias already exists, we can ignore the error and don't waste time with hashset_add
-            goto next;
+            continue;
 
         default:
             goto out; // stop in case we encounter an unexpected error
@@ -380,42 +336,419 @@ out:; // the ; is needed, because C standard doesn't allow declarations after la
     return good ? DICEY_OK : err;
 }
 
-static enum dicey_error server_sendpkt(
-    struct dicey_server *const server,
-    struct dicey_client_data *const client,
-    struct outbound_packet packet
-) {
-    assert(server && client && outbound_packet_is_valid(packet));
+static enum dicey_error server_flush_client(struct dicey_server *const server, struct dicey_client_data *const client) {
+    assert(server && client);
 
-    const size_t nbytes = outbound_packet_size(packet);
-    if (nbytes > UINT_MAX) {
-        return TRACE(DICEY_EOVERFLOW);
+    struct dicey_outbound_queue *const queue = &client->outbound;
+
+    const size_t npackets = queue->len;
+    if (!npackets) {
+        return DICEY_OK;
     }
 
-    enum dicey_error err = DICEY_OK;
+    const size_t nbytes = queue->nbytes;
 
-    struct write_request *const req = malloc(sizeof *req);
+    struct write_request *const req = dicey_bufpool_alloc(sizeof *req + npackets * sizeof *req->packets);
     if (!req) {
-        err = TRACE(DICEY_ENOMEM);
-
-        goto fail;
+        return TRACE(DICEY_ENOMEM); // the packets stay queued, we'll try again later
     }
 
     *req = (struct write_request) {
         .server = server,
         .client_id = client->info.id,
-        .packet = packet,
+        .npackets = npackets,
     };
 
-    void *const payload = outbound_packet_payload(packet);
-    assert(payload);
+    // the packets are now owned by the write request. uv_write copies the buffer list, so the queue can be reused
+    // right away
+    const size_t taken = dicey_outbound_queue_take(queue, req->packets);
+    assert(taken == npackets);
+    DICEY_UNUSED(taken);
 
-    uv_buf_t buf = uv_buf_init(payload, (unsigned int) nbytes);
+    for (size_t i = 0U; i < npackets; ++i) {
+        if (dicey_packet_get_kind(dicey_outbound_packet_borrow(req->packets[i])) == DICEY_PACKET_KIND_BYE) {
+            req->has_bye = true;
 
-    return dicey_error_from_uv(uv_write((uv_write_t *) req, (uv_stream_t *) client, &buf, 1, &on_write));
+            break;
+        }
+    }
 
-fail:
-    free(req);
+    const int uverr =
+        uv_write((uv_write_t *) req, (uv_stream_t *) client, queue->bufs, (unsigned int) npackets, &on_write);
+    if (uverr < 0) {
+        for (size_t i = 0U; i < npackets; ++i) {
+            dicey_outbound_packet_cleanup(&req->packets[i]);
+        }
+
+        dicey_bufpool_free(req);
+
+        return dicey_error_from_uv(uverr);
+    }
+
+    client->inflight_packets += npackets;
+
+    atomic_fetch_add_explicit(&server->stats.writes, 1U, memory_order_relaxed);
+    atomic_fetch_add_explicit(&server->stats.packets, npackets, memory_order_relaxed);
+    atomic_fetch_add_explicit(&server->stats.bytes, nbytes, memory_order_relaxed);
+
+    return DICEY_OK;
+}
+
+static void server_flush_client_or_report(struct dicey_server *const server, struct dicey_client_data *const client) {
+    const enum dicey_error err = server_flush_client(server, client);
+    if (err) {
+        server->on_error(server, err, &client->info, "write error: %s\n", dicey_error_name(err));
+    }
+}
+
+static enum dicey_error server_schedule_flush(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client
+) {
+    assert(server && client);
+
+    if (client->outbound.scheduled) {
+        return DICEY_OK;
+    }
+
+    if (server->flush_list.len == server->flush_list.cap) {
+        const size_t new_cap = server->flush_list.cap ? server->flush_list.cap * 3 / 2 : 16U;
+
+        size_t *const ids = realloc(server->flush_list.ids, new_cap * sizeof *ids);
+        if (!ids) {
+            return TRACE(DICEY_ENOMEM);
+        }
+
+        server->flush_list.ids = ids;
+        server->flush_list.cap = new_cap;
+    }
+
+    server->flush_list.ids[server->flush_list.len++] = client->info.id;
+    client->outbound.scheduled = true;
+
+    // an active idle handle forces the loop not to block in the poll phase, so the check handle runs right away even
+    // if the packets were queued from a timer or a prepare callback
+    if (!uv_is_active((uv_handle_t *) &server->flush_idle)) {
+        return dicey_error_from_uv(uv_idle_start(&server->flush_idle, &on_flush_idle));
+    }
+
+    return DICEY_OK;
+}
+
+static const char *overflow_policy_name(const enum dicey_server_overflow_policy policy) {
+    switch (policy) {
+    case DICEY_SERVER_OVERFLOW_DROP_SIGNALS:
+        return "drop signals";
+
+    case DICEY_SERVER_OVERFLOW_CONFLATE_SIGNALS:
+        return "conflate signals";
+
+    case DICEY_SERVER_OVERFLOW_PAUSE_READING:
+        return "pause reading";
+
+    case DICEY_SERVER_OVERFLOW_KICK:
+        return "kick";
+
+    default:
+        return "unknown";
+    }
+}
+
+static size_t client_inflight_bytes(const struct dicey_client_data *const client) {
+    return uv_stream_get_write_queue_size((const uv_stream_t *) client);
+}
+
+static bool client_has_budget(const struct dicey_client_data *const client) {
+    return client->outbound_max_bytes || client->outbound_max_packets;
+}
+
+static bool client_would_exceed_budget(const struct dicey_client_data *const client, const size_t nbytes) {
+    if (!client_has_budget(client)) {
+        return false;
+    }
+
+    const size_t pending_bytes = client->outbound.nbytes + client_inflight_bytes(client) + nbytes;
+    const size_t pending_packets = client->outbound.len + client->inflight_packets + 1U;
+
+    return (client->outbound_max_bytes && pending_bytes > client->outbound_max_bytes) ||
+           (client->outbound_max_packets && pending_packets > client->outbound_max_packets);
+}
+
+// a client is considered to have caught up once the data libuv is still writing falls below half the budget. Queued
+// packets are not counted, because while conflating they are held back until this happens
+static bool client_has_caught_up(const struct dicey_client_data *const client) {
+    return (!client->outbound_max_bytes || client_inflight_bytes(client) <= client->outbound_max_bytes / 2U) &&
+           (!client->outbound_max_packets || client->inflight_packets <= client->outbound_max_packets / 2U);
+}
+
+// true if the queue must not be flushed yet, because signals are still being conflated into it
+static bool client_is_holding_outbound(const struct dicey_client_data *const client) {
+    return client->over_budget && client->overflow_policy == DICEY_SERVER_OVERFLOW_CONFLATE_SIGNALS;
+}
+
+// replaces the queued signal with the same path and selector as `packet`, if any. Returns false if there is none
+static bool client_conflate_signal(struct dicey_client_data *const client, const struct dicey_outbound_packet packet) {
+    struct dicey_message msg = { 0 };
+    if (dicey_packet_as_message(dicey_outbound_packet_borrow(packet), &msg)) {
+        return false;
+    }
+
+    struct dicey_outbound_queue *const queue = &client->outbound;
+
+    for (size_t i = 0U; i < queue->len; ++i) {
+        const struct dicey_outbound_packet queued = queue->packets[i];
+        if (queued.kind != DICEY_OP_SIGNAL) {
+            continue;
+        }
+
+        struct dicey_message queued_msg = { 0 };
+        if (dicey_packet_as_message(dicey_outbound_packet_borrow(queued), &queued_msg)) {
+            continue;
+        }
+
+        if (!strcmp(msg.path, queued_msg.path) && !dicey_selector_cmp(msg.selector, queued_msg.selector)) {
+            return dicey_outbound_queue_replace(queue, i, packet) == DICEY_OK;
+        }
+    }
+
+    return false;
+}
+
+static void client_pause_reading(struct dicey_client_data *const client) {
+    if (!client->reading_paused && client->state != CLIENT_DATA_STATE_DEAD) {
+        (void) uv_read_stop((uv_stream_t *) client);
+
+        client->reading_paused = true;
+    }
+}
+
+// applies the overflow policy of a client that has exceeded its outbound budget. Returns true if `packet` has been
+// consumed by the policy, false if it must be queued as usual
+static bool client_handle_overflow(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    struct dicey_outbound_packet *const packet
+) {
+    assert(server && client && packet);
+
+    if (!client->over_budget) {
+        client->over_budget = true;
+
+        server->on_error(
+            server,
+            DICEY_EOVERFLOW,
+            &client->info,
+            "client exceeded its outbound budget (%zu bytes, %zu packets pending), policy: %s\n",
+            client->outbound.nbytes + client_inflight_bytes(client),
+            client->outbound.len + client->inflight_packets,
+            overflow_policy_name(client->overflow_policy)
+        );
+
+        switch (client->overflow_policy) {
+        case DICEY_SERVER_OVERFLOW_PAUSE_READING:
+            client_pause_reading(client);
+
+            break;
+
+        case DICEY_SERVER_OVERFLOW_KICK:
+            if (client->state != CLIENT_DATA_STATE_DEAD) {
+                dicey_client_data_set_state(client, CLIENT_DATA_STATE_DEAD);
+
+                // nothing else is going to be delivered, so don't bother sending what's still queued
+                dicey_outbound_queue_clear(&client->outbound);
+
+                const enum dicey_error err = server_kick_client(server, client, DICEY_BYE_REASON_KICKED);
+                if (err) {
+                    server->on_error(server, err, &client->info, "server_kick_client: %s\n", dicey_error_name(err));
+                }
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    switch (client->overflow_policy) {
+    case DICEY_SERVER_OVERFLOW_DROP_SIGNALS:
+    case DICEY_SERVER_OVERFLOW_CONFLATE_SIGNALS:
+        if (packet->kind != DICEY_OP_SIGNAL) {
+            // responses can't be dropped or conflated, so these policies can't keep them within the budget. Stop
+            // reading requests from the client until it catches up, or its responses would pile up without bound
+            client_pause_reading(client);
+
+            return false;
+        }
+
+        if (client->overflow_policy == DICEY_SERVER_OVERFLOW_DROP_SIGNALS) {
+            break;
+        }
+
+        if (client_conflate_signal(client, *packet)) {
+            return true; // the queue now owns the packet
+        }
+
+        return false; // first signal for this element, queue it
+
+    case DICEY_SERVER_OVERFLOW_PAUSE_READING:
+        return false;
+
+    case DICEY_SERVER_OVERFLOW_KICK:
+    default:
+        break; // the client is going away, drop everything
+    }
+
+    dicey_outbound_packet_cleanup(packet);
+
+    return true;
+}
+
+// called whenever some of a client's data has been written. Lifts the overflow policy if the client has caught up
+static void client_update_budget(struct dicey_server *const server, struct dicey_client_data *const client) {
+    assert(server && client);
+
+    if (!client->over_budget || client->state == CLIENT_DATA_STATE_DEAD || !client_has_caught_up(client)) {
+        return;
+    }
+
+    client->over_budget = false;
+
+    if (client->reading_paused) {
+        client->reading_paused = false;
+
+        const int uverr = uv_read_start((uv_stream_t *) client, &alloc_buffer, &on_read);
+        if (uverr < 0) {
+            server->on_error(
+                server, dicey_error_from_uv(uverr), &client->info, "uv_read_start: %s\n", uv_strerror(uverr)
+            );
+        }
+    }
+
+    // the queue may have been held back while conflating
+    if (client->outbound.len) {
+        const enum dicey_error err = server_schedule_flush(server, client);
+        if (err) {
+            server_flush_client_or_report(server, client);
+        }
+    }
+}
+
+// queues a packet for `client`. The packet is consumed on success, and left untouched on failure.
+// Nothing is written immediately: all the packets queued during a loop iteration are written together in
+// on_flush_check, unless the queue grows beyond the configured thresholds.
+// If the client has an outbound budget and exceeds it, the packet may be dropped or conflated instead. Byes are never
+// subject to the budget
+static enum dicey_error server_sendpkt(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    struct dicey_outbound_packet packet
+) {
+    assert(server && client && dicey_outbound_packet_is_valid(packet));
+
+    struct dicey_outbound_queue *const queue = &client->outbound;
+
+    const bool is_bye = dicey_packet_get_kind(dicey_outbound_packet_borrow(packet)) == DICEY_PACKET_KIND_BYE;
+
+    if (!is_bye && (client->over_budget || client_would_exceed_budget(client, dicey_outbound_packet_size(packet))) &&
+        client_handle_overflow(server, client, &packet)) {
+        return DICEY_OK;
+    }
+
+    const enum dicey_error err = dicey_outbound_queue_push(queue, packet);
+    if (err) {
+        return err;
+    }
+
+    // from now on the packet belongs to the queue: errors past this point must not be returned to the caller, or it
+    // will attempt to free the packet again.
+    // While conflating, the packets are kept in the queue where signals can still be replaced, and on_flush_check only
+    // writes them once the client catches up. A bye always flushes everything, given that the client is going away
+    const bool hold = client_is_holding_outbound(client);
+
+    if (is_bye || (!hold && (queue->len >= server->flush_packets || queue->nbytes >= server->flush_bytes))) {
+        server_flush_client_or_report(server, client);
+    } else {
+        const enum dicey_error sched_err = server_schedule_flush(server, client);
+        if (sched_err) {
+            // can't defer the write, just send everything now
+            server_flush_client_or_report(server, client);
+        }
+    }
+
+    return DICEY_OK;
+}
+
+// sends the aggregated responses of all the batches of `client` that are done
+static void server_finish_batches(struct dicey_server *const server, struct dicey_client_data *const client) {
+    assert(server && client);
+
+    struct dicey_batch_request *batch = NULL;
+
+    while ((batch = dicey_batch_requests_take_done(client->batches))) {
+        struct dicey_outbound_packet response = { .kind = DICEY_OP_RESPONSE };
+
+        enum dicey_error err = dicey_batch_request_build_response(batch, &response.single);
+        if (err) {
+            // the results can't be sent, so at least let the client know that the whole batch failed
+            err = make_error(&response.single, batch->seq, batch->path, batch->sel, err);
+        }
+
+        if (!err) {
+            err = server_sendpkt(server, client, response);
+
+            if (err) {
+                dicey_outbound_packet_cleanup(&response);
+            }
+        }
+
+        if (err) {
+            // if this fails the client will time out, there's not much else we can do
+            server->on_error(server, err, &client->info, "failed to send batch response: %s", dicey_error_name(err));
+        }
+
+        dicey_batch_request_delete(batch);
+    }
+}
+
+static enum dicey_error client_complete_batch_item(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    struct dicey_packet packet,
+    const struct dicey_message *const msg, // packet, parsed as msg
+    const uint32_t seq
+) {
+    assert(server && client && msg);
+
+    size_t item = 0U;
+
+    struct dicey_batch_request *const batch = dicey_batch_requests_find(client->batches, seq, &item);
+    if (!batch || batch->slots[item].done) {
+        dicey_packet_deinit(&packet);
+
+        return TRACE(DICEY_ENOENT);
+    }
+
+    const struct dicey_request *const req = &batch->slots[item].req;
+
+    // same checks as regular responses, but a mismatch only fails this item
+    const bool can_return = req->op == DICEY_OP_SET
+                                ? dicey_value_can_be_returned_from(&msg->value, DICEY_SET_RESPONSE_SIG)
+                                : dicey_validator_can_return(req->validator, &msg->value);
+
+    enum dicey_error err = DICEY_OK;
+
+    if (can_return) {
+        dicey_batch_request_complete(batch, item, packet);
+    } else {
+        dicey_packet_deinit(&packet);
+
+        err = TRACE(DICEY_ESIGNATURE_MISMATCH);
+
+        dicey_batch_request_fail(batch, item, err);
+    }
+
+    server_finish_batches(server, client);
 
     return err;
 }
@@ -450,6 +783,11 @@ static enum dicey_error client_send_response(
         goto quit;
     }
 
+    if (dicey_batch_seq_is_item(seq)) {
+        // a response to an item of a GetMany or SetMany. It's collected with the others and sent back all at once
+        return client_complete_batch_item(server, client, packet, msg, seq);
+    }
+
     err = dicey_pending_requests_complete(client->pending, seq, &req);
     if (err) {
         goto quit;
@@ -457,9 +795,11 @@ static enum dicey_error client_send_response(
 
     // if the request was a set, the response must have a unit signature, while in all other cases, the response
     // must have the same signature as the request
-    const char *sig = req.op == DICEY_OP_SET ? DICEY_SET_RESPONSE_SIG : req.signature;
+    const bool can_return = req.op == DICEY_OP_SET
+                                ? dicey_value_can_be_returned_from(&msg->value, DICEY_SET_RESPONSE_SIG)
+                                : dicey_validator_can_return(req.validator, &msg->value);
 
-    if (!dicey_value_can_be_returned_from(&msg->value, sig)) {
+    if (!can_return) {
         err = TRACE(DICEY_ESIGNATURE_MISMATCH);
 
         goto quit;
@@ -468,7 +808,7 @@ static enum dicey_error client_send_response(
     err = server_sendpkt(
         server,
         client,
-        (struct outbound_packet) {
+        (struct dicey_outbound_packet) {
             .kind = DICEY_OP_RESPONSE,
             .single = packet, // responses are always single packets
         }
@@ -536,13 +876,31 @@ static void server_shutdown_at_end(uv_handle_t *const handle) {
     }
 }
 
+static void server_close_flush_idle(uv_handle_t *const handle) {
+    assert(handle);
+
+    struct dicey_server *const server = handle->data;
+    assert(server);
+
+    uv_close((uv_handle_t *) &server->flush_idle, &server_shutdown_at_end);
+}
+
+static void server_close_flush_check(uv_handle_t *const handle) {
+    assert(handle);
+
+    struct dicey_server *const server = handle->data;
+    assert(server);
+
+    uv_close((uv_handle_t *) &server->flush_check, &server_close_flush_idle);
+}
+
 static void server_close_prepare(uv_handle_t *const handle) {
     assert(handle);
 
     struct dicey_server *const server = handle->data; // the async handle, which has the server as data
     assert(server);
 
-    uv_close((uv_handle_t *) &server->startup_prepare, &server_shutdown_at_end);
+    uv_close((uv_handle_t *) &server->startup_prepare, &server_close_flush_check);
 }
 
 static void server_close_pipe(uv_handle_t *const handle) {
@@ -600,7 +958,7 @@ static enum dicey_error server_kick_client(
 ) {
     assert(server);
 
-    struct outbound_packet packet = { .kind = DICEY_OP_RESPONSE };
+    struct dicey_outbound_packet packet = { .kind = DICEY_OP_RESPONSE };
 
     enum dicey_error err = dicey_packet_bye(&packet.single, server_next_seq(server), reason);
     if (err) {
@@ -610,7 +968,7 @@ static enum dicey_error server_kick_client(
     err = server_sendpkt(server, client, packet);
 
     if (err) {
-        outbound_packet_cleanup(&packet);
+        dicey_outbound_packet_cleanup(&packet);
     }
 
     return err;
@@ -624,7 +982,7 @@ static enum dicey_error server_report_error(
 ) {
     assert(server && client);
 
-    struct outbound_packet packet = { .kind = DICEY_OP_RESPONSE };
+    struct dicey_outbound_packet packet = { .kind = DICEY_OP_RESPONSE };
 
     uint32_t seq = UINT32_MAX;
     enum dicey_error err = dicey_packet_get_seq(req, &seq);
@@ -646,7 +1004,7 @@ static enum dicey_error server_report_error(
     err = server_sendpkt(server, client, packet);
 
     if (err) {
-        outbound_packet_cleanup(&packet);
+        dicey_outbound_packet_cleanup(&packet);
     }
 
     return err;
@@ -658,20 +1016,29 @@ struct prune_ctx {
     const char *path_to_prune;
 };
 
-static bool request_should_prune_if_matching(const struct dicey_request *const req, void *const ctx) {
-    const struct prune_ctx *const pctx = ctx;
-
+static bool request_targets_pruned_path(const struct dicey_request *const req, const struct prune_ctx *const pctx) {
     assert(req && pctx && pctx->server);
 
     const char *const main_path = dicey_registry_get_main_path(&pctx->server->registry, pctx->path_to_prune);
     assert(main_path); // the object must exist, we should have catched it earlier
 
+    return !strcmp(main_path, req->real_path);
+}
+
+static bool batch_item_should_prune_if_matching(const struct dicey_request *const req, void *const ctx) {
+    // the error is reported as the result of the item, once the whole batch is done
+    return request_targets_pruned_path(req, ctx);
+}
+
+static bool request_should_prune_if_matching(const struct dicey_request *const req, void *const ctx) {
+    const struct prune_ctx *const pctx = ctx;
+
     // check if the request is for the object we are removing
-    if (!strcmp(main_path, req->real_path)) {
+    if (request_targets_pruned_path(req, pctx)) {
         const struct dicey_message *const msg = dicey_request_get_message(req);
         assert(msg);
 
-        struct outbound_packet packet = { .kind = DICEY_OP_RESPONSE };
+        struct dicey_outbound_packet packet = { .kind = DICEY_OP_RESPONSE };
         enum dicey_error err =
             make_error(&packet.single, req->packet_seq, msg->path, msg->selector, DICEY_EPATH_DELETED);
         if (!err) {
@@ -681,7 +1048,7 @@ static bool request_should_prune_if_matching(const struct dicey_request *const r
             err = server_sendpkt(pctx->server, pctx->client, packet);
 
             if (err) {
-                outbound_packet_cleanup(&packet);
+                dicey_outbound_packet_cleanup(&packet);
             }
         }
 
@@ -691,27 +1058,184 @@ static bool request_should_prune_if_matching(const struct dicey_request *const r
     return false;
 }
 
+// the property cache is keyed by the main path of each object, while `path` may be any of its aliases
+static void drop_cached_properties(struct dicey_server *const server, const char *const path) {
+    const char *const main_path = dicey_registry_get_main_path(&server->registry, path);
+
+    if (main_path) {
+        dicey_property_cache_drop_object(&server->props, main_path);
+    }
+}
+
 static enum dicey_error remove_object(struct dicey_server *server, const char *const path) {
     // before removing an object from the registry, we must prune all pending requests to it from all clients
     struct dicey_client_data *const *const end = dicey_client_list_end(server->clients);
 
-    for (struct dicey_client_data *const *cur = dicey_client_list_begin(server->clients); cur < end; ++cur) {
-        struct dicey_client_data *client = *cur;
+    for (struct dicey_client_data *const *cur = dicey_client_list_begin(server->clients); cur < end; ++cur) {
+        struct dicey_client_data *client = *cur;
+
+        if (!client) {
+            continue;
+        }
+
+        struct prune_ctx ctx = {
+            .server = server,
+            .client = client,
+            .path_to_prune = path,
+        };
+
+        dicey_pending_requests_prune(client->pending, &request_should_prune_if_matching, &ctx);
+
+        dicey_batch_requests_prune(client->batches, &batch_item_should_prune_if_matching, &ctx, DICEY_EPATH_DELETED);
+        server_finish_batches(server, client);
+    }
+
+    drop_cached_properties(server, path);
+
+    return dicey_registry_delete_object(&server->registry, path);
+}
+
+// applies every entry of the batch in order, and writes their outcome in `results` (if any). Must either be called
+// before the server starts or on the loop thread. Returns the error of the first entry that failed
+static enum dicey_error server_apply_registry_batch(
+    struct dicey_server *const server,
+    const struct dicey_server_registry_batch *const batch,
+    enum dicey_error *const results
+) {
+    assert(server && batch);
+
+    // room for the NULL-terminated trait list of any object in the batch
+    const char **const traits = calloc(batch->max_traits + 1U, sizeof *traits);
+    if (!traits) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    enum dicey_error first_err = DICEY_OK;
+
+    for (size_t i = 0U; i < batch->len; ++i) {
+        const struct dicey_registry_batch_entry *const entry = &batch->entries[i];
+        const char *const path = dicey_registry_batch_entry_path(batch, entry);
+
+        enum dicey_error err = DICEY_OK;
+
+        switch (entry->op) {
+        case DICEY_REGISTRY_BATCH_OP_ADD_OBJECT:
+            dicey_registry_batch_entry_traits(batch, entry, traits);
+
+            err = dicey_registry_add_object_with_trait_list(&server->registry, path, traits);
+            break;
+
+        case DICEY_REGISTRY_BATCH_OP_ADD_ALIAS:
+            err = dicey_registry_alias_object(&server->registry, path, dicey_registry_batch_entry_arg(batch, entry));
+            break;
+
+        case DICEY_REGISTRY_BATCH_OP_DELETE_OBJECT:
+            // also prunes the pending requests to the object, if there are any clients
+            err = remove_object(server, path);
+            break;
+
+        default:
+            DICEY_UNREACHABLE();
+
+            err = TRACE(DICEY_EINVAL);
+            break;
+        }
+
+        if (results) {
+            results[i] = err;
+        }
+
+        if (err && !first_err) {
+            first_err = err;
+        }
+    }
+
+    free(traits);
+
+    return first_err;
+}
+
+// stores the value of a cached property, and raises `change_signal` (if any) with the same value. The packet is a
+// response holding the value, and is always consumed
+static enum dicey_error server_publish_property(
+    struct dicey_server *const server,
+    struct dicey_packet packet,
+    const char *const change_signal
+) {
+    assert(server && dicey_packet_is_valid(packet));
+
+    struct dicey_packet signal = { 0 };
+
+    struct dicey_message msg = { 0 };
+    enum dicey_error err = dicey_packet_as_message(packet, &msg);
+    if (err) {
+        goto fail;
+    }
+
+    struct dicey_route route = { 0 };
+    err = dicey_route_cache_resolve(&server->routes, &server->registry, msg.path, msg.selector, &route);
+    if (err) {
+        goto fail;
+    }
+
+    const struct dicey_element *const elem = route.entry.element;
+    if (elem->type != DICEY_ELEMENT_TYPE_PROPERTY || !(elem->flags & DICEY_ELEMENT_CACHED)) {
+        err = TRACE(DICEY_EINVAL);
+
+        goto fail;
+    }
+
+    if (!dicey_validator_accepts(route.validator, &msg.value)) {
+        err = TRACE(DICEY_ESIGNATURE_MISMATCH);
+
+        goto fail;
+    }
+
+    // the message is about to be handed over to the cache, so only use strings owned by the registry from now on
+    const char *const main_path = route.entry.main_path;
+    const struct dicey_selector sel = route.entry.sel;
+
+    if (change_signal) {
+        const struct dicey_selector signal_sel = { .trait = sel.trait, .elem = change_signal };
+
+        struct dicey_route signal_route = { 0 };
+        err = dicey_route_cache_resolve(&server->routes, &server->registry, main_path, signal_sel, &signal_route);
+        if (err) {
+            goto fail;
+        }
+
+        if (signal_route.entry.element->type != DICEY_ELEMENT_TYPE_SIGNAL) {
+            err = TRACE(DICEY_EINVAL);
+
+            goto fail;
+        }
+
+        if (!dicey_validator_accepts(signal_route.validator, &msg.value)) {
+            err = TRACE(DICEY_ESIGNATURE_MISMATCH);
 
-        if (!client) {
-            continue;
+            goto fail;
         }
 
-        struct prune_ctx ctx = {
-            .server = server,
-            .client = client,
-            .path_to_prune = path,
-        };
+        // always raise from the main path, which is what subscriptions are bound to
+        err = dicey_packet_forward_message(&signal, packet, 0U, DICEY_OP_SIGNAL, main_path, signal_route.entry.sel);
+        if (err) {
+            goto fail;
+        }
+    }
 
-        dicey_pending_requests_prune(client->pending, &request_should_prune_if_matching, &ctx);
+    err = dicey_property_cache_set(&server->props, main_path, sel, packet);
+    if (err) {
+        goto fail;
     }
 
-    return dicey_registry_delete_object(&server->registry, path);
+    // the cache owns the packet now
+    return dicey_packet_is_valid(signal) ? dicey_server_raise_internal(server, signal) : DICEY_OK;
+
+fail:
+    dicey_packet_deinit(&signal);
+    dicey_packet_deinit(&packet);
+
+    return err;
 }
 
 static enum dicey_error server_shutdown(struct dicey_server *const server) {
@@ -785,7 +1309,7 @@ static ptrdiff_t client_got_hello(
         return TRACE(DICEY_ECLIENT_TOO_OLD);
     }
 
-    struct outbound_packet hello_repl = { .kind = DICEY_OP_RESPONSE };
+    struct dicey_outbound_packet hello_repl = { .kind = DICEY_OP_RESPONSE };
 
     // reply with the same seq
     enum dicey_error err = dicey_packet_hello(&hello_repl.single, seq, DICEY_PROTO_VERSION_CURRENT);
@@ -796,7 +1320,7 @@ static ptrdiff_t client_got_hello(
     err = server_sendpkt(server, client, hello_repl);
 
     if (err) {
-        outbound_packet_cleanup(&hello_repl);
+        dicey_outbound_packet_cleanup(&hello_repl);
         return err;
     }
 
@@ -823,9 +1347,12 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
         return TRACE(DICEY_EINVAL);
     }
 
-    struct dicey_object_entry obj_entry = { 0 };
+    // resolve path, element, builtin info and compiled signature in one go. Repeated requests hit the route cache
+    struct dicey_route route = { 0 };
+    const enum dicey_error route_err =
+        dicey_route_cache_resolve(&server->routes, &server->registry, message.path, message.selector, &route);
 
-    if (!dicey_registry_get_object_entry(&server->registry, message.path, &obj_entry)) {
+    if (route_err) {
         // not a fatal error: skip the seq and send an error response
         const enum dicey_error skip_err = dicey_pending_request_skip(&client->pending, seq);
         if (skip_err) {
@@ -834,18 +1361,17 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
             return skip_err;
         }
 
-        const enum dicey_error repl_err = server_report_error(server, client, packet, DICEY_EPATH_NOT_FOUND);
+        const enum dicey_error repl_err = server_report_error(server, client, packet, route_err);
 
         // get rid of packet
         dicey_packet_deinit(&packet);
 
-        // shortcircuit: the object was not found, so we've already sent an error response
+        // shortcircuit: the object or element was not found, so we've already sent an error response
         return repl_err ? repl_err : CLIENT_DATA_STATE_RUNNING;
     }
 
-    struct dicey_object_element_entry object_entry = { 0 };
-
-    if (!dicey_registry_get_element_entry_from_sel(&server->registry, message.path, message.selector, &object_entry)) {
+    const enum dicey_error op_err = is_message_acceptable_for(&route, &message);
+    if (op_err) {
         // not a fatal error: skip the seq and send an error response
         const enum dicey_error skip_err = dicey_pending_request_skip(&client->pending, seq);
         if (skip_err) {
@@ -854,18 +1380,18 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
             return skip_err;
         }
 
-        const enum dicey_error repl_err = server_report_error(server, client, packet, DICEY_EELEMENT_NOT_FOUND);
+        const enum dicey_error repl_err = server_report_error(server, client, packet, op_err);
 
         // get rid of packet
         dicey_packet_deinit(&packet);
 
-        // shortcircuit: the element was not found, so we've already sent an error response
+        // shortcircuit: the message has been rejected and we've already sent an error response
         return repl_err ? repl_err : CLIENT_DATA_STATE_RUNNING;
     }
 
-    const enum dicey_error op_err = is_message_acceptable_for(*object_entry.element, &message);
-    if (op_err) {
-        // not a fatal error: skip the seq and send an error response
+    const struct dicey_packet *const cached = server_cached_value_for(server, &route, &message);
+    if (cached) {
+        // the property has a published value: answer straight away, on_request is never involved
         const enum dicey_error skip_err = dicey_pending_request_skip(&client->pending, seq);
         if (skip_err) {
             dicey_packet_deinit(&packet);
@@ -873,20 +1399,34 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
             return skip_err;
         }
 
-        const enum dicey_error repl_err = server_report_error(server, client, packet, op_err);
+        struct dicey_outbound_packet response = { .kind = DICEY_OP_RESPONSE };
+
+        // reuse the encoded value as it is, only stamping the seq and path (which may be an alias) of the request
+        const enum dicey_error fwd_err = dicey_packet_forward_message(
+            &response.single, *cached, seq, DICEY_OP_RESPONSE, message.path, message.selector
+        );
+        if (fwd_err) {
+            const enum dicey_error repl_err = server_report_error(server, client, packet, fwd_err);
+
+            dicey_packet_deinit(&packet);
+
+            return repl_err ? repl_err : CLIENT_DATA_STATE_RUNNING;
+        }
 
-        // get rid of packet
         dicey_packet_deinit(&packet);
 
-        // shortcircuit: the message has been rejected and we've already sent an error response
-        return repl_err ? repl_err : CLIENT_DATA_STATE_RUNNING;
+        const enum dicey_error send_err = server_sendpkt(server, client, response);
+        if (send_err) {
+            dicey_outbound_packet_cleanup(&response);
+        }
+
+        return send_err ? (ptrdiff_t) send_err : CLIENT_DATA_STATE_RUNNING;
     }
 
-    const struct dicey_element_entry elem_entry = dicey_object_element_entry_to_element_entry(&object_entry);
+    const struct dicey_element_entry elem_entry = dicey_object_element_entry_to_element_entry(&route.entry);
 
-    struct dicey_registry_builtin_info binfo = { 0 };
-    if (dicey_registry_get_builtin_info_for(elem_entry, &binfo)) {
-        assert(binfo.handler);
+    const struct dicey_registry_builtin_info binfo = route.binfo;
+    if (binfo.handler) {
 
         // we hit on a builtin
         // validate and skip the seq - otherwise the client state will misalign with the server
@@ -897,7 +1437,7 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
             return skip_err;
         }
 
-        struct outbound_packet response = { .kind = DICEY_OP_RESPONSE };
+        struct dicey_outbound_packet response = { .kind = DICEY_OP_RESPONSE };
 
         struct dicey_builtin_context context = {
             .registry = &server->registry,
@@ -931,7 +1471,7 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
             dicey_packet_deinit(&packet);
         }
 
-        struct dicey_packet rpkt = outbound_packet_borrow(response);
+        struct dicey_packet rpkt = dicey_outbound_packet_borrow(response);
 
         if (!dicey_packet_is_valid(rpkt)) {
             return new_state; // no response needed for this builtin
@@ -939,7 +1479,7 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
         // set the seq number of the response to match the seq number of the request
         const enum dicey_error set_err = dicey_packet_set_seq(rpkt, seq);
         if (set_err) {
-            outbound_packet_cleanup(&response);
+            dicey_outbound_packet_cleanup(&response);
 
             return set_err;
         }
@@ -947,7 +1487,7 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
         const enum dicey_error send_err = server_sendpkt(server, client, response);
 
         if (send_err) {
-            outbound_packet_cleanup(&response);
+            dicey_outbound_packet_cleanup(&response);
         }
 
         return send_err ? (ptrdiff_t) send_err : (ptrdiff_t) new_state;
@@ -956,7 +1496,7 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
     if (server->on_request) {
         struct dicey_request request = { 0 };
 
-        const enum dicey_error err = dicey_server_request_for(server, &client->info, packet, &request);
+        const enum dicey_error err = dicey_server_request_for(server, &client->info, packet, &route, &request);
         if (err) {
             dicey_packet_deinit(&packet);
 
@@ -999,6 +1539,122 @@ static ptrdiff_t client_got_message(struct dicey_client_data *const client, stru
     return CLIENT_DATA_STATE_RUNNING;
 }
 
+// handles a single item of a GetMany or SetMany, in the same way client_got_message handles a standalone request. The
+// packet is always consumed, and the item either gets its outcome right away or is handed to on_request
+static void server_dispatch_batch_item(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    struct dicey_batch_request *const batch,
+    const size_t item,
+    struct dicey_packet packet
+) {
+    assert(server && client && batch && item < batch->nitems);
+
+    struct dicey_message message = { 0 };
+
+    enum dicey_error err = dicey_packet_as_message(packet, &message);
+    if (err) {
+        goto fail;
+    }
+
+    struct dicey_route route = { 0 };
+
+    err = dicey_route_cache_resolve(&server->routes, &server->registry, message.path, message.selector, &route);
+    if (err) {
+        goto fail;
+    }
+
+    err = is_message_acceptable_for(&route, &message);
+    if (err) {
+        goto fail;
+    }
+
+    const struct dicey_packet *const cached = server_cached_value_for(server, &route, &message);
+    if (cached) {
+        struct dicey_packet response = { 0 };
+
+        err = dicey_packet_forward_message(&response, *cached, 0U, DICEY_OP_RESPONSE, message.path, message.selector);
+        if (err) {
+            goto fail;
+        }
+
+        dicey_packet_deinit(&packet);
+        dicey_batch_request_complete(batch, item, response);
+
+        return;
+    }
+
+    if (route.binfo.handler) {
+        const struct dicey_element_entry elem_entry = dicey_object_element_entry_to_element_entry(&route.entry);
+
+        struct dicey_packet response = { 0 };
+
+        struct dicey_builtin_context context = {
+            .registry = &server->registry,
+            .scratchpad = &server->scratchpad,
+        };
+
+        struct dicey_builtin_request request = {
+            .opcode = route.binfo.opcode,
+            .client = client,
+            .path = message.path,
+            .entry = &elem_entry,
+            .source = &packet,
+            .value = &message.value,
+        };
+
+        // builtin properties never alter the state of the client, so the state returned by the handler is ignored
+        const ptrdiff_t builtin_res = route.binfo.handler(&context, &request, &response);
+        if (builtin_res < 0) {
+            err = (enum dicey_error) builtin_res;
+
+            goto fail;
+        }
+
+        if (dicey_packet_is_valid(packet)) {
+            dicey_packet_deinit(&packet);
+        }
+
+        if (dicey_packet_is_valid(response)) {
+            dicey_batch_request_complete(batch, item, response);
+        } else {
+            dicey_batch_request_fail(batch, item, TRACE(DICEY_EINVAL));
+        }
+
+        return;
+    }
+
+    if (!server->on_request) {
+        err = TRACE(DICEY_EINVAL);
+
+        goto fail;
+    }
+
+    struct dicey_batch_slot *const slot = &batch->slots[item];
+
+    err = dicey_server_request_for(server, &client->info, packet, &route, &slot->req);
+    if (err) {
+        goto fail;
+    }
+
+    // the request owns the packet from now on. The user may reply right away, from within on_request
+    server->on_request(server, &slot->req);
+
+    // same as regular requests, if the user failed to build or send a response the item is failed on their behalf
+    if (slot->req.state == DICEY_REQUEST_STATE_ABORTED) {
+        dicey_batch_request_fail(batch, item, DICEY_EAGAIN);
+    }
+
+    return;
+
+fail:
+    if (dicey_packet_is_valid(packet)) {
+        dicey_packet_deinit(&packet);
+    }
+
+    dicey_batch_request_fail(batch, item, err);
+}
+
 static enum dicey_error client_got_packet(struct dicey_client_data *const client, struct dicey_packet packet) {
     assert(client && dicey_packet_is_valid(packet));
 
@@ -1045,6 +1701,11 @@ static enum dicey_error client_got_packet(struct dicey_client_data *const client
         abort(); // unreachable, dicey_packet_is_valid guarantees a valid packet
     }
 
+    // the client may have been kicked while handling the packet (i.e. for exceeding its outbound budget)
+    if (client->state == CLIENT_DATA_STATE_DEAD) {
+        return err < 0 ? err : DICEY_OK;
+    }
+
     if (err < 0) {
         return dicey_server_client_raised_error(client->parent, client, err);
     } else {
@@ -1054,6 +1715,22 @@ static enum dicey_error client_got_packet(struct dicey_client_data *const client
     }
 }
 
+static bool client_got_packet_from_chunk(void *const ctx, const struct dicey_packet packet) {
+    struct dicey_client_data *const client = ctx;
+    assert(client && client->parent);
+
+    struct dicey_server *const server = client->parent;
+
+    DICEY_UNUSED(client_got_packet(client, packet));
+
+    // handlers running on the loop thread reply by submitting requests to the loop queue. Process them right away, so
+    // that a long train of pipelined requests can't fill up the queue and deadlock the loop
+    loop_request_inbound(&server->async);
+
+    // stop parsing if the client has been kicked out or the server is shutting down. Any data left is meaningless
+    return client->state != CLIENT_DATA_STATE_DEAD && server->state == SERVER_STATE_RUNNING;
+}
+
 static void on_write(uv_write_t *const req, const int status) {
     assert(req);
 
@@ -1062,30 +1739,42 @@ static void on_write(uv_write_t *const req, const int status) {
 
     assert(server);
 
-    const struct dicey_client_data *const client = dicey_client_list_get_client(server->clients, write_req->client_id);
-    assert(client);
-
-    const struct dicey_client_info *const info = &client->info;
+    // the client may be gone already: closing a pipe cancels all of its pending writes
+    struct dicey_client_data *const client = dicey_client_list_get_client(server->clients, write_req->client_id);
+    const struct dicey_client_info *const info = client ? &client->info : NULL;
 
-    if (status < 0) {
+    if (status < 0 && status != UV_ECANCELED) {
         server->on_error(server, dicey_error_from_uv(status), info, "write error %s\n", uv_strerror(status));
     }
 
-    // temporarily borrow the packet
-    const struct dicey_packet packet = outbound_packet_borrow(write_req->packet);
+    // writes are only cancelled when the pipe is closed, after the client has been dropped from the list
+    if (client && status != UV_ECANCELED) {
+        assert(client->inflight_packets >= write_req->npackets);
+
+        client->inflight_packets -= write_req->npackets;
+
+        if (!write_req->has_bye) {
+            client_update_budget(server, client);
+        }
+    }
 
-    if (dicey_packet_get_kind(packet) == DICEY_PACKET_KIND_BYE) {
+    if (write_req->has_bye && client) {
         const enum dicey_error err = dicey_server_remove_client(write_req->server, write_req->client_id);
         if (err) {
             server->on_error(server, err, info, "dicey_server_remove_client: %s\n", dicey_error_name(err));
         }
     }
 
-    // either cleans up the packet or decrements the refcount
-    outbound_packet_cleanup(&write_req->packet);
-    free(write_req);
+    // either cleans up the packets or decrements their refcount
+    for (size_t i = 0U; i < write_req->npackets; ++i) {
+        dicey_outbound_packet_cleanup(&write_req->packets[i]);
+    }
+
+    dicey_bufpool_free(write_req);
 
-    if (server->state == SERVER_STATE_QUITTING && dicey_client_list_is_empty(server->clients)) {
+    // canceled writes may still trickle in after the shutdown has been finalized - only do it once
+    if (server->state == SERVER_STATE_QUITTING && !uv_is_closing((uv_handle_t *) &server->async) &&
+        dicey_client_list_is_empty(server->clients)) {
         // all clients have been freed. We can now close the server
         const enum dicey_error err = server_finalize_shutdown(server);
 
@@ -1099,6 +1788,83 @@ static void on_write(uv_write_t *const req, const int status) {
     }
 }
 
+// raises dicey.Registry.Changed if the registry changed since the last time. Called once per loop iteration, so a burst
+// of changes (e.g. a plugin registering all of its objects) only results in a single signal
+static void server_notify_registry_changes(struct dicey_server *const server) {
+    assert(server);
+
+    const uint64_t generation = server->registry.generation;
+    if (generation == server->notified_generation || server->state != SERVER_STATE_RUNNING) {
+        return;
+    }
+
+    server->notified_generation = generation;
+
+    struct dicey_packet signal = { 0 };
+    enum dicey_error err = dicey_packet_message(
+        &signal,
+        0U,
+        DICEY_OP_SIGNAL,
+        DICEY_REGISTRY_PATH,
+        (struct dicey_selector) {
+            .trait = DICEY_REGISTRY_TRAIT_NAME,
+            .elem = DICEY_REGISTRY_CHANGED_SIGNAL_NAME,
+        },
+        (struct dicey_arg) {
+            .type = DICEY_TYPE_UINT64,
+            .u64 = generation,
+        }
+    );
+
+    if (!err) {
+        err = dicey_server_raise_internal(server, signal);
+    }
+
+    if (err) {
+        server->on_error(server, err, NULL, "failed to raise registry changes: %s", dicey_error_name(err));
+    }
+}
+
+static void on_flush_check(uv_check_t *const check) {
+    assert(check && check->data);
+
+    struct dicey_server *const server = check->data;
+
+    // the signal is queued like any other packet, so raise it before flushing
+    server_notify_registry_changes(server);
+
+    // flush every queue that received packets during this loop iteration. The list may grow while we walk it (e.g.
+    // client_update_budget reschedules a client whose queue was held back), which may also reallocate `ids`: always
+    // walk it by index, re-reading both `len` and `ids`, so that anything appended is flushed in this same pass
+    for (size_t i = 0U; i < server->flush_list.len; ++i) {
+        struct dicey_client_data *const client =
+            dicey_client_list_get_client(server->clients, server->flush_list.ids[i]);
+
+        // the client may have been removed in the meantime; its queue is dropped with it
+        if (client && client->outbound.scheduled) {
+            client->outbound.scheduled = false;
+
+            client_update_budget(server, client);
+
+            // a conflating client is flushed from on_write, once it catches up
+            if (!client_is_holding_outbound(client)) {
+                server_flush_client_or_report(server, client);
+            }
+        }
+    }
+
+    server->flush_list.len = 0U;
+
+    // nothing left to flush, let the loop block again
+    (void) uv_idle_stop(&server->flush_idle);
+}
+
+static void on_flush_idle(uv_idle_t *const idle) {
+    // nothing to do: this handle only exists to keep the poll phase from blocking while some queue is waiting to be
+    // flushed
+    DICEY_UNUSED(idle);
+}
+
 static void alloc_buffer(uv_handle_t *const handle, const size_t suggested_size, uv_buf_t *const buf) {
     DICEY_UNUSED(suggested_size); // useless, always 65k (max UDP packet size)
 
@@ -1107,7 +1873,7 @@ static void alloc_buffer(uv_handle_t *const handle, const size_t suggested_size,
 
     *buf = dicey_chunk_get_buf(&client->chunk, READ_MINBUF);
 
-    assert(buf->base && buf->len && buf->len >= READ_MINBUF && client->chunk);
+    assert(buf->base && buf->len && buf->len >= READ_MINBUF && client->chunk.buf);
 }
 
 static void on_read(uv_stream_t *const stream, const ssize_t nread, const uv_buf_t *const buf) {
@@ -1144,33 +1910,17 @@ static void on_read(uv_stream_t *const stream, const ssize_t nread, const uv_buf
         return;
     }
 
-    struct dicey_chunk *const chunk = client->chunk;
-    assert(chunk); // if we got to this point, we must have a chunk
+    struct dicey_chunk *const chunk = &client->chunk;
+    assert(chunk->buf); // if we got to this point, we must have a buffer
 
     // mark the first nread bytes of the chunk as taken
     chunk->len += (size_t) nread;
 
-    const void *base = chunk->bytes;
-    size_t remainder = chunk->len;
-
-    // attempt parsing a packet
-    struct dicey_packet packet = { 0 };
-    const enum dicey_error err = dicey_packet_load(&packet, &base, &remainder);
-    switch (err) {
-    case DICEY_OK:
-        DICEY_UNUSED(client_got_packet(client, packet));
-
-        dicey_chunk_clear(chunk);
-
-        break;
-
-    case DICEY_EAGAIN:
-        break; // not enough data to parse a packet
-
-    default:
+    // parse and dispatch all the packets in the chunk. Clients may pipeline many requests, which may arrive in a single
+    // read
+    const enum dicey_error err = dicey_chunk_drain_packets(chunk, &client_got_packet_from_chunk, client);
+    if (err) {
         DICEY_UNUSED(dicey_server_client_raised_error(client->parent, client, err));
-
-        break;
     }
 }
 
@@ -1257,6 +2007,24 @@ static enum dicey_error loop_request_add_trait(
     return dicey_registry_add_trait(&server->registry, trait);
 }
 
+struct registry_batch_info {
+    const struct dicey_server_registry_batch *batch; // owned by the caller, which is blocked waiting for the request
+    enum dicey_error *results;
+};
+
+static enum dicey_error loop_request_commit_registry_batch(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    void *const payload
+) {
+    DICEY_UNUSED(client);
+
+    const struct registry_batch_info *const info = payload;
+    assert(info && info->batch);
+
+    return server ? server_apply_registry_batch(server, info->batch, info->results) : DICEY_ECANCELLED;
+}
+
 static enum dicey_error loop_request_del_alias(
     struct dicey_server *const server,
     struct dicey_client_data *const client,
@@ -1330,6 +2098,42 @@ static enum dicey_error loop_request_kick_client(
     return server_kick_client(server, client, reason);
 }
 
+struct publish_info {
+    struct dicey_packet packet;
+    char *change_signal; // owned by the request, NULL if no signal must be raised
+};
+
+static enum dicey_error loop_request_publish_property(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    void *const payload
+) {
+    DICEY_UNUSED(client);
+
+    struct publish_info info = { 0 };
+
+    memcpy(&info, payload, sizeof info);
+    assert(dicey_packet_is_valid(info.packet));
+
+    if (!server) {
+        dicey_packet_deinit(&info.packet);
+        free(info.change_signal);
+
+        return DICEY_ECANCELLED;
+    }
+
+    const enum dicey_error err = server_publish_property(server, info.packet, info.change_signal);
+
+    free(info.change_signal);
+
+    if (err) {
+        // nobody is waiting for this request, so this is the only chance to report the error
+        server->on_error(server, err, NULL, "publish_property: %s", dicey_error_name(err));
+    }
+
+    return err;
+}
+
 static enum dicey_error loop_request_raise_signal(
     struct dicey_server *const server,
     struct dicey_client_data *const client,
@@ -1351,6 +2155,65 @@ static enum dicey_error loop_request_raise_signal(
     return dicey_server_raise_internal(server, packet);
 }
 
+// batch requests carry the number of items followed by the items themselves. The payload has no particular alignment,
+// so items are always copied in and out of it
+#define LOOP_BATCH_PAYLOAD_SIZE(N, TYPE) (sizeof(size_t) + (N) * sizeof(TYPE))
+#define LOOP_BATCH_MAX_ITEMS(TYPE) ((SIZE_MAX - sizeof(struct dicey_server_loop_request) - sizeof(size_t)) / sizeof(TYPE))
+
+static void loop_batch_set(
+    struct dicey_server_loop_request *const req,
+    const void *const items,
+    const size_t nitems,
+    const size_t item_size
+) {
+    memcpy(req->payload, &nitems, sizeof nitems);
+    memcpy(req->payload + sizeof nitems, items, nitems * item_size);
+}
+
+static size_t loop_batch_len(const void *const payload) {
+    size_t nitems = 0U;
+    memcpy(&nitems, payload, sizeof nitems);
+
+    return nitems;
+}
+
+static void loop_batch_get(void *const dest, const void *const payload, const size_t i, const size_t item_size) {
+    memcpy(dest, (const char *) payload + sizeof(size_t) + i * item_size, item_size);
+}
+
+static enum dicey_error loop_request_raise_batch(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    void *const payload
+) {
+    DICEY_UNUSED(client);
+
+    const size_t npackets = loop_batch_len(payload);
+
+    enum dicey_error first_err = DICEY_OK;
+
+    for (size_t i = 0U; i < npackets; ++i) {
+        struct dicey_packet packet = { 0 };
+        loop_batch_get(&packet, payload, i, sizeof packet);
+        assert(dicey_packet_is_valid(packet));
+
+        if (!server) {
+            dicey_packet_deinit(&packet);
+
+            continue;
+        }
+
+        // every signal goes through the same path as dicey_server_raise, and is queued on the subscribers' outbound
+        // queues. These are only written once this whole batch (and whatever else is pending) has been processed
+        const enum dicey_error err = dicey_server_raise_internal(server, packet);
+        if (err && !first_err) {
+            first_err = err;
+        }
+    }
+
+    return server ? first_err : DICEY_ECANCELLED;
+}
+
 static enum dicey_error loop_request_send_response(
     struct dicey_server *const server,
     struct dicey_client_data *const client,
@@ -1391,6 +2254,31 @@ quit:
     return err;
 }
 
+static enum dicey_error loop_request_send_responses(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    void *const payload
+) {
+    DICEY_UNUSED(client);
+
+    const size_t nresponses = loop_batch_len(payload);
+
+    for (size_t i = 0U; i < nresponses; ++i) {
+        struct dicey_server_response response = { 0 };
+        loop_batch_get(&response, payload, i, sizeof response);
+        assert(dicey_packet_is_valid(response.packet));
+
+        if (server) {
+            // each response may be for a different client. Failures are reported one by one via on_error
+            server_send_batch_response_inline(server, response.client_id, response.packet);
+        } else {
+            dicey_packet_deinit(&response.packet);
+        }
+    }
+
+    return server ? DICEY_OK : DICEY_ECANCELLED;
+}
+
 // ew! this function is not a real handler, but its address is used as a tag to identify the shutdown request
 // shutting the loop down is a special case, because due to the loop shutting down we can't send a response
 static enum dicey_error loop_request_shutdown_phony_handler(
@@ -1419,7 +2307,7 @@ static void loop_request_inbound(uv_async_t *const async) {
 
     void *item = NULL;
     struct dicey_client_data *client = NULL;
-    while (dicey_queue_pop(&server->queue, &item, DICEY_LOCKING_POLICY_NONBLOCKING)) {
+    while (dicey_queue_pop(&server->queue, &item)) {
         assert(item);
 
         struct dicey_server_loop_request *const req = item;
@@ -1438,6 +2326,9 @@ static void loop_request_inbound(uv_async_t *const async) {
                     free(req);
                 }
 
+                // whatever is left in the queue is handled by the next wakeup, or cancelled when the shutdown completes
+                dicey_queue_reset_wakeup(&server->queue);
+
                 return;
             }
 
@@ -1565,8 +2456,12 @@ void dicey_server_delete(struct dicey_server *const server) {
     }
 
     dicey_registry_deinit(&server->registry);
+    dicey_subscription_index_deinit(&server->subscribers);
+    dicey_route_cache_deinit(&server->routes);
+    dicey_property_cache_deinit(&server->props);
 
     free(server->clients);
+    free(server->flush_list.ids);
     free(server->scratchpad.data);
     free(server);
 }
@@ -1585,6 +2480,9 @@ enum dicey_error dicey_server_new(struct dicey_server **const dest, const struct
         .seq_cnt = 1U, // server-initiated seq numbers are always odd
 
         .clients = NULL,
+
+        .flush_bytes = OUTBOUND_DEFAULT_FLUSH_BYTES,
+        .flush_packets = OUTBOUND_DEFAULT_FLUSH_PACKETS,
     };
 
     enum dicey_error err = dicey_registry_init(&server->registry);
@@ -1600,6 +2498,18 @@ enum dicey_error dicey_server_new(struct dicey_server **const dest, const struct
         server->on_request = args->on_request;
         server->on_startup = args->on_startup;
 
+        if (args->outbound_flush_bytes) {
+            server->flush_bytes = args->outbound_flush_bytes;
+        }
+
+        if (args->outbound_flush_packets) {
+            server->flush_packets = args->outbound_flush_packets;
+        }
+
+        server->client_max_bytes = args->client_max_outbound_bytes;
+        server->client_max_packets = args->client_max_outbound_packets;
+        server->overflow_policy = args->client_overflow_policy;
+
 #if DICEY_HAS_PLUGINS
         server->on_plugin_event = args->on_plugin_event;
 
@@ -1618,10 +2528,8 @@ enum dicey_error dicey_server_new(struct dicey_server **const dest, const struct
         goto free_clients;
     }
 
-    uverr = dicey_queue_init(&server->queue);
-    if (uverr < 0) {
-        err = dicey_error_from_uv(uverr);
-
+    err = dicey_queue_init(&server->queue, args ? args->loop_queue_cap : 0U, true);
+    if (err) {
         goto free_loop;
     }
 
@@ -1652,10 +2560,34 @@ enum dicey_error dicey_server_new(struct dicey_server **const dest, const struct
 
     server->startup_prepare.data = server;
 
+    uverr = uv_check_init(&server->loop, &server->flush_check);
+    if (uverr) {
+        err = dicey_error_from_uv(uverr);
+
+        goto free_prepare;
+    }
+
+    server->flush_check.data = server;
+
+    uverr = uv_idle_init(&server->loop, &server->flush_idle);
+    if (uverr) {
+        err = dicey_error_from_uv(uverr);
+
+        goto free_check;
+    }
+
+    server->flush_idle.data = server;
+
     *dest = server;
 
     return DICEY_OK;
 
+free_check:
+    uv_close((uv_handle_t *) &server->flush_check, NULL);
+
+free_prepare:
+    uv_close((uv_handle_t *) &server->startup_prepare, NULL);
+
 free_pipe:
     uv_close((uv_handle_t *) &server->pipe, NULL);
 
@@ -1894,6 +2826,8 @@ enum dicey_error dicey_server_delete_object(struct dicey_server *const server, c
             struct dicey_registry *const registry = dicey_server_get_registry(server);
             assert(registry);
 
+            drop_cached_properties(server, path);
+
             return dicey_registry_delete_object(registry, path);
         }
 
@@ -2018,10 +2952,82 @@ enum dicey_error dicey_server_drop_all_aliases_of_object(struct dicey_server *co
     }
 }
 
+enum dicey_error dicey_server_registry_batch_commit(
+    struct dicey_server *const server,
+    struct dicey_server_registry_batch *const batch,
+    enum dicey_error *const results
+) {
+    assert(server && batch);
+
+    enum dicey_error err = DICEY_OK;
+
+    // the loop can't wait on itself: when called from it, the batch is applied right away
+    if (is_on_loop_thread(server)) {
+        err = server_apply_registry_batch(server, batch, results);
+
+        goto out;
+    }
+
+    switch ((enum dicey_server_state) server->state) {
+    case SERVER_STATE_UNINIT:
+    case SERVER_STATE_INIT:
+        err = server_apply_registry_batch(server, batch, results);
+
+        break;
+
+    case SERVER_STATE_RUNNING:
+        {
+            struct dicey_server_loop_request *const req = DICEY_SERVER_LOOP_REQ_NEW(struct registry_batch_info);
+            if (!req) {
+                err = TRACE(DICEY_ENOMEM);
+
+                break;
+            }
+
+            *req = (struct dicey_server_loop_request) {
+                .cb = &loop_request_commit_registry_batch,
+                .target = DICEY_SERVER_LOOP_REQ_NO_TARGET,
+            };
+
+            const struct registry_batch_info info = {
+                .batch = batch,
+                .results = results,
+            };
+
+            DICEY_SERVER_LOOP_SET_PAYLOAD(req, struct registry_batch_info, &info);
+
+            // the whole batch is applied by a single request. The batch is only read by the loop while we wait
+            err = dicey_server_blocking_request(server, req);
+
+            break;
+        }
+
+    default:
+        err = TRACE(DICEY_EINVAL);
+
+        break;
+    }
+
+out:
+    dicey_server_registry_batch_discard(batch);
+
+    return err;
+}
+
 void *dicey_server_get_context(struct dicey_server *const server) {
     return server ? server->ctx : NULL;
 }
 
+void dicey_server_get_stats(struct dicey_server *const server, struct dicey_server_stats *const stats) {
+    assert(server && stats);
+
+    *stats = (struct dicey_server_stats) {
+        .writes = atomic_load_explicit(&server->stats.writes, memory_order_relaxed),
+        .packets = atomic_load_explicit(&server->stats.packets, memory_order_relaxed),
+        .bytes = atomic_load_explicit(&server->stats.bytes, memory_order_relaxed),
+    };
+}
+
 struct dicey_registry *dicey_server_get_registry(struct dicey_server *const server) {
     assert(server && server->state <= SERVER_STATE_INIT);
 
@@ -2049,6 +3055,82 @@ enum dicey_error dicey_server_kick(struct dicey_server *const server, const size
     return dicey_server_blocking_request(server, req);
 }
 
+enum dicey_error dicey_server_publish_property(
+    struct dicey_server *const server,
+    const char *const path,
+    const struct dicey_selector sel,
+    const struct dicey_arg value,
+    const char *const change_signal
+) {
+    assert(server && path && dicey_selector_is_valid(sel));
+
+    // encode the value right away, outside of the loop thread. The packet is stored as it is, and only its seq and path
+    // are rewritten when it's sent
+    struct dicey_packet packet = { 0 };
+    enum dicey_error err = dicey_packet_message(&packet, 0U, DICEY_OP_RESPONSE, path, sel, value);
+    if (err) {
+        return err;
+    }
+
+    switch ((enum dicey_server_state) server->state) {
+    case SERVER_STATE_UNINIT:
+    case SERVER_STATE_INIT:
+        return server_publish_property(server, packet, change_signal);
+
+    case SERVER_STATE_RUNNING:
+        {
+            if (is_on_loop_thread(server)) {
+                return server_publish_property(server, packet, change_signal);
+            }
+
+            struct publish_info info = { .packet = packet };
+
+            if (change_signal) {
+                info.change_signal = strdup(change_signal); // the string is NOT owned by the request
+                if (!info.change_signal) {
+                    err = TRACE(DICEY_ENOMEM);
+
+                    break;
+                }
+            }
+
+            struct dicey_server_loop_request *const req = DICEY_SERVER_LOOP_REQ_NEW(struct publish_info);
+            if (!req) {
+                free(info.change_signal);
+                err = TRACE(DICEY_ENOMEM);
+
+                break;
+            }
+
+            *req = (struct dicey_server_loop_request) {
+                .cb = &loop_request_publish_property,
+                .target = DICEY_SERVER_LOOP_REQ_NO_TARGET,
+            };
+
+            DICEY_SERVER_LOOP_SET_PAYLOAD(req, struct publish_info, &info);
+
+            err = dicey_server_submit_request(server, req);
+            if (err) {
+                free(info.change_signal);
+                free(req);
+
+                break;
+            }
+
+            return DICEY_OK;
+        }
+
+    default:
+        err = TRACE(DICEY_EINVAL);
+
+        break;
+    }
+
+    dicey_packet_deinit(&packet);
+
+    return err;
+}
+
 enum dicey_error dicey_server_raise(struct dicey_server *const server, const struct dicey_packet packet) {
     assert(server && dicey_packet_is_valid(packet));
 
@@ -2071,6 +3153,45 @@ enum dicey_error dicey_server_raise(struct dicey_server *const server, const str
     return dicey_server_submit_request(server, req);
 }
 
+enum dicey_error dicey_server_raise_batch(
+    struct dicey_server *const server,
+    const struct dicey_packet *const packets,
+    const size_t npackets
+) {
+    assert(server && (packets || !npackets));
+
+    for (size_t i = 0U; i < npackets; ++i) {
+        if (!can_send_as_event(packets[i])) {
+            return TRACE(DICEY_EINVAL);
+        }
+    }
+
+    if (!npackets) {
+        return DICEY_OK;
+    }
+
+    if (npackets > LOOP_BATCH_MAX_ITEMS(struct dicey_packet)) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    struct dicey_server_loop_request *const req =
+        DICEY_SERVER_LOOP_REQ_NEW_WITH_BYTES(LOOP_BATCH_PAYLOAD_SIZE(npackets, struct dicey_packet));
+    if (!req) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    *req = (struct dicey_server_loop_request) {
+        .cb = &loop_request_raise_batch,
+        .target = DICEY_SERVER_LOOP_REQ_NO_TARGET,
+    };
+
+    loop_batch_set(req, packets, npackets, sizeof *packets);
+
+    // the request is always queued, so the batch belongs to the loop from here on: any error can only come from waking
+    // the loop up, and neither the request nor the packets must be freed
+    return dicey_server_submit_request(server, req);
+}
+
 enum dicey_error dicey_server_raise_and_wait(struct dicey_server *const server, const struct dicey_packet packet) {
     assert(server && dicey_packet_is_valid(packet));
 
@@ -2138,24 +3259,22 @@ enum dicey_error dicey_server_raise_internal(struct dicey_server *const server,
         return err;
     }
 
-    // iterate all clients and check if they should receive the event
-    struct dicey_client_data *const *const end = dicey_client_list_end(server->clients);
-    for (struct dicey_client_data *const *client = dicey_client_list_begin(server->clients); client < end; ++client) {
-        if (!*client) {
-            continue;
-        }
+    // only visit the clients that are actually subscribed to the element
+    const struct dicey_subscriber_list *const subscribers =
+        dicey_subscription_index_get(&server->subscribers, elemdescr);
+    const size_t nsubscribers = subscribers ? subscribers->len : 0U;
 
-        if (!dicey_client_data_is_subscribed(*client, elemdescr)) {
-            continue;
-        }
+    for (size_t i = 0U; i < nsubscribers; ++i) {
+        struct dicey_client_data *const client = dicey_client_list_get_client(server->clients, subscribers->ids[i]);
+        assert(client && dicey_client_data_is_subscribed(client, elemdescr));
 
         // hold the packet. We know the refcount will be equal to the number of events sent (because we hold the thread)
         // + 1 (because this function is holding it too for now)
         dicey_shared_packet_ref(shared_pkt);
 
-        struct outbound_packet event = { .kind = DICEY_OP_SIGNAL, .shared = shared_pkt };
+        struct dicey_outbound_packet event = { .kind = DICEY_OP_SIGNAL, .shared = shared_pkt };
 
-        err = server_sendpkt(server, *client, event);
+        err = server_sendpkt(server, client, event);
         if (err) {
             // deref, we failed this send
             dicey_shared_packet_unref(shared_pkt);
@@ -2168,19 +3287,72 @@ enum dicey_error dicey_server_raise_internal(struct dicey_server *const server,
     return DICEY_OK;
 }
 
-enum dicey_error dicey_server_send_response(
+static enum dicey_error server_check_response(const struct dicey_packet packet, const size_t id) {
+    if (!can_send_as_response(packet)) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (id > (size_t) PTRDIFF_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    return DICEY_OK;
+}
+
+// sends a response right away, without going through the loop queue. Must be called from the loop thread. The packet is
+// always consumed, and any error returned refers to the send itself
+static enum dicey_error server_send_response_inline(
+    struct dicey_server *const server,
+    const size_t id,
+    struct dicey_packet packet
+) {
+    assert(server && is_on_loop_thread(server));
+
+    struct dicey_client_data *const client = dicey_client_list_get_client(server->clients, id);
+
+    // same as what loop_request_inbound does, minus the malloc and the loop wakeup
+    return loop_request_send_response(server, client, &packet);
+}
+
+// sends one of the responses of a batch inline. There's no single caller to return errors to, so they are reported one
+// by one via on_error, like loop_request_inbound would
+static void server_send_batch_response_inline(
     struct dicey_server *const server,
     const size_t id,
     const struct dicey_packet packet
 ) {
-    assert(server);
+    const enum dicey_error err = server_send_response_inline(server, id, packet);
+    if (err) {
+        struct dicey_client_data *const client = dicey_client_list_get_client(server->clients, id);
 
-    if (!can_send_as_response(packet)) {
-        return TRACE(DICEY_EINVAL);
+        if (client) {
+            server->on_error(server, err, &client->info, "send_response: %s", dicey_error_name(err));
+        }
     }
+}
 
-    if (id > (size_t) PTRDIFF_MAX) {
-        return TRACE(DICEY_EOVERFLOW);
+enum dicey_error dicey_server_send_response_internal(
+    struct dicey_server *const server,
+    const size_t id,
+    struct dicey_packet packet,
+    const bool wait,
+    bool *const accepted
+) {
+    assert(server && accepted);
+
+    *accepted = false;
+
+    const enum dicey_error err = server_check_response(packet, id);
+    if (err) {
+        return err;
+    }
+
+    // replying from the loop thread (i.e. synchronously from on_request) doesn't need to go through the queue. Waiting
+    // there would also deadlock, and there's no need to anyway
+    if (is_on_loop_thread(server)) {
+        *accepted = true;
+
+        return server_send_response_inline(server, id, packet);
     }
 
     struct dicey_server_loop_request *const req = DICEY_SERVER_LOOP_REQ_NEW(struct dicey_packet);
@@ -2195,7 +3367,20 @@ enum dicey_error dicey_server_send_response(
 
     DICEY_SERVER_LOOP_SET_PAYLOAD(req, struct dicey_packet, &packet);
 
-    return dicey_server_submit_request(server, req);
+    // from here on the packet belongs to the loop, whatever happens
+    *accepted = true;
+
+    return wait ? dicey_server_blocking_request(server, req) : dicey_server_submit_request(server, req);
+}
+
+enum dicey_error dicey_server_send_response(
+    struct dicey_server *const server,
+    const size_t id,
+    const struct dicey_packet packet
+) {
+    bool accepted = false;
+
+    return dicey_server_send_response_internal(server, id, packet, false, &accepted);
 }
 
 enum dicey_error dicey_server_send_response_and_wait(
@@ -2203,29 +3388,57 @@ enum dicey_error dicey_server_send_response_and_wait(
     const size_t id,
     const struct dicey_packet packet
 ) {
-    assert(server);
+    bool accepted = false;
 
-    if (!can_send_as_response(packet)) {
-        return TRACE(DICEY_EINVAL);
+    return dicey_server_send_response_internal(server, id, packet, true, &accepted);
+}
+
+enum dicey_error dicey_server_send_responses(
+    struct dicey_server *const server,
+    const struct dicey_server_response *const responses,
+    const size_t nresponses
+) {
+    assert(server && (responses || !nresponses));
+
+    for (size_t i = 0U; i < nresponses; ++i) {
+        const enum dicey_error err = server_check_response(responses[i].packet, responses[i].client_id);
+        if (err) {
+            return err;
+        }
     }
 
-    if (id > (size_t) PTRDIFF_MAX) {
+    if (!nresponses) {
+        return DICEY_OK;
+    }
+
+    if (nresponses > LOOP_BATCH_MAX_ITEMS(struct dicey_server_response)) {
         return TRACE(DICEY_EOVERFLOW);
     }
 
-    struct dicey_server_loop_request *const req = DICEY_SERVER_LOOP_REQ_NEW(struct dicey_packet);
+    // replying from the loop thread doesn't need to go through the queue, same as dicey_server_send_response
+    if (is_on_loop_thread(server)) {
+        for (size_t i = 0U; i < nresponses; ++i) {
+            server_send_batch_response_inline(server, responses[i].client_id, responses[i].packet);
+        }
+
+        return DICEY_OK;
+    }
+
+    struct dicey_server_loop_request *const req =
+        DICEY_SERVER_LOOP_REQ_NEW_WITH_BYTES(LOOP_BATCH_PAYLOAD_SIZE(nresponses, struct dicey_server_response));
     if (!req) {
         return TRACE(DICEY_ENOMEM);
     }
 
     *req = (struct dicey_server_loop_request) {
-        .cb = &loop_request_send_response,
-        .target = id,
+        .cb = &loop_request_send_responses,
+        .target = DICEY_SERVER_LOOP_REQ_NO_TARGET,
     };
 
-    DICEY_SERVER_LOOP_SET_PAYLOAD(req, struct dicey_packet, &packet);
+    loop_batch_set(req, responses, nresponses, sizeof *responses);
 
-    return dicey_server_blocking_request(server, req);
+    // same as dicey_server_raise_batch: once queued, the request and the packets belong to the loop, even on failure
+    return dicey_server_submit_request(server, req);
 }
 
 void *dicey_server_set_context(struct dicey_server *const server, void *const new_context) {
@@ -2237,6 +3450,42 @@ void *dicey_server_set_context(struct dicey_server *const server, void *const ne
     return old_context;
 }
 
+enum dicey_error dicey_server_dispatch_batch_internal(
+    struct dicey_server *const server,
+    struct dicey_client_data *const client,
+    struct dicey_batch_request *const batch,
+    struct dicey_packet *const packets
+) {
+    assert(server && client && batch && (packets || !batch->nitems) && is_on_loop_thread(server));
+
+    const enum dicey_error err = dicey_batch_requests_add(&client->batches, batch);
+    if (err) {
+        return err;
+    }
+
+    for (size_t i = 0U; i < batch->nitems; ++i) {
+        struct dicey_packet packet = packets[i];
+        packets[i] = DICEY_EMPTY_PACKET;
+
+        // every item is seen by the user as a standalone request, with a seq that the client never uses
+        const enum dicey_error seq_err = dicey_packet_set_seq(packet, batch->first_seq + (uint32_t) i * 2U);
+        if (seq_err) {
+            dicey_packet_deinit(&packet);
+            dicey_batch_request_fail(batch, i, seq_err);
+
+            continue;
+        }
+
+        server_dispatch_batch_item(server, client, batch, i, packet);
+    }
+
+    // the batch may be already done if no item had to wait on the user
+    dicey_batch_request_release(batch);
+    server_finish_batches(server, client);
+
+    return DICEY_OK;
+}
+
 enum dicey_error dicey_server_start(struct dicey_server *const server, struct dicey_addr addr) {
     assert(server && addr.addr && addr.len);
 
@@ -2253,13 +3502,23 @@ enum dicey_error dicey_server_start(struct dicey_server *const server, struct di
         goto fail;
     }
 
+    uverr = uv_check_start(&server->flush_check, &on_flush_check);
+    if (uverr) {
+        goto after_prepare;
+    }
+
     uverr = uv_listen((uv_stream_t *) &server->pipe, 128, &on_connect);
 
     if (uverr < 0) {
         goto after_prepare;
     }
 
-    server->state = SERVER_STATE_RUNNING;
+    // nobody can be subscribed yet, so there's no point in reporting the changes made before the server started
+    server->notified_generation = server->registry.generation;
+
+    // must be published before the state, which is what other threads check before comparing against it
+    server->loop_thread = uv_thread_self();
+    atomic_store_explicit(&server->state, SERVER_STATE_RUNNING, memory_order_release);
 
     uverr = uv_run(&server->loop, UV_RUN_DEFAULT);
     if (uverr < 0) {
@@ -2271,6 +3530,7 @@ enum dicey_error dicey_server_start(struct dicey_server *const server, struct di
     return DICEY_OK;
 
 after_prepare:
+    uv_check_stop(&server->flush_check);
     uv_prepare_stop(&server->startup_prepare);
 
 fail:
@@ -20,6 +20,8 @@
 
 #include <dicey/core/packet.h>
 
+#include "sup/bufpool.h"
+
 #include "shared-packet.h"
 
 struct dicey_shared_packet {
@@ -30,7 +32,7 @@ struct dicey_shared_packet {
 struct dicey_shared_packet *dicey_shared_packet_from(const struct dicey_packet packet, const size_t starting_refcount) {
     assert(dicey_packet_is_valid(packet));
 
-    struct dicey_shared_packet *const shared_packet = malloc(sizeof *shared_packet);
+    struct dicey_shared_packet *const shared_packet = dicey_bufpool_alloc(sizeof *shared_packet);
     if (shared_packet) {
         *shared_packet = (struct dicey_shared_packet) {
             .refc = starting_refcount,
@@ -72,6 +74,6 @@ void dicey_shared_packet_unref(struct dicey_shared_packet *const shared_packet)
     if (--shared_packet->refc <= 0) {
         dicey_packet_deinit(&shared_packet->packet);
 
-        free(shared_packet);
+        dicey_bufpool_free(shared_packet);
     }
 }
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/hashtable.h>
+
+#include "sup/trace.h"
+
+#include "subscriptions.h"
+
+#define SUBSCRIBER_LIST_MINCAP 4U
+
+static struct dicey_subscriber_list *subscriber_list_grow(struct dicey_subscriber_list *list) {
+    const size_t old_cap = list ? list->cap : 0U;
+    const size_t new_cap = old_cap ? old_cap * 3 / 2 : SUBSCRIBER_LIST_MINCAP;
+
+    if (new_cap > ((size_t) PTRDIFF_MAX - sizeof *list) / sizeof *list->ids) {
+        return NULL;
+    }
+
+    struct dicey_subscriber_list *const new_list = realloc(list, sizeof *new_list + new_cap * sizeof *new_list->ids);
+    if (!new_list) {
+        return NULL;
+    }
+
+    if (!list) {
+        new_list->len = 0U;
+    }
+
+    new_list->cap = new_cap;
+
+    return new_list;
+}
+
+enum dicey_error dicey_subscription_index_add(
+    struct dicey_subscription_index *const index,
+    const char *const elemdescr,
+    const size_t id
+) {
+    assert(index && elemdescr);
+
+    struct dicey_subscriber_list *list = dicey_hashtable_get(index->elems, elemdescr);
+
+    if (list) {
+        for (size_t i = 0U; i < list->len; ++i) {
+            if (list->ids[i] == id) {
+                return DICEY_OK; // already subscribed
+            }
+        }
+
+        if (list->len < list->cap) {
+            list->ids[list->len++] = id;
+
+            return DICEY_OK;
+        }
+    }
+
+    struct dicey_subscriber_list *const new_list = subscriber_list_grow(list);
+    if (!new_list) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    new_list->ids[new_list->len++] = id;
+
+    // the list may have moved, so the table must be updated anyway. Updating an existing key never allocates, so this
+    // can only fail when the element had no subscribers yet
+    if (!dicey_hashtable_set(&index->elems, elemdescr, new_list, NULL)) {
+        assert(!list);
+
+        free(new_list);
+
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    return DICEY_OK;
+}
+
+void dicey_subscription_index_deinit(struct dicey_subscription_index *const index) {
+    if (index) {
+        dicey_hashtable_delete(index->elems, &free);
+
+        *index = (struct dicey_subscription_index) { 0 };
+    }
+}
+
+const struct dicey_subscriber_list *dicey_subscription_index_get(
+    const struct dicey_subscription_index *const index,
+    const char *const elemdescr
+) {
+    assert(index && elemdescr);
+
+    return dicey_hashtable_get(index->elems, elemdescr);
+}
+
+bool dicey_subscription_index_remove(
+    struct dicey_subscription_index *const index,
+    const char *const elemdescr,
+    const size_t id
+) {
+    assert(index && elemdescr);
+
+    struct dicey_subscriber_list *const list = dicey_hashtable_get(index->elems, elemdescr);
+    if (!list) {
+        return false;
+    }
+
+    for (size_t i = 0U; i < list->len; ++i) {
+        if (list->ids[i] == id) {
+            // order doesn't matter, just move the last id in the hole
+            list->ids[i] = list->ids[--list->len];
+
+            if (!list->len) {
+                free(dicey_hashtable_remove(index->elems, elemdescr));
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(WKDPQZLUYE_SUBSCRIPTIONS_H)
+#define WKDPQZLUYE_SUBSCRIPTIONS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/hashtable.h>
+
+#include "dicey_config.h"
+
+#if defined(DICEY_CC_IS_MSVC)
+#pragma warning(disable : 4200)
+#endif
+
+// the ids of all the clients subscribed to a given element, in no particular order
+struct dicey_subscriber_list {
+    size_t len;
+    size_t cap;
+    size_t ids[];
+};
+
+// server-wide index from element descriptor to the clients subscribed to it. It mirrors the `subscriptions` set of
+// every client, and allows signals to be delivered without walking the whole client list
+struct dicey_subscription_index {
+    struct dicey_hashtable *elems; // elemdescr -> struct dicey_subscriber_list *
+};
+
+enum dicey_error dicey_subscription_index_add(struct dicey_subscription_index *index, const char *elemdescr, size_t id);
+void dicey_subscription_index_deinit(struct dicey_subscription_index *index);
+
+// returns the clients subscribed to `elemdescr`, or NULL if there are none
+const struct dicey_subscriber_list *dicey_subscription_index_get(
+    const struct dicey_subscription_index *index,
+    const char *elemdescr
+);
+
+bool dicey_subscription_index_remove(struct dicey_subscription_index *index, const char *elemdescr, size_t id);
+
+#endif // WKDPQZLUYE_SUBSCRIPTIONS_H
@@ -30,39 +30,67 @@
 #include <dicey/ipc/traits.h>
 
 #include "sup/trace.h"
+#include "sup/util.h"
+
+#include "wirefmt/value-validate.h"
+
+#include "registry-internal.h"
+
+// what is actually stored in a trait for each element. The element must be the first member, so that pointers to it
+// can be converted back to the whole struct
+struct trait_element {
+    struct dicey_element elem;
+
+    struct dicey_validator validator; // the element's signature, compiled once at registration
+};
 
 static struct dicey_element *elem_dup(const struct dicey_element *const elem) {
     if (!elem) {
         return NULL;
     }
 
-    struct dicey_element *const elem_copy = calloc(1U, sizeof *elem_copy);
+    struct trait_element *const elem_copy = calloc(1U, sizeof *elem_copy);
     if (!elem_copy) {
         return NULL;
     }
 
-    *elem_copy = *elem;
+    elem_copy->elem = *elem;
 
-    elem_copy->signature = strdup(elem->signature);
-    if (!elem_copy->signature) {
+    elem_copy->elem.signature = strdup(elem->signature);
+    if (!elem_copy->elem.signature) {
         free(elem_copy);
 
         return NULL;
     }
 
-    return elem_copy;
+    if (dicey_validator_init(&elem_copy->validator, elem_copy->elem.signature)) {
+        free((char *) elem_copy->elem.signature);
+        free(elem_copy);
+
+        return NULL;
+    }
+
+    return &elem_copy->elem;
 }
 
 static void free_elem(void *const elem) {
-    struct dicey_element *const elem_cast = (struct dicey_element *) elem;
+    struct trait_element *const elem_cast = (struct trait_element *) elem;
 
     if (elem) {
+        dicey_validator_deinit(&elem_cast->validator);
+
         // originally strdup'd
-        free((char *) elem_cast->signature);
+        free((char *) elem_cast->elem.signature);
         free(elem_cast);
     }
 }
 
+const struct dicey_validator *dicey_element_get_validator(const struct dicey_element *const elem) {
+    assert(elem);
+
+    return &((const struct trait_element *) elem)->validator;
+}
+
 const char *dicey_element_type_name(const enum dicey_element_type type) {
     switch (type) {
     case DICEY_ELEMENT_TYPE_OPERATION:
@@ -115,7 +143,7 @@ enum dicey_error dicey_trait_add_element(
     void *old_val = NULL;
     switch (dicey_hashtable_set(&trait->elems, name, elem_val, &old_val)) {
     case DICEY_HASH_SET_FAILED:
-        free(elem_val);
+        free_elem(elem_val);
 
         return TRACE(DICEY_ENOMEM);
 
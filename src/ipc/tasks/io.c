@@ -25,6 +25,7 @@
 #include <dicey/core/errors.h>
 #include <dicey/ipc/address.h>
 
+#include "sup/bufpool.h"
 #include "sup/uvtools.h"
 
 #include "io.h"
@@ -92,7 +93,7 @@ static void on_write(uv_write_t *const write, const int status) {
         unlock_task(context->cookie, status);
     }
 
-    free(write);
+    dicey_bufpool_free(write);
 }
 
 struct dicey_task_error *perform_write(
@@ -104,7 +105,7 @@ struct dicey_task_error *perform_write(
 ) {
     assert(tloop && stream && buf.base && buf.len);
 
-    struct write_op *const write = malloc(sizeof(*write));
+    struct write_op *const write = dicey_bufpool_alloc(sizeof(*write));
     if (!write) {
         // this will almost certainly fail too, but we can't do anything about it
         return dicey_task_error_new(DICEY_ENOMEM, "failed to allocate write operation");
@@ -117,7 +118,7 @@ struct dicey_task_error *perform_write(
 
     const int uverr = uv_write((uv_write_t *) write, stream, &buf, 1, &on_write);
     if (uverr < 0) {
-        free(write);
+        dicey_bufpool_free(write);
 
         return dicey_task_error_new(dicey_error_from_uv(uverr), "failed to issue write: %s", uv_strerror(uverr));
     }
@@ -15,7 +15,6 @@
  */
 
 #include <assert.h>
-#include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -27,113 +26,257 @@
 #include "list.h"
 
 #define BASE_CAP 128U
-#define FOREVER_TIME                                                                                                   \
-    (uv_timespec64_t) { 0 }
+#define BASE_INDEX_CAP (BASE_CAP * 2U)
 
-static int32_t add_wrapping(int32_t *const a, const int32_t b, const int32_t max) {
-    const intmax_t a_quot = (intmax_t) *a / (intmax_t) max;
-    const intmax_t a_rem = (intmax_t) *a % (intmax_t) max;
+#define NS_PER_MS 1000000U
 
-    const intmax_t b_quot = (intmax_t) b / (intmax_t) max;
-    const intmax_t b_rem = (intmax_t) b % (intmax_t) max;
+static size_t index_home(const struct dicey_task_list *const list, const int64_t id) {
+    // fibonacci hashing: ids are sequential, so this spreads them evenly over the table
+    return (size_t) (((uint64_t) id * 0x9E3779B97F4A7C15ULL) >> 32U) & (list->index_cap - 1U);
+}
+
+static struct dicey_task_index_slot *index_find(const struct dicey_task_list *const list, const int64_t id) {
+    assert(list && id >= 0);
+
+    if (!list->index_cap) {
+        return NULL;
+    }
 
-    *a = (int32_t) (a_rem + b_rem) % max;
+    const size_t mask = list->index_cap - 1U;
+
+    for (size_t pos = index_home(list, id);; pos = (pos + 1U) & mask) {
+        struct dicey_task_index_slot *const slot = &list->index[pos];
+
+        if (slot->id == id) {
+            return slot;
+        }
 
-    return (int32_t) (a_quot + b_quot);
+        if (slot->id < 0) {
+            return NULL;
+        }
+    }
 }
 
-static void task_list_erase_at(struct dicey_task_list *const list, const size_t entry) {
-    assert(list);
+static void index_put(struct dicey_task_list *const list, const int64_t id, const size_t entry) {
+    assert(list && id >= 0 && list->index_cap);
+
+    const size_t mask = list->index_cap - 1U;
 
-    if (entry >= list->len) {
-        return; // the node has been already removed somehow
+    size_t pos = index_home(list, id);
+    while (list->index[pos].id >= 0) {
+        assert(list->index[pos].id != id);
+
+        pos = (pos + 1U) & mask;
     }
 
-    if (entry + 1 < list->len) {
-        const ptrdiff_t len_after = list->len - entry - 1;
+    list->index[pos] = (struct dicey_task_index_slot) { .id = id, .entry = entry };
+}
+
+static void index_remove(struct dicey_task_list *const list, struct dicey_task_index_slot *const slot) {
+    assert(list && slot);
 
-        memmove(&list->waiting[entry], &list->waiting[entry + 1], len_after * sizeof *list->waiting);
+    const size_t mask = list->index_cap - 1U;
+    size_t hole = (size_t) (slot - list->index);
+
+    // backward shift deletion: pull back every following entry that would be unreachable across the hole, so that no
+    // tombstones are ever needed
+    for (size_t pos = (hole + 1U) & mask;; pos = (pos + 1U) & mask) {
+        const struct dicey_task_index_slot cur = list->index[pos];
+        if (cur.id < 0) {
+            break;
+        }
+
+        const size_t home = index_home(list, cur.id);
+
+        // move `cur` into the hole only if its home is not cyclically in (hole, pos]
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            list->index[hole] = cur;
+            hole = pos;
+        }
     }
 
-    --list->len;
+    list->index[hole].id = -1;
 }
 
-static ptrdiff_t task_list_find_index(const struct dicey_task_list *const list, const int64_t id) {
+static bool index_grow_if_needed(struct dicey_task_list *const list) {
     assert(list);
 
-    const size_t len = list->len;
-    assert(len <= (size_t) PTRDIFF_MAX);
+    if ((list->len + 1U) * 2U <= list->index_cap) {
+        return true;
+    }
+
+    const size_t new_cap = list->index_cap ? list->index_cap * 2U : BASE_INDEX_CAP;
+    if (new_cap < list->index_cap || new_cap > SIZE_MAX / sizeof *list->index) {
+        return false;
+    }
+
+    struct dicey_task_index_slot *const new_index = malloc(new_cap * sizeof *new_index);
+    if (!new_index) {
+        return false;
+    }
+
+    // all bits set means id -1, i.e. an empty slot
+    memset(new_index, 0xFF, new_cap * sizeof *new_index);
+
+    free(list->index);
+
+    list->index = new_index;
+    list->index_cap = new_cap;
+
+    // rebuild from the entries, which are the source of truth
+    for (size_t i = 0U; i < list->len; ++i) {
+        index_put(list, list->waiting[i].id, i);
+    }
+
+    return true;
+}
+
+static bool deadline_before(const struct dicey_task_deadline a, const struct dicey_task_deadline b) {
+    return a.expires_at < b.expires_at;
+}
 
-    for (ptrdiff_t i = 0; i < (ptrdiff_t) len; ++i) {
-        if (list->waiting[i].id == id) {
-            return i;
+static void heap_set(struct dicey_task_list *const list, const size_t pos, const struct dicey_task_deadline node) {
+    list->heap[pos] = node;
+    list->waiting[node.entry].heap_pos = pos;
+}
+
+static void heap_sift_up(struct dicey_task_list *const list, size_t pos) {
+    const struct dicey_task_deadline node = list->heap[pos];
+
+    while (pos) {
+        const size_t parent = (pos - 1U) / 2U;
+        if (!deadline_before(node, list->heap[parent])) {
+            break;
         }
+
+        heap_set(list, pos, list->heap[parent]);
+        pos = parent;
     }
 
-    return -1;
+    heap_set(list, pos, node);
 }
 
-static uv_timespec64_t now_plus(const int32_t ms) {
-    uv_timespec64_t now = { 0 };
-    uv_clock_gettime(UV_CLOCK_MONOTONIC, &now);
+static void heap_sift_down(struct dicey_task_list *const list, size_t pos) {
+    const struct dicey_task_deadline node = list->heap[pos];
 
-    const int32_t nsec = (ms % 1000) * 1000000;
+    for (;;) {
+        size_t child = pos * 2U + 1U;
+        if (child >= list->heap_len) {
+            break;
+        }
 
-    const int32_t sec = ms / 1000 + add_wrapping(&now.tv_nsec, nsec, 1000000000);
+        if (child + 1U < list->heap_len && deadline_before(list->heap[child + 1U], list->heap[child])) {
+            ++child;
+        }
+
+        if (!deadline_before(list->heap[child], node)) {
+            break;
+        }
 
-    now.tv_sec += sec;
+        heap_set(list, pos, list->heap[child]);
+        pos = child;
+    }
 
-    return now;
+    heap_set(list, pos, node);
 }
 
-static bool is_wait_forever(const uv_timespec64_t ts) {
-    return !ts.tv_sec && !ts.tv_nsec;
+static void heap_remove(struct dicey_task_list *const list, const size_t pos) {
+    assert(list && pos < list->heap_len);
+
+    list->waiting[list->heap[pos].entry].heap_pos = SIZE_MAX;
+
+    const size_t last = --list->heap_len;
+    if (pos == last) {
+        return;
+    }
+
+    heap_set(list, pos, list->heap[last]);
+
+    // the moved node may belong either above or below its new position
+    if (pos && deadline_before(list->heap[pos], list->heap[(pos - 1U) / 2U])) {
+        heap_sift_up(list, pos);
+    } else {
+        heap_sift_down(list, pos);
+    }
+}
+
+static void task_list_erase_at(struct dicey_task_list *const list, struct dicey_task_index_slot *const slot) {
+    assert(list && slot && slot->entry < list->len);
+
+    const size_t entry = slot->entry;
+
+    if (list->waiting[entry].heap_pos != SIZE_MAX) {
+        heap_remove(list, list->waiting[entry].heap_pos);
+    }
+
+    index_remove(list, slot);
+
+    // fill the hole with the last entry, and fix up whatever pointed to it
+    const size_t last = --list->len;
+    if (entry != last) {
+        const struct dicey_task_entry moved = list->waiting[last];
+
+        list->waiting[entry] = moved;
+
+        struct dicey_task_index_slot *const moved_slot = index_find(list, moved.id);
+        assert(moved_slot);
+
+        moved_slot->entry = entry;
+
+        if (moved.heap_pos != SIZE_MAX) {
+            list->heap[moved.heap_pos].entry = entry;
+        }
+    }
 }
 
 static bool task_list_grow_if_needed(struct dicey_task_list **const list_ptr) {
     assert(list_ptr);
 
-    struct dicey_task_list *list = *list_ptr;
+    if (!*list_ptr) {
+        *list_ptr = calloc(1U, sizeof **list_ptr);
+        if (!*list_ptr) {
+            return false;
+        }
+    }
 
-    const uintmax_t len = list ? list->len : 0U;
-    if ((uintmax_t) len > (uintmax_t) INT64_MAX) {
+    struct dicey_task_list *const list = *list_ptr;
+
+    if ((uintmax_t) list->len >= (uintmax_t) INT64_MAX) {
         return false; // ids go up to int64_t and are positive
     }
 
-    const size_t old_cap = list ? list->cap : 0U;
+    if (!index_grow_if_needed(list)) {
+        return false;
+    }
 
-    if (len < old_cap) {
+    if (list->len < list->cap) {
         return true;
     }
 
-    const size_t new_cap = old_cap ? old_cap * 3U / 2U : BASE_CAP;
-
-    if (new_cap < old_cap) { // overflow
+    const size_t new_cap = list->cap ? list->cap * 3U / 2U : BASE_CAP;
+    if (new_cap < list->cap || new_cap > SIZE_MAX / sizeof *list->waiting) {
         return false;
     }
 
-    const size_t new_size = sizeof *list + new_cap * sizeof *list->waiting;
+    struct dicey_task_entry *const waiting = realloc(list->waiting, new_cap * sizeof *waiting);
+    if (!waiting) {
+        return false;
+    }
 
-    list = list ? realloc(list, new_size) : calloc(1U, new_size);
-    if (!list) {
-        free(*list_ptr);
+    list->waiting = waiting;
 
+    // the heap can never be longer than the entry list, so it can simply track its capacity
+    struct dicey_task_deadline *const heap = realloc(list->heap, new_cap * sizeof *heap);
+    if (!heap) {
         return false;
     }
 
+    list->heap = heap;
     list->cap = new_cap;
 
-    *list_ptr = list;
-
     return true;
 }
 
-static int timespec_cmp(const uv_timespec64_t a, const uv_timespec64_t b) {
-    int sec_cmp = (a.tv_sec > b.tv_sec) - (a.tv_sec < b.tv_sec);
-
-    return sec_cmp ? sec_cmp : (a.tv_nsec > b.tv_nsec) - (a.tv_nsec < b.tv_nsec);
-}
-
 int64_t dicey_task_list_append(
     struct dicey_task_list **const list_ptr,
     void *const entry_data,
@@ -148,13 +291,28 @@ int64_t dicey_task_list_append(
     struct dicey_task_list *const list = *list_ptr;
 
     const int64_t id = list->next_id++;
+    const size_t entry = list->len++;
 
-    list->waiting[list->len++] = (struct dicey_task_entry) {
+    list->waiting[entry] = (struct dicey_task_entry) {
         .id = id,
-        .expires_at = delay_ms == WAIT_FOREVER ? FOREVER_TIME : now_plus(delay_ms),
+        .expires_at = delay_ms == WAIT_FOREVER ? DICEY_TASK_NO_DEADLINE : uv_hrtime() + (uint64_t) delay_ms * NS_PER_MS,
         .data = entry_data,
+        .heap_pos = SIZE_MAX,
     };
 
+    index_put(list, id, entry);
+
+    if (delay_ms != WAIT_FOREVER) {
+        const size_t pos = list->heap_len++;
+
+        list->heap[pos] = (struct dicey_task_deadline) {
+            .expires_at = list->waiting[entry].expires_at,
+            .entry = entry,
+        };
+
+        heap_sift_up(list, pos);
+    }
+
     return id;
 }
 
@@ -162,6 +320,15 @@ const struct dicey_task_entry *dicey_task_list_begin(const struct dicey_task_lis
     return list ? list->waiting : NULL;
 }
 
+void dicey_task_list_delete(struct dicey_task_list *const list) {
+    if (list) {
+        free(list->waiting);
+        free(list->heap);
+        free(list->index);
+        free(list);
+    }
+}
+
 const struct dicey_task_entry *dicey_task_list_end(const struct dicey_task_list *list) {
     return list ? list->waiting + list->len : NULL;
 }
@@ -169,61 +336,59 @@ const struct dicey_task_entry *dicey_task_list_end(const struct dicey_task_list
 bool dicey_task_list_erase(struct dicey_task_list *const list, const int64_t id) {
     assert(list);
 
-    const ptrdiff_t index = task_list_find_index(list, id);
-    if (index < 0) {
+    struct dicey_task_index_slot *const slot = id >= 0 ? index_find(list, id) : NULL;
+    if (!slot) {
         return false;
     }
 
-    task_list_erase_at(list, index);
+    task_list_erase_at(list, slot);
 
     return true;
 }
 
 const struct dicey_task_entry *dicey_task_list_find(const struct dicey_task_list *const list, const int64_t id) {
-    assert(list);
+    if (!list || id < 0) {
+        return NULL;
+    }
 
-    const ptrdiff_t index = task_list_find_index(list, id);
+    const struct dicey_task_index_slot *const slot = index_find(list, id);
 
-    return index >= 0 ? &list->waiting[index] : NULL;
+    return slot ? &list->waiting[slot->entry] : NULL;
+}
+
+bool dicey_task_list_next_deadline(const struct dicey_task_list *const list, uint64_t *const deadline) {
+    assert(deadline);
+
+    if (!list || !list->heap_len) {
+        return false;
+    }
+
+    *deadline = list->heap[0].expires_at;
+
+    return true;
 }
 
 void dicey_task_list_prune(
-    struct dicey_task_list *const task,
+    struct dicey_task_list *const list,
     dicey_task_list_expired_fn *const expired_cb,
     void *const ctx
 ) {
     assert(expired_cb);
 
-    // note: for the time being this is being done only once in the entire function, in order not to penalise the last
-    // items if the previous callbacks were very slow
-    uv_timespec64_t now = { 0 };
-    uv_clock_gettime(UV_CLOCK_MONOTONIC, &now);
-
-    if (!task) {
+    if (!list) {
         return;
     }
 
-    size_t index = 0;
-    for (;;) {
-        if (index >= task->len) {
-            break;
-        }
+    // note: the time is only read once, in order not to penalise the last items if the previous callbacks were slow
+    const uint64_t now = uv_hrtime();
 
-        struct dicey_task_entry *const item = &task->waiting[index];
+    // the callbacks may mutate the list in any way, so the top of the heap must be read again every time
+    while (list->heap_len && list->heap[0].expires_at <= now) {
+        const struct dicey_task_entry item = list->waiting[list->heap[0].entry];
 
-        const uv_timespec64_t expires_at = item->expires_at;
+        expired_cb(ctx, item.id, item.data);
 
-        if (!is_wait_forever(expires_at) && timespec_cmp(expires_at, now) < 0) {
-            expired_cb(ctx, item->id, item->data);
-
-            task_list_erase_at(task, index);
-
-            // note: keep the index at the current value. The rest of the array has been shifted down by one.
-            // Len has been decreased by one.
-            return;
-        } else {
-            // move to the next position. All items checked so far are still valid.
-            ++index;
-        }
+        // make sure the task is gone, in case the callback did not erase it
+        dicey_task_list_erase(list, item.id);
     }
 }
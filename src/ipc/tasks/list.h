@@ -31,25 +31,57 @@
 #pragma warning(disable : 4200)
 #endif
 
+#define DICEY_TASK_NO_DEADLINE UINT64_MAX
+
 struct dicey_task_entry {
     int64_t id;
-    uv_timespec64_t expires_at;
+    uint64_t expires_at; // in uv_hrtime() nanoseconds, or DICEY_TASK_NO_DEADLINE
 
     void *data;
+
+    size_t heap_pos; // position in the deadline heap; SIZE_MAX if the task never expires
+};
+
+// a node of the deadline heap. The deadline is duplicated here to keep sifting cache friendly
+struct dicey_task_deadline {
+    uint64_t expires_at;
+    size_t entry; // index in `waiting`
+};
+
+// id -> index in `waiting`, open addressing with linear probing. Empty slots have a negative id
+struct dicey_task_index_slot {
+    int64_t id;
+    size_t entry;
 };
 
 struct dicey_task_list {
     int64_t next_id;
+
+    // all pending tasks, densely packed and in no particular order. Erasing swaps the last entry in
     size_t len, cap;
-    struct dicey_task_entry waiting[];
+    struct dicey_task_entry *waiting;
+
+    // binary min-heap of the tasks that can expire, ordered by deadline
+    size_t heap_len;
+    struct dicey_task_deadline *heap;
+
+    size_t index_cap; // power of two, kept at most half full
+    struct dicey_task_index_slot *index;
 };
 
 int64_t dicey_task_list_append(struct dicey_task_list **list_ptr, void *entry_data, const int32_t delay_ms);
 const struct dicey_task_entry *dicey_task_list_begin(const struct dicey_task_list *list);
+void dicey_task_list_delete(struct dicey_task_list *list);
 const struct dicey_task_entry *dicey_task_list_end(const struct dicey_task_list *list);
 bool dicey_task_list_erase(struct dicey_task_list *list, int64_t id);
 const struct dicey_task_entry *dicey_task_list_find(const struct dicey_task_list *list, int64_t id);
 
+// gets the earliest deadline of any task in the list, in uv_hrtime() nanoseconds. Returns false if no task can expire
+bool dicey_task_list_next_deadline(const struct dicey_task_list *list, uint64_t *deadline);
+
+// calls `expired_cb` for every task whose deadline has passed, earliest first. The callback is allowed to erase any
+// task (including the expired one) or append new ones; the expired task is erased after the callback if it is
+// still in the list
 typedef void dicey_task_list_expired_fn(void *ctx, int64_t id, void *expired_item);
 void dicey_task_list_prune(struct dicey_task_list *list, dicey_task_list_expired_fn *expired_cb, void *ctx);
 
@@ -36,7 +36,7 @@
 #include "list.h"
 #include "loop.h"
 
-#define TIMEOUT_CHECK_MS 10U
+#define NS_PER_MS 1000000U
 
 struct dicey_task_loop {
     _Atomic bool running;
@@ -44,9 +44,11 @@ struct dicey_task_loop {
     uv_thread_t thread;
     uv_async_t *jobs_async, *halt_async;
     uv_loop_t *loop;
-    uv_timer_t *timer;
+    uv_timer_t *timer;       // armed for the earliest deadline in `pending_tasks`, if any
+    uint64_t timer_deadline; // the deadline `timer` is armed for, or DICEY_TASK_NO_DEADLINE
 
     struct dicey_queue queue;
+    size_t queue_cap;
     struct dicey_task_list *pending_tasks;
 
     dicey_task_loop_global_at_end *global_at_end;
@@ -149,6 +151,43 @@ static bool step_task(
     }
 }
 
+static void check_timeout(uv_timer_t *timer);
+
+// arms the timer for the earliest deadline among the pending tasks, or stops it if no task can expire. Called whenever
+// the pending list may have changed, so the loop never polls
+static void schedule_timeout(struct dicey_task_loop *const tloop) {
+    assert(tloop);
+
+    uv_timer_t *const timer = tloop->timer;
+    if (!timer || uv_is_closing((uv_handle_t *) timer)) {
+        return; // the loop is shutting down
+    }
+
+    uint64_t deadline = DICEY_TASK_NO_DEADLINE;
+    if (!dicey_task_list_next_deadline(tloop->pending_tasks, &deadline)) {
+        if (tloop->timer_deadline != DICEY_TASK_NO_DEADLINE) {
+            uv_timer_stop(timer);
+
+            tloop->timer_deadline = DICEY_TASK_NO_DEADLINE;
+        }
+
+        return;
+    }
+
+    if (deadline == tloop->timer_deadline) {
+        return; // already armed
+    }
+
+    const uint64_t now = uv_hrtime();
+
+    // round up, so that the timer never fires before the deadline
+    const uint64_t delay_ms = deadline > now ? (deadline - now + NS_PER_MS - 1U) / NS_PER_MS : 0U;
+
+    if (!uv_timer_start(timer, &check_timeout, delay_ms, 0U)) {
+        tloop->timer_deadline = deadline;
+    }
+}
+
 static bool start_task(struct dicey_task_loop *const tloop, int64_t id, struct dicey_task_request *const task) {
     assert(tloop && task && task->work && *task->work);
 
@@ -243,7 +282,7 @@ static void process_queue(uv_async_t *const async) {
     assert(task_loop);
 
     void *req_ptr = NULL;
-    while (dicey_queue_pop(&task_loop->queue, &req_ptr, DICEY_LOCKING_POLICY_NONBLOCKING)) {
+    while (dicey_queue_pop(&task_loop->queue, &req_ptr)) {
         assert(req_ptr);
 
         struct dicey_task_request *const req = req_ptr;
@@ -258,6 +297,8 @@ static void process_queue(uv_async_t *const async) {
             fail_task(task_loop, -1, req, dicey_task_error_new(DICEY_ENOMEM, "failed to add task to pending list"));
         }
     }
+
+    schedule_timeout(task_loop);
 }
 
 static void task_timed_out(void *const ctx, const int64_t id, void *const expired_item) {
@@ -275,7 +316,12 @@ static void check_timeout(uv_timer_t *const timer) {
 
     assert(tloop);
 
+    // the timer is one-shot, so it's not armed anymore
+    tloop->timer_deadline = DICEY_TASK_NO_DEADLINE;
+
     dicey_task_list_prune(tloop->pending_tasks, &task_timed_out, tloop);
+
+    schedule_timeout(tloop);
 }
 
 struct loop_checker {
@@ -323,16 +369,16 @@ static void cancel_all_pending(struct dicey_task_loop *const tloop) {
     };
 
     if (tloop->pending_tasks) {
-        const struct dicey_task_entry *const rend = dicey_task_list_begin(tloop->pending_tasks) - 1;
+        // completing a task erases it from the list, and its callbacks may erase others, so always take the last one
+        while (dicey_task_list_begin(tloop->pending_tasks) != dicey_task_list_end(tloop->pending_tasks)) {
+            const struct dicey_task_entry last = dicey_task_list_end(tloop->pending_tasks)[-1];
 
-        for (const struct dicey_task_entry *rit = dicey_task_list_end(tloop->pending_tasks) - 1; rit != rend; --rit) {
-            struct dicey_task_request *const req = rit->data;
-
-            complete_task(tloop, rit->id, req, free_ctx.err);
+            complete_task(tloop, last.id, last.data, free_ctx.err);
         }
     }
 
-    free(tloop->pending_tasks);
+    dicey_task_list_delete(tloop->pending_tasks);
+    tloop->pending_tasks = NULL;
     dicey_queue_deinit(&tloop->queue, &free_incoming_task, &free_ctx);
 
     free(free_ctx.err);
@@ -388,23 +434,19 @@ static enum dicey_error init_loop(
     tloop->halt_async = halt_async;
     tloop->timer = timer;
 
-    err = dicey_queue_init(&tloop->queue);
+    err = dicey_queue_init(&tloop->queue, tloop->queue_cap, true);
     if (err) {
         goto deinit_idle;
     }
 
     tloop->pending_tasks = NULL;
+    tloop->timer_deadline = DICEY_TASK_NO_DEADLINE; // the timer is only armed once a task with a timeout is added
 
     err = dicey_error_from_uv(uv_idle_start(&up_check->idle, &notify_running));
     if (err) {
         goto clear_all;
     }
 
-    err = dicey_error_from_uv(uv_timer_start(timer, &check_timeout, TIMEOUT_CHECK_MS, TIMEOUT_CHECK_MS));
-    if (err) {
-        goto clear_all;
-    }
-
     return DICEY_OK;
 
 clear_all:
@@ -543,6 +585,8 @@ void dicey_task_loop_advance(struct dicey_task_loop *const tloop, const int64_t
         if (done) {
             dicey_task_list_erase(tloop->pending_tasks, id);
         }
+
+        schedule_timeout(tloop);
     }
 }
 
@@ -586,6 +630,8 @@ void dicey_task_loop_fail_with(
         fail_task(tloop, id, req, err);
 
         dicey_task_list_erase(tloop->pending_tasks, id);
+
+        schedule_timeout(tloop);
     } else {
         free(err);
     }
@@ -616,6 +662,7 @@ enum dicey_error dicey_task_loop_new(struct dicey_task_loop **const dest, struct
     if (args) {
         tloop->global_at_end = args->global_at_end;
         tloop->global_stopped = args->global_stopped;
+        tloop->queue_cap = args->queue_cap;
     }
 
     *dest = tloop;
@@ -696,7 +743,10 @@ enum dicey_error dicey_task_loop_submit(struct dicey_task_loop *const tloop, str
         return DICEY_ENOMEM;
     }
 
-    uv_async_send(tloop->jobs_async);
+    // process_queue drains everything each time it runs, so a single wakeup covers all pushes until it runs dry
+    if (dicey_queue_claim_wakeup(&tloop->queue)) {
+        uv_async_send(tloop->jobs_async);
+    }
 
     return DICEY_OK;
 }
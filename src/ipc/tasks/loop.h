@@ -63,6 +63,10 @@ struct dicey_task_loop_args {
     // called when the task loop is stopped, but before the thread quits. It's useful to clean up state before the task
     // loop is deleted.
     dicey_task_loop_global_stopped *global_stopped;
+
+    // capacity of the ring jobs are submitted through. Jobs that don't fit spill into a growable overflow list. If
+    // not set, it's DICEY_QUEUE_DEFAULT_CAP
+    size_t queue_cap;
 };
 
 struct dicey_task_request {
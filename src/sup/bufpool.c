@@ -0,0 +1,567 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <uv.h>
+
+#include "dicey_config.h"
+
+#if defined(DICEY_IS_UNIX)
+#include <pthread.h>
+
+// a thread cache must be handed back to the depot when its thread exits, and only pthread keys can run code at that
+// point. Everywhere else, all blocks go through the depot
+#define BUFPOOL_HAS_TCACHE 1
+#endif
+
+#include "bufpool.h"
+
+#define MIN_CLASS_SHIFT 6U // the smallest class is 64 bytes, header included
+#define NCLASSES 11U       // 64B, 128B, ..., 64KB
+
+// marks blocks too big for any class. These are plain malloc'd blocks and are never cached
+#define LARGE_CLASS SIZE_MAX
+
+// how much memory a single class may keep idle, per thread and in the depot respectively
+#define TCACHE_CLASS_BYTES ((size_t) 128U * 1024U) // 128KB
+#define TCACHE_CLASS_MIN 2U
+#define TCACHE_CLASS_MAX 64U
+
+#define DEPOT_CLASS_BYTES ((size_t) 1024U * 1024U) // 1MB
+#define DEPOT_CLASS_MIN 4U
+#define DEPOT_CLASS_MAX 256U
+
+struct block {
+    size_t cls;
+
+    union {
+        size_t large_cap;        // only meaningful for LARGE_CLASS blocks
+        struct block *next_free; // only meaningful while the block sits in a cache
+    };
+};
+
+struct freelist {
+    struct block *head;
+    size_t count;
+};
+
+static size_t class_block_size(const size_t cls) {
+    assert(cls < NCLASSES);
+
+    return (size_t) 1U << (MIN_CLASS_SHIFT + cls);
+}
+
+static size_t class_cap(const size_t cls) {
+    return class_block_size(cls) - sizeof(struct block);
+}
+
+static size_t class_for(const size_t size) {
+    for (size_t cls = 0U; cls < NCLASSES; ++cls) {
+        if (size <= class_cap(cls)) {
+            return cls;
+        }
+    }
+
+    return LARGE_CLASS;
+}
+
+static size_t clamp_count(const size_t count, const size_t min, const size_t max) {
+    return count < min ? min : count > max ? max : count;
+}
+
+static size_t depot_limit(const size_t cls) {
+    return clamp_count(DEPOT_CLASS_BYTES / class_block_size(cls), DEPOT_CLASS_MIN, DEPOT_CLASS_MAX);
+}
+
+static void freelist_push(struct freelist *const list, struct block *const blk) {
+    blk->next_free = list->head;
+    list->head = blk;
+    ++list->count;
+}
+
+static struct block *freelist_pop(struct freelist *const list) {
+    struct block *const blk = list->head;
+    if (blk) {
+        list->head = blk->next_free;
+        --list->count;
+    }
+
+    return blk;
+}
+
+// frees all the blocks in the list, and returns how many bytes that released
+static size_t freelist_release(struct freelist *const list, const size_t cls) {
+    const size_t nbytes = list->count * class_block_size(cls);
+
+    for (struct block *blk = freelist_pop(list); blk; blk = freelist_pop(list)) {
+        free(blk);
+    }
+
+    return nbytes;
+}
+
+#if defined(BUFPOOL_HAS_TCACHE)
+
+enum tcache_state {
+    TCACHE_UNINIT = 0,
+    TCACHE_LIVE,
+    TCACHE_DEAD, // the thread is exiting, or the cache could not be set up. Blocks go straight to the depot
+};
+
+struct tcache {
+    enum tcache_state state;
+
+    struct freelist lists[NCLASSES];
+
+    // only ever written by the owning thread. They are atomics only so that dicey_bufpool_get_stats can read them
+    _Atomic size_t hits;
+    _Atomic size_t misses;
+    _Atomic size_t bytes_cached;
+
+    struct tcache *prev, *next; // the registry of live caches, protected by the depot lock
+};
+
+static _Thread_local struct tcache tcache = { 0 };
+
+#endif // BUFPOOL_HAS_TCACHE
+
+static struct depot {
+    uv_mutex_t lock;
+    bool usable;
+
+    struct freelist lists[NCLASSES];
+
+    // counts the traffic that didn't go through a thread cache, plus the counters of exited threads
+    _Atomic size_t hits;
+    _Atomic size_t misses;
+
+#if defined(BUFPOOL_HAS_TCACHE)
+    pthread_key_t tcache_key;
+    bool has_tcache_key;
+
+    struct tcache *live;
+#endif
+} depot = { 0 };
+
+static uv_once_t depot_flag = UV_ONCE_INIT;
+
+#if defined(BUFPOOL_HAS_TCACHE)
+static void tcache_release(void *arg);
+#endif
+
+static void depot_init(void) {
+    // if the mutex can't be initialised nothing is ever cached, and all blocks go through malloc/free
+    depot.usable = !uv_mutex_init(&depot.lock);
+
+#if defined(BUFPOOL_HAS_TCACHE)
+    depot.has_tcache_key = depot.usable && !pthread_key_create(&depot.tcache_key, &tcache_release);
+#endif
+}
+
+static bool depot_is_usable(void) {
+    uv_once(&depot_flag, &depot_init);
+
+    return depot.usable;
+}
+
+// moves at most `max` blocks of the given class from the depot into `dest`. Returns how many were moved
+static size_t depot_take(const size_t cls, struct freelist *const dest, const size_t max) {
+    if (!depot_is_usable()) {
+        return 0U;
+    }
+
+    size_t taken = 0U;
+
+    uv_mutex_lock(&depot.lock);
+
+    struct freelist *const src = &depot.lists[cls];
+    for (; taken < max && src->head; ++taken) {
+        freelist_push(dest, freelist_pop(src));
+    }
+
+    uv_mutex_unlock(&depot.lock);
+
+    return taken;
+}
+
+// moves all the blocks in `src` into the depot. Whatever doesn't fit is freed, outside of the lock
+static void depot_give(const size_t cls, struct freelist *const src) {
+    if (depot_is_usable()) {
+        const size_t limit = depot_limit(cls);
+
+        uv_mutex_lock(&depot.lock);
+
+        struct freelist *const dest = &depot.lists[cls];
+        while (dest->count < limit && src->head) {
+            freelist_push(dest, freelist_pop(src));
+        }
+
+        uv_mutex_unlock(&depot.lock);
+    }
+
+    freelist_release(src, cls);
+}
+
+#if defined(BUFPOOL_HAS_TCACHE)
+
+static size_t tcache_limit(const size_t cls) {
+    return clamp_count(TCACHE_CLASS_BYTES / class_block_size(cls), TCACHE_CLASS_MIN, TCACHE_CLASS_MAX);
+}
+
+static void counter_add(_Atomic size_t *const counter, const size_t n) {
+    // single writer: a plain load and store are enough, and much cheaper than a locked add
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static void counter_sub(_Atomic size_t *const counter, const size_t n) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) - n, memory_order_relaxed);
+}
+
+// called by pthread when a thread that used the pool exits
+static void tcache_release(void *const arg) {
+    struct tcache *const tc = arg;
+    assert(tc && tc->state == TCACHE_LIVE);
+
+    uv_mutex_lock(&depot.lock);
+
+    if (tc->prev) {
+        tc->prev->next = tc->next;
+    } else {
+        depot.live = tc->next;
+    }
+
+    if (tc->next) {
+        tc->next->prev = tc->prev;
+    }
+
+    // fold the counters while still holding the lock, so that dicey_bufpool_get_stats never sees them go missing
+    atomic_fetch_add_explicit(&depot.hits, atomic_load_explicit(&tc->hits, memory_order_relaxed), memory_order_relaxed);
+    atomic_fetch_add_explicit(
+        &depot.misses, atomic_load_explicit(&tc->misses, memory_order_relaxed), memory_order_relaxed
+    );
+
+    uv_mutex_unlock(&depot.lock);
+
+    // anything freed by later destructors on this thread goes to the depot
+    tc->state = TCACHE_DEAD;
+
+    for (size_t cls = 0U; cls < NCLASSES; ++cls) {
+        depot_give(cls, &tc->lists[cls]);
+    }
+
+    atomic_store_explicit(&tc->bytes_cached, 0U, memory_order_relaxed);
+}
+
+// returns the cache of the calling thread, or NULL if it can't have one
+static struct tcache *tcache_get(void) {
+    struct tcache *const tc = &tcache;
+
+    switch (tc->state) {
+    case TCACHE_LIVE:
+        return tc;
+
+    case TCACHE_DEAD:
+        return NULL;
+
+    case TCACHE_UNINIT:
+        break;
+    }
+
+    // first use on this thread: the cache must be registered with pthread, or it would leak when the thread exits
+    if (!depot_is_usable() || !depot.has_tcache_key || pthread_setspecific(depot.tcache_key, tc)) {
+        tc->state = TCACHE_DEAD;
+
+        return NULL;
+    }
+
+    uv_mutex_lock(&depot.lock);
+
+    tc->prev = NULL;
+    tc->next = depot.live;
+
+    if (depot.live) {
+        depot.live->prev = tc;
+    }
+
+    depot.live = tc;
+
+    uv_mutex_unlock(&depot.lock);
+
+    tc->state = TCACHE_LIVE;
+
+    return tc;
+}
+
+#endif // BUFPOOL_HAS_TCACHE
+
+static struct block *cache_take(const size_t cls) {
+#if defined(BUFPOOL_HAS_TCACHE)
+    struct tcache *const tc = tcache_get();
+    if (tc) {
+        struct freelist *const list = &tc->lists[cls];
+
+        if (!list->head) {
+            // refill half of the cache in one go, so the depot lock isn't taken on every allocation
+            const size_t moved = depot_take(cls, list, tcache_limit(cls) / 2U);
+
+            counter_add(&tc->bytes_cached, moved * class_block_size(cls));
+        }
+
+        struct block *const blk = freelist_pop(list);
+        if (blk) {
+            counter_add(&tc->hits, 1U);
+            counter_sub(&tc->bytes_cached, class_block_size(cls));
+        } else {
+            counter_add(&tc->misses, 1U);
+        }
+
+        return blk;
+    }
+#endif
+
+    struct freelist taken = { 0 };
+    depot_take(cls, &taken, 1U);
+
+    atomic_fetch_add_explicit(taken.head ? &depot.hits : &depot.misses, 1U, memory_order_relaxed);
+
+    return taken.head;
+}
+
+static void cache_give(struct block *const blk) {
+    const size_t cls = blk->cls;
+
+#if defined(BUFPOOL_HAS_TCACHE)
+    struct tcache *const tc = tcache_get();
+    if (tc) {
+        struct freelist *const list = &tc->lists[cls];
+
+        if (list->count >= tcache_limit(cls)) {
+            // spill half of the cache into the depot. Threads that mostly free (e.g. a loop releasing packets built
+            // elsewhere) end up feeding the ones that mostly allocate
+            struct freelist spill = { 0 };
+            for (size_t i = list->count / 2U; i > 0U; --i) {
+                freelist_push(&spill, freelist_pop(list));
+            }
+
+            counter_sub(&tc->bytes_cached, spill.count * class_block_size(cls));
+
+            depot_give(cls, &spill);
+        }
+
+        freelist_push(list, blk);
+        counter_add(&tc->bytes_cached, class_block_size(cls));
+
+        return;
+    }
+#endif
+
+    struct freelist single = { 0 };
+    freelist_push(&single, blk);
+
+    depot_give(cls, &single);
+}
+
+static void *large_alloc(const size_t size) {
+    if (size > SIZE_MAX - sizeof(struct block)) {
+        return NULL;
+    }
+
+    struct block *const blk = malloc(sizeof *blk + size);
+    if (!blk) {
+        return NULL;
+    }
+
+    *blk = (struct block) {
+        .cls = LARGE_CLASS,
+        .large_cap = size,
+    };
+
+    return blk + 1;
+}
+
+void *dicey_bufpool_alloc(const size_t size) {
+    const size_t cls = class_for(size);
+    if (cls == LARGE_CLASS) {
+        atomic_fetch_add_explicit(&depot.misses, 1U, memory_order_relaxed);
+
+        return large_alloc(size);
+    }
+
+    struct block *blk = cache_take(cls);
+    if (!blk) {
+        blk = malloc(class_block_size(cls));
+        if (!blk) {
+            return NULL;
+        }
+    }
+
+    *blk = (struct block) {
+        .cls = cls,
+    };
+
+    return blk + 1;
+}
+
+void *dicey_bufpool_calloc(const size_t size) {
+    void *const ptr = dicey_bufpool_alloc(size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+
+    return ptr;
+}
+
+void *dicey_bufpool_realloc(void *const ptr, const size_t size) {
+    if (!ptr) {
+        return dicey_bufpool_alloc(size);
+    }
+
+    struct block *const blk = (struct block *) ptr - 1;
+    const size_t new_cls = class_for(size);
+
+    if (blk->cls == LARGE_CLASS && new_cls == LARGE_CLASS) {
+        if (size > SIZE_MAX - sizeof *blk) {
+            return NULL;
+        }
+
+        struct block *const grown = realloc(blk, sizeof *blk + size);
+        if (!grown) {
+            return NULL;
+        }
+
+        grown->large_cap = size;
+
+        return grown + 1;
+    }
+
+    if (blk->cls == new_cls) {
+        return ptr; // same class, the block already fits
+    }
+
+    void *const moved = dicey_bufpool_alloc(size);
+    if (!moved) {
+        return NULL;
+    }
+
+    const size_t old_cap = dicey_bufpool_usable_size(ptr);
+    memcpy(moved, ptr, old_cap < size ? old_cap : size);
+
+    dicey_bufpool_free(ptr);
+
+    return moved;
+}
+
+void dicey_bufpool_free(void *const ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    struct block *const blk = (struct block *) ptr - 1;
+    if (blk->cls == LARGE_CLASS) {
+        free(blk);
+
+        return;
+    }
+
+    assert(blk->cls < NCLASSES);
+
+    cache_give(blk);
+}
+
+size_t dicey_bufpool_usable_size(const void *const ptr) {
+    assert(ptr);
+
+    const struct block *const blk = (const struct block *) ptr - 1;
+
+    return blk->cls == LARGE_CLASS ? blk->large_cap : class_cap(blk->cls);
+}
+
+struct dicey_bufpool_stats dicey_bufpool_get_stats(void) {
+    if (!depot_is_usable()) {
+        return (struct dicey_bufpool_stats) {
+            .hits = atomic_load_explicit(&depot.hits, memory_order_relaxed),
+            .misses = atomic_load_explicit(&depot.misses, memory_order_relaxed),
+        };
+    }
+
+    uv_mutex_lock(&depot.lock);
+
+    // exiting threads fold their counters into the depot under the lock, so nothing is counted twice or skipped
+    struct dicey_bufpool_stats stats = {
+        .hits = atomic_load_explicit(&depot.hits, memory_order_relaxed),
+        .misses = atomic_load_explicit(&depot.misses, memory_order_relaxed),
+    };
+
+    for (size_t cls = 0U; cls < NCLASSES; ++cls) {
+        stats.bytes_cached += depot.lists[cls].count * class_block_size(cls);
+    }
+
+#if defined(BUFPOOL_HAS_TCACHE)
+    for (const struct tcache *tc = depot.live; tc; tc = tc->next) {
+        stats.hits += atomic_load_explicit(&tc->hits, memory_order_relaxed);
+        stats.misses += atomic_load_explicit(&tc->misses, memory_order_relaxed);
+        stats.bytes_cached += atomic_load_explicit(&tc->bytes_cached, memory_order_relaxed);
+    }
+#endif
+
+    uv_mutex_unlock(&depot.lock);
+
+    return stats;
+}
+
+size_t dicey_bufpool_trim(void) {
+    if (!depot_is_usable()) {
+        return 0U;
+    }
+
+    size_t released = 0U;
+
+#if defined(BUFPOOL_HAS_TCACHE)
+    struct tcache *const tc = &tcache;
+    if (tc->state == TCACHE_LIVE) {
+        for (size_t cls = 0U; cls < NCLASSES; ++cls) {
+            released += freelist_release(&tc->lists[cls], cls);
+        }
+
+        atomic_store_explicit(&tc->bytes_cached, 0U, memory_order_relaxed);
+    }
+#endif
+
+    struct freelist lists[NCLASSES] = { 0 };
+
+    // detach everything under the lock, and free it after releasing it
+    uv_mutex_lock(&depot.lock);
+
+    memcpy(lists, depot.lists, sizeof lists);
+    memset(depot.lists, 0, sizeof depot.lists);
+
+    uv_mutex_unlock(&depot.lock);
+
+    for (size_t cls = 0U; cls < NCLASSES; ++cls) {
+        released += freelist_release(&lists[cls], cls);
+    }
+
+    return released;
+}
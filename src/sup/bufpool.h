@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(TQLWMZKHRE_BUFPOOL_H)
+#define TQLWMZKHRE_BUFPOOL_H
+
+#include <stddef.h>
+
+// a size-class allocator for packet payloads and the short-lived bookkeeping that goes with writing them (write
+// requests, write ops, shared packets). Blocks are rounded up to a power of two between 64 bytes and 64KB, and freed
+// blocks are kept in a small per-thread cache backed by a process-wide depot, so that the steady state of a busy
+// connection doesn't touch malloc at all. Anything bigger than the largest class goes straight to malloc/free.
+//
+// Memory returned by these functions MUST be released with dicey_bufpool_free, never with free(), and vice versa.
+// Blocks can be freed from any thread, not just the one that allocated them
+
+void *dicey_bufpool_alloc(size_t size);
+void *dicey_bufpool_calloc(size_t size);
+
+// same semantics as realloc(). Blocks that stay in the same size class are returned as they are
+void *dicey_bufpool_realloc(void *ptr, size_t size);
+
+void dicey_bufpool_free(void *ptr);
+
+// the number of bytes that can actually be used in the block, which may be more than what was asked for
+size_t dicey_bufpool_usable_size(const void *ptr);
+
+struct dicey_bufpool_stats {
+    size_t hits;         // allocations served from a cache
+    size_t misses;       // allocations that had to go to malloc
+    size_t bytes_cached; // bytes currently sitting in the caches, ready to be reused
+};
+
+// the counters of threads other than the caller are read without stopping them, so the result is a snapshot that may
+// be slightly stale
+struct dicey_bufpool_stats dicey_bufpool_get_stats(void);
+
+// releases all the blocks held in the process-wide depot and in the calling thread's cache. The caches of other
+// threads can't be touched safely, and are only released when those threads exit. Returns the number of bytes freed
+size_t dicey_bufpool_trim(void);
+
+#endif // TQLWMZKHRE_BUFPOOL_H
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+
 #define _CRT_SECURE_NO_WARNINGS 1
 #define _XOPEN_SOURCE 700
 
@@ -28,410 +29,385 @@
 
 #include "dicey_config.h"
 
+#include "util.h"
+
 #if defined(DICEY_CC_IS_MSVC_LIKE)
 #pragma warning(disable : 4200) // borked C11 flex array
 #pragma warning(disable : 4996) // strdup
+#include <intrin.h>
 #endif
 
-#define REHASH_THRESHOLD 75U
+// The table is an open addressing "swiss table": every slot has a control byte, stored in a separate array, which is
+// either EMPTY, DELETED or holds the low 7 bits of the hash of the key in the slot. Slots are probed a group at a
+// time: the control bytes of a whole group are compared against the key's 7 bits at once, and only the slots that
+// match have their full hash, length and contents compared.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHTABLE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define HASHTABLE_NEON 1
+#include <arm_neon.h>
+#endif
 
-// if this doesn't hold then the hash table will misbehave due to overflows. AFAIK this is never false in any relevant
-// case
-static_assert(sizeof(int32_t) <= sizeof(ptrdiff_t), "int32_t must either be or fit into ptrdiff_t");
+#define CTRL_EMPTY ((int8_t) -128)
+#define CTRL_DELETED ((int8_t) -2)
 
-// Prime list courtesy of Aaron Krowne (http://br.endernet.org/~akrowne/)
-// Taken from http://planetmath.org/encyclopedia/GoodHashTablePrimes.html
-static const int32_t primes[] = {
-    53,       97,       193,      389,       769,       1543,      3079,      6151,       12289,
-    24593,    49157,    98317,    196613,    393241,    786433,    1572869,   3145739,    6291469,
-    12582917, 25165843, 50331653, 100663319, 201326611, 402653189, 805306457, 1610612741,
-    -1 // -1 to indicate end of list
-};
+#if defined(HASHTABLE_SSE2)
 
-struct maybe_owned_str {
-    const char *str;
-    bool owned;
-};
+#define GROUP_WIDTH 16U
+#define GROUP_LANE_BITS 1U
 
-void maybe_free(struct maybe_owned_str str) {
-    if (str.owned) {
-        free((void *) str.str); // cast away constness, the string was malloc'd
-    }
-}
-
-struct maybe_owned_str maybe_move(struct maybe_owned_str *const mstr) {
-    assert(mstr);
+// one bit per slot in the group
+typedef uint32_t group_mask;
 
-    struct maybe_owned_str ret = { .str = mstr->str, .owned = mstr->owned };
+static group_mask group_match(const int8_t *const ctrl, const int8_t h2) {
+    const __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
 
-    *mstr = (struct maybe_owned_str) { 0 };
+    return (group_mask) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+}
 
-    return ret;
+static group_mask group_match_free(const int8_t *const ctrl) {
+    // EMPTY and DELETED are the only control bytes with the sign bit set
+    return (group_mask) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
 }
 
-const char *maybe_take(struct maybe_owned_str *const str) {
-    assert(str);
+#elif defined(HASHTABLE_NEON)
 
-    if (!str->owned) {
-        return strdup(str->str);
-    }
+#define GROUP_WIDTH 16U
+#define GROUP_LANE_BITS 4U
 
-    const char *const owned = str->str;
+// four bits per slot in the group, only the highest one of which is kept
+typedef uint64_t group_mask;
 
-    *str = (struct maybe_owned_str) { 0 };
+static group_mask neon_movemask(const uint8x16_t cmp) {
+    const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
 
-    return owned;
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ULL;
 }
 
-struct table_entry {
-    const char *key;
-    void *value;
-
-    // offset to the next entry in the bucket. 0 means no next entry, because 0 is always a bucket start
-    size_t next;
-};
+static group_mask group_match(const int8_t *const ctrl, const int8_t h2) {
+    return neon_movemask(vceqq_s8(vld1q_s8(ctrl), vdupq_n_s8(h2)));
+}
 
-struct dicey_hashtable {
-    uint32_t len, cap;
-    const int32_t *buckets_no;
+static group_mask group_match_free(const int8_t *const ctrl) {
+    return neon_movemask(vcltq_s8(vld1q_s8(ctrl), vdupq_n_s8(0)));
+}
 
-    size_t free_cur;
-    struct table_entry entries[];
-};
+#else
 
-static struct table_entry *bucket_find_entry(
-    struct dicey_hashtable *const ht,
-    const size_t bucket_offs,
-    const char *const key,
-    struct table_entry **const first_free,
-    size_t *bucket_end
-) {
-    assert(ht && ht->buckets_no && bucket_offs < (uint32_t) *ht->buckets_no);
-
-    struct table_entry *const cells = ht->entries;
+#define GROUP_WIDTH 8U
+#define GROUP_LANE_BITS 1U
 
-    size_t current_offs = bucket_offs;
-    for (;;) {
-        assert(current_offs < ht->cap);
+typedef uint32_t group_mask;
 
-        struct table_entry *entry = cells + current_offs;
+static group_mask group_match(const int8_t *const ctrl, const int8_t h2) {
+    group_mask mask = 0U;
 
-        if (entry->key) {
-            if (!strcmp(entry->key, key)) {
-                return entry;
-            }
-        } else if (first_free && !*first_free) {
-            // given that we're already recurring through the bucket, we can also find the first free cell and return it
-            // this is used by set to avoid recurring through the bucket twice
-            *first_free = entry;
-        }
+    for (uint32_t i = 0U; i < GROUP_WIDTH; ++i) {
+        mask |= (group_mask) (ctrl[i] == h2) << i;
+    }
 
-        if (!entry->next) {
-            if (bucket_end) {
-                *bucket_end = current_offs;
-            }
+    return mask;
+}
 
-            break;
-        }
+static group_mask group_match_free(const int8_t *const ctrl) {
+    group_mask mask = 0U;
 
-        current_offs = entry->next;
+    for (uint32_t i = 0U; i < GROUP_WIDTH; ++i) {
+        mask |= (group_mask) (ctrl[i] < 0) << i;
     }
 
-    return NULL;
+    return mask;
 }
 
-static uint32_t djb2(const char *str) {
-    uint32_t hash = 5381;
+#endif
 
-    for (;;) {
-        const int32_t c = (uint8_t) *str++;
+#define MIN_CAP 16U
 
-        if (!c) {
-            break;
-        }
+static_assert(MIN_CAP % GROUP_WIDTH == 0U, "MIN_CAP must be a multiple of the group width");
+
+static uint32_t ctz64(const uint64_t value) {
+    assert(value);
 
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+#if defined(DICEY_CC_IS_MSVC_LIKE)
+    unsigned long idx = 0;
+
+#if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanForward64(&idx, value);
+#else
+    if (!_BitScanForward(&idx, (unsigned long) value)) {
+        _BitScanForward(&idx, (unsigned long) (value >> 32));
+        idx += 32;
     }
+#endif
 
-    return hash;
+    return (uint32_t) idx;
+#else
+    return (uint32_t) __builtin_ctzll(value);
+#endif
 }
 
-/**
- * @brief Find the entry containing a given key in the hash table. For simplicity, the first free hole in the bucket is
- *        optionally determined (if any), and the bucket end.
- */
-static struct table_entry *hash_get_entry_for_set(
-    struct dicey_hashtable *const ht,
-    const char *const key,
-    struct table_entry **const first_free,
-    size_t *const bucket_end
-) {
-    assert(ht && ht->buckets_no && *ht->buckets_no > 0);
+static uint32_t mask_first(const group_mask mask) {
+    return ctz64(mask) / GROUP_LANE_BITS;
+}
 
-    if (!key) {
-        return NULL;
-    }
+static group_mask mask_next(const group_mask mask) {
+    return mask & (mask - 1U);
+}
 
-    const uint32_t buckets_no = (uint32_t) *ht->buckets_no;
-    assert(buckets_no <= ht->cap);
+static group_mask group_match_empty(const int8_t *const ctrl) {
+    return group_match(ctrl, CTRL_EMPTY);
+}
 
-    const uint32_t hash = djb2(key);
-    const uint32_t bucket = hash % buckets_no;
+#define HASH_K0 0xa0761d6478bd642fULL
+#define HASH_K1 0xe7037ed1a0b428dbULL
+#define HASH_K2 0x8ebc6af09c88c6e3ULL
 
-    return bucket_find_entry(ht, (ptrdiff_t) bucket, key, first_free, bucket_end);
+static uint64_t rotl64(const uint64_t value, const unsigned int shift) {
+    return (value << shift) | (value >> (64U - shift));
 }
 
-static struct table_entry *hash_get_entry(struct dicey_hashtable *const ht, const char *const key) {
-    return ht ? hash_get_entry_for_set(ht, key, NULL, NULL) : NULL; // handle empty table
+static uint64_t hash_word(const uint64_t hash, const uint64_t word) {
+    return rotl64(hash ^ (word * HASH_K1), 31U) * HASH_K2;
 }
 
-static struct dicey_hashtable *hash_new(const int32_t *const primes_list, const size_t extra_cap) {
-    assert(primes_list);
+// word-at-a-time multiplicative hash, finalised with the MurmurHash3 avalanche step
+static uint64_t hash_bytes(const char *const str, const size_t len) {
+    const unsigned char *it = (const unsigned char *) str;
+    size_t left = len;
 
-    if (*primes_list <= 0) {
-        return NULL;
+    uint64_t hash = HASH_K0 ^ ((uint64_t) len * HASH_K2);
+
+    for (; left >= sizeof(uint64_t); left -= sizeof(uint64_t), it += sizeof(uint64_t)) {
+        uint64_t word = 0U;
+        memcpy(&word, it, sizeof word);
+
+        hash = hash_word(hash, word);
     }
 
-    const size_t cap = (size_t) *primes_list + extra_cap;
-    struct dicey_hashtable *table = calloc(1, sizeof(struct dicey_hashtable) + cap * sizeof(struct table_entry));
-    if (!table) {
-        return NULL;
+    if (left) {
+        uint64_t word = 0U;
+        memcpy(&word, it, left);
+
+        hash = hash_word(hash, word);
     }
 
-    *table = (struct dicey_hashtable) {
-        .cap = (uint32_t) *primes_list,
-        .buckets_no = primes_list,
-        .free_cur = *primes_list,
-    };
+    hash ^= hash >> 33U;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33U;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33U;
 
-    return table;
+    return hash;
 }
 
-struct dicey_hashtable *hash_new_default(void) {
-    assert(*primes > 0);
+// a key, together with what is needed to compare it without touching its contents most of the time
+struct hashed_key {
+    const char *str;
+    size_t len;
+    uint64_t hash;
+};
 
-    return hash_new(primes, 0U);
+static struct hashed_key hashed_key(const char *const str) {
+    assert(str);
+
+    const size_t len = strlen(str);
+
+    return (struct hashed_key) {
+        .str = str,
+        .len = len,
+        .hash = hash_bytes(str, len),
+    };
 }
 
-static enum dicey_hash_set_result hash_set(
-    struct dicey_hashtable **table_ptr,
-    const struct maybe_owned_str key,
-    void *const value,
-    void **const old_value
-);
+// the high bits choose where to start probing, the low 7 bits go in the control byte
+static size_t hash_h1(const uint64_t hash) {
+    return (size_t) (hash >> 7U);
+}
 
-static bool hash_rehash_and_set_new(
-    struct dicey_hashtable **const table_ptr,
-    const struct maybe_owned_str key,
-    void *const value
-) {
-    assert(table_ptr && *table_ptr);
+static int8_t hash_h2(const uint64_t hash) {
+    return (int8_t) (hash & 0x7FU);
+}
 
-    struct dicey_hashtable *const table = *table_ptr;
+struct table_slot {
+    const char *key; // malloc'd and owned by the table. Only meaningful if the control byte is not EMPTY or DELETED
+    void *value;
 
-    assert(table->buckets_no && *table->buckets_no > 0);
+    // cached from hashed_key, so that lookups and rehashes never need to touch the key itself
+    uint64_t hash;
+    size_t key_len;
+};
 
-    // we accept a few reallocations when we rehash for the sake of simplicity
-    // TODO: add a magical "extra cap" value
-    struct dicey_hashtable *new_table = hash_new(table->buckets_no + 1, 0);
-    if (!new_table) {
-        return false;
-    }
+struct dicey_hashtable {
+    uint32_t len;
+    uint32_t cap;         // power of two, and a multiple of GROUP_WIDTH
+    uint32_t growth_left; // how many EMPTY slots can still be filled before the table must be rehashed
 
-    // steal the old table's entries
-    const struct table_entry *const end = table->entries + table->cap;
-    for (struct table_entry *it = table->entries; it < end; ++it) {
-        if (!it->key) {
-            continue;
-        }
+    int8_t *ctrl; // `cap` control bytes, allocated right after the slots
 
-        struct maybe_owned_str stolen_key = { .str = it->key, .owned = true };
+    struct table_slot slots[];
+};
 
-        const enum dicey_hash_set_result res = hash_set(&new_table, stolen_key, it->value, NULL);
+static uint32_t max_load(const uint32_t cap) {
+    // 7/8 load factor; probing is cheap enough thanks to the control bytes that a denser table pays off
+    return cap - cap / 8U;
+}
 
-        // this is impossible, keys are unique
-        assert(res != DICEY_HASH_SET_UPDATED);
+static bool slot_is_full(const struct dicey_hashtable *const table, const size_t idx) {
+    return table->ctrl[idx] >= 0;
+}
 
-        if (!res) {
-            // free the new table - without deleting anything. The keys are all still in place in the old one.
-            // Everything is fine. The old table is still valid and the new one is not.
-            free(new_table);
-            maybe_free(key);
+static bool slot_matches(const struct table_slot *const slot, const struct hashed_key *const key) {
+    return slot->hash == key->hash && slot->key_len == key->len && !memcmp(slot->key, key->str, key->len);
+}
 
-            return false;
-        }
-    }
+// triangular probing over whole groups. With a power of two number of groups this visits every group exactly once
+struct probe_seq {
+    size_t group;
+    size_t stride;
+    size_t mask;
+};
 
-    // set the last value
-    void *old_value;
-    const enum dicey_hash_set_result res = hash_set(&new_table, key, value, &old_value);
-    if (!res) {
-        free(new_table);
-        maybe_free(key);
+static struct probe_seq probe_start(const struct dicey_hashtable *const table, const uint64_t hash) {
+    const size_t mask = table->cap / GROUP_WIDTH - 1U;
 
-        return false;
-    }
+    return (struct probe_seq) {
+        .group = hash_h1(hash) & mask,
+        .stride = 0U,
+        .mask = mask,
+    };
+}
 
-    // free the old table without deleting the keys
-    free(table);
+static bool probe_next(struct probe_seq *const seq) {
+    if (seq->stride >= seq->mask) {
+        return false; // every group has been visited
+    }
 
-    *table_ptr = new_table;
+    ++seq->stride;
+    seq->group = (seq->group + seq->stride) & seq->mask;
 
     return true;
 }
 
-static bool hash_grow(struct dicey_hashtable **const table_ptr) {
-    assert(table_ptr && *table_ptr);
-
-    struct dicey_hashtable *table = *table_ptr;
-    assert(table->buckets_no && *table->buckets_no > 0);
+static ptrdiff_t table_find(const struct dicey_hashtable *const table, const struct hashed_key *const key) {
+    assert(table && key);
 
-    const uint32_t old_cap = table->cap;
-    assert(old_cap >= (uint32_t) *table->buckets_no);
+    const int8_t h2 = hash_h2(key->hash);
+    struct probe_seq seq = probe_start(table, key->hash);
 
-    const uint32_t new_cap = old_cap * 3 / 2;
-    if (new_cap <= old_cap) {
-        return false;
-    }
+    do {
+        const size_t base = seq.group * GROUP_WIDTH;
+        const int8_t *const ctrl = table->ctrl + base;
 
-    table = realloc(table, sizeof(struct dicey_hashtable) + new_cap * sizeof(struct table_entry));
-    if (!table) {
-        return false;
-    }
+        for (group_mask mask = group_match(ctrl, h2); mask; mask = mask_next(mask)) {
+            const size_t idx = base + mask_first(mask);
 
-    // zero the new values. _technically_ UB, but works everywhere
-    memset(table->entries + old_cap, 0, (new_cap - old_cap) * sizeof(struct table_entry));
-    table->cap = new_cap;
+            if (slot_matches(&table->slots[idx], key)) {
+                return (ptrdiff_t) idx;
+            }
+        }
 
-    *table_ptr = table;
+        // a group with an EMPTY slot was never full, so no key ever probed past it
+        if (group_match_empty(ctrl)) {
+            break;
+        }
+    } while (probe_next(&seq));
 
-    return true;
+    return -1;
 }
 
-static bool hash_bucket_append(
-    struct dicey_hashtable **const table_ptr,
-    const size_t last_item,
-    struct maybe_owned_str key,
-    void *const value
-) {
-    assert(table_ptr && *table_ptr && key.str);
-
-    struct dicey_hashtable *table = *table_ptr;
+// returns the first EMPTY or DELETED slot in the probe sequence of `hash`. The table must have at least one
+static size_t table_find_free(const struct dicey_hashtable *const table, const uint64_t hash) {
+    struct probe_seq seq = probe_start(table, hash);
 
-    assert(last_item < table->cap);
+    do {
+        const size_t base = seq.group * GROUP_WIDTH;
+        const group_mask mask = group_match_free(table->ctrl + base);
 
-    if (table->free_cur >= table->cap) {
-        if (!hash_grow(table_ptr)) {
-            return false;
+        if (mask) {
+            return base + mask_first(mask);
         }
+    } while (probe_next(&seq));
 
-        table = *table_ptr;
-    }
+    // the load factor guarantees that there's always a free slot
+    DICEY_UNREACHABLE();
 
-    assert(table->free_cur < table->cap);
+    return 0U;
+}
 
-    const char *const new_key = maybe_take(&key);
-    if (!new_key) {
-        return false;
+static struct dicey_hashtable *table_new(const uint32_t cap) {
+    assert(cap >= MIN_CAP && !(cap & (cap - 1U)));
+
+    const size_t size = sizeof(struct dicey_hashtable) + (size_t) cap * (sizeof(struct table_slot) + 1U);
+
+    struct dicey_hashtable *const table = malloc(size);
+    if (!table) {
+        return NULL;
     }
 
-    const size_t new_entry_offs = table->free_cur++;
-    struct table_entry *new_entry = table->entries + new_entry_offs;
-    *new_entry = (struct table_entry) {
-        .key = (char *) new_key,
-        .value = value,
+    *table = (struct dicey_hashtable) {
+        .cap = cap,
+        .growth_left = max_load(cap),
+        .ctrl = (int8_t *) (table->slots + cap),
     };
 
-    struct table_entry *const last = table->entries + last_item;
-    last->next = new_entry_offs;
+    memset(table->ctrl, (unsigned char) CTRL_EMPTY, cap);
 
-    ++table->len; // don't forget to increment the length!
-
-    return true;
+    return table;
 }
 
-static uint32_t load_factor(const uint32_t len, const uint32_t buckets_no) {
-    assert(len * 100 >= len); // check for overflow
+static void table_put_slot(struct dicey_hashtable *const table, const size_t idx, const struct table_slot slot) {
+    assert(idx < table->cap && !slot_is_full(table, idx));
 
-    return len * 100 / buckets_no;
-}
+    if (table->ctrl[idx] == CTRL_EMPTY) {
+        assert(table->growth_left);
 
-enum dicey_hash_set_result hash_set(
-    struct dicey_hashtable **table_ptr,
-    struct maybe_owned_str key,
-    void *const value,
-    void **const old_value
-) {
-    assert(table_ptr && *table_ptr && key.str);
+        --table->growth_left;
+    }
 
-    struct dicey_hashtable *table = *table_ptr;
+    table->ctrl[idx] = hash_h2(slot.hash);
+    table->slots[idx] = slot;
 
-    struct table_entry *first_free = NULL;
+    ++table->len;
+}
 
-    size_t bucket_end = 0;
-    struct table_entry *const existing = hash_get_entry_for_set(table, key.str, &first_free, &bucket_end);
+// moves all the entries of `*table_ptr` to a new table, dropping all DELETED slots. The table grows only if it is
+// actually full, not if it merely filled up with DELETED slots. The keys are moved, not copied, so their addresses
+// do not change
+static bool table_rehash(struct dicey_hashtable **const table_ptr) {
+    assert(table_ptr && *table_ptr);
 
-    enum dicey_hash_set_result res = DICEY_HASH_SET_FAILED;
+    struct dicey_hashtable *const table = *table_ptr;
 
-    if (existing) {
-        // no old_value means the client doesn't care about the old value
-        if (old_value) {
-            *old_value = existing->value;
+    uint32_t new_cap = table->cap;
+    if (table->len >= max_load(table->cap) / 2U) {
+        if (new_cap > UINT32_MAX / 2U) {
+            return false;
         }
 
-        existing->value = value;
-
-        res = DICEY_HASH_SET_UPDATED;
-
-        goto finish;
+        new_cap *= 2U;
     }
 
-    // the value doesn't exist - set the old value to NULL
-    if (old_value) {
-        *old_value = NULL;
+    struct dicey_hashtable *const new_table = table_new(new_cap);
+    if (!new_table) {
+        return false;
     }
 
-    const uint32_t new_len = table->len + 1;
-    assert(table->buckets_no && *table->buckets_no > 0);
+    for (size_t i = 0U; i < table->cap; ++i) {
+        if (slot_is_full(table, i)) {
+            const struct table_slot slot = table->slots[i];
 
-    if (load_factor(new_len, (uint32_t) *table->buckets_no) >= REHASH_THRESHOLD) {
-        if (!hash_rehash_and_set_new(&table, maybe_move(&key), value)) {
-            res = DICEY_HASH_SET_FAILED;
-            goto finish;
+            table_put_slot(new_table, table_find_free(new_table, slot.hash), slot);
         }
-
-        assert(table);
-
-        *table_ptr = table;
-
-        res = DICEY_HASH_SET_ADDED;
-
-        goto finish;
     }
 
-    if (first_free) {
-        first_free->key = maybe_take(&key);
-        if (!first_free->key) {
-            return DICEY_HASH_SET_FAILED;
-        }
-
-        first_free->value = value;
-
-        table->len = new_len;
-
-        res = DICEY_HASH_SET_ADDED;
+    assert(new_table->len == table->len);
 
-        goto finish;
-    }
-
-    // if we reached this point then the bucket has no holes and we need to add a new entry at the end
-    res = hash_bucket_append(table_ptr, bucket_end, maybe_move(&key), value) ? DICEY_HASH_SET_ADDED
-                                                                             : DICEY_HASH_SET_FAILED;
+    free(table);
 
-finish:
-    maybe_free(key);
+    *table_ptr = new_table;
 
-    return res;
+    return true;
 }
 
 void dicey_hashtable_delete(struct dicey_hashtable *const table, dicey_hashtable_free_fn *const free_fn) {
@@ -439,14 +415,18 @@ void dicey_hashtable_delete(struct dicey_hashtable *const table, dicey_hashtable
         return;
     }
 
-    const struct table_entry *const end = table->entries + table->cap;
+    for (size_t i = 0U; i < table->cap; ++i) {
+        if (!slot_is_full(table, i)) {
+            continue;
+        }
+
+        struct table_slot *const slot = &table->slots[i];
 
-    for (struct table_entry *entry = table->entries; entry < end; ++entry) {
-        free((void *) entry->key); // all these strings are malloc'd
+        free((void *) slot->key); // all these strings are malloc'd
 
         if (free_fn) {
             // values are not owned by the table
-            free_fn(entry->value);
+            free_fn(slot->value);
         }
     }
 
@@ -456,43 +436,38 @@ void dicey_hashtable_delete(struct dicey_hashtable *const table, dicey_hashtable
 struct dicey_hashtable_iter dicey_hashtable_iter_start(const struct dicey_hashtable *const table) {
     return (struct dicey_hashtable_iter) {
         ._table = table,
-        ._current = table ? table->entries : NULL,
+        ._current = table ? table->slots : NULL,
     };
 }
 
 bool dicey_hashtable_iter_next(struct dicey_hashtable_iter *const iter, const char **const key, void **const value) {
     assert(iter);
 
-    const struct dicey_hashtable *const ht = iter->_table;
-    const struct table_entry *cell = iter->_current;
+    const struct dicey_hashtable *const table = iter->_table;
+    const struct table_slot *slot = iter->_current;
 
-    if (!ht || !cell) {
+    if (!table || !slot) {
         goto iter_end;
     }
 
-    const struct table_entry *const end = ht->entries + ht->cap;
-    if (cell >= end) {
-        goto iter_end;
-    }
-
-    // skip empty cells
-    while (!cell->key) {
-        if (++cell >= end) {
-            goto iter_end;
-        }
-    }
+    const struct table_slot *const end = table->slots + table->cap;
 
-    if (key) {
-        *key = cell->key;
-    }
+    // skip free slots. Removing the current entry while iterating is fine, because entries never move
+    for (; slot < end; ++slot) {
+        if (slot_is_full(table, (size_t) (slot - table->slots))) {
+            if (key) {
+                *key = slot->key;
+            }
 
-    if (value) {
-        *value = cell->value;
-    }
+            if (value) {
+                *value = slot->value;
+            }
 
-    iter->_current = cell + 1;
+            iter->_current = slot + 1;
 
-    return true;
+            return true;
+        }
+    }
 
 iter_end:
     iter->_current = NULL;
@@ -515,63 +490,127 @@ void *dicey_hashtable_get_entry(
 ) {
     assert(entry);
 
-    // we know as a fact we aren't going to edit the table and that we are the only one able to allocate new tables
-    // we can thus cast away constness without ever incurring in UB
-    const struct table_entry *const table_entry = hash_get_entry((struct dicey_hashtable *) table, key);
-    if (!table_entry) {
+    if (!table || !key) {
+        return NULL;
+    }
+
+    const struct hashed_key hkey = hashed_key(key);
+
+    const ptrdiff_t idx = table_find(table, &hkey);
+    if (idx < 0) {
         return NULL;
     }
 
+    const struct table_slot *const slot = &table->slots[idx];
+
     *entry = (struct dicey_hashtable_entry) {
-        .key = table_entry->key,
-        .value = table_entry->value,
+        .key = slot->key,
+        .value = slot->value,
     };
 
-    return table_entry->value;
+    return slot->value;
 }
 
-void *dicey_hashtable_remove(struct dicey_hashtable *table, const char *const key) {
-    // remove is simple: just set the key to NULL and return the value
-    // the entry will be reused when a new key is added, or skipped if the table is rehashed
-    // during search the entry will be skipped if the key is NULL
+void *dicey_hashtable_remove(struct dicey_hashtable *const table, const char *const key) {
+    if (!table || !key) {
+        return NULL;
+    }
+
+    const struct hashed_key hkey = hashed_key(key);
 
-    struct table_entry *const entry = hash_get_entry(table, key);
-    if (!entry) {
+    const ptrdiff_t idx = table_find(table, &hkey);
+    if (idx < 0) {
         return NULL;
     }
 
     assert(table->len);
 
-    void *const value = entry->value;
+    struct table_slot *const slot = &table->slots[idx];
+    void *const value = slot->value;
 
-    free((void *) entry->key); // the key is malloc'd
+    free((void *) slot->key); // the key is malloc'd
 
-    entry->key = NULL;
-    entry->value = NULL;
+    *slot = (struct table_slot) { 0 };
 
-    --table->len;
+    // if the group still has an EMPTY slot it has never been full, so no probe sequence goes through it and the slot
+    // can go straight back to EMPTY. Otherwise, leave a DELETED marker so that lookups keep probing past it
+    const int8_t *const group = table->ctrl + ((size_t) idx & ~(size_t) (GROUP_WIDTH - 1U));
+    if (group_match_empty(group)) {
+        table->ctrl[idx] = CTRL_EMPTY;
+        ++table->growth_left;
+    } else {
+        table->ctrl[idx] = CTRL_DELETED;
+    }
 
-    // leave the next offset as is, this cell is now a free cell and will be reused when a new key is added
+    --table->len;
 
     return value;
 }
 
 enum dicey_hash_set_result dicey_hashtable_set(
-    struct dicey_hashtable **table_ptr,
+    struct dicey_hashtable **const table_ptr,
     const char *const key,
     void *const value,
     void **const old_value
 ) {
-    assert(table_ptr);
+    assert(table_ptr && key);
 
     if (!*table_ptr) {
-        *table_ptr = hash_new_default();
+        *table_ptr = table_new(MIN_CAP);
         if (!*table_ptr) {
             return DICEY_HASH_SET_FAILED;
         }
     }
 
-    return hash_set(table_ptr, (struct maybe_owned_str) { .str = (char *) key, .owned = false }, value, old_value);
+    const struct hashed_key hkey = hashed_key(key);
+
+    const ptrdiff_t existing = table_find(*table_ptr, &hkey);
+    if (existing >= 0) {
+        struct table_slot *const slot = &(*table_ptr)->slots[existing];
+
+        // no old_value means the client doesn't care about the old value
+        if (old_value) {
+            *old_value = slot->value;
+        }
+
+        slot->value = value;
+
+        return DICEY_HASH_SET_UPDATED;
+    }
+
+    // the value doesn't exist - set the old value to NULL
+    if (old_value) {
+        *old_value = NULL;
+    }
+
+    size_t idx = table_find_free(*table_ptr, hkey.hash);
+
+    // reusing a DELETED slot never requires a rehash; filling an EMPTY one does if the table is at its load limit
+    if ((*table_ptr)->ctrl[idx] == CTRL_EMPTY && !(*table_ptr)->growth_left) {
+        if (!table_rehash(table_ptr)) {
+            return DICEY_HASH_SET_FAILED;
+        }
+
+        idx = table_find_free(*table_ptr, hkey.hash);
+    }
+
+    const char *const owned_key = strdup(key);
+    if (!owned_key) {
+        return DICEY_HASH_SET_FAILED;
+    }
+
+    table_put_slot(
+        *table_ptr,
+        idx,
+        (struct table_slot) {
+            .key = owned_key,
+            .value = value,
+            .hash = hkey.hash,
+            .key_len = hkey.len,
+        }
+    );
+
+    return DICEY_HASH_SET_ADDED;
 }
 
 uint32_t dicey_hashtable_size(const struct dicey_hashtable *const table) {
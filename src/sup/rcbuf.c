@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <uv.h>
+
+#include "rcbuf.h"
+
+// at most this many idle slab blocks are kept around (i.e. 4MB)
+#define SLAB_CACHE_MAX 64U
+
+struct dicey_rcbuf {
+    _Atomic size_t refc;
+    size_t cap;
+
+    struct dicey_rcbuf *next_free; // only meaningful while the block sits in the slab cache
+
+    char bytes[];
+};
+
+#define SLAB_CAP (DICEY_RCBUF_SLAB_SIZE - sizeof(struct dicey_rcbuf))
+
+static struct slab_cache {
+    uv_mutex_t lock;
+    bool usable;
+
+    struct dicey_rcbuf *head;
+    size_t count;
+} slab_cache = { 0 };
+
+static uv_once_t slab_cache_flag = UV_ONCE_INIT;
+
+static void slab_cache_init(void) {
+    // if the mutex can't be initialised the cache is simply never used, and all blocks go through malloc/free
+    slab_cache.usable = !uv_mutex_init(&slab_cache.lock);
+}
+
+static bool slab_cache_give(struct dicey_rcbuf *const buf) {
+    assert(buf && buf->cap == SLAB_CAP);
+
+    uv_once(&slab_cache_flag, &slab_cache_init);
+    if (!slab_cache.usable) {
+        return false;
+    }
+
+    bool taken = false;
+
+    uv_mutex_lock(&slab_cache.lock);
+
+    if (slab_cache.count < SLAB_CACHE_MAX) {
+        buf->next_free = slab_cache.head;
+        slab_cache.head = buf;
+        ++slab_cache.count;
+
+        taken = true;
+    }
+
+    uv_mutex_unlock(&slab_cache.lock);
+
+    return taken;
+}
+
+static struct dicey_rcbuf *slab_cache_take(void) {
+    uv_once(&slab_cache_flag, &slab_cache_init);
+    if (!slab_cache.usable) {
+        return NULL;
+    }
+
+    uv_mutex_lock(&slab_cache.lock);
+
+    struct dicey_rcbuf *const buf = slab_cache.head;
+    if (buf) {
+        slab_cache.head = buf->next_free;
+        --slab_cache.count;
+    }
+
+    uv_mutex_unlock(&slab_cache.lock);
+
+    return buf;
+}
+
+struct dicey_rcbuf *dicey_rcbuf_new(const size_t min_cap) {
+    struct dicey_rcbuf *buf = NULL;
+    size_t cap = SLAB_CAP;
+
+    if (min_cap <= SLAB_CAP) {
+        buf = slab_cache_take();
+
+        if (!buf) {
+            buf = malloc(DICEY_RCBUF_SLAB_SIZE);
+        }
+    } else {
+        // too big for a slab block: allocate exactly what's been asked for. These are never cached
+        if (min_cap > SIZE_MAX - sizeof *buf) {
+            return NULL;
+        }
+
+        cap = min_cap;
+        buf = malloc(sizeof *buf + cap);
+    }
+
+    if (buf) {
+        atomic_init(&buf->refc, 1U);
+        buf->cap = cap;
+        buf->next_free = NULL;
+    }
+
+    return buf;
+}
+
+char *dicey_rcbuf_bytes(struct dicey_rcbuf *const buf) {
+    assert(buf);
+
+    return buf->bytes;
+}
+
+size_t dicey_rcbuf_cap(const struct dicey_rcbuf *const buf) {
+    assert(buf);
+
+    return buf->cap;
+}
+
+bool dicey_rcbuf_is_shared(const struct dicey_rcbuf *const buf) {
+    assert(buf);
+
+    return atomic_load(&buf->refc) > 1U;
+}
+
+void dicey_rcbuf_ref(struct dicey_rcbuf *const buf) {
+    assert(buf && atomic_load(&buf->refc) > 0U);
+
+    atomic_fetch_add(&buf->refc, 1U);
+}
+
+void dicey_rcbuf_unref(struct dicey_rcbuf *const buf) {
+    if (!buf) {
+        return;
+    }
+
+    const size_t old = atomic_fetch_sub(&buf->refc, 1U);
+    assert(old > 0U);
+
+    if (old == 1U) {
+        if (buf->cap == SLAB_CAP && slab_cache_give(buf)) {
+            return;
+        }
+
+        free(buf);
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(PWSNMBQXFE_RCBUF_H)
+#define PWSNMBQXFE_RCBUF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dicey_config.h"
+
+#if defined(DICEY_CC_IS_MSVC)
+#pragma warning(disable : 4200)
+#endif
+
+// size of a single slab block, header included. Buffers requested with a capacity that fits in a slab block are
+// recycled through a small process-wide cache instead of going back to the allocator every time
+#define DICEY_RCBUF_SLAB_SIZE ((size_t) 64U * 1024U) // 64KB
+
+// a refcounted byte buffer. Used as backing storage for received data, so that packets can borrow slices of it
+// without copying. The buffer is released when its last reference is dropped - from any thread
+struct dicey_rcbuf;
+
+// allocates a new buffer with at least `min_cap` bytes of capacity, and a refcount of 1
+struct dicey_rcbuf *dicey_rcbuf_new(size_t min_cap);
+
+char *dicey_rcbuf_bytes(struct dicey_rcbuf *buf);
+size_t dicey_rcbuf_cap(const struct dicey_rcbuf *buf);
+
+// true if anything else besides the caller holds a reference to this buffer (i.e. its contents must not be touched)
+bool dicey_rcbuf_is_shared(const struct dicey_rcbuf *buf);
+
+void dicey_rcbuf_ref(struct dicey_rcbuf *buf);
+void dicey_rcbuf_unref(struct dicey_rcbuf *buf);
+
+#endif // PWSNMBQXFE_RCBUF_H
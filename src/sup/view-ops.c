@@ -24,6 +24,7 @@
 #include <dicey/core/errors.h>
 #include <dicey/core/views.h>
 
+#include "bufpool.h"
 #include "trace.h"
 #include "unsafe.h"
 #include "util.h"
@@ -142,8 +143,9 @@ ptrdiff_t dicey_view_mut_ensure_cap(struct dicey_view_mut *const dest, const siz
             return TRACE(DICEY_EOVERFLOW);
         }
 
-        // if, and only if, the buffer is NULL, we allocate a new one
-        void *new_alloc = calloc(required, 1U);
+        // if, and only if, the buffer is NULL, we allocate a new one. Only packet payloads are built this way, so the
+        // buffer comes from the packet pool and must be released with dicey_bufpool_free
+        void *new_alloc = dicey_bufpool_calloc(required);
         if (!new_alloc) {
             return TRACE(DICEY_ENOMEM);
         }
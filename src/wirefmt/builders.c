@@ -19,6 +19,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <dicey/core/builders.h>
 #include <dicey/core/errors.h>
@@ -29,12 +30,32 @@
 
 #include "dtf/dtf.h"
 
+#include "sup/bufpool.h"
 #include "sup/trace.h"
+#include "sup/util.h"
 #include "sup/view-ops.h"
 
 #include "packet-args.h"
 
 #define DEFAULT_VAL_CAP 16U
+#define DEFAULT_STREAM_CAP 256U
+
+// list headers are written by the streaming builders as prefixes of an array header, and patched the same way
+static_assert(
+    offsetof(struct dtf_array_header, nitems) == offsetof(struct dtf_tuple_header, nitems),
+    "array and tuple headers must keep nitems at the same offset"
+);
+
+// the state of a streaming message builder. It lives on the heap, so value builders can keep referring to it even if
+// the message builder is moved around (e.g., when the server compacts its pending requests)
+struct _dicey_message_builder_stream {
+    unsigned char *data;
+    size_t len, cap;
+    size_t value_at; // the value starts here: everything before it is room reserved for the message header
+
+    size_t depth;    // number of lists currently open
+    bool incomplete; // a value builder was handed out, but nothing has been written through it yet
+};
 
 enum builder_state {
     BUILDER_STATE_IDLE = 0,
@@ -47,6 +68,9 @@ enum builder_state {
     BUILDER_STATE_TUPLE,
 };
 
+// set alongside the state of streaming builders, whose _stream shares its storage with the _root of regular ones
+#define BUILDER_STREAMING_FLAG 0x100
+
 static enum dicey_error arglist_grow(struct _dicey_value_builder_list *const list) {
     const size_t new_cap = list->cap ? list->cap * 3U / 2U : DEFAULT_VAL_CAP;
 
@@ -65,20 +89,43 @@ static enum builder_state builder_state_get(const void *const builder) {
     assert(builder);
 
     // all builders start with an integer state, or a struct which starts with an integer state
-    return *(const int *) builder;
+    return *(const int *) builder & ~BUILDER_STREAMING_FLAG;
 }
 
 static void builder_state_set(const void *const builder, const enum builder_state state) {
     assert(builder);
 
     // all builders start with an integer state, or a struct which starts with an integer state
-    *(int *) builder = state;
+    int *const builder_state = (int *) builder;
+
+    *builder_state = (*builder_state & BUILDER_STREAMING_FLAG) | (int) state;
+}
+
+static struct _dicey_message_builder_stream *msgbuilder_stream(const struct dicey_message_builder *const builder) {
+    assert(builder);
+
+    return builder->_state & BUILDER_STREAMING_FLAG ? builder->_stream : NULL;
+}
+
+static struct _dicey_message_builder_stream *valbuilder_stream(const struct dicey_value_builder *const builder) {
+    assert(builder);
+
+    return builder->_state & BUILDER_STREAMING_FLAG ? builder->_stream : NULL;
+}
+
+static bool msgbuilder_has_value(const struct dicey_message_builder *const builder) {
+    assert(builder);
+
+    const struct _dicey_message_builder_stream *const stream = msgbuilder_stream(builder);
+
+    // every value takes at least one byte, which is either its type or, for array elements, its content
+    return stream ? stream->len > stream->value_at : (bool) { builder->_root };
 }
 
 static bool msgbuilder_is_complete(const struct dicey_message_builder *const builder) {
     assert(builder);
 
-    return builder->_state == BUILDER_STATE_PENDING
+    return builder_state_get(builder) == BUILDER_STATE_PENDING
            // the path must always be set in order for a builder to be valid
            && builder->_path
            // the selector must be valid
@@ -86,7 +133,7 @@ static bool msgbuilder_is_complete(const struct dicey_message_builder *const bui
            // validate that the operation is not junk
            && dicey_op_is_valid(builder->_type)
            // get messages must not have a root, everything else does
-           && (builder->_type == DICEY_OP_GET) != (bool) { builder->_root };
+           && (builder->_type == DICEY_OP_GET) != msgbuilder_has_value(builder);
 }
 
 static ptrdiff_t msgkind_to_dtf(const enum dicey_op kind) {
@@ -114,14 +161,455 @@ static ptrdiff_t msgkind_to_dtf(const enum dicey_op kind) {
     }
 }
 
+static enum dicey_error stream_reserve(struct _dicey_message_builder_stream *const stream, const size_t size) {
+    assert(stream);
+
+    if (size <= stream->cap - stream->len) {
+        return DICEY_OK;
+    }
+
+    // no DTF message can ever be larger than this
+    if (size > UINT32_MAX - stream->len) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    const size_t required = stream->len + size;
+
+    size_t new_cap = stream->cap ? stream->cap : DEFAULT_STREAM_CAP;
+    while (new_cap < required) {
+        new_cap = new_cap <= SIZE_MAX / 2U ? new_cap * 2U : required;
+    }
+
+    unsigned char *const new_data = dicey_bufpool_realloc(stream->data, new_cap);
+    if (!new_data) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    // the pool rounds the block up to its size class: make use of all of it before growing again
+    stream->data = new_data;
+    stream->cap = dicey_bufpool_usable_size(new_data);
+
+    return DICEY_OK;
+}
+
+static enum dicey_error stream_write(
+    struct _dicey_message_builder_stream *const stream,
+    const void *const data,
+    const size_t size
+) {
+    const enum dicey_error err = stream_reserve(stream, size);
+    if (err) {
+        return err;
+    }
+
+    memcpy(stream->data + stream->len, data, size);
+    stream->len += size;
+
+    return DICEY_OK;
+}
+
+static size_t stream_list_header_size(const enum builder_state list_kind) {
+    switch (list_kind) {
+    case BUILDER_STATE_ARRAY:
+        return sizeof(struct dtf_array_header);
+
+    case BUILDER_STATE_PAIR:
+        return sizeof(struct dtf_pair_header);
+
+    case BUILDER_STATE_TUPLE:
+        return sizeof(struct dtf_tuple_header);
+
+    default:
+        assert(false);
+
+        return 0U;
+    }
+}
+
+static enum dicey_error msgbuilder_stream_build(
+    struct dicey_message_builder *const builder,
+    const enum dtf_payload_kind kind,
+    struct dicey_packet *const packet
+) {
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+
+    if (dutl_zstring_size(builder->_path) == DICEY_EOVERFLOW) {
+        return TRACE(DICEY_EPATH_TOO_LONG);
+    }
+
+    const ptrdiff_t header_size = dtf_message_estimate_header_size(kind, builder->_path, builder->_selector);
+    if (header_size < 0) {
+        return (enum dicey_error) header_size;
+    }
+
+    const size_t value_len = stream->len - stream->value_at;
+
+    if ((size_t) header_size != stream->value_at) {
+        // the header was not known (or has changed) since the value was started: move the value to make room for it
+        if ((size_t) header_size > stream->value_at) {
+            const enum dicey_error err = stream_reserve(stream, (size_t) header_size - stream->value_at);
+            if (err) {
+                return err;
+            }
+        }
+
+        if (value_len) {
+            memmove(stream->data + header_size, stream->data + stream->value_at, value_len);
+        }
+
+        stream->value_at = (size_t) header_size;
+        stream->len = stream->value_at + value_len;
+    }
+
+    struct dicey_view_mut header = { .data = stream->data, .len = (size_t) header_size };
+
+    const ptrdiff_t write_res = dtf_message_write_header(
+        &header, kind, builder->_seq, builder->_path, builder->_selector, value_len
+    );
+
+    if (write_res < 0) {
+        return (enum dicey_error) write_res;
+    }
+
+    // give back the excess capacity if it's a significant chunk of the buffer
+    if (stream->cap - stream->len > stream->len / 4U) {
+        unsigned char *const shrunk = dicey_bufpool_realloc(stream->data, stream->len);
+        if (shrunk) {
+            stream->data = shrunk;
+            stream->cap = dicey_bufpool_usable_size(shrunk);
+        }
+    }
+
+    *packet = (struct dicey_packet) {
+        .payload = stream->data,
+        .nbytes = (uint32_t) stream->len,
+    };
+
+    // the buffer now belongs to the packet
+    stream->data = NULL;
+
+    dicey_message_builder_discard(builder);
+
+    return DICEY_OK;
+}
+
+static enum dicey_error msgbuilder_stream_value_start(
+    struct dicey_message_builder *const builder,
+    struct dicey_value_builder *const value
+) {
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+
+    // if the path and the selector are already known, leave room for the header so that it can be written in place
+    size_t value_at = 0U;
+    if (builder->_path && dicey_selector_is_valid(builder->_selector) && dicey_op_is_valid(builder->_type)) {
+        const ptrdiff_t header_size = dtf_message_estimate_header_size(
+            (enum dtf_payload_kind) msgkind_to_dtf(builder->_type), builder->_path, builder->_selector
+        );
+
+        // any error will be reported again by build()
+        value_at = header_size > 0 ? (size_t) header_size : 0U;
+    }
+
+    // drop any previously set value
+    stream->len = 0U;
+
+    const enum dicey_error err = stream_reserve(stream, value_at);
+    if (err) {
+        return err;
+    }
+
+    stream->len = stream->value_at = value_at;
+    stream->depth = 0U;
+    stream->incomplete = true;
+
+    builder_state_set(builder, BUILDER_STATE_VALUE);
+    builder->_borrowed_to = value;
+
+    *value = (struct dicey_value_builder) {
+        ._state = BUILDER_STATE_PENDING | BUILDER_STREAMING_FLAG,
+        ._stream = stream,
+    };
+
+    return DICEY_OK;
+}
+
 #if !defined(NDEBUG)
 
 static bool valbuilder_is_valid(const struct dicey_value_builder *const builder) {
-    return builder && builder->_root;
+    return builder && (valbuilder_stream(builder) || builder->_root);
 }
 
 #endif
 
+// writes the type of a value that is about to be written to the stream if the value is a variant, or checks it against
+// the type the value is required to have (i.e. the type of the array it belongs to) otherwise
+static enum dicey_error valbuilder_stream_open(
+    struct dicey_value_builder *const builder,
+    const enum dicey_type type
+) {
+    assert(builder && valbuilder_stream(builder));
+
+    // before the value is set, _list.type holds the type it is required to have
+    const enum dicey_type required = builder->_list.type;
+    if (dicey_type_is_valid(required)) {
+        return required == type ? DICEY_OK : TRACE(DICEY_EVALUE_TYPE_MISMATCH);
+    }
+
+    const struct dtf_value_header header = { .type = (dtf_typeid) type };
+
+    return stream_write(builder->_stream, &header, sizeof header);
+}
+
+static enum dicey_error valbuilder_stream_list_end(struct dicey_value_builder *const builder) {
+    assert(valbuilder_is_valid(builder) && valbuilder_stream(builder));
+
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+    const struct _dicey_value_builder_list *const list = &builder->_list;
+    const enum builder_state list_kind = builder_state_get(builder);
+
+    // a nested list is still open, or the last element was never written
+    if (stream->depth != list->depth || stream->incomplete) {
+        return TRACE(DICEY_EAGAIN);
+    }
+
+    if (list_kind == BUILDER_STATE_PAIR && list->nitems != 2) {
+        return TRACE(DICEY_EAGAIN);
+    }
+
+    const size_t content_at = list->header_at + stream_list_header_size(list_kind);
+    assert(content_at <= stream->len);
+
+    if (stream->len - content_at > DTF_SIZE_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    // nbytes is always the first field of a list header, followed by nitems for arrays and tuples
+    const dtf_size nbytes = (dtf_size) (stream->len - content_at);
+    memcpy(stream->data + list->header_at, &nbytes, sizeof nbytes);
+
+    if (list_kind != BUILDER_STATE_PAIR) {
+        const dtf_nmemb nitems = list->nitems;
+        memcpy(stream->data + list->header_at + offsetof(struct dtf_tuple_header, nitems), &nitems, sizeof nitems);
+    }
+
+    --stream->depth;
+
+    *builder = (struct dicey_value_builder) { 0 };
+
+    return DICEY_OK;
+}
+
+static enum dicey_error valbuilder_stream_list_start(
+    struct dicey_value_builder *const builder,
+    const enum builder_state list_kind,
+    const enum dicey_type type
+) {
+    assert(valbuilder_is_valid(builder) && valbuilder_stream(builder));
+
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+    const size_t start = stream->len;
+
+    enum dicey_type list_type = DICEY_TYPE_INVALID;
+    switch (list_kind) {
+    case BUILDER_STATE_ARRAY:
+        list_type = DICEY_TYPE_ARRAY;
+        break;
+
+    case BUILDER_STATE_PAIR:
+        list_type = DICEY_TYPE_PAIR;
+        break;
+
+    case BUILDER_STATE_TUPLE:
+        list_type = DICEY_TYPE_TUPLE;
+        break;
+
+    default:
+        assert(false);
+    }
+
+    enum dicey_error err = valbuilder_stream_open(builder, list_type);
+    if (err) {
+        return err;
+    }
+
+    const size_t header_at = stream->len;
+
+    // the sizes are unknown until the list ends, so they are patched in by valbuilder_stream_list_end
+    const struct dtf_array_header header = { .type = (dtf_typeid) type };
+
+    err = stream_write(stream, &header, stream_list_header_size(list_kind));
+    if (err) {
+        stream->len = start;
+
+        return err;
+    }
+
+    builder->_list = (struct _dicey_value_builder_list) {
+        .type = type,
+        .header_at = header_at,
+        .depth = ++stream->depth,
+    };
+
+    stream->incomplete = false;
+
+    builder_state_set(builder, list_kind);
+
+    return DICEY_OK;
+}
+
+static enum dicey_error valbuilder_stream_next(
+    struct dicey_value_builder *const builder,
+    struct dicey_value_builder *const elem
+) {
+    assert(valbuilder_is_valid(builder) && valbuilder_stream(builder) && elem);
+
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+    struct _dicey_value_builder_list *const list = &builder->_list;
+
+    // elements are written in order, so the previous one must be complete before the next one can start
+    if (stream->depth != list->depth || stream->incomplete) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (list->nitems >= DTF_NMEMB_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    ++list->nitems;
+    stream->incomplete = true;
+
+    *elem = (struct dicey_value_builder) {
+        ._state = BUILDER_STATE_PENDING | BUILDER_STREAMING_FLAG,
+        ._stream = stream,
+        ._list = {
+            .type = builder_state_get(builder) == BUILDER_STATE_ARRAY ? list->type : DICEY_TYPE_INVALID,
+        },
+    };
+
+    return DICEY_OK;
+}
+
+static enum dicey_error valbuilder_stream_set_array(
+    struct dicey_value_builder *const builder,
+    const enum dicey_type type,
+    const void *const elems,
+    const dtf_nmemb nitems,
+    const size_t elem_size
+) {
+    assert(valbuilder_is_valid(builder) && valbuilder_stream(builder));
+
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+
+    // DTF stores fixed-size elements back to back, exactly as a C array does
+    const size_t nbytes = nitems * elem_size;
+    if (nbytes > DTF_SIZE_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    enum dicey_error err = stream_reserve(
+        stream, sizeof(struct dtf_value_header) + sizeof(struct dtf_array_header) + nbytes
+    );
+
+    if (err) {
+        return err;
+    }
+
+    err = valbuilder_stream_open(builder, DICEY_TYPE_ARRAY);
+    if (err) {
+        return err;
+    }
+
+    const struct dtf_array_header header = {
+        .nbytes = (dtf_size) nbytes,
+        .nitems = nitems,
+        .type = (dtf_typeid) type,
+    };
+
+    memcpy(stream->data + stream->len, &header, sizeof header);
+    stream->len += sizeof header;
+
+    if (nbytes) {
+        memcpy(stream->data + stream->len, elems, nbytes);
+        stream->len += nbytes;
+    }
+
+    stream->incomplete = false;
+
+    builder_state_set(builder, BUILDER_STATE_IDLE);
+
+    return DICEY_OK;
+}
+
+static enum dicey_error valbuilder_stream_set(
+    struct dicey_value_builder *const builder,
+    const struct dicey_arg *const value
+) {
+    assert(valbuilder_is_valid(builder) && valbuilder_stream(builder) && value);
+
+    struct _dicey_message_builder_stream *const stream = builder->_stream;
+    const size_t start = stream->len;
+
+    const ptrdiff_t fixed_size = dtf_type_size(value->type);
+    if (fixed_size != DTF_SIZE_DYNAMIC) {
+        // scalars are stored as they are in memory, so they can skip the generic writer. This is the hot path for large
+        // arrays of numbers
+        enum dicey_error err = stream_reserve(stream, sizeof(struct dtf_value_header) + (size_t) fixed_size);
+        if (err) {
+            return err;
+        }
+
+        err = valbuilder_stream_open(builder, value->type);
+        if (err) {
+            return err;
+        }
+
+        // all scalar members of the union start at the same offset
+        memcpy(stream->data + stream->len, (const unsigned char *) value + offsetof(struct dicey_arg, u64), fixed_size);
+
+        stream->len += (size_t) fixed_size;
+        stream->incomplete = false;
+
+        builder_state_set(builder, BUILDER_STATE_IDLE);
+
+        return DICEY_OK;
+    }
+
+    // the estimate always accounts for the type of the value, even if it ends up not being written
+    const ptrdiff_t size = dtf_value_estimate_size(value);
+    if (size < 0) {
+        return (enum dicey_error) size;
+    }
+
+    enum dicey_error err = stream_reserve(stream, (size_t) size);
+    if (err) {
+        return err;
+    }
+
+    err = valbuilder_stream_open(builder, value->type);
+    if (err) {
+        return err;
+    }
+
+    struct dtf_bytes_writer writer = dtf_bytes_writer_new((struct dicey_view_mut) {
+        .data = stream->data + stream->len,
+        .len = stream->cap - stream->len,
+    });
+
+    const ptrdiff_t written = dtf_value_write_content_to(&writer, value);
+    if (written < 0) {
+        stream->len = start;
+
+        return (enum dicey_error) written;
+    }
+
+    stream->len += (size_t) written;
+    stream->incomplete = false;
+
+    builder_state_set(builder, BUILDER_STATE_IDLE);
+
+    return DICEY_OK;
+}
+
 static enum dicey_error valbuilder_list_start(
     struct dicey_value_builder *const builder,
     const enum builder_state list_kind,
@@ -133,6 +621,10 @@ static enum dicey_error valbuilder_list_start(
         return TRACE(DICEY_EINVAL);
     }
 
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_list_start(builder, list_kind, type);
+    }
+
     builder->_list = (struct _dicey_value_builder_list) { 0 };
 
     if (list_kind == BUILDER_STATE_ARRAY) {
@@ -161,6 +653,28 @@ enum dicey_error dicey_message_builder_begin(struct dicey_message_builder *const
     return DICEY_OK;
 }
 
+enum dicey_error dicey_message_builder_begin_streaming(
+    struct dicey_message_builder *const builder,
+    const enum dicey_op op
+) {
+    const enum dicey_error err = dicey_message_builder_begin(builder, op);
+    if (err) {
+        return err;
+    }
+
+    struct _dicey_message_builder_stream *const stream = calloc(1U, sizeof *stream);
+    if (!stream) {
+        dicey_message_builder_discard(builder);
+
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    builder->_state |= BUILDER_STREAMING_FLAG;
+    builder->_stream = stream;
+
+    return DICEY_OK;
+}
+
 enum dicey_error dicey_message_builder_build(
     struct dicey_message_builder *const builder,
     struct dicey_packet *const packet
@@ -180,6 +694,10 @@ enum dicey_error dicey_message_builder_build(
         return payload_kind;
     }
 
+    if (msgbuilder_stream(builder)) {
+        return msgbuilder_stream_build(builder, (enum dtf_payload_kind) payload_kind, packet);
+    }
+
     const struct dtf_result craft_res = dtf_message_write(
         DICEY_NULL,
         (enum dtf_payload_kind) payload_kind,
@@ -206,14 +724,21 @@ enum dicey_error dicey_message_builder_build(
 void dicey_message_builder_discard(struct dicey_message_builder *const builder) {
     assert(builder);
 
-    if (builder->_borrowed_to) {
-        // free any lingering list elements
-        const struct _dicey_value_builder_list *const list = &builder->_borrowed_to->_list;
+    struct _dicey_message_builder_stream *const stream = msgbuilder_stream(builder);
 
-        dicey_arg_free_list(list->elems, list->nitems);
-    }
+    if (stream) {
+        dicey_bufpool_free(stream->data);
+        free(stream);
+    } else {
+        if (builder->_borrowed_to) {
+            // free any lingering list elements
+            const struct _dicey_value_builder_list *const list = &builder->_borrowed_to->_list;
 
-    dicey_arg_free(builder->_root);
+            dicey_arg_free_list(list->elems, list->nitems);
+        }
+
+        dicey_arg_free(builder->_root);
+    }
 
     *builder = (struct dicey_message_builder) { 0 };
 }
@@ -315,6 +840,10 @@ enum dicey_error dicey_message_builder_value_start(
         return TRACE(DICEY_EINVAL);
     }
 
+    if (msgbuilder_stream(builder)) {
+        return msgbuilder_stream_value_start(builder, value);
+    }
+
     builder_state_set(builder, BUILDER_STATE_VALUE);
 
     struct dicey_arg *const root = calloc(1U, sizeof(struct dicey_arg));
@@ -349,9 +878,17 @@ enum dicey_error dicey_message_builder_value_end(
         return TRACE(DICEY_EINVAL);
     }
 
+    struct _dicey_message_builder_stream *const stream = msgbuilder_stream(builder);
+    if (stream && (stream->depth || stream->incomplete)) {
+        // the value was left incomplete: drop it, so build() will report the message as such
+        stream->len = stream->value_at;
+        stream->depth = 0U;
+        stream->incomplete = false;
+    }
+
     *value = (struct dicey_value_builder) { 0 };
 
-    builder->_state = BUILDER_STATE_PENDING;
+    builder_state_set(builder, BUILDER_STATE_PENDING);
     builder->_borrowed_to = NULL;
 
     return DICEY_OK;
@@ -431,6 +968,10 @@ enum dicey_error dicey_value_builder_array_end(struct dicey_value_builder *const
         return TRACE(DICEY_EINVAL);
     }
 
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_list_end(builder);
+    }
+
     const struct _dicey_value_builder_list *const list = &builder->_list;
 
     assert(!list->nitems || list->elems);
@@ -487,6 +1028,10 @@ enum dicey_error dicey_value_builder_next(
         return TRACE(DICEY_EINVAL);
     }
 
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_next(builder, elem);
+    }
+
     struct _dicey_value_builder_list *const list = &builder->_list;
 
     if (list->nitems >= list->cap) {
@@ -522,6 +1067,10 @@ enum dicey_error dicey_value_builder_pair_end(struct dicey_value_builder *const
         return TRACE(DICEY_EINVAL);
     }
 
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_list_end(builder);
+    }
+
     const struct _dicey_value_builder_list *const list = &builder->_list;
 
     assert(list->nitems <= 2);
@@ -569,6 +1118,10 @@ enum dicey_error dicey_value_builder_set(struct dicey_value_builder *const build
         return TRACE(DICEY_EINVAL);
     }
 
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_set(builder, &value);
+    }
+
     const struct dicey_arg *const root = builder->_root;
 
     if (dicey_type_is_valid(root->type) && root->type != value.type) {
@@ -587,6 +1140,70 @@ enum dicey_error dicey_value_builder_set(struct dicey_value_builder *const build
     return DICEY_OK;
 }
 
+enum dicey_error dicey_value_builder_set_array(
+    struct dicey_value_builder *const builder,
+    const enum dicey_type type,
+    const void *const elems,
+    const size_t nitems
+) {
+    assert(valbuilder_is_valid(builder) && (elems || !nitems));
+
+    if (builder_state_get(builder) != BUILDER_STATE_PENDING) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (!dicey_type_is_valid(type)) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    const ptrdiff_t elem_size = dtf_type_size(type);
+    if (elem_size == DTF_SIZE_DYNAMIC || elem_size <= 0) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (nitems > DTF_NMEMB_MAX) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_set_array(builder, type, elems, (dtf_nmemb) nitems, (size_t) elem_size);
+    }
+
+    const struct dicey_arg *const root = builder->_root;
+
+    if (dicey_type_is_valid(root->type) && root->type != DICEY_TYPE_ARRAY) {
+        return TRACE(DICEY_EVALUE_TYPE_MISMATCH);
+    }
+
+    struct dicey_arg *const args = nitems ? calloc(nitems, sizeof *args) : NULL;
+    if (nitems && !args) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    const unsigned char *elem = elems;
+    for (size_t i = 0U; i < nitems; ++i, elem += elem_size) {
+        args[i].type = type;
+
+        memcpy((unsigned char *) &args[i] + offsetof(struct dicey_arg, u64), elem, (size_t) elem_size);
+    }
+
+    // free any previously set value
+    dicey_arg_free_contents(root);
+
+    *builder->_root = (struct dicey_arg) {
+        .type = DICEY_TYPE_ARRAY,
+        .array = {
+            .type = type,
+            .nitems = (uint16_t) nitems,
+            .elems = args,
+        },
+    };
+
+    builder_state_set(builder, BUILDER_STATE_IDLE);
+
+    return DICEY_OK;
+}
+
 enum dicey_error dicey_value_builder_tuple_start(struct dicey_value_builder *const builder) {
     return valbuilder_list_start(builder, BUILDER_STATE_TUPLE, DICEY_TYPE_INVALID);
 }
@@ -598,6 +1215,10 @@ enum dicey_error dicey_value_builder_tuple_end(struct dicey_value_builder *const
         return TRACE(DICEY_EINVAL);
     }
 
+    if (valbuilder_stream(builder)) {
+        return valbuilder_stream_list_end(builder);
+    }
+
     const struct _dicey_value_builder_list *const list = &builder->_list;
 
     assert(!list->nitems || list->elems);
@@ -25,6 +25,7 @@
 #include <dicey/core/value.h>
 #include <dicey/core/views.h>
 
+#include "sup/bufpool.h"
 #include "sup/trace.h"
 #include "sup/util.h"
 #include "sup/view-ops.h"
@@ -333,12 +334,56 @@ struct dtf_result dtf_message_write(
 
 fail:
     if (alloc_res > 0) {
-        free(msg);
+        dicey_bufpool_free(msg);
     }
 
     return (struct dtf_result) { .result = result, .size = (size_t) needed_len };
 }
 
+ptrdiff_t dtf_message_write_header(
+    struct dicey_view_mut *const dest,
+    const enum dtf_payload_kind kind,
+    const uint32_t seq,
+    const char *const path,
+    const struct dicey_selector selector,
+    const size_t value_len
+) {
+    assert(dest && dest->data);
+
+    if (dutl_zstring_size(path) == DICEY_EOVERFLOW) {
+        return TRACE(DICEY_EPATH_TOO_LONG);
+    }
+
+    const ptrdiff_t header_size = dtf_message_estimate_header_size(kind, path, selector);
+    if (header_size < 0) {
+        return header_size;
+    }
+
+    if (value_len > UINT32_MAX - (size_t) header_size) {
+        return TRACE(DICEY_EOVERFLOW);
+    }
+
+    const uint32_t trailer_size =
+        (uint32_t) header_size - (uint32_t) sizeof(struct dtf_message_head) + (uint32_t) value_len;
+
+    ptrdiff_t result = message_header_write(dest, kind, seq, trailer_size);
+    if (result < 0) {
+        return result;
+    }
+
+    result = dicey_view_mut_write_zstring(dest, path);
+    if (result < 0) {
+        return result;
+    }
+
+    result = dtf_selector_write(selector, dest);
+    if (result < 0) {
+        return result;
+    }
+
+    return header_size;
+}
+
 struct dtf_result dtf_message_write_with_raw_value(
     struct dicey_view_mut dest,
     const enum dtf_payload_kind kind,
@@ -373,19 +418,7 @@ struct dtf_result dtf_message_write_with_raw_value(
 
     struct dtf_message *const msg = dest.data;
 
-    const uint32_t trailer_size = (uint32_t) needed_len - (uint32_t) sizeof(struct dtf_message_head);
-
-    ptrdiff_t result = message_header_write(&dest, kind, seq, trailer_size);
-    if (result < 0) {
-        goto fail;
-    }
-
-    result = dicey_view_mut_write_zstring(&dest, path);
-    if (result < 0) {
-        goto fail;
-    }
-
-    result = dtf_selector_write(selector, &dest);
+    ptrdiff_t result = dtf_message_write_header(&dest, kind, seq, path, selector, value.len);
     if (result < 0) {
         goto fail;
     }
@@ -402,7 +435,7 @@ struct dtf_result dtf_message_write_with_raw_value(
 
 fail:
     if (alloc_res > 0) {
-        free(msg);
+        dicey_bufpool_free(msg);
     }
 
     return (struct dtf_result) { .result = result, .size = (size_t) needed_len };
@@ -480,71 +513,72 @@ ptrdiff_t dtf_payload_get_seq(const union dtf_payload payload) {
     return payload.header->seq;
 }
 
-struct dtf_result dtf_payload_load(union dtf_payload *const payload, struct dicey_view *const src) {
-    assert(src);
-
-    struct dtf_result res = { 0 };
-
+// checks whether `src` starts with a complete payload, and returns its size in bytes or a negative error code.
+// DICEY_EAGAIN means that the data is not complete yet
+static ptrdiff_t payload_measure(const struct dicey_view src) {
     // ensure we have at least the message kind
-    if (!src->data || src->len < sizeof(struct dtf_payload_head)) {
-        return (struct dtf_result) { .result = TRACE(DICEY_EAGAIN) };
+    if (!src.data || src.len < sizeof(struct dtf_payload_head)) {
+        return TRACE(DICEY_EAGAIN);
     }
 
     struct dtf_payload_head head = { 0 };
-    ptrdiff_t read_res = payload_header_read(&head, &(struct dicey_view) { .data = src->data, .len = sizeof head });
+    const ptrdiff_t read_res =
+        payload_header_read(&head, &(struct dicey_view) { .data = src.data, .len = sizeof head });
 
     if (read_res < 0) {
-        return (struct dtf_result) {
-            .result = read_res == DICEY_EOVERFLOW ? DICEY_EAGAIN : read_res,
-        };
+        return read_res == DICEY_EOVERFLOW ? DICEY_EAGAIN : read_res;
     }
 
     // get the base size of the message (fixed part)
     ptrdiff_t needed_len = message_fixed_size(head.kind);
     if (needed_len < 0) {
-        return (struct dtf_result) { .result = TRACE(DICEY_EBADMSG) };
+        return TRACE(DICEY_EBADMSG);
     }
 
-    if ((size_t) needed_len > src->len) {
-        return (struct dtf_result) { .result = TRACE(DICEY_EAGAIN) };
+    if ((size_t) needed_len > src.len) {
+        return TRACE(DICEY_EAGAIN);
     }
 
     // get the trailer, if any. Given that the trailer size is part of the fixed part, we know already if it's
     // available for the given message kind (or it's 0)
-    const ptrdiff_t trailer_size = trailer_read_size(*src, head.kind);
+    const ptrdiff_t trailer_size = trailer_read_size(src, head.kind);
     if (trailer_size < 0) {
-        return (struct dtf_result) { .result = trailer_size };
+        return trailer_size;
     }
 
     if (!payload_kind_is_valid(head.kind)) {
-        res.result = TRACE(DICEY_EBADMSG);
-
-        return res;
+        return TRACE(DICEY_EBADMSG);
     }
 
     if (!dutl_checked_add(&needed_len, needed_len, trailer_size)) {
-        res.result = TRACE(DICEY_EOVERFLOW);
+        return TRACE(DICEY_EOVERFLOW);
+    }
 
-        return res;
+    if ((size_t) needed_len > src.len) {
+        return TRACE(DICEY_EAGAIN);
     }
 
-    if ((size_t) needed_len > src->len) {
-        res.result = TRACE(DICEY_EAGAIN);
+    return needed_len;
+}
 
-        return res;
+struct dtf_result dtf_payload_load(union dtf_payload *const payload, struct dicey_view *const src) {
+    assert(src);
+
+    const ptrdiff_t needed_len = payload_measure(*src);
+    if (needed_len < 0) {
+        return (struct dtf_result) { .result = needed_len };
     }
 
     // allocate the payload and then load it
-    void *const data = malloc((size_t) needed_len);
+    void *const data = dicey_bufpool_alloc((size_t) needed_len);
     if (!data) {
-        res.result = TRACE(DICEY_ENOMEM);
-
-        return res;
+        return (struct dtf_result) { .result = TRACE(DICEY_ENOMEM) };
     }
 
     struct dicey_view remainder = *src;
-    read_res = dicey_view_read_ptr(&remainder, data, (size_t) needed_len);
+    const ptrdiff_t read_res = dicey_view_read_ptr(&remainder, data, (size_t) needed_len);
     assert(read_res >= 0);
+    DICEY_UNUSED(read_res);
 
     // success: return the payload and advance the pointer
     *src = remainder;
@@ -553,6 +587,27 @@ struct dtf_result dtf_payload_load(union dtf_payload *const payload, struct dice
     return (struct dtf_result) { .result = DICEY_OK, .data = data, .size = (size_t) needed_len };
 }
 
+struct dtf_result dtf_payload_load_borrowed(union dtf_payload *const payload, struct dicey_view *const src) {
+    assert(src);
+
+    const ptrdiff_t needed_len = payload_measure(*src);
+    if (needed_len < 0) {
+        return (struct dtf_result) { .result = needed_len };
+    }
+
+    // the payload points straight into the source data, which must outlive it. Casting away const is fine - the
+    // source is always a mutable receive buffer, and borrowed payloads are never written to
+    void *const data = (void *) src->data;
+
+    const ptrdiff_t adv_res = dicey_view_advance(src, needed_len);
+    assert(adv_res >= 0);
+    DICEY_UNUSED(adv_res);
+
+    *payload = (union dtf_payload) { .header = data };
+
+    return (struct dtf_result) { .result = DICEY_OK, .data = data, .size = (size_t) needed_len };
+}
+
 enum dicey_error dtf_payload_set_seq(const union dtf_payload msg, const uint32_t seq) {
     if (!msg.header) {
         return TRACE(DICEY_EINVAL);
@@ -99,6 +99,17 @@ struct dtf_result dtf_message_write(
     const struct dicey_arg *value
 );
 
+// writes the fixed header, path and selector of a message whose value, `value_len` bytes long, will follow right after.
+// `dest` must already be large enough to hold the header; returns the number of bytes written
+ptrdiff_t dtf_message_write_header(
+    struct dicey_view_mut *dest,
+    enum dtf_payload_kind kind,
+    uint32_t seq,
+    const char *path,
+    struct dicey_selector selector,
+    size_t value_len
+);
+
 struct dtf_result dtf_message_write_with_raw_value(
     struct dicey_view_mut dest,
     enum dtf_payload_kind kind,
@@ -123,6 +134,9 @@ ptrdiff_t dtf_payload_get_seq(union dtf_payload msg);
 
 struct dtf_result dtf_payload_load(union dtf_payload *dest, struct dicey_view *src);
 
+// same as dtf_payload_load, but the payload is not copied: it points straight into `src`, which must outlive it
+struct dtf_result dtf_payload_load_borrowed(union dtf_payload *dest, struct dicey_view *src);
+
 enum dicey_error dtf_payload_set_seq(union dtf_payload msg, uint32_t seq);
 
 #endif // DTF_DHCBDDHD_H
@@ -234,7 +234,7 @@ static ptrdiff_t tuple_probe(struct dicey_view *const src, union _dicey_data_inf
     return read_bytes;
 }
 
-ptrdiff_t type_size(const enum dicey_type type) {
+ptrdiff_t dtf_type_size(const enum dicey_type type) {
     switch (type) {
     default:
         assert(false);
@@ -392,7 +392,7 @@ ptrdiff_t dtf_value_probe_as(
         return TRACE(DICEY_EINVAL);
     }
 
-    const ptrdiff_t size = type_size(type);
+    const ptrdiff_t size = dtf_type_size(type);
     assert(size >= 0);
 
     return size == DTF_SIZE_DYNAMIC ? value_probe_dynamic(type, src, info)
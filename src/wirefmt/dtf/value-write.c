@@ -24,6 +24,7 @@
 #include <dicey/core/value.h>
 #include <dicey/core/views.h>
 
+#include "sup/bufpool.h"
 #include "sup/trace.h"
 #include "sup/util.h"
 #include "sup/view-ops.h"
@@ -426,7 +427,7 @@ struct dtf_valueres dtf_value_write(struct dicey_view_mut dest, const struct dic
     const ptrdiff_t write_res = dtf_value_write_to(&writer, item);
     if (write_res < 0) {
         if (!alloc_res) {
-            free(dest.data);
+            dicey_bufpool_free(dest.data);
         }
 
         return (struct dtf_valueres) { .result = write_res, .size = (size_t) size };
@@ -439,3 +440,7 @@ struct dtf_valueres dtf_value_write(struct dicey_view_mut dest, const struct dic
 ptrdiff_t dtf_value_write_to(struct dtf_bytes_writer *const writer, const struct dicey_arg *const item) {
     return item_write(writer, item, ITEM_POLICY_VARIANT);
 }
+
+ptrdiff_t dtf_value_write_content_to(struct dtf_bytes_writer *const writer, const struct dicey_arg *const item) {
+    return item_write(writer, item, ITEM_POLICY_EXACT);
+}
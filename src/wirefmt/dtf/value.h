@@ -49,6 +49,9 @@ struct dtf_valueres {
     struct dtf_value *value;
 };
 
+// the size of values of the given type, or DTF_SIZE_DYNAMIC if it depends on the value itself
+ptrdiff_t dtf_type_size(enum dicey_type type);
+
 ptrdiff_t dtf_value_estimate_size(const struct dicey_arg *item);
 
 ptrdiff_t dtf_value_probe(struct dicey_view *src, struct dtf_probed_value *info);
@@ -58,4 +61,7 @@ ptrdiff_t dtf_value_probe_type(struct dicey_view *src);
 struct dtf_valueres dtf_value_write(struct dicey_view_mut dest, const struct dicey_arg *item);
 ptrdiff_t dtf_value_write_to(struct dtf_bytes_writer *writer, const struct dicey_arg *item);
 
+// same as dtf_value_write_to, but without the leading type id, as in the elements of an array
+ptrdiff_t dtf_value_write_content_to(struct dtf_bytes_writer *writer, const struct dicey_arg *item);
+
 #endif // CNHZVJKDMF_DTF_VALUE_H
@@ -73,7 +73,14 @@ static enum dicey_error value_list_to_arg(
     struct dicey_iterator iter = dicey_list_iter(&list);
     struct dicey_value value = { 0 };
 
-    while (dicey_iterator_next(&iter, &value)) {
+    while (dicey_iterator_has_next(iter)) {
+        enum dicey_error err = dicey_iterator_next(&iter, &value);
+        if (err) {
+            dicey_arg_free_list(elems, len);
+
+            return err;
+        }
+
         if (len == UINT16_MAX) {
             dicey_arg_free_list(elems, len);
 
@@ -93,7 +100,7 @@ static enum dicey_error value_list_to_arg(
             elems = new_elems;
         }
 
-        const enum dicey_error err = dicey_arg_from_borrowed_value(&elems[len], &value);
+        err = dicey_arg_from_borrowed_value(&elems[len], &value);
         if (err) {
             dicey_arg_free_list(elems, len);
 
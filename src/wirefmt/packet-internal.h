@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(GQXRMZEBKT_PACKET_INTERNAL_H)
+#define GQXRMZEBKT_PACKET_INTERNAL_H
+
+#include <stddef.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/packet.h>
+
+#include "sup/rcbuf.h"
+
+/**
+ * @brief Same as `dicey_packet_load`, but without copying the payload. The packet borrows its payload straight from
+ *        `*data`, which must point inside `owner`, and holds a reference to `owner` until it is deinit'ed.
+ */
+enum dicey_error dicey_packet_load_borrowed(
+    struct dicey_packet *packet,
+    const void **data,
+    size_t *nbytes,
+    struct dicey_rcbuf *owner
+);
+
+#endif // GQXRMZEBKT_PACKET_INTERNAL_H
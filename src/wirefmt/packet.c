@@ -20,18 +20,24 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <dicey/core/data-info.h>
 #include <dicey/core/errors.h>
+#include <dicey/core/packet-pool.h>
 #include <dicey/core/packet.h>
 #include <dicey/core/type.h>
 #include <dicey/core/views.h>
 
 #include "dtf/dtf.h"
 
+#include "sup/bufpool.h"
+#include "sup/rcbuf.h"
 #include "sup/trace.h"
 #include "sup/view-ops.h"
 
+#include "packet-internal.h"
+
 static bool is_valid_forward(const enum dicey_op from, const enum dicey_op to) {
     const bool from_is_get = from == DICEY_OP_GET, to_is_get = to == DICEY_OP_GET;
 
@@ -223,6 +229,7 @@ bool dicey_bye_reason_is_valid(const enum dicey_bye_reason reason) {
 
     case DICEY_BYE_REASON_SHUTDOWN:
     case DICEY_BYE_REASON_ERROR:
+    case DICEY_BYE_REASON_KICKED:
         return true;
     }
 }
@@ -238,6 +245,9 @@ const char *dicey_bye_reason_to_string(const enum dicey_bye_reason reason) {
 
     case DICEY_BYE_REASON_ERROR:
         return "ERROR";
+
+    case DICEY_BYE_REASON_KICKED:
+        return "KICKED";
     }
 }
 
@@ -451,7 +461,7 @@ enum dicey_error dicey_packet_bye(
 ) {
     assert(dest && dicey_bye_reason_is_valid(reason));
 
-    struct dtf_bye *const bye = calloc(1U, sizeof *bye);
+    struct dtf_bye *const bye = dicey_bufpool_calloc(sizeof *bye);
     if (!bye) {
         return TRACE(DICEY_ENOMEM);
     }
@@ -467,7 +477,7 @@ enum dicey_error dicey_packet_bye(
 
     if (write_res.result < 0) {
         assert(write_res.result != DICEY_EOVERFLOW);
-        free(bye);
+        dicey_bufpool_free(bye);
 
         return write_res.result;
     }
@@ -480,15 +490,68 @@ enum dicey_error dicey_packet_bye(
     return DICEY_OK;
 }
 
+enum dicey_error dicey_packet_clone(struct dicey_packet *const dest, const struct dicey_packet src) {
+    assert(dest);
+
+    if (!dicey_packet_is_valid(src)) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    void *const payload = dicey_bufpool_alloc(src.nbytes);
+    if (!payload) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    memcpy(payload, src.payload, src.nbytes);
+
+    *dest = (struct dicey_packet) {
+        .payload = payload,
+        .nbytes = src.nbytes,
+    };
+
+    return DICEY_OK;
+}
+
 void dicey_packet_deinit(struct dicey_packet *const packet) {
     if (packet) {
-        // not UB: the payload is always allocated with {c,m}alloc so it's originally void*
-        free((void *) packet->payload);
+        if (packet->_owner) {
+            // borrowed payload: it lives inside the receive buffer, which goes away with its last reference
+            dicey_rcbuf_unref(packet->_owner);
+        } else {
+            // not UB: owned payloads always come from the packet pool, so they are originally void*
+            dicey_bufpool_free((void *) packet->payload);
+        }
 
         *packet = (struct dicey_packet) { 0 };
     }
 }
 
+enum dicey_error dicey_packet_detach(struct dicey_packet *const packet) {
+    if (!packet || !dicey_packet_is_valid(*packet)) {
+        return TRACE(DICEY_EINVAL);
+    }
+
+    if (!packet->_owner) {
+        return DICEY_OK; // already owns its payload
+    }
+
+    void *const payload = dicey_bufpool_alloc(packet->nbytes);
+    if (!payload) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    memcpy(payload, packet->payload, packet->nbytes);
+
+    dicey_rcbuf_unref(packet->_owner);
+
+    *packet = (struct dicey_packet) {
+        .payload = payload,
+        .nbytes = packet->nbytes,
+    };
+
+    return DICEY_OK;
+}
+
 enum dicey_error dicey_packet_dump(const struct dicey_packet packet, void **const data, size_t *const nbytes) {
     assert(dicey_packet_is_valid(packet) && data && *data && nbytes);
 
@@ -551,7 +614,7 @@ enum dicey_error dicey_packet_hello(
 ) {
     assert(dest);
 
-    struct dtf_hello *const hello = calloc(1U, sizeof *hello);
+    struct dtf_hello *const hello = dicey_bufpool_calloc(sizeof *hello);
     if (!hello) {
         return TRACE(DICEY_ENOMEM);
     }
@@ -567,7 +630,7 @@ enum dicey_error dicey_packet_hello(
 
     if (write_res.result < 0) {
         assert(write_res.result != DICEY_EOVERFLOW);
-        free(hello);
+        dicey_bufpool_free(hello);
 
         return write_res.result;
     }
@@ -614,7 +677,12 @@ DICEY_EXPORT const char *dicey_packet_kind_to_string(enum dicey_packet_kind kind
     }
 }
 
-enum dicey_error dicey_packet_load(struct dicey_packet *const packet, const void **const data, size_t *const nbytes) {
+static enum dicey_error packet_load(
+    struct dicey_packet *const packet,
+    const void **const data,
+    size_t *const nbytes,
+    struct dicey_rcbuf *const owner
+) {
     if (!(packet && data && *data && nbytes)) {
         return TRACE(DICEY_EINVAL);
     }
@@ -625,7 +693,8 @@ enum dicey_error dicey_packet_load(struct dicey_packet *const packet, const void
     };
 
     union dtf_payload payload = { 0 };
-    const struct dtf_result load_res = dtf_payload_load(&payload, &src);
+    const struct dtf_result load_res =
+        owner ? dtf_payload_load_borrowed(&payload, &src) : dtf_payload_load(&payload, &src);
     if (load_res.result < 0) {
         return load_res.result;
     }
@@ -675,11 +744,49 @@ enum dicey_error dicey_packet_load(struct dicey_packet *const packet, const void
     *data = src.data;
     *nbytes = src.len;
 
+    if (owner) {
+        // the packet is now a view over the receive buffer, which must stay alive until the packet is deinit'ed
+        dicey_rcbuf_ref(owner);
+        packet->_owner = owner;
+    }
+
     return err;
 
 fail:
-    free(load_res.data);
+    if (!owner) {
+        dicey_bufpool_free(load_res.data);
+    }
+
     *packet = (struct dicey_packet) { 0 };
 
     return err;
 }
+
+enum dicey_error dicey_packet_load(struct dicey_packet *const packet, const void **const data, size_t *const nbytes) {
+    return packet_load(packet, data, nbytes, NULL);
+}
+
+enum dicey_error dicey_packet_load_borrowed(
+    struct dicey_packet *const packet,
+    const void **const data,
+    size_t *const nbytes,
+    struct dicey_rcbuf *const owner
+) {
+    assert(owner);
+
+    return packet_load(packet, data, nbytes, owner);
+}
+
+struct dicey_packet_pool_stats dicey_packet_pool_get_stats(void) {
+    const struct dicey_bufpool_stats stats = dicey_bufpool_get_stats();
+
+    return (struct dicey_packet_pool_stats) {
+        .hits = stats.hits,
+        .misses = stats.misses,
+        .bytes_cached = stats.bytes_cached,
+    };
+}
+
+size_t dicey_packet_pool_trim(void) {
+    return dicey_bufpool_trim();
+}
@@ -16,16 +16,25 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 
+#include <dicey/core/errors.h>
 #include <dicey/core/type.h>
 #include <dicey/core/typedescr.h>
 #include <dicey/core/value.h>
 #include <dicey/core/views.h>
 
+#include "sup/trace.h"
 #include "sup/util.h"
 #include "sup/view-ops.h"
 
+#include "value-validate.h"
+
+// signatures up to this size are compiled on the stack when checked directly from their string
+#define VALIDATOR_STACK_OPS 64U
+
 static bool is_compatible(const enum dicey_type value, const uint16_t type) {
     assert(dicey_type_is_valid(value));
 
@@ -44,6 +53,12 @@ static uint16_t take_elem(struct dicey_view *const sig) {
     return elem;
 }
 
+static uint16_t peek_elem(const struct dicey_view sig) {
+    struct dicey_view copy = sig;
+
+    return take_elem(&copy);
+}
+
 static int skip_char(struct dicey_view *const sig) {
     assert(sig);
 
@@ -58,33 +73,24 @@ static int skip_char(struct dicey_view *const sig) {
     return byte;
 }
 
-static bool checksig(struct dicey_view *const sig, const struct dicey_value *const value) {
-    assert(value && sig && dicey_view_is_valid(*sig));
+// compiles a single type from the (valid) signature in `sig` into `prog`, and returns a pointer past the last op
+// written. A signature never compiles to more ops than it has characters
+static uint16_t *compile_type(struct dicey_view *const sig, uint16_t *prog) {
+    assert(sig && prog && dicey_view_is_valid(*sig));
 
     const uint16_t elem_ty = take_elem(sig);
+    assert(elem_ty != DICEY_TYPE_INVALID); // the signature is assumed valid
 
-    if (!is_compatible(dicey_value_get_type(value), elem_ty)) {
-        return false;
-    }
+    *prog++ = elem_ty;
 
     switch (elem_ty) {
     case DICEY_TYPE_ARRAY:
         {
-            struct dicey_list list = { 0 };
-            DICEY_ASSUME(dicey_value_get_array(value, &list));
-
-            // The buffer here is like `t]`
-            // we must get the first byte of the signature, but we don't want to consume it.
-            // Copy the view instead.
-            struct dicey_view sig_copy = *sig;
-            const uint16_t array_ty = take_elem(&sig_copy);
-            assert(array_ty != DICEY_TYPE_INVALID); // the signature is assumed valid
-
-            if (!is_compatible(dicey_list_type(&list), array_ty)) {
-                return false;
-            }
+            // the elements of an array are all of the same type, which the list carries along. Checking that is enough
+            // to validate the whole array, so only its first byte is needed
+            *prog++ = peek_elem(*sig);
 
-            // we must now slurp the inner array signature using the signature parser, otherwise we will be out of sync
+            // slurp the inner array signature using the signature parser, otherwise we will be out of sync
             const bool valid = dicey_typedescr_in_view(sig);
             assert(valid);
             DICEY_UNUSED(valid); // MSVC again
@@ -94,7 +100,62 @@ static bool checksig(struct dicey_view *const sig, const struct dicey_value *con
             assert(cpar == ']'); // TODO: export this as a constant, this requires a new header though
             DICEY_UNUSED(cpar);  // MSVC discards the assert before parsing it, so cpar appears unused
 
-            return true;
+            return prog;
+        }
+
+    case DICEY_TYPE_TUPLE:
+        {
+            uint16_t *const nelems = prog++;
+            *nelems = 0U;
+
+            while (peek_elem(*sig) != ')') {
+                prog = compile_type(sig, prog);
+                ++*nelems;
+            }
+
+            const int cpar = skip_char(sig);
+            assert(cpar == ')'); // TODO: export this as a constant, this requires a new header though
+            DICEY_UNUSED(cpar);  // thank you again MSVC!
+
+            return prog;
+        }
+
+    case DICEY_TYPE_PAIR:
+        {
+            prog = compile_type(sig, prog);
+            prog = compile_type(sig, prog);
+
+            const int cpar = skip_char(sig);
+            assert(cpar == '}'); // TODO: export this as a constant, this requires a new header though
+            DICEY_UNUSED(cpar);  // MSVC again
+
+            return prog;
+        }
+
+    default:
+        return prog;
+    }
+}
+
+// runs the program at `*pc` against `value`. On success, `*pc` is moved past the program for the value's type
+static bool run_check(const uint16_t **const pc, const struct dicey_value *const value) {
+    assert(pc && *pc && value);
+
+    const uint16_t elem_ty = *(*pc)++;
+
+    if (!is_compatible(dicey_value_get_type(value), elem_ty)) {
+        return false;
+    }
+
+    switch (elem_ty) {
+    case DICEY_TYPE_ARRAY:
+        {
+            struct dicey_list list = { 0 };
+            DICEY_ASSUME(dicey_value_get_array(value, &list));
+
+            const uint16_t array_ty = *(*pc)++;
+
+            return is_compatible(dicey_list_type(&list), array_ty);
         }
 
     case DICEY_TYPE_TUPLE:
@@ -102,21 +163,20 @@ static bool checksig(struct dicey_view *const sig, const struct dicey_value *con
             struct dicey_list list = { 0 };
             DICEY_ASSUME(dicey_value_get_tuple(value, &list));
 
+            const uint16_t nelems = *(*pc)++;
+            uint16_t n = 0U;
+
             struct dicey_iterator iter = dicey_list_iter(&list);
             while (dicey_iterator_has_next(iter)) {
                 struct dicey_value elem = { 0 };
                 DICEY_ASSUME(dicey_iterator_next(&iter, &elem));
 
-                if (!checksig(sig, &elem)) {
+                if (n++ == nelems || !run_check(pc, &elem)) {
                     return false;
                 }
             }
 
-            const int cpar = skip_char(sig);
-            assert(cpar == ')'); // TODO: export this as a constant, this requires a new header though
-            DICEY_UNUSED(cpar);  // thank you again MSVC!
-
-            return true;
+            return n == nelems;
         }
 
     case DICEY_TYPE_PAIR:
@@ -124,19 +184,7 @@ static bool checksig(struct dicey_view *const sig, const struct dicey_value *con
             struct dicey_pair pair = { 0 };
             DICEY_ASSUME(dicey_value_get_pair(value, &pair));
 
-            if (!checksig(sig, &pair.first)) {
-                return false;
-            }
-
-            if (!checksig(sig, &pair.second)) {
-                return false;
-            }
-
-            const int cpar = skip_char(sig);
-            assert(cpar == '}'); // TODO: export this as a constant, this requires a new header though
-            DICEY_UNUSED(cpar);  // MSVC again
-
-            return true;
+            return run_check(pc, &pair.first) && run_check(pc, &pair.second);
         }
 
     default:
@@ -145,64 +193,143 @@ static bool checksig(struct dicey_view *const sig, const struct dicey_value *con
     }
 }
 
-bool dicey_value_can_be_returned_from(const struct dicey_value *value, const char *sigstr) {
-    assert(value && sigstr);
+static bool check_prog(const uint16_t *const prog, const struct dicey_value *const value) {
+    assert(prog && value);
 
-    if (dicey_value_get_type(value) == DICEY_TYPE_ERROR) {
-        return true; // errors can be returned by any operation or property
+    const uint16_t *pc = prog;
+
+    return run_check(&pc, value);
+}
+
+// compiles `sig` on the fly and checks `value` against it. Only used when no compiled program is available
+static bool check_sig(struct dicey_view sig, const struct dicey_value *const value) {
+    assert(value && dicey_view_is_valid(sig));
+
+    uint16_t stack_prog[VALIDATOR_STACK_OPS];
+    uint16_t *const prog = sig.len <= VALIDATOR_STACK_OPS ? stack_prog : calloc(sig.len, sizeof *prog);
+    if (!prog) {
+        return false;
+    }
+
+    (void) compile_type(&sig, prog);
+
+    const bool res = check_prog(prog, value);
+
+    if (prog != stack_prog) {
+        free(prog);
     }
 
+    return res;
+}
+
+static bool parse_sig(const char *const sigstr, struct dicey_view *const input, struct dicey_view *const output) {
+    assert(sigstr && input && output);
+
     struct dicey_typedescr descr = { 0 };
     if (!dicey_typedescr_parse(sigstr, &descr)) {
         return false;
     }
 
-    struct dicey_view sig = { 0 };
-
     switch (descr.kind) {
-    case DICEY_TYPEDESCR_INVALID:
+    case DICEY_TYPEDESCR_VALUE:
+        *input = *output = dicey_view_from_str(descr.value);
+
+        return true;
+
+    case DICEY_TYPEDESCR_FUNCTIONAL:
+        *input = descr.op.input;
+        *output = descr.op.output;
+
+        return true;
+
+    default:
         assert(false);
 
         return false;
+    }
+}
 
-    case DICEY_TYPEDESCR_VALUE:
-        sig = dicey_view_from_str(descr.value);
-        break;
+bool dicey_value_can_be_returned_from(const struct dicey_value *value, const char *sigstr) {
+    assert(value && sigstr);
 
-    case DICEY_TYPEDESCR_FUNCTIONAL:
-        sig = descr.op.output;
+    if (dicey_value_get_type(value) == DICEY_TYPE_ERROR) {
+        return true; // errors can be returned by any operation or property
+    }
 
-        break;
+    struct dicey_view input = { 0 }, output = { 0 };
+    if (!parse_sig(sigstr, &input, &output)) {
+        return false;
     }
 
-    return checksig(&sig, value);
+    return check_sig(output, value);
 }
 
 bool dicey_value_is_compatible_with(const struct dicey_value *const value, const char *const sigstr) {
     assert(value && sigstr);
 
-    struct dicey_typedescr descr = { 0 };
-    if (!dicey_typedescr_parse(sigstr, &descr)) {
+    struct dicey_view input = { 0 }, output = { 0 };
+    if (!parse_sig(sigstr, &input, &output)) {
         return false;
     }
 
-    struct dicey_view sig = { 0 };
+    return check_sig(input, value);
+}
 
-    switch (descr.kind) {
-    case DICEY_TYPEDESCR_INVALID:
-        assert(false);
+bool dicey_validator_accepts(const struct dicey_validator *const validator, const struct dicey_value *const value) {
+    assert(validator && validator->input && value);
 
-        return false;
+    return check_prog(validator->input, value);
+}
 
-    case DICEY_TYPEDESCR_VALUE:
-        sig = dicey_view_from_str(descr.value);
-        break;
+bool dicey_validator_can_return(const struct dicey_validator *const validator, const struct dicey_value *const value) {
+    assert(validator && validator->output && value);
 
-    case DICEY_TYPEDESCR_FUNCTIONAL:
-        sig = descr.op.input;
+    if (dicey_value_get_type(value) == DICEY_TYPE_ERROR) {
+        return true; // errors can be returned by any operation or property
+    }
+
+    return check_prog(validator->output, value);
+}
+
+void dicey_validator_deinit(struct dicey_validator *const validator) {
+    if (validator) {
+        free(validator->input); // output always lives in the same allocation
+
+        *validator = (struct dicey_validator) { 0 };
+    }
+}
+
+enum dicey_error dicey_validator_init(struct dicey_validator *const dest, const char *const sigstr) {
+    assert(dest && sigstr);
 
-        break;
+    struct dicey_view input = { 0 }, output = { 0 };
+    if (!parse_sig(sigstr, &input, &output)) {
+        return TRACE(DICEY_ESIGNATURE_MALFORMED);
     }
 
-    return checksig(&sig, value);
+    const bool is_functional = input.data != output.data;
+
+    // a signature never compiles to more ops than it has characters, so this is always enough room for both programs
+    const size_t max_ops = input.len + (is_functional ? output.len : 0U);
+    if (max_ops > UINT16_MAX) {
+        return TRACE(DICEY_EOVERFLOW); // tuple lengths are stored as uint16_t
+    }
+
+    uint16_t *const prog = calloc(max_ops, sizeof *prog);
+    if (!prog) {
+        return TRACE(DICEY_ENOMEM);
+    }
+
+    uint16_t *const output_prog = is_functional ? compile_type(&input, prog) : prog;
+    uint16_t *const end = compile_type(&output, output_prog);
+
+    assert((size_t) (end - prog) <= max_ops);
+    DICEY_UNUSED(end);
+
+    *dest = (struct dicey_validator) {
+        .input = prog,
+        .output = output_prog,
+    };
+
+    return DICEY_OK;
 }
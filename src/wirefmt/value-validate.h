@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2024-2025 Zuru Tech HK Limited, All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(RHVNQDXWJO_VALUE_VALIDATE_H)
+#define RHVNQDXWJO_VALUE_VALIDATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <dicey/core/errors.h>
+#include <dicey/core/value.h>
+
+// A signature compiled into a flat program, used to check values without parsing the signature text every time.
+// The program is a tree of nodes in prefix order: scalars are a single type id, arrays are followed by the type of
+// their elements, tuples by their number of elements and then by each element, pairs by their two elements
+struct dicey_validator {
+    uint16_t *input;  // the program for the values accepted by the element (i.e. the input of an operation)
+    uint16_t *output; // the program for the values returned by the element. Same as `input` for properties and signals
+};
+
+void dicey_validator_deinit(struct dicey_validator *validator);
+
+// compiles `sigstr`, which must be a valid signature
+enum dicey_error dicey_validator_init(struct dicey_validator *dest, const char *sigstr);
+
+// equivalent to dicey_value_is_compatible_with, using a compiled signature
+bool dicey_validator_accepts(const struct dicey_validator *validator, const struct dicey_value *value);
+
+// equivalent to dicey_value_can_be_returned_from, using a compiled signature
+bool dicey_validator_can_return(const struct dicey_validator *validator, const struct dicey_value *value);
+
+#endif // RHVNQDXWJO_VALUE_VALIDATE_H
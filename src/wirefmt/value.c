@@ -296,6 +296,37 @@ enum dicey_error dicey_value_get_array(const struct dicey_value *const value, st
     return dicey_value_get_list(value, dest);
 }
 
+enum dicey_error dicey_value_get_array_span(
+    const struct dicey_value *const value,
+    struct dicey_array_span *const dest
+) {
+    assert(value && dest);
+
+    if (dicey_value_get_type(value) != DICEY_TYPE_ARRAY) {
+        return TRACE(DICEY_EVALUE_TYPE_MISMATCH);
+    }
+
+    const struct dtf_probed_list *const list = &value->_data.list;
+
+    // unit has a fixed size too, but a span of zero-sized elements is useless
+    const ptrdiff_t elem_size = dtf_type_size(list->inner_type);
+    if (elem_size == DTF_SIZE_DYNAMIC || elem_size <= 0) {
+        return TRACE(DICEY_EVALUE_TYPE_MISMATCH);
+    }
+
+    if (list->data.len != (size_t) list->nitems * (size_t) elem_size) {
+        return TRACE(DICEY_EBADMSG);
+    }
+
+    *dest = (struct dicey_array_span) {
+        .type = list->inner_type,
+        .nitems = list->nitems,
+        .data = list->data.data,
+    };
+
+    return DICEY_OK;
+}
+
 DICEY_VALUE_GET_IMPL_TRIVIAL(bool, bool, DICEY_TYPE_BOOL, boolean)
 DICEY_VALUE_GET_IMPL_TRIVIAL(byte, uint8_t, DICEY_TYPE_BYTE, byte)
 